@@ -86,6 +86,12 @@ public:
      */
     ShaderVar operator[](const char* name) const { return getRootVar()[name]; }
 
+    /**
+     * Get a shader variable that points at the field with the given `name`.
+     * This is an alias for `getRootVar()[name]`.
+     */
+    ShaderVar operator[](const ShaderVarName& name) const { return getRootVar()[name]; }
+
     /**
      * Get a shader variable that points at the field/element with the given `index`.
      * This is an alias for `getRootVar()[index]`.
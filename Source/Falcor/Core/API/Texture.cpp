@@ -236,7 +236,7 @@ Texture::SharedPtr Texture::createFromFile(
     {
         try
         {
-            pTex = ImageIO::loadTextureFromDDS(pDevice, fullPath, loadAsSrgb);
+            pTex = ImageIO::loadTextureFromDDS(pDevice, fullPath, loadAsSrgb, bindFlags);
         }
         catch (const std::exception& e)
         {
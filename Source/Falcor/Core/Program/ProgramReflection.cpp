@@ -33,6 +33,7 @@
 
 #include <slang.h>
 
+#include <algorithm>
 #include <map>
 
 using namespace slang;
@@ -48,7 +49,7 @@ TypedShaderVarOffset::TypedShaderVarOffset(const ReflectionType* pType, ShaderVa
     : ShaderVarOffset(offset), mpType(pType->shared_from_this())
 {}
 
-TypedShaderVarOffset TypedShaderVarOffset::operator[](const std::string& name) const
+TypedShaderVarOffset TypedShaderVarOffset::operator[](const ShaderVarName& name) const
 {
     if (!isValid())
         return *this;
@@ -63,15 +64,10 @@ TypedShaderVarOffset TypedShaderVarOffset::operator[](const std::string& name) c
         }
     }
 
-    reportError(fmt::format("No member named '{}' found.", name));
+    reportError(fmt::format("No member named '{}' found.", name.getName()));
     return TypedShaderVarOffset();
 }
 
-TypedShaderVarOffset TypedShaderVarOffset::operator[](const char* name) const
-{
-    return (*this)[std::string(name)];
-}
-
 TypedShaderVarOffset TypedShaderVarOffset::operator[](size_t index) const
 {
     throw 99;
@@ -82,7 +78,7 @@ TypedShaderVarOffset ReflectionType::getZeroOffset() const
     return TypedShaderVarOffset(this, ShaderVarOffset::kZero);
 }
 
-TypedShaderVarOffset ReflectionType::getMemberOffset(const std::string& name) const
+TypedShaderVarOffset ReflectionType::getMemberOffset(const ShaderVarName& name) const
 {
     return getZeroOffset()[name];
 }
@@ -1602,6 +1598,18 @@ int32_t ReflectionStructType::addMemberIgnoringNameConflicts(
     auto memberIndex = int32_t(mMembers.size());
     mMembers.push_back(pVar);
 
+    // Keep members with uniform data sorted by offset for lookups by offset.
+    if (pVar->getType()->getByteSize() > 0)
+    {
+        auto it = std::upper_bound(
+            mOffsetToIndex.begin(),
+            mOffsetToIndex.end(),
+            pVar->getByteOffset(),
+            [this](size_t offset, int32_t index) { return offset < mMembers[index]->getByteOffset(); }
+        );
+        mOffsetToIndex.insert(it, memberIndex);
+    }
+
     auto pFieldType = pVar->getType();
     auto fieldRangeCount = pFieldType->getResourceRangeCount();
     for (uint32_t rr = 0; rr < fieldRangeCount; ++rr)
@@ -1654,9 +1662,9 @@ int32_t ReflectionStructType::addMemberIgnoringNameConflicts(
 
 int32_t ReflectionStructType::addMember(const std::shared_ptr<const ReflectionVar>& pVar, ReflectionStructType::BuildState& ioBuildState)
 {
-    if (mNameToIndex.find(pVar->getName()) != mNameToIndex.end())
+    int32_t index = getMemberIndex(pVar->getName());
+    if (index != kInvalidMemberIndex)
     {
-        int32_t index = mNameToIndex[pVar->getName()];
         if (*pVar != *mMembers[index])
         {
             throw RuntimeError(
@@ -1667,7 +1675,8 @@ int32_t ReflectionStructType::addMember(const std::shared_ptr<const ReflectionVa
         return -1;
     }
     auto memberIndex = addMemberIgnoringNameConflicts(pVar, ioBuildState);
-    mNameToIndex[pVar->getName()] = memberIndex;
+    auto entry = std::make_pair(ShaderVarName::hash(pVar->getName()), memberIndex);
+    mNameToIndex.insert(std::upper_bound(mNameToIndex.begin(), mNameToIndex.end(), entry), entry);
     return memberIndex;
 }
 
@@ -2082,26 +2091,34 @@ TypedShaderVarOffset ReflectionType::findMemberByOffset(size_t offset) const
 
 TypedShaderVarOffset ReflectionStructType::findMemberByOffset(size_t offset) const
 {
-    for (auto pMember : mMembers)
-    {
-        auto memberOffset = pMember->getBindLocation();
-        auto memberUniformOffset = memberOffset.getUniform().getByteOffset();
-        auto pMemberType = pMember->getType();
-        auto memberByteSize = pMember->getType()->getByteSize();
+    auto index = getMemberIndexByOffset(offset);
+    if (index == kInvalidMemberIndex)
+        return TypedShaderVarOffset::kInvalid;
 
-        if (offset >= memberUniformOffset)
-        {
-            if (offset < memberUniformOffset + memberByteSize)
-            {
-                return TypedShaderVarOffset(pMemberType.get(), memberOffset);
-            }
-        }
-    }
+    const auto& pMember = mMembers[index];
+    return TypedShaderVarOffset(pMember->getType().get(), pMember->getBindLocation());
+}
 
-    return TypedShaderVarOffset::kInvalid;
+int32_t ReflectionStructType::getMemberIndexByOffset(size_t offset) const
+{
+    // Find the last member starting at or before the offset. Members with uniform data don't overlap.
+    auto it = std::upper_bound(
+        mOffsetToIndex.begin(),
+        mOffsetToIndex.end(),
+        offset,
+        [this](size_t offset, int32_t index) { return offset < mMembers[index]->getByteOffset(); }
+    );
+    if (it == mOffsetToIndex.begin())
+        return kInvalidMemberIndex;
+
+    int32_t index = *std::prev(it);
+    const auto& pMember = mMembers[index];
+    if (offset >= pMember->getByteOffset() + pMember->getType()->getByteSize())
+        return kInvalidMemberIndex;
+    return index;
 }
 
-ReflectionVar::SharedConstPtr ReflectionType::findMember(const std::string& name) const
+ReflectionVar::SharedConstPtr ReflectionType::findMember(const ShaderVarName& name) const
 {
     if (auto pStructType = asStructType())
     {
@@ -2115,15 +2132,19 @@ ReflectionVar::SharedConstPtr ReflectionType::findMember(const std::string& name
     return nullptr;
 }
 
-int32_t ReflectionStructType::getMemberIndex(const std::string& name) const
+int32_t ReflectionStructType::getMemberIndex(const ShaderVarName& name) const
 {
-    auto it = mNameToIndex.find(name);
-    if (it == mNameToIndex.end())
-        return kInvalidMemberIndex;
-    return it->second;
+    // Binary search on the name hash, then compare names to resolve hash collisions.
+    auto it = std::lower_bound(mNameToIndex.begin(), mNameToIndex.end(), std::make_pair(name.getHash(), int32_t(kInvalidMemberIndex)));
+    for (; it != mNameToIndex.end() && it->first == name.getHash(); ++it)
+    {
+        if (mMembers[it->second]->getName() == name.getName())
+            return it->second;
+    }
+    return kInvalidMemberIndex;
 }
 
-const ReflectionVar::SharedConstPtr& ReflectionStructType::getMember(const std::string& name) const
+const ReflectionVar::SharedConstPtr& ReflectionStructType::getMember(const ShaderVarName& name) const
 {
     static const ReflectionVar::SharedConstPtr pNull;
     auto index = getMemberIndex(name);
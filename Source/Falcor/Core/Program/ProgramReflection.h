@@ -39,6 +39,7 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <unordered_map>
 
@@ -502,6 +503,55 @@ protected:
     ResourceShaderVarOffset mResource;
 };
 
+/**
+ * Name of a shader variable member, used as the key for member lookups.
+ *
+ * A `ShaderVarName` is a non-owning view of a name together with its hash.
+ * It converts implicitly from `const char*`, `std::string` and `std::string_view`, so member lookups
+ * never construct a `std::string`. The hash is computed at compile time when the name is declared
+ * `constexpr`, which avoids hashing the name on every lookup:
+ *
+ * static constexpr ShaderVarName kLight("light");
+ * var[kLight] = ...;
+ *
+ * The referenced characters must outlive the `ShaderVarName`.
+ */
+class ShaderVarName
+{
+public:
+    constexpr ShaderVarName(std::string_view name) : mName(name), mHash(hash(name)) {}
+    constexpr ShaderVarName(const char* name) : ShaderVarName(std::string_view(name)) {}
+    ShaderVarName(const std::string& name) : ShaderVarName(std::string_view(name)) {}
+
+    /**
+     * Get the name.
+     */
+    constexpr std::string_view getName() const { return mName; }
+
+    /**
+     * Get the hash of the name.
+     */
+    constexpr uint64_t getHash() const { return mHash; }
+
+    /**
+     * Compute the hash of a name (64-bit FNV-1a).
+     */
+    static constexpr uint64_t hash(std::string_view name)
+    {
+        uint64_t h = UINT64_C(14695981039346656037);
+        for (char c : name)
+        {
+            h ^= uint8_t(c);
+            h *= UINT64_C(1099511628211);
+        }
+        return h;
+    }
+
+private:
+    std::string_view mName;
+    uint64_t mHash;
+};
+
 /**
  * Represents the type of a shader variable and its offset relative to its enclosing type/buffer/block.
  *
@@ -524,6 +574,8 @@ protected:
  * ResourceShaderVarOffset diffuseMapOffset = materialOffset["diffuseMap"];
  *
  * Such offsets are always relative to the root type or block where lookup started.
+ * This makes them useful for caching: a path of member lookups can be resolved once
+ * (see `ShaderVar::resolvePath()`) and applied to any shader variable of the same type.
  * For example, in the above code `lightPosOffset` would be the offset of the
  * field `light.position` relative to the enclosing type `pSomeType` and *not*
  * the offset of the `position` field relative to the immediately enclosing `light` field.
@@ -553,12 +605,17 @@ public:
     /**
      * Look up type and offset of a sub-field with the given `name`.
      */
-    TypedShaderVarOffset operator[](const std::string& name) const;
+    TypedShaderVarOffset operator[](const ShaderVarName& name) const;
+
+    /**
+     * Look up type and offset of a sub-field with the given `name`.
+     */
+    TypedShaderVarOffset operator[](const std::string& name) const { return (*this)[ShaderVarName(name)]; }
 
     /**
      * Look up type and offset of a sub-field with the given `name`.
      */
-    TypedShaderVarOffset operator[](const char*) const;
+    TypedShaderVarOffset operator[](const char* name) const { return (*this)[ShaderVarName(name)]; }
 
     /**
      * Look up type and offset of a sub-element or sub-field with the given `index`.
@@ -669,7 +726,7 @@ public:
      *
      * If this type doesn't have fields/members, or doesn't have a field/member matching `name`, then returns null.
      */
-    std::shared_ptr<const ReflectionVar> findMember(const std::string& name) const;
+    std::shared_ptr<const ReflectionVar> findMember(const ShaderVarName& name) const;
 
     /**
      * Get the (type and) offset of a field/member with the given `name`.
@@ -677,7 +734,7 @@ public:
      * If this type doesn't have fields/members, or doesn't have a field/member matching `name`,
      * then logs an error and returns an invalid offset.
      */
-    TypedShaderVarOffset getMemberOffset(const std::string& name) const;
+    TypedShaderVarOffset getMemberOffset(const ShaderVarName& name) const;
 
     /**
      * Find a typed member/element offset corresponding to the given byte offset.
@@ -862,19 +919,26 @@ public:
     /**
      * Get member by name
      */
-    const std::shared_ptr<const ReflectionVar>& getMember(const std::string& name) const;
+    const std::shared_ptr<const ReflectionVar>& getMember(const ShaderVarName& name) const;
 
     /**
      * Constant used to indicate that member lookup failed.
      */
-    static const int32_t kInvalidMemberIndex = -1;
+    static constexpr int32_t kInvalidMemberIndex = -1;
 
     /**
      * Get the index of a member
      *
      * Returns `kInvalidMemberIndex` if no such member exists.
      */
-    int32_t getMemberIndex(const std::string& name) const;
+    int32_t getMemberIndex(const ShaderVarName& name) const;
+
+    /**
+     * Get the index of the member holding the uniform data at a byte offset.
+     *
+     * Returns `kInvalidMemberIndex` if no such member exists.
+     */
+    int32_t getMemberIndexByOffset(size_t offset) const;
 
     /**
      * Find a member based on a byte offset.
@@ -911,7 +975,8 @@ public:
 private:
     ReflectionStructType(size_t size, const std::string& name, slang::TypeLayoutReflection* pSlangTypeLayout);
     std::vector<std::shared_ptr<const ReflectionVar>> mMembers; // Struct members
-    std::unordered_map<std::string, int32_t> mNameToIndex;      // Translates from a name to an index in mMembers
+    std::vector<std::pair<uint64_t, int32_t>> mNameToIndex;     // Translates from a name hash to an index in mMembers, sorted by hash
+    std::vector<int32_t> mOffsetToIndex;                        // Indices in mMembers of members with uniform data, sorted by byte offset
     std::string mName;
 };
 
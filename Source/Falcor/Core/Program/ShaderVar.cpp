@@ -35,7 +35,7 @@ ShaderVar::ShaderVar(const ShaderVar& other) : mpBlock(other.mpBlock), mOffset(o
 ShaderVar::ShaderVar(ParameterBlock* pObject, const TypedShaderVarOffset& offset) : mpBlock(pObject), mOffset(offset) {}
 ShaderVar::ShaderVar(ParameterBlock* pObject) : mpBlock(pObject), mOffset(pObject->getElementType().get(), ShaderVarOffset::kZero) {}
 
-ShaderVar ShaderVar::findMember(const std::string& name) const
+ShaderVar ShaderVar::findMember(const ShaderVarName& name) const
 {
     if (!isValid())
         return *this;
@@ -109,37 +109,39 @@ ShaderVar ShaderVar::findMember(uint32_t index) const
     return ShaderVar();
 }
 
-ShaderVar ShaderVar::operator[](const std::string& name) const
+TypedShaderVarOffset ShaderVar::resolvePath(std::initializer_list<ShaderVarName> path) const
 {
-    auto result = findMember(name);
-    if (!result.isValid() && isValid())
+    if (!isValid())
+        return TypedShaderVarOffset();
+    auto pType = getType();
+
+    // As for `operator[]`, a path applied to a constant buffer (or parameter block)
+    // is resolved inside the buffer/block.
+    if (auto pResourceType = pType->asResourceType())
     {
-        reportError("No member named '" + name + "' found.\n");
+        switch (pResourceType->getType())
+        {
+        case ReflectionResourceType::Type::ConstantBuffer:
+            return getParameterBlock()->getRootVar().resolvePath(path);
+        default:
+            break;
+        }
     }
-    return result;
+
+    TypedShaderVarOffset offset = pType->getZeroOffset();
+    for (const auto& name : path)
+        offset = offset[name];
+    return offset;
 }
 
-ShaderVar ShaderVar::operator[](const char* name) const
+ShaderVar ShaderVar::operator[](const ShaderVarName& name) const
 {
-    // #SHADER_VAR we can use std::string_view to do lookups into the map
-    // TODO: We should have the ability to do this lookup
-    // without ever having to construct a `std::string`.
-    //
-    // The sticking point is the `ReflectionStructType::findMember`
-    // operation, which currently needs to do lookup in a `std::map<std::string, ...>`,
-    // so that we can't use a `const char*` as the key for lookup
-    // without incurring the cost of a constructing a `std::string`.
-    //
-    // To get around this limitation we'd need to implement a more clever/complicated
-    // map that uses a raw `const char*` as the key, and then compares keys with
-    // `strcmp`, while ensuring that the keys actually stored in the map are allocated
-    // and retained somewhere (which they should be because they are the names of
-    // the members of the `ReflectionStructType`).
-    //
-    // For now we just punt and go with the slow option even
-    // if the user is using a static string.
-    //
-    return (*this)[std::string(name)];
+    auto result = findMember(name);
+    if (!result.isValid() && isValid())
+    {
+        reportError(fmt::format("No member named '{}' found.\n", name.getName()));
+    }
+    return result;
 }
 
 ShaderVar ShaderVar::operator[](size_t index) const
@@ -265,21 +267,11 @@ ShaderVar ShaderVar::operator[](UniformShaderVarOffset const& loc) const
     else if (auto pStructType = pType->asStructType())
     {
         // We want to search for a member matching this offset
-        //
-        // TODO: A binary search should be preferred to the linear
-        // search here.
-
-        auto memberCount = pStructType->getMemberCount();
-        for (uint32_t m = 0; m < memberCount; ++m)
+        auto memberIndex = pStructType->getMemberIndexByOffset(byteOffset);
+        if (memberIndex != ReflectionStructType::kInvalidMemberIndex)
         {
-            auto pMember = pStructType->getMember(m);
+            const auto& pMember = pStructType->getMember(memberIndex);
             auto memberByteOffset = pMember->getByteOffset();
-            auto memberByteSize = pMember->getType()->getByteSize();
-
-            if (byteOffset < memberByteOffset)
-                continue;
-            if (byteOffset >= memberByteOffset + memberByteSize)
-                continue;
 
             auto offsetIntoMember = byteOffset - memberByteOffset;
             TypedShaderVarOffset memberOffset = TypedShaderVarOffset(pMember->getType().get(), mOffset + pMember->getBindLocation());
@@ -34,6 +34,7 @@
 #include "Core/API/ResourceViews.h"
 #include "Core/API/RtAccelerationStructure.h"
 #include "Utils/Math/Vector.h"
+#include <initializer_list>
 #include <memory>
 #include <string>
 #include <cstddef>
@@ -75,6 +76,12 @@ class ParameterBlockSharedPtr;
  * someField = float3(0);
  *
  * pObj["someTexture"].setTexture(pMyTexture);
+ *
+ * Code that sets the same variables every frame can avoid repeated member lookups
+ * by resolving the path once and reusing the resulting offset:
+ *
+ * TypedShaderVarOffset offset = var.resolvePath({"light", "position"}); // once
+ * var[offset] = float3(0);                                               // works like var["light"]["position"]
  */
 struct FALCOR_API ShaderVar
 {
@@ -135,16 +142,19 @@ struct FALCOR_API ShaderVar
      * If this shader variable points at a constant buffer or parameter block, then the lookup will proceed in the contents of that block.
      * Otherwise an error is logged and an invalid `ShaderVar` is returned.
      */
-    ShaderVar operator[](const char* name) const;
+    ShaderVar operator[](const ShaderVarName& name) const;
 
     /**
      * Get a shader variable pointer to a sub-field.
-     *
-     * This shader variable must point to a value of `struct` type, with a field matching the given `name`.
-     * If this shader variable points at a constant buffer or parameter block, then the lookup will proceed in the contents of that block.
-     * Otherwise an error is logged and an invalid `ShaderVar` is returned.
+     * See `operator[](const ShaderVarName&)`.
      */
-    ShaderVar operator[](const std::string& name) const;
+    ShaderVar operator[](const char* name) const { return (*this)[ShaderVarName(name)]; }
+
+    /**
+     * Get a shader variable pointer to a sub-field.
+     * See `operator[](const ShaderVarName&)`.
+     */
+    ShaderVar operator[](const std::string& name) const { return (*this)[ShaderVarName(name)]; }
 
     /**
      * Get a shader variable pointer to an element or sub-field.
@@ -166,7 +176,7 @@ struct FALCOR_API ShaderVar
      * Unlike `operator[]`, a `findMember` operation does not
      * log an error if a member of the given name cannot be found.
      */
-    ShaderVar findMember(const std::string& name) const;
+    ShaderVar findMember(const ShaderVarName& name) const;
 
     /**
      * Try to get a variable for a member/field, by index.
@@ -176,6 +186,18 @@ struct FALCOR_API ShaderVar
      */
     ShaderVar findMember(uint32_t index) const;
 
+    /**
+     * Resolve a path of member names into an offset relative to this shader variable.
+     *
+     * The result refers to the same variable as applying `operator[]` for each name in turn. It can be cached
+     * and passed to `operator[](TypedShaderVarOffset const&)` on any shader variable of the same type, which
+     * skips the name lookups.
+     * If this shader variable points at a constant buffer or parameter block, then the path is resolved in the contents of that block.
+     * The path cannot cross into a nested constant buffer or parameter block. If a member is not found an error is logged
+     * and an invalid offset is returned.
+     */
+    TypedShaderVarOffset resolvePath(std::initializer_list<ShaderVarName> path) const;
+
     /**
      * Set the value of the data pointed to by this shader variable.
      * Returns `true` if successful. Logs and error and returns `false` if the given `val` does not have a suitable type for the value
@@ -676,6 +676,13 @@ namespace Falcor
             src.getSampleCount() == dst.getSampleCount();
     }
 
+    void RenderGraph::setResourceAliasingEnabled(bool enabled)
+    {
+        if (mCompilerDeps.enableResourceAliasing == enabled) return;
+        mCompilerDeps.enableResourceAliasing = enabled;
+        mRecompile = true;
+    }
+
     void RenderGraph::renderUI(RenderContext* pRenderContext, Gui::Widgets& widget)
     {
         if (mpExe) mpExe->renderUI(pRenderContext, widget);
@@ -731,6 +738,7 @@ namespace Falcor
         };
         renderGraph.def_static("createFromFile", createFromFile, "path"_a); // PYTHONDEPRECATED
         renderGraph.def_property("name", &RenderGraph::getName, &RenderGraph::setName);
+        renderGraph.def_property("resourceAliasing", &RenderGraph::isResourceAliasingEnabled, &RenderGraph::setResourceAliasingEnabled);
         renderGraph.def(RenderGraphIR::kAddPass, &RenderGraph::addPass, "pass_"_a, "name"_a);
         renderGraph.def(RenderGraphIR::kRemovePass, &RenderGraph::removePass, "name"_a);
         renderGraph.def(RenderGraphIR::kAddEdge, &RenderGraph::addEdge, "src"_a, "dst"_a);
@@ -248,6 +248,16 @@ namespace Falcor
         */
         void setName(const std::string& name) { mName = name; }
 
+        /** Enable/disable sharing of resources between fields that are used at disjoint times during graph execution.
+            Render passes that rely on the contents of an output across executions must mark the field as persistent.
+            Resource aliasing is enabled by default.
+        */
+        void setResourceAliasingEnabled(bool enabled);
+
+        /** Check if resource aliasing is enabled.
+        */
+        bool isResourceAliasingEnabled() const { return mCompilerDeps.enableResourceAliasing; }
+
         /** Compile the graph.
         */
         bool compile(RenderContext* pRenderContext, std::string& log);
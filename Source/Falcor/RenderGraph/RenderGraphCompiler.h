@@ -46,6 +46,7 @@ namespace Falcor
         {
             ResourceCache::DefaultProperties defaultResourceProps;
             ResourceCache::ResourcesMap externalResources;
+            bool enableResourceAliasing = true;     ///< Share resources between fields that are used at disjoint times during graph execution.
         };
         static RenderGraphExe::SharedPtr compile(RenderGraph& graph, RenderContext* pRenderContext, const Dependencies& dependencies);
 
@@ -26,6 +26,7 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "RenderGraphExe.h"
+#include "Utils/StringUtils.h"
 #include "Utils/Timing/Profiler.h"
 
 namespace Falcor
@@ -45,6 +46,21 @@ namespace Falcor
 
     void RenderGraphExe::renderUI(RenderContext* pRenderContext, Gui::Widgets& widget)
     {
+        if (mpResourceCache)
+        {
+            if (auto memoryGroup = widget.group("Resource memory"))
+            {
+                const auto& stats = mpResourceCache->getMemoryStats();
+                memoryGroup.text(fmt::format(
+                    "  Fields:      {}\n"
+                    "  Resources:   {}\n"
+                    "  Allocated:   {}\n"
+                    "  Naive:       {}\n"
+                    "  Peak in use: {}",
+                    stats.fieldCount, stats.resourceCount, formatByteSize(stats.allocatedBytes), formatByteSize(stats.naiveBytes), formatByteSize(stats.peakLiveBytes)));
+            }
+        }
+
         for (const auto& p : mExecutionList)
         {
             const auto& pPass = p.pPass;
@@ -30,6 +30,10 @@
 #include "Core/API/Texture.h"
 #include "Core/API/Buffer.h"
 #include "Utils/Logger.h"
+#include "Utils/StringUtils.h"
+#include "Utils/Math/Common.h"
+#include <algorithm>
+#include <numeric>
 
 namespace Falcor
 {
@@ -42,6 +46,7 @@ namespace Falcor
     {
         mNameToIndex.clear();
         mResourceData.clear();
+        mMemoryStats = MemoryStats();
     }
 
     const Resource::SharedPtr& ResourceCache::getResource(const std::string& name) const
@@ -117,78 +122,282 @@ namespace Falcor
         }
     }
 
-    inline Resource::SharedPtr createResourceForPass(Device* pDevice, const ResourceCache::DefaultProperties& params, const RenderPassReflection::Field& field, bool resolveBindFlags, const std::string& resourceName)
+    namespace
     {
-        uint32_t width = field.getWidth() ? field.getWidth() : params.dims.x;
-        uint32_t height = field.getHeight() ? field.getHeight() : params.dims.y;
-        uint32_t depth = field.getDepth() ? field.getDepth() : 1;
-        uint32_t sampleCount = field.getSampleCount() ? field.getSampleCount() : 1;
-        auto bindFlags = field.getBindFlags();
-        auto arraySize = field.getArraySize();
-        auto mipLevels = field.getMipCount();
+        /** Fully resolved properties of a resource created by the cache.
+        */
+        struct ResourceDesc
+        {
+            RenderPassReflection::Field::Type type = RenderPassReflection::Field::Type::Texture2D;
+            uint32_t width = 0;
+            uint32_t height = 0;
+            uint32_t depth = 0;
+            uint32_t sampleCount = 0;
+            uint32_t arraySize = 0;
+            uint32_t mipLevels = 0;
+            ResourceFormat format = ResourceFormat::Unknown;
+            ResourceBindFlags bindFlags = ResourceBindFlags::None;
 
-        ResourceFormat format = ResourceFormat::Unknown;
+            bool operator==(const ResourceDesc& other) const
+            {
+                return type == other.type && width == other.width && height == other.height && depth == other.depth &&
+                    sampleCount == other.sampleCount && arraySize == other.arraySize && mipLevels == other.mipLevels &&
+                    format == other.format && bindFlags == other.bindFlags;
+            }
+        };
 
-        if (field.getType() != RenderPassReflection::Field::Type::RawBuffer)
+        ResourceDesc resolveResourceDesc(Device* pDevice, const ResourceCache::DefaultProperties& params, const RenderPassReflection::Field& field, bool resolveBindFlags)
         {
-            format = field.getFormat() == ResourceFormat::Unknown ? params.format : field.getFormat();
-            if (resolveBindFlags)
+            ResourceDesc desc;
+            desc.type = field.getType();
+            desc.width = field.getWidth() ? field.getWidth() : params.dims.x;
+            desc.height = field.getHeight() ? field.getHeight() : params.dims.y;
+            desc.depth = field.getDepth() ? field.getDepth() : 1;
+            desc.sampleCount = field.getSampleCount() ? field.getSampleCount() : 1;
+            desc.bindFlags = field.getBindFlags();
+            desc.arraySize = field.getArraySize();
+            desc.mipLevels = field.getMipCount();
+
+            if (field.getType() != RenderPassReflection::Field::Type::RawBuffer)
             {
-                ResourceBindFlags mask = Resource::BindFlags::UnorderedAccess | Resource::BindFlags::ShaderResource;
-                bool isOutput = is_set(field.getVisibility(), RenderPassReflection::Field::Visibility::Output);
-                bool isInternal = is_set(field.getVisibility(), RenderPassReflection::Field::Visibility::Internal);
-                if (isOutput || isInternal) mask |= Resource::BindFlags::DepthStencil | Resource::BindFlags::RenderTarget;
-                auto supported = pDevice->getFormatBindFlags(format);
-                mask &= supported;
-                bindFlags |= mask;
+                desc.format = field.getFormat() == ResourceFormat::Unknown ? params.format : field.getFormat();
+                if (resolveBindFlags)
+                {
+                    ResourceBindFlags mask = Resource::BindFlags::UnorderedAccess | Resource::BindFlags::ShaderResource;
+                    bool isOutput = is_set(field.getVisibility(), RenderPassReflection::Field::Visibility::Output);
+                    bool isInternal = is_set(field.getVisibility(), RenderPassReflection::Field::Visibility::Internal);
+                    if (isOutput || isInternal) mask |= Resource::BindFlags::DepthStencil | Resource::BindFlags::RenderTarget;
+                    auto supported = pDevice->getFormatBindFlags(desc.format);
+                    mask &= supported;
+                    desc.bindFlags |= mask;
+                }
             }
+            else // RawBuffer
+            {
+                if (resolveBindFlags) desc.bindFlags = Resource::BindFlags::UnorderedAccess | Resource::BindFlags::ShaderResource;
+            }
+            return desc;
         }
-        else // RawBuffer
+
+        Resource::SharedPtr createResource(Device* pDevice, const ResourceDesc& desc, const std::string& resourceName)
         {
-            if (resolveBindFlags) bindFlags = Resource::BindFlags::UnorderedAccess | Resource::BindFlags::ShaderResource;
+            Resource::SharedPtr pResource;
+
+            switch (desc.type)
+            {
+            case RenderPassReflection::Field::Type::RawBuffer:
+                pResource = Buffer::create(pDevice, desc.width, desc.bindFlags, Buffer::CpuAccess::None);
+                break;
+            case RenderPassReflection::Field::Type::Texture1D:
+                pResource = Texture::create1D(pDevice, desc.width, desc.format, desc.arraySize, desc.mipLevels, nullptr, desc.bindFlags);
+                break;
+            case RenderPassReflection::Field::Type::Texture2D:
+                if (desc.sampleCount > 1)
+                {
+                    pResource = Texture::create2DMS(pDevice, desc.width, desc.height, desc.format, desc.sampleCount, desc.arraySize, desc.bindFlags);
+                }
+                else
+                {
+                    pResource = Texture::create2D(pDevice, desc.width, desc.height, desc.format, desc.arraySize, desc.mipLevels, nullptr, desc.bindFlags);
+                }
+                break;
+            case RenderPassReflection::Field::Type::Texture3D:
+                pResource = Texture::create3D(pDevice, desc.width, desc.height, desc.depth, desc.format, desc.mipLevels, nullptr, desc.bindFlags);
+                break;
+            case RenderPassReflection::Field::Type::TextureCube:
+                pResource = Texture::createCube(pDevice, desc.width, desc.height, desc.format, desc.arraySize, desc.mipLevels, nullptr, desc.bindFlags);
+                break;
+            default:
+                FALCOR_UNREACHABLE();
+                return nullptr;
+            }
+            pResource->setName(resourceName);
+            return pResource;
         }
-        Resource::SharedPtr pResource;
 
-        switch (field.getType())
+        /** Estimate the size of a resource in bytes, ignoring alignment and padding.
+        */
+        uint64_t estimateResourceSize(const ResourceDesc& desc)
         {
-        case RenderPassReflection::Field::Type::RawBuffer:
-            pResource = Buffer::create(pDevice, width, bindFlags, Buffer::CpuAccess::None);
-            break;
-        case RenderPassReflection::Field::Type::Texture1D:
-            pResource = Texture::create1D(pDevice, width, format, arraySize, mipLevels, nullptr, bindFlags);
-            break;
-        case RenderPassReflection::Field::Type::Texture2D:
-            if (sampleCount > 1)
+            if (desc.type == RenderPassReflection::Field::Type::RawBuffer) return desc.width;
+
+            const bool is3D = desc.type == RenderPassReflection::Field::Type::Texture3D;
+            uint64_t width = desc.width;
+            uint64_t height = desc.type == RenderPassReflection::Field::Type::Texture1D ? 1 : desc.height;
+            uint64_t depth = is3D ? desc.depth : 1;
+
+            uint32_t mipLevels = desc.mipLevels;
+            if (mipLevels == Texture::kMaxPossible)
             {
-                pResource = Texture::create2DMS(pDevice, width, height, format, sampleCount, arraySize, bindFlags);
+                uint64_t maxDim = std::max(width, std::max(height, depth));
+                mipLevels = 1;
+                while (maxDim >>= 1) mipLevels++;
             }
-            else
+
+            const uint64_t bytesPerBlock = getFormatBytesPerBlock(desc.format);
+            const uint64_t blockWidth = getFormatWidthCompressionRatio(desc.format);
+            const uint64_t blockHeight = getFormatHeightCompressionRatio(desc.format);
+
+            uint64_t size = 0;
+            for (uint32_t mip = 0; mip < mipLevels; mip++)
             {
-                pResource = Texture::create2D(pDevice, width, height, format, arraySize, mipLevels, nullptr, bindFlags);
+                uint64_t w = std::max<uint64_t>(1, width >> mip);
+                uint64_t h = std::max<uint64_t>(1, height >> mip);
+                uint64_t d = std::max<uint64_t>(1, depth >> mip);
+                size += div_round_up(w, blockWidth) * div_round_up(h, blockHeight) * d * bytesPerBlock;
             }
-            break;
-        case RenderPassReflection::Field::Type::Texture3D:
-            pResource = Texture::create3D(pDevice, width, height, depth, format, mipLevels, nullptr, bindFlags);
-            break;
-        case RenderPassReflection::Field::Type::TextureCube:
-            pResource = Texture::createCube(pDevice, width, height, format, arraySize, mipLevels, nullptr, bindFlags);
-            break;
-        default:
-            FALCOR_UNREACHABLE();
-            return nullptr;
-        }
-        pResource->setName(resourceName);
-        return pResource;
+
+            uint64_t layerCount = is3D ? 1 : std::max(desc.arraySize, 1u);
+            if (desc.type == RenderPassReflection::Field::Type::TextureCube) layerCount *= 6;
+            return size * layerCount * desc.sampleCount;
+        }
+
+        /** Returns true if the field may share its resource with other fields used at different times.
+        */
+        bool isAliasable(const RenderPassReflection::Field& field, const std::pair<uint32_t, uint32_t>& lifetime)
+        {
+            // Internal and persistent resources must keep their contents across graph executions.
+            if (is_set(field.getVisibility(), RenderPassReflection::Field::Visibility::Internal)) return false;
+            if (is_set(field.getFlags(), RenderPassReflection::Field::Flags::Persistent)) return false;
+            // Graph outputs are used until the end of graph execution and beyond.
+            if (lifetime.second == uint32_t(-1)) return false;
+            return true;
+        }
     }
 
-    void ResourceCache::allocateResources(Device* pDevice, const DefaultProperties& params)
+    std::vector<uint32_t> ResourceCache::planResourceAliasing(const std::vector<AliasingRequest>& requests)
     {
-        for (auto& data : mResourceData)
+        // Assign the requests in order of their first use. Each request reuses a resource of its compatibility class that is
+        // no longer in use, or gets a new one. This greedy interval coloring is optimal, i.e., it uses as many resources per
+        // compatibility class as there are requests in use at the same time.
+        std::vector<uint32_t> order(requests.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return requests[a].lifetime.first < requests[b].lifetime.first; });
+
+        struct SharedResource
+        {
+            uint32_t compatibilityClass;
+            uint32_t lastUse;
+            bool canAlias;
+        };
+        std::vector<SharedResource> resources;
+        std::vector<uint32_t> assignment(requests.size());
+
+        for (uint32_t requestIndex : order)
         {
+            const auto& request = requests[requestIndex];
+            FALCOR_ASSERT(request.lifetime.first <= request.lifetime.second);
+
+            uint32_t resourceIndex = (uint32_t)resources.size();
+            if (request.canAlias)
+            {
+                for (uint32_t i = 0; i < (uint32_t)resources.size(); i++)
+                {
+                    const auto& resource = resources[i];
+                    if (resource.canAlias && resource.compatibilityClass == request.compatibilityClass && resource.lastUse < request.lifetime.first)
+                    {
+                        resourceIndex = i;
+                        break;
+                    }
+                }
+            }
+
+            if (resourceIndex == resources.size()) resources.push_back({ request.compatibilityClass, request.lifetime.second, request.canAlias });
+            else resources[resourceIndex].lastUse = request.lifetime.second;
+            assignment[requestIndex] = resourceIndex;
+        }
+
+        return assignment;
+    }
+
+    ResourceCache::MemoryStats ResourceCache::computeMemoryStats(const std::vector<AliasingRequest>& requests, const std::vector<uint32_t>& assignment)
+    {
+        FALCOR_ASSERT(requests.size() == assignment.size());
+
+        MemoryStats stats;
+        stats.fieldCount = (uint32_t)requests.size();
+
+        std::vector<uint64_t> resourceSizes;
+        for (size_t i = 0; i < requests.size(); i++)
+        {
+            if (assignment[i] >= resourceSizes.size()) resourceSizes.resize(assignment[i] + 1, 0);
+            resourceSizes[assignment[i]] = std::max(resourceSizes[assignment[i]], requests[i].size);
+            stats.naiveBytes += requests[i].size;
+        }
+        stats.resourceCount = (uint32_t)resourceSizes.size();
+        for (uint64_t size : resourceSizes) stats.allocatedBytes += size;
+
+        // Sweep over the lifetime boundaries to find the peak memory in use. A request is in use from its
+        // first time point until the time point after its last use, so releases are processed before allocations.
+        std::vector<std::pair<uint64_t, int64_t>> events;
+        events.reserve(2 * requests.size());
+        for (const auto& request : requests)
+        {
+            events.emplace_back(request.lifetime.first, (int64_t)request.size);
+            events.emplace_back((uint64_t)request.lifetime.second + 1, -(int64_t)request.size);
+        }
+        std::sort(events.begin(), events.end());
+
+        int64_t liveBytes = 0;
+        for (const auto& [time, delta] : events)
+        {
+            liveBytes += delta;
+            stats.peakLiveBytes = std::max(stats.peakLiveBytes, (uint64_t)liveBytes);
+        }
+
+        return stats;
+    }
+
+    void ResourceCache::allocateResources(Device* pDevice, const DefaultProperties& params, bool enableAliasing)
+    {
+        // Resolve the properties of all resources that need to be created.
+        std::vector<uint32_t> dataIndices;
+        std::vector<ResourceDesc> descs;
+        for (uint32_t i = 0; i < (uint32_t)mResourceData.size(); i++)
+        {
+            const auto& data = mResourceData[i];
             if ((data.pResource == nullptr) && (data.field.isValid()))
             {
-                data.pResource = createResourceForPass(pDevice, params, data.field, data.resolveBindFlags, data.name);
+                dataIndices.push_back(i);
+                descs.push_back(resolveResourceDesc(pDevice, params, data.field, data.resolveBindFlags));
             }
         }
+
+        // Fields can only share a resource if all resource properties are identical.
+        // The compatibility class of a field is the index of the first field with identical properties.
+        std::vector<AliasingRequest> requests(descs.size());
+        for (size_t i = 0; i < descs.size(); i++)
+        {
+            const auto& data = mResourceData[dataIndices[i]];
+            auto& request = requests[i];
+            request.compatibilityClass = (uint32_t)(std::find(descs.begin(), descs.end(), descs[i]) - descs.begin());
+            request.lifetime = data.lifetime;
+            request.size = estimateResourceSize(descs[i]);
+            request.canAlias = enableAliasing && isAliasable(data.field, data.lifetime);
+        }
+
+        std::vector<uint32_t> assignment = planResourceAliasing(requests);
+        mMemoryStats = computeMemoryStats(requests, assignment);
+
+        // Create the resources. Shared resources are named after all the fields using them.
+        std::vector<std::string> resourceNames(mMemoryStats.resourceCount);
+        for (size_t i = 0; i < descs.size(); i++)
+        {
+            auto& resourceName = resourceNames[assignment[i]];
+            if (!resourceName.empty()) resourceName += ", ";
+            resourceName += mResourceData[dataIndices[i]].name;
+        }
+
+        std::vector<Resource::SharedPtr> resources(mMemoryStats.resourceCount);
+        for (size_t i = 0; i < descs.size(); i++)
+        {
+            auto& pResource = resources[assignment[i]];
+            if (!pResource) pResource = createResource(pDevice, descs[i], resourceNames[assignment[i]]);
+            mResourceData[dataIndices[i]].pResource = pResource;
+        }
+
+        logDebug("ResourceCache: Allocated {} resources for {} fields, {} (naive {}, peak in use {}).",
+            mMemoryStats.resourceCount, mMemoryStats.fieldCount, formatByteSize(mMemoryStats.allocatedBytes),
+            formatByteSize(mMemoryStats.naiveBytes), formatByteSize(mMemoryStats.peakLiveBytes));
     }
 }
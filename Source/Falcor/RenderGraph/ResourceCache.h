@@ -38,6 +38,12 @@
 
 namespace Falcor
 {
+    /** Cache of the resources owned by a compiled render graph.
+
+        Fields that are used at disjoint times during graph execution and have identical resource properties
+        share a single resource (transient resource aliasing). Fields that must keep their contents across
+        graph executions (internal and persistent fields, graph outputs) always get a dedicated resource.
+    */
     class FALCOR_API ResourceCache
     {
     public:
@@ -56,6 +62,27 @@ namespace Falcor
             ResourceFormat format = ResourceFormat::Unknown;    ///< Format to use for texture creation
         };
 
+        /** Request for a resource, used for planning resource aliasing.
+        */
+        struct AliasingRequest
+        {
+            uint32_t compatibilityClass = 0;            ///< Requests can only share a resource if they have the same compatibility class.
+            std::pair<uint32_t, uint32_t> lifetime;     ///< Inclusive range of time points where the resource is used.
+            uint64_t size = 0;                          ///< Estimated size of the resource in bytes.
+            bool canAlias = true;                       ///< False if the request needs a dedicated resource.
+        };
+
+        /** Estimated memory usage of the resources allocated by the cache.
+        */
+        struct MemoryStats
+        {
+            uint32_t fieldCount = 0;                    ///< Number of fields that required a resource.
+            uint32_t resourceCount = 0;                 ///< Number of resources created for these fields.
+            uint64_t naiveBytes = 0;                    ///< Memory required if every field had a dedicated resource.
+            uint64_t allocatedBytes = 0;                ///< Memory of the created resources.
+            uint64_t peakLiveBytes = 0;                 ///< Peak memory of the fields in use at the same time. This is a lower bound for allocatedBytes.
+        };
+
         /** Add/Remove reference to a graph input resource not owned by the cache
             \param[in] name The resource's name
             \param[in] pResource The resource to register. If this is null, will unregister the resource
@@ -81,8 +108,30 @@ namespace Falcor
 
         /** Allocate all resources that need to be created/updated.
             This includes new resources, resources whose properties have been updated since last allocation call.
+            \param[in] pDevice GPU device.
+            \param[in] params Default resource properties.
+            \param[in] enableAliasing If true, fields with compatible properties and disjoint lifetimes share resources.
+        */
+        void allocateResources(Device* pDevice, const DefaultProperties& params, bool enableAliasing = true);
+
+        /** Get the estimated memory usage of the resources created by the last allocateResources() call.
+        */
+        const MemoryStats& getMemoryStats() const { return mMemoryStats; }
+
+        /** Assign requests to shared resources.
+            Requests that can alias share a resource with other requests of the same compatibility class if their lifetimes don't overlap.
+            The requests are assigned in order of their first use, which results in the minimum number of resources per compatibility class.
+            \param[in] requests The resource requests.
+            \return For each request, the index of the resource it is assigned to. Resource indices are dense and start at 0.
+        */
+        static std::vector<uint32_t> planResourceAliasing(const std::vector<AliasingRequest>& requests);
+
+        /** Compute memory statistics for an aliasing plan.
+            \param[in] requests The resource requests.
+            \param[in] assignment The resource index of each request, see planResourceAliasing().
+            \return Memory statistics. The size of a shared resource is the largest size of the requests assigned to it.
         */
-        void allocateResources(Device* pDevice, const DefaultProperties& params);
+        static MemoryStats computeMemoryStats(const std::vector<AliasingRequest>& requests, const std::vector<uint32_t>& assignment);
 
         /** Clears all registered field/resource properties and allocated resources.
         */
@@ -106,6 +155,9 @@ namespace Falcor
 
         // References to output resources not to be allocated by the render graph
         ResourcesMap mExternalResources;
+
+        // Estimated memory usage of the allocated resources
+        MemoryStats mMemoryStats;
     };
 
 }
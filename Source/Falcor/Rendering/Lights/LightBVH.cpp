@@ -43,6 +43,7 @@ namespace Falcor
     {
         mLeafUpdater = ComputePass::create(mpDevice, kShaderFile, "updateLeafNodes");
         mInternalUpdater = ComputePass::create(mpDevice, kShaderFile, "updateInternalNodes");
+        mWideNodeUpdater = ComputePass::create(mpDevice, kShaderFile, "updateWideNodes");
     }
 
     // TODO: Only update the ones that moved.
@@ -86,6 +87,20 @@ namespace Falcor
             }
         }
 
+        // Update all wide nodes by copying the refitted binary nodes into their child slots.
+        if (mWideNodes.width > 2)
+        {
+            auto var = mWideNodeUpdater->getVars()["CB"];
+            setShaderData(var["gLightBVH"]);
+            var["gWideChildNodeIndices"] = mpWideChildNodeIndicesBuffer;
+            var["gWideNodeWidth"] = mWideNodes.width;
+
+            const uint32_t childCount = (uint32_t)mWideNodes.childNodeIndices.size();
+            var["gNodeCount"] = childCount;
+
+            mWideNodeUpdater->execute(pRenderContext, childCount, 1, 1);
+        }
+
         mIsCpuDataValid = false;
     }
 
@@ -103,7 +118,9 @@ namespace Falcor
             "  Size:                " + std::to_string(stats.byteSize) + " bytes\n" +
             "  Internal node count: " + std::to_string(stats.internalNodeCount) + "\n" +
             "  Leaf node count:     " + std::to_string(stats.leafNodeCount) + "\n" +
-            "  Triangle count:      " + std::to_string(stats.triangleCount) + "\n";
+            "  Triangle count:      " + std::to_string(stats.triangleCount) + "\n" +
+            "  Node width:          " + std::to_string(stats.nodeWidth) + "\n" +
+            "  Wide node count:     " + std::to_string(stats.wideNodeCount) + "\n";
         widget.text(statsStr);
 
         if (auto nodeGroup = widget.group("Node count per level"))
@@ -133,6 +150,7 @@ namespace Falcor
     {
         // Reset all CPU data.
         mNodes.clear();
+        mWideNodes = WideNodes();
         mNodeIndices.clear();
         mPerDepthRefitEntryInfo.clear();
         mMaxTriangleCountPerLeaf = 0;
@@ -213,7 +231,9 @@ namespace Falcor
         };
         traverseBVH(evalInternal, evalLeaf);
 
-        mBVHStats.byteSize = (uint32_t)(mNodes.size() * sizeof(mNodes[0]));
+        mBVHStats.nodeWidth = mWideNodes.width;
+        mBVHStats.wideNodeCount = mWideNodes.width > 2 ? mWideNodes.getNodeCount() : 0;
+        mBVHStats.byteSize = (uint32_t)(mNodes.size() * sizeof(mNodes[0]) + mWideNodes.data.size() * sizeof(uint32_t));
     }
 
     void LightBVH::updateNodeIndices()
@@ -300,6 +320,24 @@ namespace Falcor
         FALCOR_ASSERT(mpTriangleBitmasksBuffer->getSize() >= triangleBitmasks.size() * sizeof(triangleBitmasks[0]));
         mpTriangleBitmasksBuffer->setBlob(triangleBitmasks.data(), 0, triangleBitmasks.size() * sizeof(triangleBitmasks[0]));
 
+        if (mWideNodes.width > 2)
+        {
+            const size_t wideNodesSize = mWideNodes.data.size() * sizeof(uint32_t);
+            if (!mpWideNodesBuffer || mpWideNodesBuffer->getSize() < wideNodesSize)
+            {
+                mpWideNodesBuffer = Buffer::create(mpDevice.get(), wideNodesSize, Resource::BindFlags::ShaderResource | Resource::BindFlags::UnorderedAccess, Buffer::CpuAccess::None, nullptr);
+                mpWideNodesBuffer->setName("LightBVH::mpWideNodesBuffer");
+            }
+            if (!mpWideChildNodeIndicesBuffer || mpWideChildNodeIndicesBuffer->getElementCount() < mWideNodes.childNodeIndices.size())
+            {
+                mpWideChildNodeIndicesBuffer = Buffer::createStructured(mpDevice.get(), sizeof(uint32_t), (uint32_t)mWideNodes.childNodeIndices.size(), ResourceBindFlags::ShaderResource, Buffer::CpuAccess::None, nullptr, false);
+                mpWideChildNodeIndicesBuffer->setName("LightBVH::mpWideChildNodeIndicesBuffer");
+            }
+
+            mpWideNodesBuffer->setBlob(mWideNodes.data.data(), 0, wideNodesSize);
+            mpWideChildNodeIndicesBuffer->setBlob(mWideNodes.childNodeIndices.data(), 0, mWideNodes.childNodeIndices.size() * sizeof(uint32_t));
+        }
+
         mIsCpuDataValid = true;
     }
 
@@ -324,6 +362,7 @@ namespace Falcor
             var["nodes"] = mpBVHNodesBuffer;
             var["triangleIndices"] = mpTriangleIndicesBuffer;
             var["triangleBitmasks"] = mpTriangleBitmasksBuffer;
+            if (mWideNodes.width > 2) var["wideNodes"] = mpWideNodesBuffer;
         }
     }
 }
@@ -45,6 +45,8 @@ namespace Falcor
 
         This is binary BVH over all emissive triangles as described by Moreau and Clarberg,
         "Importance Sampling of Many Lights on the GPU", Ray Tracing Gems, Ch. 18, 2019.
+        Optionally, the binary BVH is collapsed into a 4- or 8-wide BVH for traversal on the GPU.
+        The wide nodes reference the binary leaf nodes, which are shared by both representations.
 
         Before being used, the BVH needs to have been built using LightBVHBuilder::build().
         The data can be both used on the CPU (using traverseBVH() or on the GPU by:
@@ -102,12 +104,29 @@ namespace Falcor
             uint32_t internalNodeCount = 0;                  ///< Number of internal nodes inside the BVH.
             uint32_t leafNodeCount = 0;                      ///< Number of leaf nodes inside the BVH.
             uint32_t triangleCount = 0;                      ///< Number of triangles inside the BVH.
+            uint32_t nodeWidth = 2;                          ///< Number of children per node used for traversal.
+            uint32_t wideNodeCount = 0;                      ///< Number of wide nodes, or 0 if the BVH has not been collapsed.
+        };
+
+        /** Wide nodes collapsed from the binary BVH.
+        */
+        struct WideNodes
+        {
+            uint32_t width = 2;                              ///< Number of children per wide node (4 or 8), or 2 if the BVH has not been collapsed.
+            std::vector<uint32_t> data;                      ///< Wide nodes in SoA layout, see WideNodeLayout.
+            std::vector<uint32_t> childNodeIndices;          ///< For each wide node child slot, the index of the binary node the child was collapsed from, or WideNodeLayout::kInvalidChild for unused slots.
+
+            uint32_t getNodeCount() const { return (uint32_t)(data.size() / (width * WideNodeLayout::kFieldCount)); }
         };
 
         /** Returns stats.
         */
         const BVHStats& getStats() const { return mBVHStats; }
 
+        /** Returns the wide nodes. The data is only valid if the BVH has been collapsed, i.e., if getWideNodes().width > 2.
+        */
+        const WideNodes& getWideNodes() const { return mWideNodes; }
+
         /** Is the BVH valid.
             \return true if the BVH is ready for use.
         */
@@ -147,9 +166,11 @@ namespace Falcor
 
         ComputePass::SharedPtr                mLeafUpdater;             ///< Compute pass for refitting the leaf nodes.
         ComputePass::SharedPtr                mInternalUpdater;         ///< Compute pass for refitting internal nodes.
+        ComputePass::SharedPtr                mWideNodeUpdater;         ///< Compute pass for refitting wide nodes.
 
         // CPU resources
         mutable std::vector<PackedNode>       mNodes;                   ///< CPU-side copy of packed BVH nodes.
+        WideNodes                             mWideNodes;               ///< CPU-side copy of the wide nodes as collapsed by the builder. Not updated on refit.
         std::vector<uint32_t>                 mNodeIndices;             ///< Array of all node indices sorted by tree depth.
         std::vector<RefitEntryInfo>           mPerDepthRefitEntryInfo;  ///< Array containing for each level the number of internal nodes as well as the corresponding offset into 'mpNodeIndicesBuffer'; the very last entry contains the same data, but for all leaf nodes instead.
         uint32_t                              mMaxTriangleCountPerLeaf = 0; ///< After the BVH is built, this contains the maximum light count per leaf node.
@@ -160,7 +181,9 @@ namespace Falcor
         // GPU resources
         Buffer::SharedPtr                     mpBVHNodesBuffer;         ///< Buffer holding all BVH nodes.
         Buffer::SharedPtr                     mpTriangleIndicesBuffer;  ///< Triangle indices sorted by leaf node. Each leaf node refers to a contiguous array of triangle indices.
-        Buffer::SharedPtr                     mpTriangleBitmasksBuffer; ///< Array containing the per triangle bit pattern retracing the tree traversal to reach the triangle: 0=left child, 1=right child.
+        Buffer::SharedPtr                     mpTriangleBitmasksBuffer; ///< Array containing the per triangle bit pattern retracing the tree traversal to reach the triangle: 0=left child, 1=right child. For wide BVHs, log2(width) bits per level selecting the child slot.
+        Buffer::SharedPtr                     mpWideNodesBuffer;        ///< Buffer holding all wide nodes. Only used if the BVH has been collapsed.
+        Buffer::SharedPtr                     mpWideChildNodeIndicesBuffer; ///< Buffer holding the binary node index of each wide node child slot. This is used for BVH refit.
         Buffer::SharedPtr                     mpNodeIndicesBuffer;      ///< Buffer holding all node indices sorted by tree depth. This is used for BVH refit.
 
         friend LightBVHBuilder;
@@ -29,9 +29,12 @@
 #include "Core/Assert.h"
 #include "Core/Errors.h"
 #include "Utils/Logger.h"
+#include "Utils/Threading.h"
+#include "Utils/Math/Common.h"
 #include "Utils/Timing/Profiler.h"
 #include "Utils/Scripting/ScriptBindings.h"
 #include <algorithm>
+#include <array>
 
 namespace
 {
@@ -45,6 +48,13 @@ namespace
     const uint32_t kMaxLeafTriangleCount = 1 << PackedNode::kTriangleCountBits;
     const uint32_t kMaxLeafTriangleOffset = 1 << PackedNode::kTriangleOffsetBits;
 
+    // Subtrees with at most this many triangles are built serially by a single task.
+    const uint32_t kSerialSubtreeTriangleCount = 1 << 12;
+
+    // Nodes with at least this many triangles are binned in parallel.
+    const uint32_t kParallelBinningTriangleCount = 1 << 16;
+    const size_t kParallelBinningGrainSize = 1 << 14;
+
     inline float safeACos(float v)
     {
         return std::acos(glm::clamp(v, -1.0f, 1.0f));
@@ -57,6 +67,36 @@ namespace
         return std::sqrt(std::max(0.f, 1.f - cosAngle * cosAngle));
     }
 
+    /** Computes the part of computeCosConeAngle() that does not depend on the cone angle of the first cone.
+        This allows evaluating it for many cones in parallel and accumulating the results in order using accumulateCosConeAngle().
+        \return The cosine of the angle needed to include the second cone, or NaN if the resulting cone would be invalid.
+    */
+    float computeCosTotalConeAngle(const float3& coneDir, const float3& otherConeDir, const float cosOtherTheta)
+    {
+        if (cosOtherTheta == kInvalidCosConeAngle) return std::numeric_limits<float>::quiet_NaN();
+
+        const float cosDiffTheta = glm::dot(coneDir, otherConeDir);
+        const float sinDiffTheta = sinFromCos(cosDiffTheta);
+        const float sinOtherTheta = sinFromCos(cosOtherTheta);
+
+        // Rotate (cosDiffTheta, sinDiffTheta) counterclockwise by the other cone's spread angle.
+        float cosTotalTheta = cosOtherTheta * cosDiffTheta - sinOtherTheta * sinDiffTheta;
+        float sinTotalTheta = sinOtherTheta * cosDiffTheta + cosOtherTheta * sinDiffTheta;
+
+        // If the total angle is less than pi, return the new cone angle.
+        // Otherwise, the bounding cone will be deactivated because it would represent the whole sphere.
+        return sinTotalTheta > 0.f ? cosTotalTheta : std::numeric_limits<float>::quiet_NaN();
+    }
+
+    /** Grows a cone angle by the result of computeCosTotalConeAngle().
+        \return The cosine of the spread angle for the new cone.
+    */
+    float accumulateCosConeAngle(const float cosTheta, const float cosTotalTheta)
+    {
+        if (cosTheta == kInvalidCosConeAngle || std::isnan(cosTotalTheta)) return kInvalidCosConeAngle;
+        return std::min(cosTheta, cosTotalTheta);
+    }
+
     /** Given a bounding cone specified by direction and cosine spread angle,
         compute the minimum cone angle that includes a second bounding cone.
         If either cone is invalid or the result is larger than pi, the resulting
@@ -66,25 +106,8 @@ namespace
     */
     float computeCosConeAngle(const float3& coneDir, const float cosTheta, const float3& otherConeDir, const float cosOtherTheta)
     {
-        float cosResult = kInvalidCosConeAngle;
-        if (cosTheta != kInvalidCosConeAngle && cosOtherTheta != kInvalidCosConeAngle)
-        {
-            const float cosDiffTheta = glm::dot(coneDir, otherConeDir);
-            const float sinDiffTheta = sinFromCos(cosDiffTheta);
-            const float sinOtherTheta = sinFromCos(cosOtherTheta);
-
-            // Rotate (cosDiffTheta, sinDiffTheta) counterclockwise by the other cone's spread angle.
-            float cosTotalTheta = cosOtherTheta * cosDiffTheta - sinOtherTheta * sinDiffTheta;
-            float sinTotalTheta = sinOtherTheta * cosDiffTheta + cosOtherTheta * sinDiffTheta;
-
-            // If the total angle is less than pi, store the new cone angle.
-            // Otherwise, the bounding cone will be deactivated because it would represent the whole sphere.
-            if (sinTotalTheta > 0.f)
-            {
-                cosResult = std::min(cosTheta, cosTotalTheta);
-            }
-        }
-        return cosResult;
+        if (cosTheta == kInvalidCosConeAngle) return kInvalidCosConeAngle;
+        return accumulateCosConeAngle(cosTheta, computeCosTotalConeAngle(coneDir, otherConeDir, cosOtherTheta));
     }
 
     /** Given two cones specified by direction vectors and the cosine of
@@ -223,6 +246,146 @@ namespace
         { (uint32_t)LightBVHBuilder::SplitHeuristic::BinnedSAH, "Binned SAH" },
         { (uint32_t)LightBVHBuilder::SplitHeuristic::BinnedSAOH, "Binned SAOH" }
     };
+
+    const Gui::DropdownList kNodeWidthList =
+    {
+        { 2, "Binary" },
+        { 4, "4-wide" },
+        { 8, "8-wide" }
+    };
+
+    // Define the maximum supported wide node width.
+    const uint32_t kMaxWideNodeWidth = 8;
+
+    /** State shared by all recursive calls of collapseNode().
+    */
+    struct CollapseContext
+    {
+        const std::vector<PackedNode>& nodes;
+        const std::vector<uint32_t>& triangleIndices;
+        const uint32_t bitsPerLevel;
+        LightBVH::WideNodes& wideNodes;
+        std::vector<uint64_t>& triangleBitmasks;
+    };
+
+    /** Returns the number of bitmask bits used per level of a wide BVH.
+    */
+    uint32_t getBitsPerLevel(uint32_t width)
+    {
+        return width == 8 ? 3 : 2;
+    }
+
+    /** Returns the surface area of the bounding box of a packed node, up to a constant factor.
+    */
+    float getNodeSurfaceArea(const PackedNode& node)
+    {
+        const float3 extent = node.getNodeAttributes().extent;
+        return extent.x * extent.y + extent.y * extent.z + extent.z * extent.x;
+    }
+
+    /** Appends a wide node with all child slots unused.
+        \return Index of the wide node.
+    */
+    uint32_t allocateWideNode(LightBVH::WideNodes& wideNodes)
+    {
+        const uint32_t width = wideNodes.width;
+        const uint32_t nodeIndex = wideNodes.getNodeCount();
+        const uint32_t invalidChild = WideNodeLayout::kInvalidChild;
+        wideNodes.data.resize(wideNodes.data.size() + width * WideNodeLayout::kFieldCount, 0);
+        std::fill_n(wideNodes.data.begin() + WideNodeLayout::getDwordOffset(width, nodeIndex, 0, 0), width, invalidChild);
+        wideNodes.childNodeIndices.resize(wideNodes.childNodeIndices.size() + width, invalidChild);
+        return nodeIndex;
+    }
+
+    /** Recursively collapse a binary node into a wide node.
+        \param[in] ctx Collapse state.
+        \param[in] binaryNodeIndex Index of the binary node.
+        \param[in] wideNodeIndex Index of the allocated wide node to fill in.
+        \param[in] depth Depth of the wide node.
+        \param[in] bitmask Bit pattern retracing the wide tree traversal to reach the wide node.
+        \return False if the traversal paths of the wide BVH don't fit in the bitmasks, true otherwise.
+    */
+    bool collapseNode(const CollapseContext& ctx, uint32_t binaryNodeIndex, uint32_t wideNodeIndex, uint32_t depth, uint64_t bitmask)
+    {
+        // The traversal path to the children of this node must fit in the bitmask.
+        if ((depth + 1) * ctx.bitsPerLevel > kMaxBVHDepth) return false;
+
+        const uint32_t width = ctx.wideNodes.width;
+        std::array<uint32_t, kMaxWideNodeWidth> children;
+        uint32_t childCount = 0;
+
+        if (ctx.nodes[binaryNodeIndex].isLeaf())
+        {
+            // This only happens if the whole BVH is a single leaf node.
+            children[childCount++] = binaryNodeIndex;
+        }
+        else
+        {
+            children[childCount++] = binaryNodeIndex + 1;
+            children[childCount++] = ctx.nodes[binaryNodeIndex].getInternalNode().rightChildIdx;
+        }
+
+        // Replace the internal child with the largest surface area by its two children until the node is full.
+        // The children are expanded in place so that they stay in depth-first order.
+        while (childCount < width)
+        {
+            uint32_t expandedChild = childCount;
+            float maxArea = -std::numeric_limits<float>::infinity();
+            for (uint32_t i = 0; i < childCount; i++)
+            {
+                const PackedNode& child = ctx.nodes[children[i]];
+                if (child.isLeaf()) continue;
+                const float area = getNodeSurfaceArea(child);
+                if (expandedChild == childCount || area > maxArea)
+                {
+                    expandedChild = i;
+                    maxArea = area;
+                }
+            }
+            if (expandedChild == childCount) break; // All children are leaves.
+
+            const uint32_t nodeIndex = children[expandedChild];
+            std::copy_backward(children.begin() + expandedChild + 1, children.begin() + childCount, children.begin() + childCount + 1);
+            children[expandedChild] = nodeIndex + 1;
+            children[expandedChild + 1] = ctx.nodes[nodeIndex].getInternalNode().rightChildIdx;
+            childCount++;
+        }
+
+        // Fill in the child slots and recurse into the internal children.
+        for (uint32_t slot = 0; slot < childCount; slot++)
+        {
+            const uint32_t childNodeIndex = children[slot];
+            const PackedNode& child = ctx.nodes[childNodeIndex];
+
+            ctx.wideNodes.childNodeIndices[wideNodeIndex * width + slot] = childNodeIndex;
+            for (uint32_t field = 1; field < WideNodeLayout::kFieldCount; field++)
+            {
+                ctx.wideNodes.data[WideNodeLayout::getDwordOffset(width, wideNodeIndex, field, slot)] = child.data[field / 4][field % 4];
+            }
+
+            const uint64_t childBitmask = bitmask | ((uint64_t)slot << (depth * ctx.bitsPerLevel));
+            const uint32_t childRefOffset = WideNodeLayout::getDwordOffset(width, wideNodeIndex, 0, slot);
+
+            if (child.isLeaf())
+            {
+                ctx.wideNodes.data[childRefOffset] = WideNodeLayout::kLeafChildFlag | childNodeIndex;
+
+                const LeafNode leaf = child.getLeafNode();
+                for (uint32_t i = 0; i < leaf.triangleCount; i++)
+                {
+                    ctx.triangleBitmasks[ctx.triangleIndices[leaf.triangleOffset + i]] = childBitmask;
+                }
+            }
+            else
+            {
+                const uint32_t childWideNodeIndex = allocateWideNode(ctx.wideNodes);
+                ctx.wideNodes.data[childRefOffset] = childWideNodeIndex;
+                if (!collapseNode(ctx, childNodeIndex, childWideNodeIndex, depth + 1, childBitmask)) return false;
+            }
+        }
+
+        return true;
+    }
 }
 
 namespace Falcor
@@ -245,9 +408,49 @@ namespace Falcor
         const auto& triangles = bvh.mpLightCollection->getMeshLightTriangles(pRenderContext);
         if (triangles.empty()) return;
 
+        std::vector<PackedNode>& nodes = bvh.mNodes;
+        std::vector<uint32_t> triangleIndices;
+        std::vector<uint64_t> triangleBitmasks;
+        buildNodes(triangles, nodes, triangleIndices, triangleBitmasks);
+
+        // If there are no non-culled triangles, we're done.
+        if (nodes.empty()) return;
+
+        // Collapse the binary BVH into a wide BVH. The triangle bitmasks are replaced by the wide tree traversal paths.
+        if (mOptions.nodeWidth > 2)
+        {
+            // Very deep BVHs fall back to the binary layout, as the binary traversal paths use fewer bits per level.
+            if (collapse(nodes, triangleIndices, mOptions.nodeWidth, bvh.mWideNodes, triangleBitmasks))
+            {
+                if (!validateCollapse(nodes, triangleIndices, bvh.mWideNodes, triangleBitmasks))
+                {
+                    throw RuntimeError("Collapsed light BVH does not match the binary BVH.");
+                }
+            }
+            else
+            {
+                logWarning("Light BVH is too deep to be collapsed into a {}-wide BVH. Using the binary BVH instead.", mOptions.nodeWidth);
+            }
+        }
+
+        // The BVH is ready, mark it as valid and upload the data.
+        bvh.mIsValid = true;
+        bvh.mMaxTriangleCountPerLeaf = mOptions.maxTriangleCountPerLeaf;
+        bvh.uploadCPUBuffers(triangleIndices, triangleBitmasks);
+
+        // Computate metadata.
+        bvh.finalize();
+    }
+
+    void LightBVHBuilder::buildNodes(const std::vector<LightCollection::MeshLightTriangle>& triangles, std::vector<PackedNode>& nodes, std::vector<uint32_t>& triangleIndices, std::vector<uint64_t>& triangleBitmasks)
+    {
+        nodes.clear();
+        triangleIndices.clear();
+        triangleBitmasks.clear();
+
         // Create list of triangles that should be included in BVH.
         // For each triangle, precompute data we need for the build.
-        BuildingData data(bvh.mNodes);
+        BuildingData data;
         data.trianglesData.reserve(triangles.size());
 
         for (size_t i = 0; i < triangles.size(); i++)
@@ -281,39 +484,38 @@ namespace Falcor
         {
             throw RuntimeError("Emissive triangle count exceeds the maximum supported ({})", kMaxLeafTriangleOffset + kMaxLeafTriangleCount);
         }
-
-        // Allocate temporary memory for the BVH build.
-        // To be grossly conservative, assume each triangle requires two nodes.
-        // This is only system RAM and shouldn't be that much, so it's not worth being more careful about it.
-        // TODO: Better estimate of how many nodes we will need.
-        data.nodes.clear();
-        data.nodes.reserve(2 * data.trianglesData.size());
-        data.triangleIndices.reserve(data.trianglesData.size());
+        if (mOptions.nodeWidth != 2 && mOptions.nodeWidth != 4 && mOptions.nodeWidth != 8)
+        {
+            throw RuntimeError("Unsupported node width ({}). Must be 2, 4 or 8.", mOptions.nodeWidth);
+        }
 
         const uint64_t invalidBitmask = std::numeric_limits<uint64_t>::max();
         data.triangleBitmasks.resize(triangles.size(), invalidBitmask); // This is sized based on input triangle count, as it's indexed by global triangle index.
 
-        // Build the tree.
+        // Build the tree. Large subtrees are built in parallel.
         SplitHeuristicFunction splitFunc = getSplitFunction(mOptions.splitHeuristicSelection);
-        buildInternal(mOptions, splitFunc, 0ull, 0, Range(0, static_cast<uint32_t>(data.trianglesData.size())), data);
-        FALCOR_ASSERT(!data.nodes.empty());
+        auto pRoot = buildSubtree(mOptions, splitFunc, 0ull, 0, Range(0, static_cast<uint32_t>(data.trianglesData.size())), data);
 
         size_t numValid = 0;
         for (auto mask : data.triangleBitmasks)
             if (mask != invalidBitmask) numValid++;
         FALCOR_ASSERT(numValid == data.trianglesData.size());
 
-        // Compute per-node light bounding cones.
-        float cosConeAngle;
-        computeLightingConesInternal(0, data, cosConeAngle);
+        // Allocate memory for the BVH.
+        // To be grossly conservative, assume each triangle requires two nodes.
+        // This is only system RAM and shouldn't be that much, so it's not worth being more careful about it.
+        // TODO: Better estimate of how many nodes we will need.
+        nodes.reserve(2 * data.trianglesData.size());
+        triangleIndices.reserve(data.trianglesData.size());
 
-        // The BVH is ready, mark it as valid and upload the data.
-        bvh.mIsValid = true;
-        bvh.mMaxTriangleCountPerLeaf = mOptions.maxTriangleCountPerLeaf;
-        bvh.uploadCPUBuffers(data.triangleIndices, data.triangleBitmasks);
+        // Assemble the subtrees and compute the light bounding cones of the nodes above them.
+        // The light bounding cones within the subtrees have already been computed when building them.
+        float cosConeAngle;
+        appendSubtree(*pRoot, nodes, triangleIndices, cosConeAngle);
+        FALCOR_ASSERT(!nodes.empty());
+        FALCOR_ASSERT(triangleIndices.size() == data.trianglesData.size());
 
-        // Computate metadata.
-        bvh.finalize();
+        triangleBitmasks = std::move(data.triangleBitmasks);
     }
 
     bool LightBVHBuilder::renderUI(Gui::Widgets& widget)
@@ -329,6 +531,7 @@ namespace Falcor
         optionsChanged |= widget.checkbox("Allow refitting", options.allowRefitting);
         optionsChanged |= widget.var("Max triangle count per leaf", options.maxTriangleCountPerLeaf, 1u, kMaxLeafTriangleCount);
         optionsChanged |= widget.dropdown("Split heuristic", kSplitHeuristicList, (uint32_t&)options.splitHeuristicSelection);
+        optionsChanged |= widget.dropdown("Node width", kNodeWidthList, options.nodeWidth);
 
         if (auto splitGroup = widget.group("Split Options", true))
         {
@@ -357,24 +560,209 @@ namespace Falcor
         return optionsChanged;
     }
 
-    uint32_t LightBVHBuilder::buildInternal(const Options& options, const SplitHeuristicFunction& splitHeuristic, uint64_t bitmask, uint32_t depth, const Range& triangleRange, BuildingData& data)
+    bool LightBVHBuilder::collapse(const std::vector<PackedNode>& nodes, const std::vector<uint32_t>& triangleIndices, uint32_t width, LightBVH::WideNodes& wideNodes, std::vector<uint64_t>& triangleBitmasks)
+    {
+        checkArgument(width == 4 || width == 8, "Unsupported wide node width ({}). Must be 4 or 8.", width);
+        checkArgument(!nodes.empty(), "'nodes' must not be empty.");
+
+        // Collapse into temporaries, so that the outputs are left unchanged if the wide BVH is too deep.
+        LightBVH::WideNodes collapsedNodes;
+        collapsedNodes.width = width;
+        std::vector<uint64_t> collapsedBitmasks = triangleBitmasks;
+
+        const CollapseContext ctx = { nodes, triangleIndices, getBitsPerLevel(width), collapsedNodes, collapsedBitmasks };
+        const uint32_t rootIndex = allocateWideNode(collapsedNodes);
+        if (!collapseNode(ctx, 0, rootIndex, 0, 0ull)) return false;
+
+        wideNodes = std::move(collapsedNodes);
+        triangleBitmasks = std::move(collapsedBitmasks);
+        return true;
+    }
+
+    bool LightBVHBuilder::validateCollapse(const std::vector<PackedNode>& nodes, const std::vector<uint32_t>& triangleIndices, const LightBVH::WideNodes& wideNodes, const std::vector<uint64_t>& triangleBitmasks)
+    {
+        const uint32_t width = wideNodes.width;
+        if (width != 4 && width != 8) return false;
+
+        const uint32_t wideNodeCount = wideNodes.getNodeCount();
+        if (nodes.empty() || wideNodeCount == 0) return false;
+        if (wideNodes.data.size() != (size_t)wideNodeCount * width * WideNodeLayout::kFieldCount) return false;
+        if (wideNodes.childNodeIndices.size() != (size_t)wideNodeCount * width) return false;
+
+        // Find the leaf nodes reachable in the binary BVH.
+        std::vector<bool> isBinaryLeaf(nodes.size(), false);
+        uint32_t binaryLeafCount = 0;
+        {
+            std::vector<uint32_t> stack = { 0 };
+            while (!stack.empty())
+            {
+                const uint32_t nodeIndex = stack.back();
+                stack.pop_back();
+                if (nodes[nodeIndex].isLeaf())
+                {
+                    isBinaryLeaf[nodeIndex] = true;
+                    binaryLeafCount++;
+                }
+                else
+                {
+                    const uint32_t rightChildIndex = nodes[nodeIndex].getInternalNode().rightChildIdx;
+                    if (nodeIndex + 1 >= nodes.size() || rightChildIndex >= nodes.size()) return false;
+                    stack.push_back(nodeIndex + 1);
+                    stack.push_back(rightChildIndex);
+                }
+            }
+        }
+
+        // Traverse the wide BVH and check that it references each binary leaf node, and thus each triangle, exactly once.
+        const uint32_t bitsPerLevel = getBitsPerLevel(width);
+        std::vector<bool> isWideNodeVisited(wideNodeCount, false);
+        std::vector<bool> isLeafVisited(nodes.size(), false);
+        std::vector<bool> isTriangleVisited(triangleBitmasks.size(), false);
+        uint32_t visitedWideNodeCount = 0;
+        uint32_t visitedLeafCount = 0;
+
+        struct StackEntry
+        {
+            uint32_t nodeIndex;
+            uint32_t depth;
+            uint64_t bitmask;
+        };
+        std::vector<StackEntry> stack = { { 0, 0, 0ull } };
+
+        while (!stack.empty())
+        {
+            const StackEntry entry = stack.back();
+            stack.pop_back();
+
+            if (isWideNodeVisited[entry.nodeIndex]) return false;
+            isWideNodeVisited[entry.nodeIndex] = true;
+            visitedWideNodeCount++;
+
+            if ((entry.depth + 1) * bitsPerLevel > kMaxBVHDepth) return false;
+
+            for (uint32_t slot = 0; slot < width; slot++)
+            {
+                const uint32_t childRef = wideNodes.data[WideNodeLayout::getDwordOffset(width, entry.nodeIndex, 0, slot)];
+                const uint32_t childNodeIndex = wideNodes.childNodeIndices[entry.nodeIndex * width + slot];
+
+                if (childRef == WideNodeLayout::kInvalidChild)
+                {
+                    if (childNodeIndex != WideNodeLayout::kInvalidChild) return false;
+                    continue;
+                }
+                if (childNodeIndex >= nodes.size()) return false;
+
+                // The child attributes must be identical to the binary node.
+                const PackedNode& child = nodes[childNodeIndex];
+                for (uint32_t field = 1; field < WideNodeLayout::kFieldCount; field++)
+                {
+                    if (wideNodes.data[WideNodeLayout::getDwordOffset(width, entry.nodeIndex, field, slot)] != child.data[field / 4][field % 4]) return false;
+                }
+
+                const uint64_t childBitmask = entry.bitmask | ((uint64_t)slot << (entry.depth * bitsPerLevel));
+
+                if (childRef & WideNodeLayout::kLeafChildFlag)
+                {
+                    if ((childRef & ~WideNodeLayout::kLeafChildFlag) != childNodeIndex) return false;
+                    if (!isBinaryLeaf[childNodeIndex] || isLeafVisited[childNodeIndex]) return false;
+                    isLeafVisited[childNodeIndex] = true;
+                    visitedLeafCount++;
+
+                    // The bitmasks of the triangles in the leaf must retrace the path to the leaf.
+                    const LeafNode leaf = child.getLeafNode();
+                    if ((size_t)leaf.triangleOffset + leaf.triangleCount > triangleIndices.size()) return false;
+                    for (uint32_t i = 0; i < leaf.triangleCount; i++)
+                    {
+                        const uint32_t triangleIndex = triangleIndices[leaf.triangleOffset + i];
+                        if (triangleIndex >= triangleBitmasks.size() || isTriangleVisited[triangleIndex]) return false;
+                        if (triangleBitmasks[triangleIndex] != childBitmask) return false;
+                        isTriangleVisited[triangleIndex] = true;
+                    }
+                }
+                else
+                {
+                    if (child.isLeaf() || childRef >= wideNodeCount) return false;
+                    stack.push_back({ childRef, entry.depth + 1, childBitmask });
+                }
+            }
+        }
+
+        if (visitedWideNodeCount != wideNodeCount || visitedLeafCount != binaryLeafCount) return false;
+
+        // All triangles in the binary BVH must have been visited.
+        for (uint32_t triangleIndex : triangleIndices)
+        {
+            if (triangleIndex >= isTriangleVisited.size() || !isTriangleVisited[triangleIndex]) return false;
+        }
+
+        return true;
+    }
+
+    std::unique_ptr<LightBVHBuilder::Subtree> LightBVHBuilder::buildSubtree(const Options& options, const SplitHeuristicFunction& splitHeuristic, uint64_t bitmask, uint32_t depth, const Range& triangleRange, BuildingData& data)
     {
         FALCOR_ASSERT(triangleRange.begin < triangleRange.end);
+        auto pSubtree = std::make_unique<Subtree>();
+
+        // Build small subtrees serially.
+        // Leaf nodes are never created for more than maxTriangleCountPerLeaf triangles, so larger subtrees always start with an internal node.
+        if (triangleRange.length() <= std::max(kSerialSubtreeTriangleCount, options.maxTriangleCountPerLeaf))
+        {
+            pSubtree->nodes.reserve(2 * triangleRange.length());
+            pSubtree->triangleIndices.reserve(triangleRange.length());
+            buildInternal(options, splitHeuristic, bitmask, depth, triangleRange, data, *pSubtree);
+            pSubtree->coneDirection = computeLightingConesInternal(0, pSubtree->nodes, pSubtree->cosConeAngle);
+            return pSubtree;
+        }
 
         // Compute the AABB and total flux of the node.
         float nodeFlux = 0.f;
-        AABB nodeBounds;
-        for (uint32_t dataIndex = triangleRange.begin; dataIndex < triangleRange.end; ++dataIndex)
+        AABB nodeBounds = computeNodeBounds(triangleRange, data, nodeFlux);
+        FALCOR_ASSERT(nodeBounds.valid());
+
+        const SplitResult splitResult = splitHeuristic(data, triangleRange, nodeBounds, nodeFlux, options);
+        FALCOR_ASSERT(splitResult.isValid());
+        FALCOR_ASSERT(triangleRange.begin < splitResult.triangleIndex && splitResult.triangleIndex < triangleRange.end);
+
+        // Sort the centroids and update the lists accordingly.
+        auto comp = [dim = splitResult.axis](const TriangleSortData& d1, const TriangleSortData& d2) { return d1.bounds.center()[dim] < d2.bounds.center()[dim]; };
+        std::nth_element(std::begin(data.trianglesData) + triangleRange.begin, std::begin(data.trianglesData) + splitResult.triangleIndex, std::begin(data.trianglesData) + triangleRange.end, comp);
+
+        InternalNode& node = pSubtree->node;
+        node.attribs.setAABB(nodeBounds.minPoint, nodeBounds.maxPoint);
+        node.attribs.flux = nodeFlux;
+        // The lighting normal bounding cone will be computed when the subtrees are appended to the BVH.
+
+        if (depth >= kMaxBVHDepth)
         {
-            nodeBounds |= data.trianglesData[dataIndex].bounds;
-            nodeFlux += data.trianglesData[dataIndex].flux;
+            // This is an unrecoverable error since we use bit masks to represent the traversal path from
+            // the root node to each leaf node in the tree, which is necessary for pdf computation with MIS.
+            throw RuntimeError("BVH depth of {} reached. Maximum of {} allowed.", depth + 1, kMaxBVHDepth);
         }
-        FALCOR_ASSERT(nodeBounds.valid());
 
-        data.currentNodeFlux = nodeFlux;
+        // Build the children in parallel. They operate on disjoint ranges of the triangle data.
+        const Range childRanges[2] = { Range(triangleRange.begin, splitResult.triangleIndex), Range(splitResult.triangleIndex, triangleRange.end) };
+        Threading::parallelFor(0, 2, 1, [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                pSubtree->children[i] = buildSubtree(options, splitHeuristic, bitmask | ((uint64_t)i << depth), depth + 1, childRanges[i], data);
+            }
+        });
+
+        return pSubtree;
+    }
+
+    uint32_t LightBVHBuilder::buildInternal(const Options& options, const SplitHeuristicFunction& splitHeuristic, uint64_t bitmask, uint32_t depth, const Range& triangleRange, BuildingData& data, Subtree& subtree)
+    {
+        FALCOR_ASSERT(triangleRange.begin < triangleRange.end);
+
+        // Compute the AABB and total flux of the node.
+        float nodeFlux = 0.f;
+        AABB nodeBounds = computeNodeBounds(triangleRange, data, nodeFlux);
+        FALCOR_ASSERT(nodeBounds.valid());
 
         bool trySplitting = triangleRange.length() > (options.createLeavesASAP ? options.maxTriangleCountPerLeaf : 1);
-        const SplitResult splitResult = trySplitting ? splitHeuristic(data, triangleRange, nodeBounds, options) : SplitResult();
+        const SplitResult splitResult = trySplitting ? splitHeuristic(data, triangleRange, nodeBounds, nodeFlux, options) : SplitResult();
 
         // If we should split, then create an internal node and split.
         if (splitResult.isValid())
@@ -386,9 +774,9 @@ namespace Falcor
             std::nth_element(std::begin(data.trianglesData) + triangleRange.begin, std::begin(data.trianglesData) + splitResult.triangleIndex, std::begin(data.trianglesData) + triangleRange.end, comp);
 
             // Allocate internal node.
-            FALCOR_ASSERT(data.nodes.size() < std::numeric_limits<uint32_t>::max());
-            const uint32_t nodeIndex = (uint32_t)data.nodes.size();
-            data.nodes.push_back({});
+            FALCOR_ASSERT(subtree.nodes.size() < std::numeric_limits<uint32_t>::max());
+            const uint32_t nodeIndex = (uint32_t)subtree.nodes.size();
+            subtree.nodes.push_back({});
 
             InternalNode node = {};
             node.attribs.setAABB(nodeBounds.minPoint, nodeBounds.maxPoint);
@@ -402,13 +790,13 @@ namespace Falcor
                 throw RuntimeError("BVH depth of {} reached. Maximum of {} allowed.", depth + 1, kMaxBVHDepth);
             }
 
-            uint32_t leftIndex = buildInternal(options, splitHeuristic, bitmask | (0ull << depth), depth + 1, Range(triangleRange.begin, splitResult.triangleIndex), data);
-            uint32_t rightIndex = buildInternal(options, splitHeuristic, bitmask | (1ull << depth), depth + 1, Range(splitResult.triangleIndex, triangleRange.end), data);
+            uint32_t leftIndex = buildInternal(options, splitHeuristic, bitmask | (0ull << depth), depth + 1, Range(triangleRange.begin, splitResult.triangleIndex), data, subtree);
+            uint32_t rightIndex = buildInternal(options, splitHeuristic, bitmask | (1ull << depth), depth + 1, Range(splitResult.triangleIndex, triangleRange.end), data, subtree);
 
             FALCOR_ASSERT(leftIndex == nodeIndex + 1); // The left node should always be placed immediately after the current node.
             node.rightChildIdx = rightIndex;
 
-            data.nodes[nodeIndex].setInternalNode(node);
+            subtree.nodes[nodeIndex].setInternalNode(node);
             return nodeIndex;
         }
         else // No split => create leaf node
@@ -416,9 +804,9 @@ namespace Falcor
             FALCOR_ASSERT(triangleRange.length() <= options.maxTriangleCountPerLeaf);
 
             // Allocate leaf node.
-            FALCOR_ASSERT(data.nodes.size() < std::numeric_limits<uint32_t>::max());
-            const uint32_t nodeIndex = (uint32_t)data.nodes.size();
-            data.nodes.push_back({});
+            FALCOR_ASSERT(subtree.nodes.size() < std::numeric_limits<uint32_t>::max());
+            const uint32_t nodeIndex = (uint32_t)subtree.nodes.size();
+            subtree.nodes.push_back({});
 
             LeafNode node = {};
             node.attribs.setAABB(nodeBounds.minPoint, nodeBounds.maxPoint);
@@ -428,36 +816,88 @@ namespace Falcor
             node.attribs.cosConeAngle = cosTheta;
 
             node.triangleCount = triangleRange.length();
-            node.triangleOffset = (uint32_t)data.triangleIndices.size();
+            node.triangleOffset = (uint32_t)subtree.triangleIndices.size();
             FALCOR_ASSERT(node.triangleCount < kMaxLeafTriangleCount);
             FALCOR_ASSERT(node.triangleOffset < kMaxLeafTriangleOffset);
 
             for (uint32_t triangleIdx = triangleRange.begin, index = 0; triangleIdx < triangleRange.end; ++triangleIdx, ++index)
             {
                 uint32_t globalTriangleIndex = data.trianglesData[triangleIdx].triangleIndex;
-                data.triangleIndices.push_back(globalTriangleIndex);
+                subtree.triangleIndices.push_back(globalTriangleIndex);
                 data.triangleBitmasks[globalTriangleIndex] = bitmask;
             }
-            FALCOR_ASSERT(data.triangleIndices.size() == node.triangleOffset + node.triangleCount);
+            FALCOR_ASSERT(subtree.triangleIndices.size() == node.triangleOffset + node.triangleCount);
 
-            data.nodes[nodeIndex].setLeafNode(node);
+            subtree.nodes[nodeIndex].setLeafNode(node);
             return nodeIndex;
         }
     }
 
-    float3 LightBVHBuilder::computeLightingConesInternal(const uint32_t nodeIndex, BuildingData& data, float& cosConeAngle)
+    float3 LightBVHBuilder::appendSubtree(const Subtree& subtree, std::vector<PackedNode>& nodes, std::vector<uint32_t>& triangleIndices, float& cosConeAngle)
+    {
+        FALCOR_ASSERT(nodes.size() < std::numeric_limits<uint32_t>::max());
+        const uint32_t nodeIndex = (uint32_t)nodes.size();
+
+        if (!subtree.children[0])
+        {
+            // Append the serially built subtree and offset its node and triangle indices.
+            // The indices are offset in the packed nodes directly, as unpacking and repacking the node attributes is lossy.
+            const uint32_t triangleOffset = (uint32_t)triangleIndices.size();
+            for (PackedNode node : subtree.nodes)
+            {
+                if (node.isLeaf())
+                {
+                    FALCOR_ASSERT(node.getLeafNode().triangleOffset + triangleOffset < kMaxLeafTriangleOffset);
+                    node.data[0].x += triangleOffset;
+                }
+                else
+                {
+                    node.data[0].x += nodeIndex;
+                }
+                nodes.push_back(node);
+            }
+            triangleIndices.insert(triangleIndices.end(), subtree.triangleIndices.begin(), subtree.triangleIndices.end());
+
+            cosConeAngle = subtree.cosConeAngle;
+            return subtree.coneDirection;
+        }
+
+        // Allocate internal node. The left child is placed immediately after it.
+        nodes.push_back({});
+        InternalNode node = subtree.node;
+
+        float leftNodeCosConeAngle = kInvalidCosConeAngle;
+        float3 leftNodeConeDirection = appendSubtree(*subtree.children[0], nodes, triangleIndices, leftNodeCosConeAngle);
+        node.rightChildIdx = (uint32_t)nodes.size();
+        float rightNodeCosConeAngle = kInvalidCosConeAngle;
+        float3 rightNodeConeDirection = appendSubtree(*subtree.children[1], nodes, triangleIndices, rightNodeCosConeAngle);
+
+        nodes[nodeIndex].setInternalNode(node);
+
+        // Update bounding cone in the same way as computeLightingConesInternal().
+        auto attribs = nodes[nodeIndex].getNodeAttributes();
+        float3 coneDirection = coneUnionOld(leftNodeConeDirection, leftNodeCosConeAngle,
+            rightNodeConeDirection, rightNodeCosConeAngle, cosConeAngle);
+        attribs.cosConeAngle = cosConeAngle;
+        attribs.coneDirection = coneDirection;
+        nodes[nodeIndex].setNodeAttributes(attribs);
+
+        return coneDirection;
+    }
+
+    float3 LightBVHBuilder::computeLightingConesInternal(const uint32_t nodeIndex, std::vector<PackedNode>& nodes, float& cosConeAngle)
     {
-        if (!data.nodes[nodeIndex].isLeaf())
+        if (!nodes[nodeIndex].isLeaf())
         {
-            auto node = data.nodes[nodeIndex].getInternalNode();
+            auto node = nodes[nodeIndex].getInternalNode();
 
             uint32_t leftIndex = nodeIndex + 1;
             uint32_t rightIndex = node.rightChildIdx;
 
             float leftNodeCosConeAngle = kInvalidCosConeAngle;
-            float3 leftNodeConeDirection = computeLightingConesInternal(leftIndex, data, leftNodeCosConeAngle);
+            float3 leftNodeConeDirection = computeLightingConesInternal(leftIndex, nodes, leftNodeCosConeAngle);
             float rightNodeCosConeAngle = kInvalidCosConeAngle;
-            float3 rightNodeConeDirection = computeLightingConesInternal(rightIndex, data, rightNodeCosConeAngle);
+            float3 rightNodeConeDirection = computeLightingConesInternal(rightIndex, nodes, rightNodeCosConeAngle);
 
             // TODO: Asserts in coneUnion
             //float3 coneDirection = coneUnion(leftNodeConeDirection, leftNodeCosConeAngle,
@@ -467,19 +907,31 @@ namespace Falcor
             // Update bounding cone.
             node.attribs.cosConeAngle = cosConeAngle;
             node.attribs.coneDirection = coneDirection;
-            data.nodes[nodeIndex].setNodeAttributes(node.attribs);
+            nodes[nodeIndex].setNodeAttributes(node.attribs);
 
             return coneDirection;
         }
         else
         {
             // Load bounding cone.
-            auto attribs = data.nodes[nodeIndex].getNodeAttributes();
+            auto attribs = nodes[nodeIndex].getNodeAttributes();
             cosConeAngle = attribs.cosConeAngle;
             return attribs.coneDirection;
         }
     }
 
+    AABB LightBVHBuilder::computeNodeBounds(const Range& triangleRange, const BuildingData& data, float& flux)
+    {
+        AABB bounds;
+        flux = 0.f;
+        for (uint32_t dataIndex = triangleRange.begin; dataIndex < triangleRange.end; ++dataIndex)
+        {
+            bounds |= data.trianglesData[dataIndex].bounds;
+            flux += data.trianglesData[dataIndex].flux;
+        }
+        return bounds;
+    }
+
     float3 LightBVHBuilder::computeLightingCone(const Range& triangleRange, const BuildingData& data, float& cosTheta)
     {
         float3 coneDirection = float3(0.0f);
@@ -505,7 +957,7 @@ namespace Falcor
         return coneDirection;
     }
 
-    LightBVHBuilder::SplitResult LightBVHBuilder::computeSplitWithEqual(const BuildingData& /*data*/, const Range& triangleRange, const AABB& nodeBounds, const Options& /*parameters*/)
+    LightBVHBuilder::SplitResult LightBVHBuilder::computeSplitWithEqual(const BuildingData& /*data*/, const Range& triangleRange, const AABB& nodeBounds, float /*nodeFlux*/, const Options& /*parameters*/)
     {
         // Find the largest dimension.
         float3 dimensions = nodeBounds.extent();
@@ -532,7 +984,7 @@ namespace Falcor
         return cost;
     }
 
-    LightBVHBuilder::SplitResult LightBVHBuilder::computeSplitWithBinnedSAH(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, const Options& parameters)
+    LightBVHBuilder::SplitResult LightBVHBuilder::computeSplitWithBinnedSAH(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, float nodeFlux, const Options& parameters)
     {
         std::pair<float, SplitResult> overallBestSplit = std::make_pair(std::numeric_limits<float>::infinity(), SplitResult());
         FALCOR_ASSERT(!overallBestSplit.second.isValid());
@@ -553,15 +1005,18 @@ namespace Falcor
         };
 
         FALCOR_ASSERT(parameters.binCount > 1);
-        std::vector<Bin> bins(parameters.binCount);
-        std::vector<float> costs(parameters.binCount - 1);
+        const bool parallel = triangleRange.length() >= kParallelBinningTriangleCount;
 
         /** Helper function that computes the best split along the given dimension using the SAH metric.
             The triangles are binned to n bins, storing only the aggregate parameters (triangle count and bounds).
             Then the cost metric is evaluated for each of the n-1 potential splits.
+            \return The best split and its cost, or an infinite cost if all lights fall on either side of the split.
         */
-        const auto binAlongDimension = [&bins, &costs, &triangleRange, &data, &parameters, &overallBestSplit, &nodeBounds](uint32_t dimension)
+        const auto binAlongDimension = [&triangleRange, &data, &parameters, &nodeBounds, parallel](uint32_t dimension)
         {
+            std::vector<Bin> bins(parameters.binCount);
+            std::vector<float> costs(parameters.binCount - 1);
+
             // Helper to compute the bin id for a given triangle.
             auto getBinId = [&](const TriangleSortData& td)
             {
@@ -573,14 +1028,36 @@ namespace Falcor
                 return std::min((uint32_t)((p - bmin) * scale), parameters.binCount - 1);
             };
 
-            // Reset the bins.
-            for (Bin& bin : bins) bin = Bin();
-
             // Fill the bins with all triangles.
-            for (uint32_t i = triangleRange.begin; i < triangleRange.end; ++i)
+            if (parallel)
             {
-                const auto& td = data.trianglesData[i];
-                bins[getBinId(td)] |= td;
+                // Bin chunks of triangles in parallel and merge the chunks in order.
+                // The result is identical to serial binning as the bounds and triangle counts do not depend on the order.
+                const uint32_t chunkCount = div_round_up(triangleRange.length(), (uint32_t)kParallelBinningGrainSize);
+                std::vector<Bin> chunkBins(chunkCount * bins.size());
+                Threading::parallelFor(0, chunkCount, 1, [&](size_t chunkBegin, size_t chunkEnd)
+                {
+                    for (size_t chunk = chunkBegin; chunk < chunkEnd; ++chunk)
+                    {
+                        Bin* pChunkBins = &chunkBins[chunk * bins.size()];
+                        const uint32_t begin = triangleRange.begin + (uint32_t)(chunk * kParallelBinningGrainSize);
+                        const uint32_t end = std::min(triangleRange.end, begin + (uint32_t)kParallelBinningGrainSize);
+                        for (uint32_t i = begin; i < end; ++i)
+                        {
+                            const auto& td = data.trianglesData[i];
+                            pChunkBins[getBinId(td)] |= td;
+                        }
+                    }
+                });
+                for (size_t i = 0; i < chunkBins.size(); ++i) bins[i % bins.size()] |= chunkBins[i];
+            }
+            else
+            {
+                for (uint32_t i = triangleRange.begin; i < triangleRange.end; ++i)
+                {
+                    const auto& td = data.trianglesData[i];
+                    bins[getBinId(td)] |= td;
+                }
             }
 
             // First, compute A_j(L) * N_j(L) by sweeping over the bins from left to right.
@@ -614,15 +1091,14 @@ namespace Falcor
 
             // Early out if all lights fall on either side of the split.
             if (axisBestSplit.second.triangleIndex == triangleRange.begin ||
-                axisBestSplit.second.triangleIndex == triangleRange.end) return;
+                axisBestSplit.second.triangleIndex == triangleRange.end) return std::make_pair(std::numeric_limits<float>::infinity(), SplitResult());
 
-            if (axisBestSplit.first < overallBestSplit.first)
-            {
-                overallBestSplit = axisBestSplit;
-                FALCOR_ASSERT(triangleRange.begin < overallBestSplit.second.triangleIndex && overallBestSplit.second.triangleIndex < triangleRange.end);
-            }
+            return axisBestSplit;
         };
 
+        // Compute the best split.
+        std::array<std::pair<float, SplitResult>, 3> axisBestSplits;
+        axisBestSplits.fill(overallBestSplit);
         if (parameters.splitAlongLargest)
         {
             // Find the largest dimension.
@@ -630,13 +1106,26 @@ namespace Falcor
             uint32_t largestDimension = dimensions[2] >= dimensions[0] && dimensions[2] >= dimensions[1] ?
                 2 : (dimensions[1] >= dimensions[0] && dimensions[1] >= dimensions[2] ? 1 : 0);
 
-            binAlongDimension(largestDimension);
+            axisBestSplits[largestDimension] = binAlongDimension(largestDimension);
         }
         else
         {
-            for (uint32_t dimension = 0; dimension < 3; ++dimension)
+            // Large nodes are binned along all dimensions in parallel.
+            Threading::parallelFor(0, 3, parallel ? 1 : 3, [&](size_t begin, size_t end)
+            {
+                for (size_t dimension = begin; dimension < end; ++dimension)
+                {
+                    axisBestSplits[dimension] = binAlongDimension((uint32_t)dimension);
+                }
+            });
+        }
+
+        for (const auto& axisBestSplit : axisBestSplits)
+        {
+            if (axisBestSplit.first < overallBestSplit.first)
             {
-                binAlongDimension(dimension);
+                overallBestSplit = axisBestSplit;
+                FALCOR_ASSERT(triangleRange.begin < overallBestSplit.second.triangleIndex && overallBestSplit.second.triangleIndex < triangleRange.end);
             }
         }
 
@@ -645,7 +1134,7 @@ namespace Falcor
         {
             if (triangleRange.length() <= parameters.maxTriangleCountPerLeaf) return SplitResult();
             logWarning("LightBVHBuilder::computeSplitWithBinnedSAH() was not able to compute a proper split: reverting to LightBVHBuilder::computeSplitWithEqual()");
-            return computeSplitWithEqual(data, triangleRange, nodeBounds, parameters);
+            return computeSplitWithEqual(data, triangleRange, nodeBounds, nodeFlux, parameters);
         }
 
         // If the best split we found is more expensive than the cost of a leaf node (and we can create one), then create a leaf node.
@@ -687,7 +1176,7 @@ namespace Falcor
         return cost;
     }
 
-    LightBVHBuilder::SplitResult LightBVHBuilder::computeSplitWithBinnedSAOH(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, const Options& parameters)
+    LightBVHBuilder::SplitResult LightBVHBuilder::computeSplitWithBinnedSAOH(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, float nodeFlux, const Options& parameters)
     {
         std::pair<float, SplitResult> overallBestSplit = std::make_pair(std::numeric_limits<float>::infinity(), SplitResult());
         FALCOR_ASSERT(!overallBestSplit.second.isValid());
@@ -719,8 +1208,7 @@ namespace Falcor
         };
 
         FALCOR_ASSERT(parameters.binCount > 1);
-        std::vector<Bin> bins(parameters.binCount);
-        std::vector<float> costs(parameters.binCount - 1);
+        const bool parallel = triangleRange.length() >= kParallelBinningTriangleCount;
 
         /** Helper function that computes the best split along the given dimension using the SAOH metric.
             The triangles are binned to n bins, storing only the aggregate parameters (triangle count, bounds, flux, and cone direction).
@@ -728,9 +1216,13 @@ namespace Falcor
             Note that while the bounds and flux are accurately represented by the aggregated parameters,
             the bounding cones are approximates based on the bins' bounding cones. This is less expensive,
             but also less precise than computing them directly from the triangles.
+            \return The best split and its cost, or an infinite cost if all lights fall on either side of the split.
         */
-        const auto binAlongDimension = [&bins, &costs, &triangleRange, &data, &parameters, &overallBestSplit, &nodeBounds, largestDimension, dimensions](uint32_t dimension)
+        const auto binAlongDimension = [&triangleRange, &data, &parameters, &nodeBounds, largestDimension, dimensions, parallel](uint32_t dimension)
         {
+            std::vector<Bin> bins(parameters.binCount);
+            std::vector<float> costs(parameters.binCount - 1);
+
             // Helper to compute the bin id for a given triangle.
             auto getBinId = [&](const TriangleSortData& td)
             {
@@ -743,14 +1235,26 @@ namespace Falcor
                 return std::min((uint32_t)((p - bmin) * scale), parameters.binCount - 1);
             };
 
-            // Reset the bins.
-            for (Bin& bin : bins) bin = Bin();
+            // For large nodes, compute the bin ids in parallel.
+            // The bins are still filled serially, as the sums of the flux and cone directions depend on the order.
+            std::vector<uint32_t> binIds;
+            if (parallel)
+            {
+                binIds.resize(triangleRange.length());
+                Threading::parallelFor(triangleRange.begin, triangleRange.end, kParallelBinningGrainSize, [&](size_t begin, size_t end)
+                {
+                    for (size_t i = begin; i < end; ++i) binIds[i - triangleRange.begin] = getBinId(data.trianglesData[i]);
+                });
+            }
+            auto getTriangleBin = [&](uint32_t i) -> Bin&
+            {
+                return bins[parallel ? binIds[i - triangleRange.begin] : getBinId(data.trianglesData[i])];
+            };
 
             // Fill the bins with all triangles.
             for (uint32_t i = triangleRange.begin; i < triangleRange.end; ++i)
             {
-                const auto& td = data.trianglesData[i];
-                bins[getBinId(td)] |= td;
+                getTriangleBin(i) |= data.trianglesData[i];
             }
 
             // Compute the lighting cones for each bin.
@@ -762,11 +1266,33 @@ namespace Falcor
                 bin.cosConeAngle = glm::length(bin.coneDirection) < FLT_MIN ? kInvalidCosConeAngle : 1.0f;
                 bin.coneDirection = glm::normalize(bin.coneDirection);
             }
-            for (uint32_t i = triangleRange.begin; i < triangleRange.end; ++i)
+            if (parallel)
             {
-                const auto& td = data.trianglesData[i];
-                Bin& bin = bins[getBinId(td)];
-                bin.cosConeAngle = computeCosConeAngle(bin.coneDirection, bin.cosConeAngle, td.coneDirection, td.cosConeAngle);
+                // Compute the per-triangle cone angles in parallel and accumulate them in order.
+                std::vector<float> cosTotalConeAngles(triangleRange.length());
+                Threading::parallelFor(triangleRange.begin, triangleRange.end, kParallelBinningGrainSize, [&](size_t begin, size_t end)
+                {
+                    for (size_t i = begin; i < end; ++i)
+                    {
+                        const auto& td = data.trianglesData[i];
+                        const Bin& bin = bins[binIds[i - triangleRange.begin]];
+                        cosTotalConeAngles[i - triangleRange.begin] = computeCosTotalConeAngle(bin.coneDirection, td.coneDirection, td.cosConeAngle);
+                    }
+                });
+                for (uint32_t i = triangleRange.begin; i < triangleRange.end; ++i)
+                {
+                    Bin& bin = getTriangleBin(i);
+                    bin.cosConeAngle = accumulateCosConeAngle(bin.cosConeAngle, cosTotalConeAngles[i - triangleRange.begin]);
+                }
+            }
+            else
+            {
+                for (uint32_t i = triangleRange.begin; i < triangleRange.end; ++i)
+                {
+                    const auto& td = data.trianglesData[i];
+                    Bin& bin = getTriangleBin(i);
+                    bin.cosConeAngle = computeCosConeAngle(bin.coneDirection, bin.cosConeAngle, td.coneDirection, td.cosConeAngle);
+                }
             }
 
             // First, compute A_j(L) * N_j(L) by sweeping over the bins from left to right.
@@ -829,25 +1355,36 @@ namespace Falcor
 
             // Early out if all lights fall on either side of the split.
             if (axisBestSplit.second.triangleIndex == triangleRange.begin ||
-                axisBestSplit.second.triangleIndex == triangleRange.end) return;
+                axisBestSplit.second.triangleIndex == triangleRange.end) return std::make_pair(std::numeric_limits<float>::infinity(), SplitResult());
 
-            if (axisBestSplit.first < overallBestSplit.first)
-            {
-                overallBestSplit = axisBestSplit;
-                FALCOR_ASSERT(triangleRange.begin < overallBestSplit.second.triangleIndex && overallBestSplit.second.triangleIndex < triangleRange.end);
-            }
+            return axisBestSplit;
         };
 
         // Compute the best split.
+        std::array<std::pair<float, SplitResult>, 3> axisBestSplits;
+        axisBestSplits.fill(overallBestSplit);
         if (parameters.splitAlongLargest)
         {
-            binAlongDimension(largestDimension);
+            axisBestSplits[largestDimension] = binAlongDimension(largestDimension);
         }
         else
         {
-            for (uint32_t dimension = 0; dimension < 3; ++dimension)
+            // Large nodes are binned along all dimensions in parallel.
+            Threading::parallelFor(0, 3, parallel ? 1 : 3, [&](size_t begin, size_t end)
+            {
+                for (size_t dimension = begin; dimension < end; ++dimension)
+                {
+                    axisBestSplits[dimension] = binAlongDimension((uint32_t)dimension);
+                }
+            });
+        }
+
+        for (const auto& axisBestSplit : axisBestSplits)
+        {
+            if (axisBestSplit.first < overallBestSplit.first)
             {
-                binAlongDimension(dimension);
+                overallBestSplit = axisBestSplit;
+                FALCOR_ASSERT(triangleRange.begin < overallBestSplit.second.triangleIndex && overallBestSplit.second.triangleIndex < triangleRange.end);
             }
         }
 
@@ -856,7 +1393,7 @@ namespace Falcor
         {
             if (triangleRange.length() <= parameters.maxTriangleCountPerLeaf) return SplitResult();
             logWarning("LightBVHBuilder::computeSplitWithBinnedSAOH() was not able to compute a proper split: reverting to LightBVHBuilder::computeSplitWithEqual()");
-            return computeSplitWithEqual(data, triangleRange, nodeBounds, parameters);
+            return computeSplitWithEqual(data, triangleRange, nodeBounds, nodeFlux, parameters);
         }
 
         // If the best split we found is more expensive than the cost of a leaf node (and we can create one), then create a leaf node.
@@ -866,7 +1403,7 @@ namespace Falcor
             // Evaluate the cost metric for the node. This requires us to first compute the cone angle.
             float cosTheta = kInvalidCosConeAngle;
             computeLightingCone(triangleRange, data, cosTheta);
-            float leafCost = evalSAOH(nodeBounds, data.currentNodeFlux, cosTheta, parameters);
+            float leafCost = evalSAOH(nodeBounds, nodeFlux, cosTheta, parameters);
             if (leafCost <= overallBestSplit.first) return SplitResult();
         }
 
@@ -909,6 +1446,7 @@ namespace Falcor
         options.field(allowRefitting);
         options.field(usePreintegration);
         options.field(useLightingCones);
+        options.field(nodeWidth);
 #undef field
     }
 }
@@ -39,10 +39,14 @@
 namespace Falcor
 {
     /** Utility class for building 2-way light BVH on the CPU.
+        The binary BVH can optionally be collapsed into a 4- or 8-wide BVH after the build (see |collapse()|).
 
         The building process can be customized via the |Options|,
         which are also available in the GUI via the |renderUI()| function.
 
+        Large nodes are binned in parallel and their subtrees are built by separate tasks on the
+        global thread pool. The result is identical to building the whole tree on a single thread.
+
         TODO: Rename all things triangle* to light* as the BVH class can be used for other types.
     */
     class FALCOR_API LightBVHBuilder
@@ -71,6 +75,7 @@ namespace Falcor
             bool           allowRefitting = true;                                ///< Rather than always rebuilding the BVH from scratch, keep the hierarchy but update the bounds and lighting cones.
             bool           usePreintegration = true;                             ///< Use pre-integration for culling out emissive triangles and use their flux when computing the splits. Only valid when using the BinnedSAOH split heuristic.
             bool           useLightingCones = true;                              ///< Use lighting cones when computing the splits. Only valid when using the BinnedSAOH split heuristic.
+            uint32_t       nodeWidth = 2;                                        ///< Number of children per node used for traversal (2, 4 or 8). Wide nodes are collapsed from the binary BVH after it has been built. BVHs too deep to be collapsed use the binary layout.
         };
 
         /** Constructor.
@@ -83,10 +88,43 @@ namespace Falcor
         */
         void build(RenderContext* pRenderContext, LightBVH& bvh);
 
+        /** Build the binary BVH nodes on the CPU. This is the part of build() that does not depend on the GPU.
+            \param[in] triangles Emissive triangles.
+            \param[out] nodes BVH nodes in depth-first order, with the root node located at index 0. All outputs are empty if all triangles are culled.
+            \param[out] triangleIndices Triangle indices sorted by leaf node.
+            \param[out] triangleBitmasks Per triangle bit pattern retracing the tree traversal to reach the triangle: 0=left child, 1=right child.
+                Indexed by global triangle index; entries of culled triangles are set to all ones.
+        */
+        void buildNodes(const std::vector<LightCollection::MeshLightTriangle>& triangles, std::vector<PackedNode>& nodes, std::vector<uint32_t>& triangleIndices, std::vector<uint64_t>& triangleBitmasks);
+
         bool renderUI(Gui::Widgets& widget);
 
         const Options& getOptions() const { return mOptions; }
 
+        /** Collapse a binary BVH into a wide BVH.
+            Each wide node is formed by repeatedly replacing the internal child with the largest surface area by its two children,
+            until the node has 'width' children or all children are leaves. The binary leaf nodes are referenced by the wide nodes.
+            \param[in] nodes Binary BVH nodes in depth-first order, with the root node located at index 0.
+            \param[in] triangleIndices Triangle indices sorted by leaf node.
+            \param[in] width Number of children per wide node (4 or 8).
+            \param[out] wideNodes The wide nodes.
+            \param[in,out] triangleBitmasks Per triangle bit pattern retracing the wide tree traversal to reach the triangle: log2(width) bits per level selecting the child slot.
+                Indexed by global triangle index; entries of triangles that are not in the BVH are left unchanged.
+            \return True if the BVH was collapsed. False if the traversal paths of the wide BVH would not fit in the 64-bit bitmasks, in which case the outputs are left unchanged.
+        */
+        static bool collapse(const std::vector<PackedNode>& nodes, const std::vector<uint32_t>& triangleIndices, uint32_t width, LightBVH::WideNodes& wideNodes, std::vector<uint64_t>& triangleBitmasks);
+
+        /** Validate a wide BVH against the binary BVH it was collapsed from.
+            Checks that every wide node is reachable exactly once, that the child attributes match the binary nodes, that the wide BVH
+            references every binary leaf node exactly once and thus covers exactly the same triangles, and that the triangle bitmasks lead to the leaves containing the triangles.
+            \param[in] nodes Binary BVH nodes.
+            \param[in] triangleIndices Triangle indices sorted by leaf node.
+            \param[in] wideNodes The wide nodes.
+            \param[in] triangleBitmasks Per triangle wide tree traversal bitmasks.
+            \return True if the wide BVH is valid.
+        */
+        static bool validateCollapse(const std::vector<PackedNode>& nodes, const std::vector<uint32_t>& triangleIndices, const LightBVH::WideNodes& wideNodes, const std::vector<uint64_t>& triangleBitmasks);
+
     protected:
         struct Range
         {
@@ -120,46 +158,87 @@ namespace Falcor
             uint32_t triangleIndex = MeshLightData::kInvalidIndex; ///< Index into global triangle list.
         };
 
+        /** Light data shared by all subtrees. Subtrees built in parallel only access disjoint ranges of the triangle data.
+        */
         struct BuildingData
         {
-            std::vector<PackedNode>& nodes;                 ///< BVH nodes generated by the builder.
             std::vector<TriangleSortData> trianglesData;    ///< Compact list of triangles to include in build.
-            std::vector<uint32_t> triangleIndices;          ///< Triangle indices sorted by leaf node. Each leaf node refers to a contiguous array of triangle indices.
             std::vector<uint64_t> triangleBitmasks;         ///< Array containing the per triangle bit pattern retracing the tree traversal to reach the triangle: 0=left child, 1=right child; this array gets filled in during the build process. Indexed by global triangle index.
-            float currentNodeFlux = 0.f;                    ///< Used by computeSAOHSplit() as the leaf creation cost.
+        };
 
-            BuildingData(std::vector<PackedNode>& bvhNodes) : nodes(bvhNodes) {}
+        /** Part of the BVH built by a single task.
+            Large subtrees are split and their children are built in parallel. Small subtrees are built serially into local
+            node and triangle index lists, which are appended to the BVH in depth-first order once all subtrees are built.
+        */
+        struct Subtree
+        {
+            std::unique_ptr<Subtree> children[2];           ///< Left and right child subtrees if the root node was split in parallel, nullptr otherwise.
+            InternalNode node = {};                         ///< Root node if the root node was split in parallel.
+            std::vector<PackedNode> nodes;                  ///< BVH nodes if the subtree was built serially. Child node indices are relative to the subtree.
+            std::vector<uint32_t> triangleIndices;          ///< Triangle indices sorted by leaf node if the subtree was built serially. Leaf node triangle offsets are relative to the subtree.
+            float3 coneDirection = {};                      ///< Lighting cone direction of the root node if the subtree was built serially.
+            float cosConeAngle = kInvalidCosConeAngle;      ///< Cosine of the lighting cone angle of the root node if the subtree was built serially.
         };
 
         /** Compute the split according to a specified heuristic.
             \param[in] data Prepared light data.
             \param[in] triangleRange Range of triangles to process.
             \param[in] nodeBounds Bounds for the node to be splitted.
+            \param[in] nodeFlux Total flux of the node to be splitted.
             \param[in] parameters Various parameters defining how the building should occur.
         */
-        using SplitHeuristicFunction = std::function<SplitResult(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, const Options& parameters)>;
+        using SplitHeuristicFunction = std::function<SplitResult(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, float nodeFlux, const Options& parameters)>;
 
         /** Renders the UI with builder options.
         */
         bool renderOptions(Gui::Widgets& widget, Options& options) const;
 
+        /** Recursive parallel BVH build.
+            Subtrees that are small enough are built serially using buildInternal(), larger subtrees are split and their children are built in parallel.
+            \param[in] splitHeuristic The splitting heuristic to be used.
+            \param[in] bitmask Bit pattern retracing the tree traversal to reach the subtree root: 0=left child, 1=right child.
+            \param[in] depth Depth of the subtree root.
+            \param[in] triangleRange Range of triangles to process.
+            \param[in,out] data Prepared light data.
+            \return The built subtree.
+        */
+        std::unique_ptr<Subtree> buildSubtree(const Options& options, const SplitHeuristicFunction& splitHeuristic, uint64_t bitmask, uint32_t depth, const Range& triangleRange, BuildingData& data);
+
         /** Recursive BVH build.
             \param[in] splitHeuristic The splitting heuristic to be used.
             \param[in] bitmask Bit pattern retracing the tree traversal to reach the node to be built: 0=left child, 1=right child.
             \param[in] depth Depth of the node to be built
             \param[in] triangleRange Range of triangles to process.
             \param[in,out] data Prepared light data.
-            \return Index of the allocated node.
+            \param[in,out] subtree Subtree to which the nodes are added.
+            \return Index of the allocated node relative to the subtree.
         */
-        uint32_t buildInternal(const Options& options, const SplitHeuristicFunction& splitHeuristic, uint64_t bitmask, uint32_t depth, const Range& triangleRange, BuildingData& data);
+        uint32_t buildInternal(const Options& options, const SplitHeuristicFunction& splitHeuristic, uint64_t bitmask, uint32_t depth, const Range& triangleRange, BuildingData& data, Subtree& subtree);
+
+        /** Recursively append a subtree to the BVH in depth-first order and compute the lighting cones of the nodes that were split in parallel.
+            \param[in] subtree The subtree to append.
+            \param[in,out] nodes BVH nodes.
+            \param[in,out] triangleIndices Triangle indices sorted by leaf node.
+            \param[out] cosConeAngle Cosine of the cone angle of the lighting cone for the subtree root, or kInvalidCosConeAngle if the cone is invalid.
+            \return direction of the lighting cone for the subtree root.
+        */
+        float3 appendSubtree(const Subtree& subtree, std::vector<PackedNode>& nodes, std::vector<uint32_t>& triangleIndices, float& cosConeAngle);
 
         /** Recursive computation of lighting cones for all internal nodes.
             \param[in] nodeIndex Index of the current node.
-            \param[in,out] data Updated node data.
+            \param[in,out] nodes Updated node data.
             \param[out] cosConeAngle Cosine of the cone angle of the lighting cone for the current node, or kInvalidCosConeAngle if the cone is invalid.
             \return direction of the lighting cone for the current node.
         */
-        float3 computeLightingConesInternal(const uint32_t nodeIndex, BuildingData& data, float& cosConeAngle);
+        float3 computeLightingConesInternal(const uint32_t nodeIndex, std::vector<PackedNode>& nodes, float& cosConeAngle);
+
+        /** Compute bounds and total flux for a range of triangles.
+            \param[in] triangleRange Range of triangles to process.
+            \param[in] data Prepared light data.
+            \param[out] flux Total flux.
+            \return Bounds of the triangles.
+        */
+        static AABB computeNodeBounds(const Range& triangleRange, const BuildingData& data, float& flux);
 
         /** Compute lighting cone for a range of triangles.
             \param[in] triangleRange Range of triangles to process.
@@ -170,9 +249,9 @@ namespace Falcor
         static float3 computeLightingCone(const Range& triangleRange, const BuildingData& data, float& cosTheta);
 
         // See the documentation of SplitHeuristicFunction.
-        static SplitResult computeSplitWithEqual(const BuildingData& /*data*/, const Range& triangleRange, const AABB& nodeBounds, const Options& /*parameters*/);
-        static SplitResult computeSplitWithBinnedSAH(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, const Options& parameters);
-        static SplitResult computeSplitWithBinnedSAOH(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, const Options& parameters);
+        static SplitResult computeSplitWithEqual(const BuildingData& /*data*/, const Range& triangleRange, const AABB& nodeBounds, float /*nodeFlux*/, const Options& /*parameters*/);
+        static SplitResult computeSplitWithBinnedSAH(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, float /*nodeFlux*/, const Options& parameters);
+        static SplitResult computeSplitWithBinnedSAOH(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, float nodeFlux, const Options& parameters);
 
         static SplitHeuristicFunction getSplitFunction(SplitHeuristic heuristic);
 
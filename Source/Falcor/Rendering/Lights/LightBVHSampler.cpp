@@ -94,6 +94,9 @@ namespace Falcor
         defines.add("_USE_UNIFORM_TRIANGLE_SAMPLING", mOptions.useUniformTriangleSampling ? "1" : "0");
         defines.add("_ACTUAL_MAX_TRIANGLES_PER_NODE", std::to_string(mOptions.buildOptions.maxTriangleCountPerLeaf));
         defines.add("_SOLID_ANGLE_BOUND_METHOD", std::to_string((uint32_t)mOptions.solidAngleBoundMethod));
+        // The width is taken from the built BVH, as the builder falls back to the binary layout if the BVH is too deep to be collapsed.
+        // Callers pick up a changed width after a rebuild in update() and recompile their programs.
+        defines.add("_LIGHT_BVH_WIDTH", std::to_string(mpBVH->getWideNodes().width));
 
         return defines;
     }
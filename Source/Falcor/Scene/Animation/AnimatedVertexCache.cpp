@@ -29,6 +29,8 @@
 #include "Animation.h"
 #include "Core/API/RenderContext.h"
 #include "Scene/Scene.h"
+#include "Utils/Logger.h"
+#include "Utils/Threading.h"
 #include "Utils/Timing/Profiler.h"
 
 namespace Falcor
@@ -94,17 +96,78 @@ namespace Falcor
 
             return InterpolationInfo{ keyframeIndices, t };
         }
+
+        const uint32_t kInvalidKeyframe = std::numeric_limits<uint32_t>::max();
+
+        /** Get the keyframes to make resident, in order of priority.
+            These are the two keyframes used for interpolation, followed by the keyframes after them.
+        */
+        std::vector<uint32_t> getWantedKeyframes(const InterpolationInfo& info, uint32_t keyframeCount, uint32_t residentCount, bool loop)
+        {
+            std::vector<uint32_t> wanted;
+            auto add = [&](uint32_t keyframe)
+            {
+                if (std::find(wanted.begin(), wanted.end(), keyframe) == wanted.end()) wanted.push_back(keyframe);
+            };
+
+            add(info.keyframeIndices.x);
+            add(info.keyframeIndices.y);
+            uint32_t keyframe = info.keyframeIndices.y;
+            while (wanted.size() < residentCount)
+            {
+                keyframe = keyframe + 1 < keyframeCount ? keyframe + 1 : (loop ? 0 : keyframe);
+                if (std::find(wanted.begin(), wanted.end(), keyframe) != wanted.end()) break;
+                wanted.push_back(keyframe);
+            }
+            return wanted;
+        }
+
+        /** Assign keyframes to resident keyframe buffers.
+            Buffers holding a wanted keyframe are kept, the remaining wanted keyframes replace the other keyframes.
+            \param[in] wanted Keyframes to make resident. There must be at most as many as there are resident buffers.
+            \param[in,out] resident Keyframe held by each resident buffer.
+            \param[out] loads Indices of the resident buffers to load the newly assigned keyframes into.
+        */
+        void assignResidentKeyframes(const std::vector<uint32_t>& wanted, std::vector<uint32_t>& resident, std::vector<uint32_t>& loads)
+        {
+            FALCOR_ASSERT(wanted.size() <= resident.size());
+            std::vector<bool> keep(resident.size(), false);
+            for (size_t i = 0; i < resident.size(); i++)
+            {
+                keep[i] = std::find(wanted.begin(), wanted.end(), resident[i]) != wanted.end();
+            }
+
+            for (uint32_t keyframe : wanted)
+            {
+                if (std::find(resident.begin(), resident.end(), keyframe) != resident.end()) continue;
+                auto it = std::find(keep.begin(), keep.end(), false);
+                FALCOR_ASSERT(it != keep.end());
+                uint32_t index = (uint32_t)(it - keep.begin());
+                keep[index] = true;
+                resident[index] = keyframe;
+                loads.push_back(index);
+            }
+        }
+
+        uint32_t findResidentKeyframe(const std::vector<uint32_t>& resident, uint32_t keyframe)
+        {
+            auto it = std::find(resident.begin(), resident.end(), keyframe);
+            FALCOR_ASSERT(it != resident.end());
+            return (uint32_t)(it - resident.begin());
+        }
     }
 
     AnimatedVertexCache::AnimatedVertexCache(std::shared_ptr<Device> pDevice, Scene* pScene, const Buffer::SharedPtr& pPrevVertexData, std::vector<CachedCurve>&& cachedCurves, std::vector<CachedMesh>&& cachedMeshes)
         : mpDevice(std::move(pDevice))
         , mpScene(pScene)
         , mpPrevVertexData(pPrevVertexData)
-        , mCachedCurves(cachedCurves)
-        , mCachedMeshes(cachedMeshes)
+        , mCachedCurves(std::move(cachedCurves))
+        , mCachedMeshes(std::move(cachedMeshes))
     {
         if (mCachedCurves.empty() && mCachedMeshes.empty()) return;
 
+        initKeyframeStore();
+
         if (!mCachedCurves.empty())
         {
             for (auto& cache : mCachedCurves)
@@ -153,6 +216,7 @@ namespace Falcor
         {
             double curveTime = mLoopAnimations ? std::fmod(time, mGlobalCurveAnimationLength) : time;
             InterpolationInfo interpolationInfo = calculateInterpolation(curveTime, mCurveKeyframeTimes, mPreInfinityBehavior, Animation::Behavior::Constant);
+            interpolationInfo = updateResidentCurveKeyframes(interpolationInfo);
 
             if (mCurveLSSCount > 0)
             {
@@ -198,9 +262,36 @@ namespace Falcor
         for (size_t i = 0; i < mpMeshVertexBuffers.size(); i++) m += mpMeshVertexBuffers[i] ? mpMeshVertexBuffers[i]->getSize() : 0;
         m += mpMeshInterpolationBuffer ? mpMeshInterpolationBuffer->getSize() : 0;
         m += mpMeshMetadataBuffer ? mpMeshMetadataBuffer->getSize() : 0;
+        for (size_t i = 0; i < mpCurvePolyTubeVertexBuffers.size(); i++) m += mpCurvePolyTubeVertexBuffers[i] ? mpCurvePolyTubeVertexBuffers[i]->getSize() : 0;
+        m += mpKeyframeStore ? mpKeyframeStore->getMemoryUsageInBytes() : 0;
         return m;
     }
 
+    void AnimatedVertexCache::initKeyframeStore()
+    {
+        mpKeyframeStore = std::make_unique<KeyframeStore>();
+
+        for (auto& cache : mCachedCurves)
+        {
+            checkArgument(!cache.vertexData.empty() && cache.vertexData.size() == cache.timeSamples.size(), "Cached curve has mismatching keyframe and time sample count.");
+            mCurveVertexCounts.push_back((uint32_t)cache.vertexData[0].size());
+            mCurveStreams.push_back(mpKeyframeStore->addStream(cache.vertexData));
+            std::vector<std::vector<DynamicCurveVertexData>>().swap(cache.vertexData);
+        }
+
+        for (auto& cache : mCachedMeshes)
+        {
+            checkArgument(!cache.vertexData.empty() && cache.vertexData.size() == cache.timeSamples.size(), "Cached mesh has mismatching keyframe and time sample count.");
+            mMeshVertexCounts.push_back((uint32_t)cache.vertexData[0].size());
+            mMeshStreams.push_back(mpKeyframeStore->addStream(cache.vertexData));
+            std::vector<std::vector<PackedStaticVertexData>>().swap(cache.vertexData);
+        }
+
+        mpKeyframeStore->finalize();
+
+        logInfo("AnimatedVertexCache: Encoded {:.1f} MB of keyframes to {:.1f} MB.", mpKeyframeStore->getDecodedSizeInBytes() / 1e6, mpKeyframeStore->getEncodedSizeInBytes() / 1e6);
+    }
+
     // We create a merged list of all timestamps and generate new frames for curves where those timestamps are missing.
     // This can lead to fairly heavy overhead if we have cached curves with vastly different total length.
     // Currently, our assets have cached curves with the same list of timestamps.
@@ -216,6 +307,68 @@ namespace Falcor
         mCurveKeyframeTimes.erase(std::unique(mCurveKeyframeTimes.begin(), mCurveKeyframeTimes.end()), mCurveKeyframeTimes.end());
 
         mGlobalCurveAnimationLength = mCurveKeyframeTimes.empty() ? 0 : mCurveKeyframeTimes.back();
+        mResidentCurveKeyframes.assign(std::min(kResidentKeyframeCount, (uint32_t)mCurveKeyframeTimes.size()), kInvalidKeyframe);
+    }
+
+    std::vector<DynamicCurveVertexData> AnimatedVertexCache::getCurveKeyframe(uint32_t curveIndex, uint32_t keyframe) const
+    {
+        const auto& timeSamples = mCachedCurves[curveIndex].timeSamples;
+        const double time = mCurveKeyframeTimes[keyframe];
+        const uint32_t k = std::min((uint32_t)(std::lower_bound(timeSamples.begin(), timeSamples.end(), time) - timeSamples.begin()), (uint32_t)timeSamples.size() - 1);
+
+        auto vertexData = mpKeyframeStore->decodeKeyframe<DynamicCurveVertexData>(mCurveStreams[curveIndex], k);
+        if (timeSamples[k] != time && k > 0)
+        {
+            // Linearly interpolate at the missing keyframe.
+            auto prevVertexData = mpKeyframeStore->decodeKeyframe<DynamicCurveVertexData>(mCurveStreams[curveIndex], k - 1);
+            float t = float((time - timeSamples[k - 1]) / (timeSamples[k] - timeSamples[k - 1]));
+            for (size_t p = 0; p < vertexData.size(); p++)
+            {
+                vertexData[p].position = lerp(prevVertexData[p].position, vertexData[p].position, t);
+            }
+        }
+        return vertexData;
+    }
+
+    InterpolationInfo AnimatedVertexCache::updateResidentCurveKeyframes(const InterpolationInfo& info)
+    {
+        auto wanted = getWantedKeyframes(info, (uint32_t)mCurveKeyframeTimes.size(), (uint32_t)mResidentCurveKeyframes.size(), mLoopAnimations);
+        std::vector<uint32_t> loads;
+        assignResidentKeyframes(wanted, mResidentCurveKeyframes, loads);
+
+        // Offsets of the curves in the LSS and poly-tube vertex buffers.
+        std::vector<uint32_t> offsets(mCachedCurves.size());
+        uint32_t lssOffset = 0;
+        uint32_t polyTubeOffset = 0;
+        for (size_t i = 0; i < mCachedCurves.size(); i++)
+        {
+            uint32_t& offset = mCachedCurves[i].tessellationMode == CurveTessellationMode::PolyTube ? polyTubeOffset : lssOffset;
+            offsets[i] = offset;
+            offset += mCurveVertexCounts[i];
+        }
+
+        for (uint32_t index : loads)
+        {
+            const uint32_t keyframe = mResidentCurveKeyframes[index];
+
+            // Gather the vertex data of all curves at the keyframe. Curves are decoded in parallel.
+            std::vector<DynamicCurveVertexData> lssVertexData(mCurveVertexCount);
+            std::vector<DynamicCurveVertexData> polyTubeVertexData(mCurvePolyTubeVertexCount);
+            Threading::parallelFor(0, mCachedCurves.size(), 1, [&](size_t begin, size_t end)
+            {
+                for (size_t i = begin; i < end; i++)
+                {
+                    auto vertexData = getCurveKeyframe((uint32_t)i, keyframe);
+                    auto& dst = mCachedCurves[i].tessellationMode == CurveTessellationMode::PolyTube ? polyTubeVertexData : lssVertexData;
+                    std::copy(vertexData.begin(), vertexData.end(), dst.begin() + offsets[i]);
+                }
+            });
+
+            if (mCurveLSSCount > 0) mpCurveVertexBuffers[index]->setBlob(lssVertexData.data(), 0, lssVertexData.size() * sizeof(DynamicCurveVertexData));
+            if (mCurvePolyTubeCount > 0) mpCurvePolyTubeVertexBuffers[index]->setBlob(polyTubeVertexData.data(), 0, polyTubeVertexData.size() * sizeof(DynamicCurveVertexData));
+        }
+
+        return InterpolationInfo{ uint2(findResidentKeyframe(mResidentCurveKeyframes, info.keyframeIndices.x), findResidentKeyframe(mResidentCurveKeyframes, info.keyframeIndices.y)), info.t };
     }
 
     void AnimatedVertexCache::bindCurveLSSBuffers()
@@ -227,14 +380,15 @@ namespace Falcor
         {
             if (mCachedCurves[i].tessellationMode != CurveTessellationMode::LinearSweptSphere) continue;
 
-            mCurveVertexCount += (uint32_t)mCachedCurves[i].vertexData[0].size();
+            mCurveVertexCount += mCurveVertexCounts[i];
             mCurveIndexCount += (uint32_t)mCachedCurves[i].indexData.size();
         }
 
-        // Create buffers for vertex positions in curve vertex caches.
+        // Create buffers for vertex positions in curve vertex caches at the resident keyframes.
+        // These are filled in updateResidentCurveKeyframes().
         ResourceBindFlags vbBindFlags = ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess;
-        mpCurveVertexBuffers.resize(mCurveKeyframeTimes.size());
-        for (uint32_t i = 0; i < mCurveKeyframeTimes.size(); i++)
+        mpCurveVertexBuffers.resize(mResidentCurveKeyframes.size());
+        for (uint32_t i = 0; i < mpCurveVertexBuffers.size(); i++)
         {
             mpCurveVertexBuffers[i] = Buffer::createStructured(mpDevice.get(), sizeof(DynamicCurveVertexData), mCurveVertexCount, vbBindFlags, Buffer::CpuAccess::None, nullptr, false);
             mpCurveVertexBuffers[i]->setName("AnimatedVertexCache::mpCurveVertexBuffers[" + std::to_string(i) + "]");
@@ -244,40 +398,15 @@ namespace Falcor
         mpPrevCurveVertexBuffer = Buffer::createStructured(mpDevice.get(), sizeof(DynamicCurveVertexData), mCurveVertexCount, vbBindFlags, Buffer::CpuAccess::None, nullptr, false);
         mpPrevCurveVertexBuffer->setName("AnimatedVertexCache::mpPrevCurveVertexBuffer");
 
-        // Initialize vertex buffers with cached positions.
+        // Initialize it with positions at the first keyframe.
         uint32_t offset = 0;
-        for (size_t i = 0; i < mCachedCurves.size(); i++)
+        for (uint32_t i = 0; i < mCachedCurves.size(); i++)
         {
             if (mCachedCurves[i].tessellationMode != CurveTessellationMode::LinearSweptSphere) continue;
 
-            size_t vertexCount = mCachedCurves[i].vertexData[0].size();
-            uint32_t bufSize = uint32_t(vertexCount * sizeof(DynamicCurveVertexData));
-            uint32_t k = 0;
-            const auto& timeSamples = mCachedCurves[i].timeSamples;
-
-            for (uint32_t j = 0; j < mCurveKeyframeTimes.size(); j++)
-            {
-                while (k + 1 < timeSamples.size() && timeSamples[k] < mCurveKeyframeTimes[j]) k++;
-
-                if (timeSamples[k] == mCurveKeyframeTimes[j])
-                {
-                    mpCurveVertexBuffers[j]->setBlob(mCachedCurves[i].vertexData[k].data(), offset, bufSize);
-                }
-                else
-                {
-                    // Linearly interpolate at the missing keyframe.
-                    float t = float((mCurveKeyframeTimes[j] - timeSamples[k - 1]) / (timeSamples[k] - timeSamples[k - 1]));
-                    std::vector<DynamicCurveVertexData> interpVertices(vertexCount);
-                    for (size_t p = 0; p < vertexCount; p++)
-                    {
-                        interpVertices[p].position = lerp(mCachedCurves[i].vertexData[k - 1][p].position, mCachedCurves[i].vertexData[k][p].position, t);
-                    }
-                    mpCurveVertexBuffers[j]->setBlob(interpVertices.data(), offset, bufSize);
-                }
-            }
-
-            // Initialize it with positions at the first keyframe.
-            mpPrevCurveVertexBuffer->setBlob(mCachedCurves[i].vertexData[0].data(), offset, bufSize);
+            uint32_t bufSize = uint32_t(mCurveVertexCounts[i] * sizeof(DynamicCurveVertexData));
+            auto vertexData = mpKeyframeStore->decodeKeyframe<DynamicCurveVertexData>(mCurveStreams[i], 0);
+            mpPrevCurveVertexBuffer->setBlob(vertexData.data(), offset, bufSize);
 
             offset += bufSize;
         }
@@ -322,7 +451,7 @@ namespace Falcor
             PerCurveMetadata curveMeta;
             curveMeta.indexCount = (uint32_t)cache.indexData.size();
             curveMeta.indexOffset = mCurvePolyTubeIndexCount;
-            curveMeta.vertexCount = (uint32_t)cache.vertexData[0].size();
+            curveMeta.vertexCount = mCurveVertexCounts[i];
             curveMeta.vertexOffset = mCurvePolyTubeVertexCount;
             curveMetadata.push_back(curveMeta);
 
@@ -344,57 +473,23 @@ namespace Falcor
         mpCurvePolyTubeMeshMetadataBuffer = Buffer::createStructured(mpDevice.get(), sizeof(PerMeshMetadata), (uint32_t)meshMetadata.size(), ResourceBindFlags::ShaderResource, Buffer::CpuAccess::None, meshMetadata.data(), false);
         mpCurvePolyTubeMeshMetadataBuffer->setName("AnimatedVertexCache::mpCurvePolyTubeMeshMetadataBuffer");
 
-        // Create buffers for vertex positions in curve vertex caches.
+        // Create buffers for vertex positions in curve vertex caches at the resident keyframes.
+        // These are filled in updateResidentCurveKeyframes().
         ResourceBindFlags vbBindFlags = ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess;
-        mpCurvePolyTubeVertexBuffers.resize(mCurveKeyframeTimes.size());
-        for (uint32_t i = 0; i < mCurveKeyframeTimes.size(); i++)
+        mpCurvePolyTubeVertexBuffers.resize(mResidentCurveKeyframes.size());
+        for (uint32_t i = 0; i < mpCurvePolyTubeVertexBuffers.size(); i++)
         {
             mpCurvePolyTubeVertexBuffers[i] = Buffer::createStructured(mpDevice.get(), sizeof(DynamicCurveVertexData), mCurvePolyTubeVertexCount, vbBindFlags, Buffer::CpuAccess::None, nullptr, false);
             mpCurvePolyTubeVertexBuffers[i]->setName("AnimatedVertexCache::mpCurvePolyTubeVertexBuffers[" + std::to_string(i) + "]");
         }
 
-        // Initialize vertex buffers with cached positions.
-        uint32_t offset = 0;
-        for (size_t i = 0; i < mCachedCurves.size(); i++)
-        {
-            if (mCachedCurves[i].tessellationMode != CurveTessellationMode::PolyTube) continue;
-
-            size_t vertexCount = mCachedCurves[i].vertexData[0].size();
-            uint32_t bufSize = uint32_t(vertexCount * sizeof(DynamicCurveVertexData));
-            uint32_t k = 0;
-            const auto& timeSamples = mCachedCurves[i].timeSamples;
-
-            for (uint32_t j = 0; j < mCurveKeyframeTimes.size(); j++)
-            {
-                while (k + 1 < timeSamples.size() && timeSamples[k] < mCurveKeyframeTimes[j]) k++;
-
-                if (timeSamples[k] == mCurveKeyframeTimes[j])
-                {
-                    mpCurvePolyTubeVertexBuffers[j]->setBlob(mCachedCurves[i].vertexData[k].data(), offset, bufSize);
-                }
-                else
-                {
-                    // Linearly interpolate at the missing keyframe.
-                    float t = float((mCurveKeyframeTimes[j] - timeSamples[k - 1]) / (timeSamples[k] - timeSamples[k - 1]));
-                    std::vector<DynamicCurveVertexData> interpVertices(vertexCount);
-                    for (size_t p = 0; p < vertexCount; p++)
-                    {
-                        interpVertices[p].position = lerp(mCachedCurves[i].vertexData[k - 1][p].position, mCachedCurves[i].vertexData[k][p].position, t);
-                    }
-                    mpCurvePolyTubeVertexBuffers[j]->setBlob(interpVertices.data(), offset, bufSize);
-                }
-            }
-
-            offset += bufSize;
-        }
-
         // Create curve strand index buffer.
         vbBindFlags = ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess;
         mpCurvePolyTubeStrandIndexBuffer = Buffer::create(mpDevice.get(), sizeof(uint32_t) * mCurvePolyTubeVertexCount, vbBindFlags);
         mpCurvePolyTubeStrandIndexBuffer->setName("AnimatedVertexCache::mpCurvePolyTubeStrandIndexBuffer");
 
         // Initialize strand index buffer.
-        offset = 0;
+        uint32_t offset = 0;
         const uint32_t strandLastVertexIndex = 0xffffffff;
         std::vector<uint32_t> strandIndexData(mCurvePolyTubeVertexCount);
         for (uint32_t i = 0; i < (uint32_t)mCachedCurves.size(); i++)
@@ -432,42 +527,46 @@ namespace Falcor
 
     void AnimatedVertexCache::initMeshKeyframes()
     {
-        for (const auto& cache : mCachedMeshes)
+        uint32_t maxKeyframeCount = 0;
+        mMeshVertexOffsets.resize(mCachedMeshes.size());
+        for (size_t i = 0; i < mCachedMeshes.size(); i++)
         {
+            const auto& cache = mCachedMeshes[i];
             mGlobalMeshAnimationLength = std::max(mGlobalMeshAnimationLength, cache.timeSamples.back());
-            mMeshKeyframeCount += (uint32_t)cache.timeSamples.size();
-            mMaxMeshVertexCount = std::max((uint32_t)cache.vertexData.front().size(), mMaxMeshVertexCount);
+            maxKeyframeCount = std::max((uint32_t)cache.timeSamples.size(), maxKeyframeCount);
+            mMaxMeshVertexCount = std::max(mMeshVertexCounts[i], mMaxMeshVertexCount);
+            mMeshVertexOffsets[i] = mMeshVertexCount;
+            mMeshVertexCount += mMeshVertexCounts[i];
         }
+
+        mResidentMeshKeyframes.assign(mCachedMeshes.size(), std::vector<uint32_t>(std::min(kResidentKeyframeCount, maxKeyframeCount), kInvalidKeyframe));
     }
 
     void AnimatedVertexCache::initMeshBuffers()
     {
-        mpMeshVertexBuffers.resize(mMeshKeyframeCount);
         std::vector<PerMeshMetadata> meshMetadata;
         meshMetadata.reserve(mCachedMeshes.size());
 
-        uint32_t keyframeOffset = 0;
-        for (auto& cache : mCachedMeshes)
+        for (size_t i = 0; i < mCachedMeshes.size(); i++)
         {
-            FALCOR_ASSERT(cache.vertexData.front().size() == mpScene->getMesh(cache.meshID).vertexCount);
+            const auto& cache = mCachedMeshes[i];
+            FALCOR_ASSERT(mMeshVertexCounts[i] == mpScene->getMesh(cache.meshID).vertexCount);
 
             PerMeshMetadata meta;
-            meta.keyframeBufferOffset = keyframeOffset;
-            meta.vertexCount = (uint32_t)cache.vertexData.front().size();
+            meta.keyframeVertexOffset = mMeshVertexOffsets[i];
+            meta.vertexCount = mMeshVertexCounts[i];
             meta.sceneVbOffset = mpScene->getMesh(cache.meshID).vbOffset;
             meta.prevVbOffset = mpScene->getMesh(cache.meshID).prevVbOffset;
             meshMetadata.push_back(meta);
+        }
 
-            // Create vertex buffer for each keyframe on this mesh
-            for (size_t i = 0; i < cache.vertexData.size(); i++)
-            {
-                auto& data = cache.vertexData[i];
-                size_t index = keyframeOffset + i;
-                mpMeshVertexBuffers[index] = Buffer::createStructured(mpDevice.get(), sizeof(PackedStaticVertexData), (uint32_t)data.size(), ResourceBindFlags::ShaderResource, Buffer::CpuAccess::None, data.data(), false);
-                mpMeshVertexBuffers[index]->setName("AnimatedVertexCache::mpMeshVertexBuffers[" + std::to_string(index) + "]");
-            }
-
-            keyframeOffset += (uint32_t)cache.timeSamples.size();
+        // Create vertex buffers for the resident keyframes. Each buffer holds one keyframe of each mesh.
+        // These are filled in updateResidentMeshKeyframes().
+        mpMeshVertexBuffers.resize(mResidentMeshKeyframes[0].size());
+        for (size_t i = 0; i < mpMeshVertexBuffers.size(); i++)
+        {
+            mpMeshVertexBuffers[i] = Buffer::createStructured(mpDevice.get(), sizeof(PackedStaticVertexData), mMeshVertexCount, ResourceBindFlags::ShaderResource, Buffer::CpuAccess::None, nullptr, false);
+            mpMeshVertexBuffers[i]->setName("AnimatedVertexCache::mpMeshVertexBuffers[" + std::to_string(i) + "]");
         }
 
         mpMeshMetadataBuffer = Buffer::createStructured(mpDevice.get(), sizeof(PerMeshMetadata), (uint32_t)meshMetadata.size(), ResourceBindFlags::ShaderResource, Buffer::CpuAccess::None, meshMetadata.data(), false);
@@ -478,12 +577,56 @@ namespace Falcor
         mpMeshInterpolationBuffer->setName("AnimatedVertexCache::mpMeshInterpolationbuffer");
     }
 
+    void AnimatedVertexCache::updateResidentMeshKeyframes()
+    {
+        struct Load
+        {
+            uint32_t meshIndex;
+            uint32_t bufferIndex;
+        };
+
+        // Make the keyframes bracketing the current time resident and prefetch the following keyframes.
+        // The interpolation info is changed to reference the resident keyframe buffers.
+        std::vector<Load> loads;
+        std::vector<uint32_t> bufferIndices;
+        for (uint32_t i = 0; i < (uint32_t)mCachedMeshes.size(); i++)
+        {
+            auto& info = mMeshInterpolationInfo[i];
+            auto& resident = mResidentMeshKeyframes[i];
+            const uint32_t keyframeCount = (uint32_t)mCachedMeshes[i].timeSamples.size();
+            auto wanted = getWantedKeyframes(info, keyframeCount, std::min((uint32_t)resident.size(), keyframeCount), mLoopAnimations);
+
+            bufferIndices.clear();
+            assignResidentKeyframes(wanted, resident, bufferIndices);
+            for (uint32_t bufferIndex : bufferIndices) loads.push_back({ i, bufferIndex });
+
+            info.keyframeIndices = uint2(findResidentKeyframe(resident, info.keyframeIndices.x), findResidentKeyframe(resident, info.keyframeIndices.y));
+        }
+
+        // Decode the missing keyframes in parallel and upload them.
+        std::vector<std::vector<PackedStaticVertexData>> vertexData(loads.size());
+        Threading::parallelFor(0, loads.size(), 1, [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++)
+            {
+                const auto& load = loads[i];
+                vertexData[i] = mpKeyframeStore->decodeKeyframe<PackedStaticVertexData>(mMeshStreams[load.meshIndex], mResidentMeshKeyframes[load.meshIndex][load.bufferIndex]);
+            }
+        });
+
+        for (size_t i = 0; i < loads.size(); i++)
+        {
+            const auto& load = loads[i];
+            mpMeshVertexBuffers[load.bufferIndex]->setBlob(vertexData[i].data(), mMeshVertexOffsets[load.meshIndex] * sizeof(PackedStaticVertexData), vertexData[i].size() * sizeof(PackedStaticVertexData));
+        }
+    }
+
     void AnimatedVertexCache::createMeshVertexUpdatePass()
     {
         FALCOR_ASSERT(!mCachedMeshes.empty());
 
         Program::DefineList defines;
-        defines.add("MESH_KEYFRAME_COUNT", std::to_string(mMeshKeyframeCount));
+        defines.add("MESH_KEYFRAME_COUNT", std::to_string(mpMeshVertexBuffers.size()));
         mpMeshVertexUpdatePass = ComputePass::create(mpDevice, "Scene/Animation/UpdateMeshVertices.slang", "main", defines);
 
         // Bind data
@@ -501,14 +644,14 @@ namespace Falcor
         FALCOR_ASSERT(mCurveLSSCount > 0);
 
         Program::DefineList defines;
-        defines.add("CURVE_KEYFRAME_COUNT", std::to_string(mCurveKeyframeTimes.size()));
+        defines.add("CURVE_KEYFRAME_COUNT", std::to_string(mResidentCurveKeyframes.size()));
         mpCurveVertexUpdatePass = ComputePass::create(mpDevice, kUpdateCurveVerticesFilename, "main", defines);
 
         auto block = mpCurveVertexUpdatePass->getVars()["gCurveVertexUpdater"];
         auto var = block["curvePerKeyframe"];
 
         // Bind curve vertex data.
-        for (uint32_t i = 0; i < mCurveKeyframeTimes.size(); i++) var[i]["vertexData"] = mpCurveVertexBuffers[i];
+        for (uint32_t i = 0; i < mpCurveVertexBuffers.size(); i++) var[i]["vertexData"] = mpCurveVertexBuffers[i];
     }
 
     void AnimatedVertexCache::createCurveLSSAABBUpdatePass()
@@ -526,7 +669,7 @@ namespace Falcor
         FALCOR_ASSERT(mCurvePolyTubeCount > 0);
 
         Program::DefineList defines;
-        defines.add("CURVE_KEYFRAME_COUNT", std::to_string(mCurveKeyframeTimes.size()));
+        defines.add("CURVE_KEYFRAME_COUNT", std::to_string(mResidentCurveKeyframes.size()));
         mpCurvePolyTubeVertexUpdatePass = ComputePass::create(mpDevice, kUpdateCurvePolyTubeVerticesFilename, "main", defines);
 
         auto block = mpCurvePolyTubeVertexUpdatePass->getVars()["gCurvePolyTubeVertexUpdater"];
@@ -536,7 +679,7 @@ namespace Falcor
         auto var = block["curvePerKeyframe"];
 
         // Bind curve vertex data.
-        for (uint32_t i = 0; i < mCurveKeyframeTimes.size(); i++) var[i]["vertexData"] = mpCurvePolyTubeVertexBuffers[i];
+        for (uint32_t i = 0; i < mpCurvePolyTubeVertexBuffers.size(); i++) var[i]["vertexData"] = mpCurvePolyTubeVertexBuffers[i];
     }
 
 
@@ -546,14 +689,18 @@ namespace Falcor
 
         FALCOR_PROFILE(pRenderContext, "update mesh vertices");
 
-        // Update interpolation
-        for (size_t i = 0; i < mMeshInterpolationInfo.size(); i++)
+        // Update interpolation. The interpolation info is not used when copying the previous vertices.
+        if (!copyPrev)
         {
-            auto postInfinityBehavior = mLoopAnimations ? Animation::Behavior::Cycle : Animation::Behavior::Constant;
-            mMeshInterpolationInfo[i] = calculateInterpolation(t, mCachedMeshes[i].timeSamples, mPreInfinityBehavior, postInfinityBehavior);
-        }
+            for (size_t i = 0; i < mMeshInterpolationInfo.size(); i++)
+            {
+                auto postInfinityBehavior = mLoopAnimations ? Animation::Behavior::Cycle : Animation::Behavior::Constant;
+                mMeshInterpolationInfo[i] = calculateInterpolation(t, mCachedMeshes[i].timeSamples, mPreInfinityBehavior, postInfinityBehavior);
+            }
+            updateResidentMeshKeyframes();
 
-        mpMeshInterpolationBuffer->setBlob(mMeshInterpolationInfo.data(), 0, mpMeshInterpolationBuffer->getSize());
+            mpMeshInterpolationBuffer->setBlob(mMeshInterpolationInfo.data(), 0, mpMeshInterpolationBuffer->getSize());
+        }
 
         auto block = mpMeshVertexUpdatePass->getVars()["gMeshVertexUpdater"];
         block["sceneVertexData"] = mpScene->getMeshVao()->getVertexBuffer(Scene::kStaticDataBufferIndex);
@@ -27,6 +27,7 @@
  **************************************************************************/
 #pragma once
 #include "Animation.h"
+#include "KeyframeStore.h"
 #include "SharedTypes.slang"
 #include "Core/API/Buffer.h"
 #include "Scene/Curves/CurveConfig.h"
@@ -71,9 +72,20 @@ namespace Falcor
         std::vector<std::vector<PackedStaticVertexData>> vertexData;
     };
 
+    /** Animates meshes and curves from vertex caches.
+
+        The keyframes are moved into a compressed KeyframeStore when the cache is created. Only a few keyframes per
+        mesh and curve set are resident on the GPU: the two keyframes bracketing the current time, and the keyframes
+        following them, which are prefetched so that advancing to the next keyframe usually needs no upload.
+        Missing keyframes are decoded in parallel and uploaded during animate().
+    */
     class FALCOR_API AnimatedVertexCache
     {
     public:
+        /** Number of keyframes resident on the GPU.
+        */
+        static constexpr uint32_t kResidentKeyframeCount = 4;
+
         using UniquePtr = std::unique_ptr<AnimatedVertexCache>;
         using UniqueConstPtr = std::unique_ptr<const AnimatedVertexCache>;
         ~AnimatedVertexCache() = default;
@@ -105,6 +117,10 @@ namespace Falcor
     private:
         AnimatedVertexCache(std::shared_ptr<Device> pDevice, Scene* pScene, const Buffer::SharedPtr& pPrevVertexData, std::vector<CachedCurve>&& cachedCurves, std::vector<CachedMesh>&& cachedMeshes);
 
+        /** Move the vertex data of all caches into the keyframe store.
+        */
+        void initKeyframeStore();
+
         void initCurveKeyframes();
         void bindCurveLSSBuffers();
         void bindCurvePolyTubeBuffers();
@@ -118,6 +134,18 @@ namespace Falcor
 
         void createMeshVertexUpdatePass();
 
+        /** Make the keyframes needed at the given interpolation resident and prefetch the following keyframes.
+            \param[in] info Interpolation info referencing keyframes.
+            \return Interpolation info referencing the resident keyframe buffers.
+        */
+        InterpolationInfo updateResidentCurveKeyframes(const InterpolationInfo& info);
+
+        /** Get the vertex data of a cached curve at a keyframe of the merged curve keyframe times.
+        */
+        std::vector<DynamicCurveVertexData> getCurveKeyframe(uint32_t curveIndex, uint32_t keyframe) const;
+
+        void updateResidentMeshKeyframes();
+
         void executeMeshVertexUpdatePass(RenderContext* pContext, double t, bool copyPrev = false);
 
         // Interpolate vertex positions.
@@ -139,10 +167,15 @@ namespace Falcor
         Buffer::SharedPtr mpPrevVertexData; ///< Owned by AnimationController
         Animation::Behavior mPreInfinityBehavior = Animation::Behavior::Constant; // How the animation behaves before the first keyframe.
 
-        std::vector<CachedCurve> mCachedCurves;
+        std::unique_ptr<KeyframeStore> mpKeyframeStore;
+
+        std::vector<CachedCurve> mCachedCurves;     ///< Cached curves. The vertex data is moved to the keyframe store.
+        std::vector<KeyframeStore::StreamID> mCurveStreams;
+        std::vector<uint32_t> mCurveVertexCounts;
         uint32_t mCurveLSSCount = 0;
         uint32_t mCurvePolyTubeCount = 0;
         std::vector<double> mCurveKeyframeTimes;
+        std::vector<uint32_t> mResidentCurveKeyframes; ///< Keyframe held by each resident curve keyframe buffer.
 
         // Cached curve (LSS) animation.
         ComputePass::SharedPtr mpCurveVertexUpdatePass;
@@ -172,9 +205,13 @@ namespace Falcor
         // Cached mesh animations
         ComputePass::SharedPtr mpMeshVertexUpdatePass;
 
-        std::vector<CachedMesh> mCachedMeshes;
+        std::vector<CachedMesh> mCachedMeshes;      ///< Cached meshes. The vertex data is moved to the keyframe store.
+        std::vector<KeyframeStore::StreamID> mMeshStreams;
+        std::vector<uint32_t> mMeshVertexCounts;
+        std::vector<uint32_t> mMeshVertexOffsets;   ///< Offset of the vertices of each mesh in the resident keyframe buffers.
         std::vector<InterpolationInfo> mMeshInterpolationInfo;
-        uint32_t mMeshKeyframeCount = 0; ///< Total count of all keyframes for all meshes
+        std::vector<std::vector<uint32_t>> mResidentMeshKeyframes; ///< Keyframe of each mesh held by each resident keyframe buffer.
+        uint32_t mMeshVertexCount = 0; ///< Total count of all vertices for all meshes
         uint32_t mMaxMeshVertexCount = 0; ///< Greatest vertex count a mesh has
 
         std::vector<Buffer::SharedPtr> mpMeshVertexBuffers;
@@ -32,6 +32,7 @@
 #include "Scene/Transform.h"
 #include <glm/gtc/quaternion.hpp>
 #include <glm/gtx/transform.hpp>
+#include <algorithm>
 
 namespace Falcor
 {
@@ -117,40 +118,53 @@ namespace Falcor
         , mDuration(duration)
     {}
 
-    rmcv::mat4 Animation::animate(double currentTime)
+    rmcv::mat4 Animation::animate(double currentTime) const
+    {
+        return animate(currentTime, mCachedFrameIndex);
+    }
+
+    void Animation::evaluate(const std::vector<double>& times, std::vector<rmcv::mat4>& transforms) const
+    {
+        transforms.resize(times.size());
+        size_t frameIndexHint = 0;
+        for (size_t i = 0; i < times.size(); i++) transforms[i] = animate(times[i], frameIndexHint);
+    }
+
+    rmcv::mat4 Animation::animate(double currentTime, size_t& frameIndexHint) const
     {
         // Calculate the sample time.
+        FALCOR_ASSERT(!mTimes.empty());
         double time = currentTime;
-        if (time < mKeyframes.front().time || time > mKeyframes.back().time)
+        if (time < mTimes.front() || time > mTimes.back())
         {
             time = calcSampleTime(currentTime);
         }
 
         // Determine if the animation behaves linearly outside of defined keyframes.
-        bool isLinearPostInfinity = time > mKeyframes.back().time && this->getPostInfinityBehavior() == Behavior::Linear;
-        bool isLinearPreInfinity = time < mKeyframes.front().time && this->getPreInfinityBehavior() == Behavior::Linear;
+        bool isLinearPostInfinity = time > mTimes.back() && this->getPostInfinityBehavior() == Behavior::Linear;
+        bool isLinearPreInfinity = time < mTimes.front() && this->getPreInfinityBehavior() == Behavior::Linear;
 
         Keyframe interpolated;
 
-        if (isLinearPreInfinity && mKeyframes.size() > 1)
+        if (isLinearPreInfinity && mTimes.size() > 1)
         {
-            const auto& k0 = mKeyframes.front();
-            auto k1 = interpolate(mInterpolationMode, k0.time + kEpsilonTime);
+            auto k0 = getKeyframeAt(0);
+            auto k1 = interpolate(mInterpolationMode, k0.time + kEpsilonTime, frameIndexHint);
             double segmentDuration = k1.time - k0.time;
             float t = (float)((time - k0.time) / segmentDuration);
             interpolated = interpolateLinear(k0, k1, t);
         }
-        else if (isLinearPostInfinity && mKeyframes.size() > 1)
+        else if (isLinearPostInfinity && mTimes.size() > 1)
         {
-            const auto& k1 = mKeyframes.back();
-            auto k0 = interpolate(mInterpolationMode, k1.time - kEpsilonTime);
+            auto k1 = getKeyframeAt(mTimes.size() - 1);
+            auto k0 = interpolate(mInterpolationMode, k1.time - kEpsilonTime, frameIndexHint);
             double segmentDuration = k1.time - k0.time;
             float t = (float)((time - k0.time) / segmentDuration);
             interpolated = interpolateLinear(k0, k1, t);
         }
         else
         {
-            interpolated = interpolate(mInterpolationMode, time);
+            interpolated = interpolate(mInterpolationMode, time, frameIndexHint);
         }
 
         rmcv::mat4 T = rmcv::translate(interpolated.translation);
@@ -161,38 +175,45 @@ namespace Falcor
         return transform;
     }
 
-    Animation::Keyframe Animation::interpolate(InterpolationMode mode, double time) const
+    size_t Animation::findFrameIndex(double time, size_t hint) const
     {
-        FALCOR_ASSERT(!mKeyframes.empty());
+        FALCOR_ASSERT(!mTimes.empty());
+        const size_t count = mTimes.size();
 
-        // Validate cached frame index.
-        size_t frameIndex = clamp(mCachedFrameIndex, (size_t)0, mKeyframes.size() - 1);
-        if (time < mKeyframes[frameIndex].time) frameIndex = 0;
-
-        // Find frame index.
-        while (frameIndex < mKeyframes.size() - 1)
+        // Check the hinted frame and the one after it first, which covers monotonic playback.
+        if (hint < count && mTimes[hint] <= time)
         {
-            if (mKeyframes[frameIndex + 1].time > time) break;
-            frameIndex++;
+            if (hint + 1 == count || time < mTimes[hint + 1]) return hint;
+            if (hint + 2 == count || time < mTimes[hint + 2]) return hint + 1;
         }
 
-        // Cache frame index;
-        mCachedFrameIndex = frameIndex;
+        // Find the last keyframe at or before the specified time.
+        auto it = std::upper_bound(mTimes.begin(), mTimes.end(), time);
+        return it == mTimes.begin() ? 0 : (size_t)(it - mTimes.begin()) - 1;
+    }
+
+    Animation::Keyframe Animation::interpolate(InterpolationMode mode, double time, size_t& frameIndexHint) const
+    {
+        FALCOR_ASSERT(!mTimes.empty());
+
+        // Find frame index and use it as hint for the next lookup.
+        size_t frameIndex = findFrameIndex(time, frameIndexHint);
+        frameIndexHint = frameIndex;
 
         // Compute index of adjacent frame including optional warping.
         auto adjacentFrame = [this] (size_t frame, int32_t offset = 1)
         {
-            size_t count = mKeyframes.size();
+            size_t count = mTimes.size();
             return mEnableWarping ? (frame + count + offset) % count : clamp(frame + offset, (size_t)0, count - 1);
         };
 
-        if (mode == InterpolationMode::Linear || mKeyframes.size() < 4)
+        if (mode == InterpolationMode::Linear || mTimes.size() < 4)
         {
             size_t i0 = frameIndex;
             size_t i1 = adjacentFrame(i0);
 
-            const Keyframe& k0 = mKeyframes[i0];
-            const Keyframe& k1 = mKeyframes[i1];
+            const Keyframe k0 = getKeyframeAt(i0);
+            const Keyframe k1 = getKeyframeAt(i1);
 
             double segmentDuration = k1.time - k0.time;
             if (mEnableWarping && segmentDuration < 0.0) segmentDuration += mDuration;
@@ -207,10 +228,10 @@ namespace Falcor
             size_t i2 = adjacentFrame(i1, 1);
             size_t i3 = adjacentFrame(i1, 2);
 
-            const Keyframe& k0 = mKeyframes[i0];
-            const Keyframe& k1 = mKeyframes[i1];
-            const Keyframe& k2 = mKeyframes[i2];
-            const Keyframe& k3 = mKeyframes[i3];
+            const Keyframe k0 = getKeyframeAt(i0);
+            const Keyframe k1 = getKeyframeAt(i1);
+            const Keyframe k2 = getKeyframeAt(i2);
+            const Keyframe k3 = getKeyframeAt(i3);
 
             double segmentDuration = k2.time - k1.time;
             if (mEnableWarping && segmentDuration < 0.0) segmentDuration += mDuration;
@@ -228,11 +249,11 @@ namespace Falcor
     // the animation does not behave linearly. If the animation behaves linearly, then the
     // current time is returned. This function should not be used if the current time lies
     // within the range of defined keyframe times.
-    double Animation::calcSampleTime(double currentTime)
+    double Animation::calcSampleTime(double currentTime) const
     {
         double modifiedTime = currentTime;
-        double firstKeyframeTime = mKeyframes.front().time;
-        double lastKeyframeTime = mKeyframes.back().time;
+        double firstKeyframeTime = mTimes.front();
+        double lastKeyframeTime = mTimes.back();
         double duration = lastKeyframeTime - firstKeyframeTime;
 
         FALCOR_ASSERT(currentTime < firstKeyframeTime || currentTime > lastKeyframeTime);
@@ -263,59 +284,68 @@ namespace Falcor
     {
         FALCOR_ASSERT(keyframe.time <= mDuration);
 
-        if (mKeyframes.size() == 0 || mKeyframes[0].time > keyframe.time)
-        {
-            mKeyframes.insert(mKeyframes.begin(), keyframe);
-        }
-        else if (mKeyframes.back().time < keyframe.time)
+        // Find the insertion point. Keyframes are usually added in order, so this is typically the end.
+        auto it = std::lower_bound(mTimes.begin(), mTimes.end(), keyframe.time);
+        size_t index = it - mTimes.begin();
+
+        // If we already have a key-frame at the same time, replace it
+        if (it != mTimes.end() && *it == keyframe.time)
         {
-            mKeyframes.push_back(keyframe);
+            mTranslations[index] = keyframe.translation;
+            mScalings[index] = keyframe.scaling;
+            mRotations[index] = keyframe.rotation;
+            return;
         }
-        else
+
+        mTimes.insert(it, keyframe.time);
+        mTranslations.insert(mTranslations.begin() + index, keyframe.translation);
+        mScalings.insert(mScalings.begin() + index, keyframe.scaling);
+        mRotations.insert(mRotations.begin() + index, keyframe.rotation);
+    }
+
+    void Animation::setKeyframes(std::vector<Keyframe> keyframes)
+    {
+        std::stable_sort(keyframes.begin(), keyframes.end(), [](const Keyframe& a, const Keyframe& b) { return a.time < b.time; });
+        FALCOR_ASSERT(keyframes.empty() || keyframes.back().time <= mDuration);
+
+        mTimes.clear();
+        mTranslations.clear();
+        mScalings.clear();
+        mRotations.clear();
+        mTimes.reserve(keyframes.size());
+        mTranslations.reserve(keyframes.size());
+        mScalings.reserve(keyframes.size());
+        mRotations.reserve(keyframes.size());
+        mCachedFrameIndex = 0;
+
+        for (const auto& keyframe : keyframes)
         {
-            for (size_t i = 0; i < mKeyframes.size(); i++)
+            // Keyframes at the same time replace the previous one, matching addKeyframe().
+            if (!mTimes.empty() && mTimes.back() == keyframe.time)
             {
-                auto& current = mKeyframes[i];
-                // If we already have a key-frame at the same time, replace it
-                if (current.time == keyframe.time)
-                {
-                    current = keyframe;
-                    return;
-                }
-
-                // If this is not the last frame, Check if we are in between frames
-                if (i < mKeyframes.size() - 1)
-                {
-                    auto& Next = mKeyframes[i + 1];
-                    if (current.time < keyframe.time && Next.time > keyframe.time)
-                    {
-                        mKeyframes.insert(mKeyframes.begin() + i + 1, keyframe);
-                        return;
-                    }
-                }
+                mTranslations.back() = keyframe.translation;
+                mScalings.back() = keyframe.scaling;
+                mRotations.back() = keyframe.rotation;
+                continue;
             }
 
-            // If we got here, need to push it to the end of the list
-            mKeyframes.push_back(keyframe);
+            mTimes.push_back(keyframe.time);
+            mTranslations.push_back(keyframe.translation);
+            mScalings.push_back(keyframe.scaling);
+            mRotations.push_back(keyframe.rotation);
         }
     }
 
-    const Animation::Keyframe& Animation::getKeyframe(double time) const
+    Animation::Keyframe Animation::getKeyframe(double time) const
     {
-        for (const auto& k : mKeyframes)
-        {
-            if (k.time == time) return k;
-        }
-        throw ArgumentError("'time' ({}) does not refer to an existing keyframe", time);
+        auto it = std::lower_bound(mTimes.begin(), mTimes.end(), time);
+        if (it == mTimes.end() || *it != time) throw ArgumentError("'time' ({}) does not refer to an existing keyframe", time);
+        return getKeyframeAt(it - mTimes.begin());
     }
 
     bool Animation::doesKeyframeExists(double time) const
     {
-        for (const auto& k : mKeyframes)
-        {
-            if (k.time == time) return true;
-        }
-        return false;
+        return std::binary_search(mTimes.begin(), mTimes.end(), time);
     }
 
     void Animation::renderUI(Gui::Widgets& widget)
@@ -128,12 +128,19 @@ namespace Falcor
         */
         void addKeyframe(const Keyframe& keyframe);
 
+        /** Replace all keyframes.
+            The keyframes don't need to be sorted. If there are multiple keyframes at the same time, the last one is used.
+            This is faster than adding the keyframes one at a time with addKeyframe().
+            \param[in] keyframes Keyframes.
+        */
+        void setKeyframes(std::vector<Keyframe> keyframes);
+
         /** Get the keyframe at the specified time.
             If the keyframe doesn't exists, the function will throw an exception. If you don't want to handle exceptions, call doesKeyframeExist() first.
             \param[in] time Time of the keyframe.
             \return Returns the keyframe.
         */
-        const Keyframe& getKeyframe(double time) const;
+        Keyframe getKeyframe(double time) const;
 
         /** Check if a keyframe exists at the specified time.
             \param[in] time Time of the keyframe.
@@ -141,11 +148,26 @@ namespace Falcor
         */
         bool doesKeyframeExists(double time) const;
 
+        /** Get the number of keyframes.
+        */
+        size_t getKeyframeCount() const { return mTimes.size(); }
+
+        /** Get the sorted list of keyframe times.
+        */
+        const std::vector<double>& getKeyframeTimes() const { return mTimes; }
+
         /** Compute the animation.
             \param time The current time in seconds. This can be larger then the animation time, in which case the animation will loop.
             \return Returns the animation's transform matrix for the specified time.
         */
-        rmcv::mat4 animate(double currentTime);
+        rmcv::mat4 animate(double currentTime) const;
+
+        /** Compute the animation at multiple times.
+            Evaluation is fastest if the times are sorted. This function doesn't modify the animation and is safe to call from multiple threads.
+            \param[in] times Times in seconds.
+            \param[out] transforms Transform matrix for each time.
+        */
+        void evaluate(const std::vector<double>& times, std::vector<rmcv::mat4>& transforms) const;
 
         /* Render the UI.
         */
@@ -154,8 +176,11 @@ namespace Falcor
     private:
         Animation(const std::string& name, NodeID nodeID, double duration);
 
-        Keyframe interpolate(InterpolationMode mode, double time) const;
-        double calcSampleTime(double currentTime);
+        Keyframe getKeyframeAt(size_t index) const { return Keyframe{ mTimes[index], mTranslations[index], mScalings[index], mRotations[index] }; }
+        size_t findFrameIndex(double time, size_t hint) const;
+        rmcv::mat4 animate(double currentTime, size_t& frameIndexHint) const;
+        Keyframe interpolate(InterpolationMode mode, double time, size_t& frameIndexHint) const;
+        double calcSampleTime(double currentTime) const;
 
         std::string mName;
         NodeID mNodeID;
@@ -167,8 +192,12 @@ namespace Falcor
         InterpolationMode mInterpolationMode = InterpolationMode::Linear;
         bool mEnableWarping = false;
 
-        std::vector<Keyframe> mKeyframes;
-        mutable size_t mCachedFrameIndex = 0;
+        // Keyframes are stored as separate arrays sorted by time.
+        std::vector<double> mTimes;
+        std::vector<float3> mTranslations;
+        std::vector<float3> mScalings;
+        std::vector<glm::quat> mRotations;
+        mutable size_t mCachedFrameIndex = 0; // Frame index of the last call to animate(), speeds up lookups for monotonic playback.
 
         friend class SceneCache;
     };
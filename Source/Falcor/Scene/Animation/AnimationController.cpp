@@ -27,6 +27,7 @@
  **************************************************************************/
 #include "AnimationController.h"
 #include "Core/API/RenderContext.h"
+#include "Utils/Threading.h"
 #include "Utils/Timing/Profiler.h"
 #include "Scene/Scene.h"
 #include <fstream>
@@ -39,6 +40,9 @@ namespace Falcor
         const std::string kInverseTransposeWorldMatrices = "inverseTransposeWorldMatrices";
         const std::string kPrevWorldMatrices = "prevWorldMatrices";
         const std::string kPrevInverseTransposeWorldMatrices = "prevInverseTransposeWorldMatrices";
+
+        const size_t kAnimationGrainSize = 64;  ///< Number of animations evaluated per task.
+        const size_t kNodeGrainSize = 1024;     ///< Number of scene graph nodes updated per task.
     }
 
     AnimationController::AnimationController(std::shared_ptr<Device> pDevice, Scene* pScene, const StaticVertexVector& staticVertexData, const SkinningVertexVector& skinningVertexData, uint32_t prevVertexCount, const std::vector<Animation::SharedPtr>& animations)
@@ -51,6 +55,8 @@ namespace Falcor
         , mMatricesChanged(pScene->mSceneGraph.size())
         , mpScene(pScene)
     {
+        initHierarchy();
+
         // Create GPU resources.
         FALCOR_ASSERT(mLocalMatrices.size() <= std::numeric_limits<uint32_t>::max());
 
@@ -187,6 +193,45 @@ namespace Falcor
         }
     }
 
+    void AnimationController::initHierarchy()
+    {
+        const auto& sceneGraph = mpScene->mSceneGraph;
+        const uint32_t nodeCount = (uint32_t)sceneGraph.size();
+
+        // Compute the depth of each node and count the children.
+        mNodeLevels.resize(nodeCount);
+        mChildOffsets.assign(nodeCount + 1, 0);
+        uint32_t levelCount = 0;
+        for (uint32_t i = 0; i < nodeCount; i++)
+        {
+            NodeID parent = sceneGraph[i].parent;
+            checkInvariant(parent == NodeID::Invalid() || parent.get() < i, "Scene graph node {} has parent {} that comes after it.", i, parent.get());
+            mNodeLevels[i] = parent == NodeID::Invalid() ? 0 : mNodeLevels[parent.get()] + 1;
+            if (parent != NodeID::Invalid()) mChildOffsets[parent.get() + 1]++;
+            levelCount = std::max(levelCount, mNodeLevels[i] + 1);
+        }
+
+        // Build the child lists.
+        for (uint32_t i = 0; i < nodeCount; i++) mChildOffsets[i + 1] += mChildOffsets[i];
+        mChildNodes.resize(mChildOffsets[nodeCount]);
+        std::vector<uint32_t> childCounts(nodeCount, 0);
+        for (uint32_t i = 0; i < nodeCount; i++)
+        {
+            NodeID parent = sceneGraph[i].parent;
+            if (parent != NodeID::Invalid()) mChildNodes[mChildOffsets[parent.get()] + childCounts[parent.get()]++] = i;
+        }
+
+        // Sort the nodes by level.
+        mLevelOffsets.assign(levelCount + 1, 0);
+        for (uint32_t i = 0; i < nodeCount; i++) mLevelOffsets[mNodeLevels[i] + 1]++;
+        for (uint32_t level = 0; level < levelCount; level++) mLevelOffsets[level + 1] += mLevelOffsets[level];
+        mLevelNodes.resize(nodeCount);
+        std::vector<uint32_t> levelCounts(levelCount, 0);
+        for (uint32_t i = 0; i < nodeCount; i++) mLevelNodes[mLevelOffsets[mNodeLevels[i]] + levelCounts[mNodeLevels[i]]++] = i;
+
+        mChangedLevelNodes.resize(levelCount);
+    }
+
     void AnimationController::initLocalMatrices()
     {
         for (size_t i = 0; i < mLocalMatrices.size(); i++)
@@ -199,21 +244,20 @@ namespace Falcor
     {
         FALCOR_PROFILE(pRenderContext, "animate");
 
-        std::fill(mMatricesChanged.begin(), mMatricesChanged.end(), false);
+        // Reset the change flags of the previous frame.
+        for (uint32_t nodeID : mChangedMatrices) mMatricesChanged[nodeID] = false;
+        mChangedMatrices.clear();
 
-        // Check for edited scene nodes and update local matrices.
+        // Update local matrices of edited scene nodes.
         const auto& sceneGraph = mpScene->mSceneGraph;
-        bool edited = false;
-        for (size_t i = 0; i < sceneGraph.size(); ++i)
+        bool edited = !mEditedNodes.empty();
+        for (uint32_t nodeID : mEditedNodes)
         {
-            if (mNodesEdited[i])
-            {
-                mLocalMatrices[i] = sceneGraph[i].transform;
-                mNodesEdited[i] = false;
-                mMatricesChanged[i] = true;
-                edited = true;
-            }
+            mLocalMatrices[nodeID] = sceneGraph[nodeID].transform;
+            mNodesEdited[nodeID] = false;
+            markMatrixChanged(nodeID);
         }
+        mEditedNodes.clear();
 
         bool changed = false;
         double time = mLoopAnimations ? std::fmod(currentTime, mGlobalAnimationLength) : currentTime;
@@ -291,45 +335,82 @@ namespace Falcor
         return changed;
     }
 
+    void AnimationController::markMatrixChanged(uint32_t nodeID)
+    {
+        if (mMatricesChanged[nodeID]) return;
+        mMatricesChanged[nodeID] = true;
+        mChangedMatrices.push_back(nodeID);
+    }
+
     void AnimationController::updateLocalMatrices(double time)
     {
-        for (auto& pAnimation : mAnimations)
+        // Evaluate the animations in parallel. The results are written in order afterwards, as multiple animations may target the same node.
+        mAnimatedMatrices.resize(mAnimations.size());
+        Threading::parallelFor(0, mAnimations.size(), kAnimationGrainSize, [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++) mAnimatedMatrices[i] = mAnimations[i]->animate(time);
+        });
+
+        for (size_t i = 0; i < mAnimations.size(); i++)
         {
-            NodeID nodeID = pAnimation->getNodeID();
+            NodeID nodeID = mAnimations[i]->getNodeID();
             FALCOR_ASSERT(nodeID.get() < mLocalMatrices.size());
-            mLocalMatrices[nodeID.get()] = pAnimation->animate(time);
-            mMatricesChanged[nodeID.get()] = true;
+            mLocalMatrices[nodeID.get()] = mAnimatedMatrices[i];
+            markMatrixChanged((uint32_t)nodeID.get());
         }
     }
 
     void AnimationController::updateWorldMatrices(bool updateAll)
     {
-        const auto& sceneGraph = mpScene->mSceneGraph;
+        // Propagate the change flags to the subtrees of the changed nodes, collecting the changed nodes of each level.
+        for (auto& nodes : mChangedLevelNodes) nodes.clear();
+        for (uint32_t nodeID : mChangedMatrices) mChangedLevelNodes[mNodeLevels[nodeID]].push_back(nodeID);
 
-        for (size_t i = 0; i < mGlobalMatrices.size(); i++)
+        for (size_t level = 0; level < mChangedLevelNodes.size(); level++)
         {
-            // Propagate matrix change flag to children.
-            if (sceneGraph[i].parent != NodeID::Invalid())
+            for (uint32_t nodeID : mChangedLevelNodes[level])
             {
-                mMatricesChanged[i] = mMatricesChanged[i] || mMatricesChanged[sceneGraph[i].parent.get()];
+                for (uint32_t i = mChildOffsets[nodeID]; i < mChildOffsets[nodeID + 1]; i++)
+                {
+                    uint32_t childID = mChildNodes[i];
+                    if (mMatricesChanged[childID]) continue;
+                    markMatrixChanged(childID);
+                    mChangedLevelNodes[level + 1].push_back(childID);
+                }
             }
+        }
 
-            if (!mMatricesChanged[i] && !updateAll) continue;
-
-            mGlobalMatrices[i] = mLocalMatrices[i];
+        // Update the matrices one level at a time, as each node depends on its parent.
+        // The nodes within a level are independent and updated in parallel.
+        for (size_t level = 0; level < mChangedLevelNodes.size(); level++)
+        {
+            const uint32_t* pNodes = updateAll ? mLevelNodes.data() + mLevelOffsets[level] : mChangedLevelNodes[level].data();
+            size_t nodeCount = updateAll ? mLevelOffsets[level + 1] - mLevelOffsets[level] : mChangedLevelNodes[level].size();
 
-            if (mpScene->mSceneGraph[i].parent != NodeID::Invalid())
+            Threading::parallelFor(0, nodeCount, kNodeGrainSize, [&](size_t begin, size_t end)
             {
-                mGlobalMatrices[i] = mGlobalMatrices[sceneGraph[i].parent.get()] * mGlobalMatrices[i];
-            }
+                for (size_t i = begin; i < end; i++) updateWorldMatrix(pNodes[i]);
+            });
+        }
+    }
+
+    void AnimationController::updateWorldMatrix(uint32_t nodeID)
+    {
+        const auto& node = mpScene->mSceneGraph[nodeID];
 
-            mInvTransposeGlobalMatrices[i] = transpose(inverse(mGlobalMatrices[i]));
+        mGlobalMatrices[nodeID] = mLocalMatrices[nodeID];
 
-            if (mpSkinningPass)
-            {
-                mSkinningMatrices[i] = mGlobalMatrices[i] * sceneGraph[i].localToBindSpace;
-                mInvTransposeSkinningMatrices[i] = transpose(inverse(mSkinningMatrices[i]));
-            }
+        if (node.parent != NodeID::Invalid())
+        {
+            mGlobalMatrices[nodeID] = mGlobalMatrices[node.parent.get()] * mGlobalMatrices[nodeID];
+        }
+
+        mInvTransposeGlobalMatrices[nodeID] = transpose(inverse(mGlobalMatrices[nodeID]));
+
+        if (mpSkinningPass)
+        {
+            mSkinningMatrices[nodeID] = mGlobalMatrices[nodeID] * node.localToBindSpace;
+            mInvTransposeSkinningMatrices[nodeID] = transpose(inverse(mSkinningMatrices[nodeID]));
         }
     }
 
@@ -348,21 +429,17 @@ namespace Falcor
         }
         else
         {
-            // Upload changed matrices only.
-            for (size_t i = 0; i < mGlobalMatrices.size();)
+            // Upload changed matrices only, coalescing consecutive matrices into a single upload.
+            std::sort(mChangedMatrices.begin(), mChangedMatrices.end());
+            for (size_t i = 0; i < mChangedMatrices.size();)
             {
-                // Detect ranges of consecutive matrices that have all changed or not.
-                size_t offset = i;
-                bool changed = mMatricesChanged[i];
-                while (i < mGlobalMatrices.size() && mMatricesChanged[i] == changed) ++i;
+                size_t offset = mChangedMatrices[i];
+                size_t count = 1;
+                while (i + count < mChangedMatrices.size() && mChangedMatrices[i + count] == offset + count) ++count;
+                i += count;
 
-                // Upload range of changed matrices.
-                if (changed)
-                {
-                    size_t count = i - offset;
-                    mpWorldMatricesBuffer->setBlob(&mGlobalMatrices[offset], offset * sizeof(float4x4), count * sizeof(float4x4));
-                    mpInvTransposeWorldMatricesBuffer->setBlob(&mInvTransposeGlobalMatrices[offset], offset * sizeof(float4x4), count * sizeof(float4x4));
-                }
+                mpWorldMatricesBuffer->setBlob(&mGlobalMatrices[offset], offset * sizeof(float4x4), count * sizeof(float4x4));
+                mpInvTransposeWorldMatricesBuffer->setBlob(&mInvTransposeGlobalMatrices[offset], offset * sizeof(float4x4), count * sizeof(float4x4));
             }
         }
     }
@@ -103,7 +103,12 @@ namespace Falcor
         /** Mark a scene node as being edited externally.
             Ensures that all global matrices depending on this scene node are updated.
         */
-        void setNodeEdited(size_t nodeID) { mNodesEdited[nodeID] = true; }
+        void setNodeEdited(size_t nodeID)
+        {
+            if (mNodesEdited[nodeID]) return;
+            mNodesEdited[nodeID] = true;
+            mEditedNodes.push_back((uint32_t)nodeID);
+        }
 
         /** Run the animation system.
             \return true if a change occurred, otherwise false.
@@ -112,7 +117,7 @@ namespace Falcor
 
         /** Check if a matrix changed since last frame.
         */
-        bool isMatrixChanged(NodeID matrixID) const { return mMatricesChanged[matrixID.get()]; }
+        bool isMatrixChanged(NodeID matrixID) const { return mMatricesChanged[matrixID.get()] != 0; }
 
         /** Get the local matrices.
             These represent the current local transform for each scene graph node.
@@ -150,9 +155,12 @@ namespace Falcor
         friend class SceneBuilder;
         AnimationController(std::shared_ptr<Device> pDevice, Scene* pScene, const StaticVertexVector& staticVertexData, const SkinningVertexVector& skinningVertexData, uint32_t prevVertexCount, const std::vector<Animation::SharedPtr>& animations);
 
+        void initHierarchy();
         void initLocalMatrices();
+        void markMatrixChanged(uint32_t nodeID);
         void updateLocalMatrices(double time);
         void updateWorldMatrices(bool updateAll = false);
+        void updateWorldMatrix(uint32_t nodeID);
         void uploadWorldMatrices(bool uploadAll = false);
 
         void bindBuffers();
@@ -165,10 +173,21 @@ namespace Falcor
         // Animation
         std::vector<Animation::SharedPtr> mAnimations;
         std::vector<bool> mNodesEdited;
+        std::vector<uint32_t> mEditedNodes;         ///< List of nodes marked as edited since last frame.
         std::vector<float4x4> mLocalMatrices;
         std::vector<float4x4> mGlobalMatrices;
         std::vector<float4x4> mInvTransposeGlobalMatrices;
-        std::vector<bool> mMatricesChanged;         ///< Flag per matrix, true if matrix changed since last frame.
+        std::vector<float4x4> mAnimatedMatrices;    ///< Local matrix evaluated by each animation.
+        std::vector<uint8_t> mMatricesChanged;      ///< Flag per matrix, true if matrix changed since last frame.
+        std::vector<uint32_t> mChangedMatrices;     ///< List of matrices that changed since last frame.
+
+        // Scene graph hierarchy, flattened for level-by-level transform propagation.
+        std::vector<uint32_t> mNodeLevels;          ///< Depth of each node in the scene graph.
+        std::vector<uint32_t> mChildOffsets;        ///< Offset of the first child of each node in mChildNodes. Has one extra entry holding the total child count.
+        std::vector<uint32_t> mChildNodes;          ///< Children of all nodes.
+        std::vector<uint32_t> mLevelOffsets;        ///< Offset of the first node of each level in mLevelNodes. Has one extra entry holding the node count.
+        std::vector<uint32_t> mLevelNodes;          ///< All nodes sorted by level.
+        std::vector<std::vector<uint32_t>> mChangedLevelNodes; ///< Changed nodes of each level, rebuilt on every update.
 
         bool mFirstUpdate = true;       ///< True if this is the first update.
         bool mEnabled = true;           ///< True if animations are enabled.
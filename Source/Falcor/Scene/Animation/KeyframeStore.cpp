@@ -0,0 +1,188 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "KeyframeStore.h"
+#include "Core/Assert.h"
+#include "Core/Errors.h"
+#include "Core/Platform/OS.h"
+#include "Utils/Threading.h"
+
+#include <lz4.h>
+
+#include <cstring>
+
+namespace Falcor
+{
+    namespace
+    {
+        /** XOR the words with the reference and shuffle the bytes of the words into byte planes.
+        */
+        void encodePlanes(const uint32_t* pSrc, const uint32_t* pRef, size_t wordCount, uint8_t* pDst)
+        {
+            for (size_t i = 0; i < wordCount; i++)
+            {
+                uint32_t w = pSrc[i] ^ pRef[i];
+                pDst[i] = (uint8_t)w;
+                pDst[wordCount + i] = (uint8_t)(w >> 8);
+                pDst[2 * wordCount + i] = (uint8_t)(w >> 16);
+                pDst[3 * wordCount + i] = (uint8_t)(w >> 24);
+            }
+        }
+
+        /** Inverse of encodePlanes().
+        */
+        void decodePlanes(const uint8_t* pSrc, const uint32_t* pRef, size_t wordCount, uint32_t* pDst)
+        {
+            for (size_t i = 0; i < wordCount; i++)
+            {
+                uint32_t w = (uint32_t)pSrc[i] | ((uint32_t)pSrc[wordCount + i] << 8) | ((uint32_t)pSrc[2 * wordCount + i] << 16) | ((uint32_t)pSrc[3 * wordCount + i] << 24);
+                pDst[i] = w ^ pRef[i];
+            }
+        }
+    }
+
+    KeyframeStore::KeyframeStore()
+        : mPath(getTempFilePath())
+    {
+        mFile.open(mPath, std::ios::binary | std::ios::trunc);
+        if (!mFile) throw RuntimeError("Failed to create keyframe store file '{}'.", mPath);
+    }
+
+    KeyframeStore::~KeyframeStore()
+    {
+        mMappedFile.close();
+        mFile.close();
+        std::error_code ec;
+        std::filesystem::remove(mPath, ec);
+    }
+
+    void KeyframeStore::checkKeyframeSize(size_t size, size_t expectedSize)
+    {
+        checkArgument(size == expectedSize, "All keyframes of a stream must have the same size.");
+    }
+
+    KeyframeStore::StreamID KeyframeStore::addStream(const std::vector<const void*>& pKeyframes, size_t keyframeSize)
+    {
+        checkInvariant(!mFinalized, "Can't add streams to a finalized keyframe store.");
+        checkArgument(keyframeSize % 4 == 0, "Keyframe size must be a multiple of 4 bytes.");
+
+        const size_t wordCount = keyframeSize / 4;
+        Stream stream;
+        stream.keyframeSize = keyframeSize;
+        stream.keyframes.resize(pKeyframes.size());
+        if (!pKeyframes.empty())
+        {
+            stream.reference.resize(wordCount);
+            if (keyframeSize > 0) std::memcpy(stream.reference.data(), pKeyframes[0], keyframeSize);
+        }
+
+        // Encode keyframes in parallel.
+        std::vector<std::vector<uint8_t>> encoded(pKeyframes.size());
+        Threading::parallelFor(0, pKeyframes.size(), 1, [&](size_t begin, size_t end)
+        {
+            std::vector<uint8_t> planes(keyframeSize);
+            for (size_t i = begin; i < end; i++)
+            {
+                if (keyframeSize == 0) continue;
+                encodePlanes(reinterpret_cast<const uint32_t*>(pKeyframes[i]), stream.reference.data(), wordCount, planes.data());
+
+                auto& data = encoded[i];
+                data.resize(LZ4_compressBound((int)keyframeSize));
+                const int compressedSize = LZ4_compress_default(reinterpret_cast<const char*>(planes.data()), reinterpret_cast<char*>(data.data()), (int)keyframeSize, (int)data.size());
+                if (compressedSize > 0 && (size_t)compressedSize < keyframeSize)
+                {
+                    data.resize(compressedSize);
+                    stream.keyframes[i].compressed = true;
+                }
+                else
+                {
+                    data = planes;
+                }
+            }
+        });
+
+        // Append the encoded keyframes to the file.
+        for (size_t i = 0; i < encoded.size(); i++)
+        {
+            auto& desc = stream.keyframes[i];
+            desc.offset = mFileSize;
+            desc.storedSize = (uint32_t)encoded[i].size();
+            mFile.write(reinterpret_cast<const char*>(encoded[i].data()), encoded[i].size());
+            mFileSize += encoded[i].size();
+        }
+        if (!mFile) throw RuntimeError("Failed to write keyframe store file '{}'.", mPath);
+
+        mDecodedSize += (uint64_t)keyframeSize * pKeyframes.size();
+        mStreams.push_back(std::move(stream));
+        return (StreamID)(mStreams.size() - 1);
+    }
+
+    void KeyframeStore::finalize()
+    {
+        if (mFinalized) return;
+        mFinalized = true;
+
+        mFile.close();
+        if (mFileSize > 0 && !mMappedFile.open(mPath, MemoryMappedFile::kWholeFile, MemoryMappedFile::AccessHint::RandomAccess))
+        {
+            throw RuntimeError("Failed to map keyframe store file '{}'.", mPath);
+        }
+    }
+
+    void KeyframeStore::decodeKeyframe(StreamID streamID, uint32_t keyframe, void* pDst) const
+    {
+        FALCOR_ASSERT(mFinalized);
+        FALCOR_ASSERT(streamID < mStreams.size() && keyframe < mStreams[streamID].keyframes.size());
+
+        const auto& stream = mStreams[streamID];
+        const auto& desc = stream.keyframes[keyframe];
+        if (stream.keyframeSize == 0) return;
+
+        const uint8_t* pSrc = reinterpret_cast<const uint8_t*>(mMappedFile.getData()) + desc.offset;
+        std::vector<uint8_t> planes;
+        if (desc.compressed)
+        {
+            planes.resize(stream.keyframeSize);
+            const int size = LZ4_decompress_safe(reinterpret_cast<const char*>(pSrc), reinterpret_cast<char*>(planes.data()), (int)desc.storedSize, (int)planes.size());
+            if (size != (int)stream.keyframeSize) throw RuntimeError("Failed to decode keyframe {} of keyframe stream {}.", keyframe, streamID);
+            pSrc = planes.data();
+        }
+
+        decodePlanes(pSrc, stream.reference.data(), stream.keyframeSize / 4, reinterpret_cast<uint32_t*>(pDst));
+    }
+
+    uint64_t KeyframeStore::getMemoryUsageInBytes() const
+    {
+        uint64_t m = 0;
+        for (const auto& stream : mStreams)
+        {
+            m += stream.reference.size() * sizeof(uint32_t);
+            m += stream.keyframes.size() * sizeof(KeyframeDesc);
+        }
+        return m;
+    }
+}
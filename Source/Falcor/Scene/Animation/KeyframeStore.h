@@ -0,0 +1,151 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Core/Platform/MemoryMappedFile.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace Falcor
+{
+    /** Compressed, file-backed store for keyframes of vertex caches.
+
+        Keyframes are grouped in streams. All keyframes of a stream have the same size, which must be a multiple of 4 bytes.
+        The first keyframe of each stream is kept in host memory and serves as reference for encoding the other keyframes.
+        Each keyframe is encoded losslessly as the XOR of its 32-bit words with the reference keyframe, with the bytes
+        of the words shuffled into byte planes, and compressed with LZ4. Data that changes little between keyframes
+        (texture coordinates, packed normals, high bits of positions) compresses to almost nothing.
+
+        The encoded keyframes are written to a temporary file, which is memory-mapped once all streams are added.
+        Keyframes are decoded on demand, so only the keyframes in use need to be resident in host memory.
+        Decoding is thread safe.
+    */
+    class FALCOR_API KeyframeStore
+    {
+    public:
+        using StreamID = uint32_t;
+
+        /** Create an empty store backed by a temporary file.
+        */
+        KeyframeStore();
+        ~KeyframeStore();
+
+        KeyframeStore(const KeyframeStore&) = delete;
+        KeyframeStore& operator=(const KeyframeStore&) = delete;
+
+        /** Add a stream of keyframes. Keyframes are encoded in parallel.
+            Must not be called after finalize().
+            \param[in] keyframes Keyframe data. All keyframes must have the same number of elements.
+            \return ID of the stream.
+        */
+        template<typename T>
+        StreamID addStream(const std::vector<std::vector<T>>& keyframes)
+        {
+            static_assert(sizeof(T) % 4 == 0, "Keyframe element size must be a multiple of 4 bytes");
+            std::vector<const void*> pKeyframes(keyframes.size());
+            for (size_t i = 0; i < keyframes.size(); i++)
+            {
+                checkKeyframeSize(keyframes[i].size() * sizeof(T), keyframes[0].size() * sizeof(T));
+                pKeyframes[i] = keyframes[i].data();
+            }
+            return addStream(pKeyframes, keyframes.empty() ? 0 : keyframes[0].size() * sizeof(T));
+        }
+
+        /** Add a stream of keyframes.
+            \param[in] pKeyframes Pointers to the keyframe data.
+            \param[in] keyframeSize Size of each keyframe in bytes. Must be a multiple of 4.
+            \return ID of the stream.
+        */
+        StreamID addStream(const std::vector<const void*>& pKeyframes, size_t keyframeSize);
+
+        /** Finish adding streams and memory-map the encoded keyframes for decoding.
+        */
+        void finalize();
+
+        uint32_t getStreamCount() const { return (uint32_t)mStreams.size(); }
+        uint32_t getKeyframeCount(StreamID streamID) const { return (uint32_t)mStreams[streamID].keyframes.size(); }
+        size_t getKeyframeSize(StreamID streamID) const { return mStreams[streamID].keyframeSize; }
+
+        /** Decode a keyframe. Must be called after finalize().
+            \param[in] streamID Stream ID.
+            \param[in] keyframe Keyframe index.
+            \param[out] pDst Destination buffer holding getKeyframeSize(streamID) bytes.
+        */
+        void decodeKeyframe(StreamID streamID, uint32_t keyframe, void* pDst) const;
+
+        template<typename T>
+        std::vector<T> decodeKeyframe(StreamID streamID, uint32_t keyframe) const
+        {
+            std::vector<T> data(getKeyframeSize(streamID) / sizeof(T));
+            decodeKeyframe(streamID, keyframe, data.data());
+            return data;
+        }
+
+        /** Get the host memory used by the reference keyframes and the keyframe tables.
+            The memory-mapped file is not included as its pages are managed by the OS.
+        */
+        uint64_t getMemoryUsageInBytes() const;
+
+        /** Get the total size of the encoded keyframes in bytes.
+        */
+        uint64_t getEncodedSizeInBytes() const { return mFileSize; }
+
+        /** Get the total size of the decoded keyframes in bytes.
+        */
+        uint64_t getDecodedSizeInBytes() const { return mDecodedSize; }
+
+    private:
+        struct KeyframeDesc
+        {
+            uint64_t offset = 0;        ///< File offset of the encoded keyframe in bytes.
+            uint32_t storedSize = 0;    ///< Size of the encoded keyframe in bytes.
+            bool compressed = false;    ///< True if the keyframe is LZ4 compressed, false if only the byte planes are stored.
+        };
+
+        struct Stream
+        {
+            size_t keyframeSize = 0;
+            std::vector<uint32_t> reference;            ///< First keyframe, used as reference for all keyframes.
+            std::vector<KeyframeDesc> keyframes;
+        };
+
+        static void checkKeyframeSize(size_t size, size_t expectedSize);
+
+        std::filesystem::path mPath;
+        std::ofstream mFile;
+        MemoryMappedFile mMappedFile;
+        bool mFinalized = false;
+
+        std::vector<Stream> mStreams;
+        uint64_t mFileSize = 0;
+        uint64_t mDecodedSize = 0;
+    };
+}
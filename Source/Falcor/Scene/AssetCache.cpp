@@ -0,0 +1,169 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "AssetCache.h"
+#include "Core/Platform/OS.h"
+#include "Utils/Logger.h"
+
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <system_error>
+
+namespace Falcor
+{
+    namespace
+    {
+        /** Specifies the current cache entry version.
+            This needs to be incremented every time the entry format changes.
+        */
+        const uint32_t kVersion = 1;
+
+        /** Asset cache directory (subdirectory in the application data directory).
+        */
+        const std::string kDirectory = "NVIDIA/Falcor/AssetCache";
+
+        const char* kMagic = "FalcorA$";
+        struct Header
+        {
+            uint8_t magic[8]{};
+            uint32_t version{};
+            uint32_t reserved{};
+            uint64_t size{};
+
+            bool isValid() const
+            {
+                return std::memcmp(magic, kMagic, sizeof(Header::magic)) == 0 && version == kVersion;
+            }
+        };
+    }
+
+    AssetCache::AssetCache(const std::filesystem::path& directory)
+        : mDirectory(directory)
+    {
+        // Random nonce to make temporary file names unique across processes.
+        std::random_device rd;
+        mNonce = ((uint64_t)rd() << 32) | rd();
+    }
+
+    std::filesystem::path AssetCache::getDefaultDirectory()
+    {
+        return getAppDataDirectory() / kDirectory;
+    }
+
+    std::optional<std::vector<uint8_t>> AssetCache::read(const Key& key)
+    {
+        auto miss = [this]()
+        {
+            mMissCount++;
+            return std::nullopt;
+        };
+
+        const auto path = getEntryPath(key);
+        std::error_code ec;
+        const uint64_t fileSize = std::filesystem::file_size(path, ec);
+        if (ec || fileSize < sizeof(Header)) return miss();
+
+        std::ifstream fs(path, std::ios_base::binary);
+        if (!fs.good()) return miss();
+
+        Header header;
+        fs.read(reinterpret_cast<char*>(&header), sizeof(header));
+        if (!fs.good() || !header.isValid() || header.size != fileSize - sizeof(Header)) return miss();
+
+        std::vector<uint8_t> data(header.size);
+        fs.read(reinterpret_cast<char*>(data.data()), data.size());
+        if (fs.gcount() != (std::streamsize)data.size()) return miss();
+
+        mHitCount++;
+        mBytesSaved += data.size();
+        return data;
+    }
+
+    void AssetCache::write(const Key& key, const std::vector<uint8_t>& data)
+    {
+        const auto path = getEntryPath(key);
+
+        std::error_code ec;
+        std::filesystem::create_directories(path.parent_path(), ec);
+
+        // Write to a temporary file first and rename it, so that concurrent readers never see partially written entries.
+        auto tempPath = path;
+        tempPath += fmt::format(".{:016x}.{}.tmp", mNonce, mTempFileCounter++);
+        {
+            std::ofstream fs(tempPath, std::ios_base::binary);
+            Header header;
+            std::memcpy(header.magic, kMagic, sizeof(Header::magic));
+            header.version = kVersion;
+            header.size = data.size();
+            fs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            fs.write(reinterpret_cast<const char*>(data.data()), data.size());
+            if (!fs.good())
+            {
+                fs.close();
+                std::filesystem::remove(tempPath, ec);
+                logWarning("Failed to write asset cache entry '{}'.", path);
+                return;
+            }
+        }
+
+        std::filesystem::rename(tempPath, path, ec);
+        if (ec)
+        {
+            // Another process or thread may have written the same entry in the meantime.
+            std::filesystem::remove(tempPath, ec);
+            return;
+        }
+
+        mBytesWritten += data.size();
+    }
+
+    AssetCache::Stats AssetCache::getStats() const
+    {
+        Stats stats;
+        stats.hitCount = mHitCount;
+        stats.missCount = mMissCount;
+        stats.bytesSaved = mBytesSaved;
+        stats.bytesWritten = mBytesWritten;
+        return stats;
+    }
+
+    void AssetCache::resetStats()
+    {
+        mHitCount = 0;
+        mMissCount = 0;
+        mBytesSaved = 0;
+        mBytesWritten = 0;
+    }
+
+    std::filesystem::path AssetCache::getEntryPath(const Key& key) const
+    {
+        // Entries are distributed over subdirectories by the first two hex digits of the key.
+        const std::string name = SHA1::toString(key);
+        return mDirectory / name.substr(0, 2) / name.substr(2);
+    }
+}
@@ -0,0 +1,104 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Utils/CryptoUtils.h"
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <vector>
+
+namespace Falcor
+{
+    /** Content-addressed cache for processed assets.
+        Each entry stores a blob of processed data, keyed by a hash of the source data and all settings that affect
+        the processing. Unlike the scene cache, which caches a whole scene, this allows reusing the results for
+        unchanged assets when other parts of a scene change. The cache is thread safe.
+    */
+    class FALCOR_API AssetCache
+    {
+    public:
+        using Key = SHA1::MD;
+
+        struct Stats
+        {
+            uint64_t hitCount = 0;      ///< Number of lookups that found a cache entry.
+            uint64_t missCount = 0;     ///< Number of lookups that did not find a cache entry.
+            uint64_t bytesSaved = 0;    ///< Bytes of processed data reused from the cache instead of being recomputed.
+            uint64_t bytesWritten = 0;  ///< Bytes of processed data written to the cache.
+        };
+
+        /** Create an asset cache.
+            \param[in] directory Cache directory. Created when the first entry is written.
+        */
+        AssetCache(const std::filesystem::path& directory = getDefaultDirectory());
+
+        /** Get the default cache directory (subdirectory in the application data directory).
+        */
+        static std::filesystem::path getDefaultDirectory();
+
+        /** Get the cache directory.
+        */
+        const std::filesystem::path& getDirectory() const { return mDirectory; }
+
+        /** Look up a cache entry.
+            \param[in] key Cache key.
+            \return Returns the cached data, or an empty optional if there is no valid entry.
+        */
+        std::optional<std::vector<uint8_t>> read(const Key& key);
+
+        /** Write a cache entry. An existing entry with the same key is replaced.
+            Failure to write the entry is logged but is not an error.
+            \param[in] key Cache key.
+            \param[in] data Data to store.
+        */
+        void write(const Key& key, const std::vector<uint8_t>& data);
+
+        /** Get cache statistics.
+        */
+        Stats getStats() const;
+
+        /** Reset cache statistics.
+        */
+        void resetStats();
+
+    private:
+        std::filesystem::path getEntryPath(const Key& key) const;
+
+        std::filesystem::path mDirectory;
+        uint64_t mNonce = 0;
+
+        std::atomic<uint64_t> mHitCount{0};
+        std::atomic<uint64_t> mMissCount{0};
+        std::atomic<uint64_t> mBytesSaved{0};
+        std::atomic<uint64_t> mBytesWritten{0};
+        std::atomic<uint64_t> mTempFileCounter{0};
+    };
+}
@@ -640,6 +640,36 @@ namespace Falcor
         return (*this) == (*other);
     }
 
+    size_t BasicMaterial::getHash() const
+    {
+        // Hash the fields compared by operator==. The samplers are not hashed as they rarely differ.
+        size_t hash = getBaseHash();
+
+#define hash_field(_a) hashCombine(hash, mData._a)
+#define hash_field16(_a, _type) hashCombine(hash, (_type)mData._a)
+        hash_field(flags);
+        hash_field(displacementScale);
+        hash_field(displacementOffset);
+        hash_field16(baseColor, float4);
+        hash_field16(specular, float4);
+        hash_field16(data1, float4);
+        hash_field16(data2, float4);
+        hash_field(emissionSpectralId);
+        hash_field(iorNSpectralId);
+        hash_field(iorKSpectralId);
+        hash_field16(IoR, float);
+        hash_field16(diffuseTransmission, float);
+        hash_field16(specularTransmission, float);
+        hash_field16(transmission, float3);
+        hash_field16(volumeAbsorption, float3);
+        hash_field16(volumeAnisotropy, float);
+        hash_field16(volumeScattering, float3);
+#undef hash_field16
+#undef hash_field
+
+        return hash;
+    }
+
     bool BasicMaterial::operator==(const BasicMaterial& other) const
     {
         if (!isBaseEqual(other)) return false;
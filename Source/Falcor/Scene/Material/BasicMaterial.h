@@ -74,6 +74,7 @@ namespace Falcor
             \return true if all materials properties *except* the name are identical.
         */
         bool isEqual(const Material::SharedPtr& pOther) const override;
+        size_t getHash() const override;
 
         /** Set the alpha mode.
         */
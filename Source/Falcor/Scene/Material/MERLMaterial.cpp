@@ -150,6 +150,13 @@ namespace Falcor
         return true;
     }
 
+    size_t MERLMaterial::getHash() const
+    {
+        size_t hash = getBaseHash();
+        hashCombine(hash, std::filesystem::hash_value(mPath));
+        return hash;
+    }
+
     Program::ShaderModuleList MERLMaterial::getShaderModules() const
     {
         return { Program::ShaderModule(kShaderFile) };
@@ -240,6 +240,17 @@ namespace Falcor
         return true;
     }
 
+    size_t MERLMixMaterial::getHash() const
+    {
+        size_t hash = getBaseHash();
+        for (const auto& brdf : mBRDFs)
+        {
+            hashCombine(hash, brdf.name);
+            hashCombine(hash, std::filesystem::hash_value(brdf.path));
+        }
+        return hash;
+    }
+
     Program::ShaderModuleList MERLMixMaterial::getShaderModules() const
     {
         return { Program::ShaderModule(kShaderFile) };
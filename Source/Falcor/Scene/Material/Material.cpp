@@ -306,6 +306,35 @@ namespace Falcor
         return true;
     }
 
+    size_t Material::getBaseHash() const
+    {
+        // This function hashes the data compared by isBaseEqual(). Floats are hashed by value so that values comparing
+        // equal (e.g. +0 and -0) hash to the same value.
+
+        size_t hash = 0;
+        hashCombine(hash, mHeader.packedData);
+
+        const auto& rotation = mTextureTransform.getRotation();
+        hashCombine(hash, mTextureTransform.getTranslation());
+        hashCombine(hash, mTextureTransform.getScaling());
+        hashCombine(hash, float4(rotation.x, rotation.y, rotation.z, rotation.w));
+
+        for (size_t i = 0; i < mTextureSlotInfo.size(); i++)
+        {
+            auto slot = (TextureSlot)i;
+            if (hasTextureSlot(slot))
+            {
+                hashCombine(hash, i);
+                hashCombine(hash, mTextureSlotInfo[i].name);
+                hashCombine(hash, (uint32_t)mTextureSlotInfo[i].mask);
+                hashCombine(hash, mTextureSlotInfo[i].srgb);
+                hashCombine(hash, mTextureSlotData[i].pTexture.get());
+            }
+        }
+
+        return hash;
+    }
+
     NormalMapType Material::detectNormalMapType(const Texture::SharedPtr& pNormalMap)
     {
         NormalMapType type = NormalMapType::None;
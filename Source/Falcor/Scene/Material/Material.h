@@ -160,6 +160,13 @@ namespace Falcor
         */
         virtual bool isEqual(const Material::SharedPtr& pOther) const = 0;
 
+        /** Compute a hash of the material properties.
+            Materials that compare equal with isEqual() are guaranteed to have the same hash,
+            which allows duplicates to be found without comparing all pairs of materials.
+            \return Hash of all material properties *except* the name.
+        */
+        virtual size_t getHash() const = 0;
+
         /** Set the double-sided flag. This flag doesn't affect the cull state, just the shading.
         */
         virtual void setDoubleSided(bool doubleSided);
@@ -331,6 +338,21 @@ namespace Falcor
         void updateTextureHandle(MaterialSystem* pOwner, const TextureSlot slot, TextureHandle& handle);
         void updateDefaultTextureSamplerID(MaterialSystem* pOwner, const Sampler::SharedPtr& pSampler);
         bool isBaseEqual(const Material& other) const;
+        size_t getBaseHash() const;
+
+        /** Combine a hash with the hash of a value. Used for implementing getHash().
+        */
+        template<typename T>
+        static void hashCombine(size_t& hash, const T& value)
+        {
+            hash ^= std::hash<T>{}(value) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+        }
+
+        template<typename T, glm::length_t N>
+        static void hashCombine(size_t& hash, const glm::vec<N, T>& value)
+        {
+            for (glm::length_t i = 0; i < N; i++) hashCombine(hash, value[i]);
+        }
 
         static NormalMapType detectNormalMapType(const Texture::SharedPtr& pNormalMap);
 
@@ -32,6 +32,7 @@
 #include "Utils/StringUtils.h"
 #include "MaterialTypeRegistry.h"
 #include <numeric>
+#include <unordered_map>
 
 namespace Falcor
 {
@@ -214,8 +215,8 @@ namespace Falcor
             pMaterial->setDefaultTextureSampler(mpDefaultTextureSampler);
         }
 
-        pMaterial->registerUpdateCallback([this](auto flags) { mMaterialUpdates |= flags; });
         mMaterials.push_back(pMaterial);
+        registerMaterialUpdates(materialID.get());
         mMaterialsChanged = true;
 
         return materialID;
@@ -236,7 +237,7 @@ namespace Falcor
                 pReplacement->setDefaultTextureSampler(mpDefaultTextureSampler);
             }
 
-            pReplacement->registerUpdateCallback([this](auto flags) { mMaterialUpdates |= flags; });
+            registerMaterialUpdates((uint32_t)std::distance(mMaterials.begin(), it));
             mMaterialsChanged = true;
         }
         else
@@ -290,28 +291,46 @@ namespace Falcor
         std::vector<Material::SharedPtr> uniqueMaterials;
         idMap.resize(mMaterials.size());
 
+        // Bucket the unique materials by hash so that each material is only compared against materials with the same hash.
+        std::unordered_map<size_t, std::vector<MaterialID>> uniqueMaterialsByHash;
+        uniqueMaterialsByHash.reserve(mMaterials.size());
+
         // Find unique set of materials.
         for (MaterialID id{ 0 }; id.get() < mMaterials.size(); ++id)
         {
             const auto& pMaterial = mMaterials[id.get()];
-            auto it = std::find_if(uniqueMaterials.begin(), uniqueMaterials.end(), [&pMaterial](const auto& m) { return m->isEqual(pMaterial); });
-            if (it == uniqueMaterials.end())
+            auto& bucket = uniqueMaterialsByHash[pMaterial->getHash()];
+            auto it = std::find_if(bucket.begin(), bucket.end(), [&](MaterialID uniqueID) { return uniqueMaterials[uniqueID.get()]->isEqual(pMaterial); });
+            if (it == bucket.end())
             {
                 idMap[id.get()] = MaterialID{ uniqueMaterials.size() };
+                bucket.push_back(idMap[id.get()]);
                 uniqueMaterials.push_back(pMaterial);
             }
             else
             {
-                logInfo("Removing duplicate material '{}' (duplicate of '{}').", pMaterial->getName(), (*it)->getName());
-                idMap[id.get()] = MaterialID{ (size_t)std::distance(uniqueMaterials.begin(), it) };
+                logInfo("Removing duplicate material '{}' (duplicate of '{}').", pMaterial->getName(), uniqueMaterials[it->get()]->getName());
+                idMap[id.get()] = *it;
             }
         }
 
         size_t removed = mMaterials.size() - uniqueMaterials.size();
         if (removed > 0)
         {
+            // Detach the removed materials, so that later changes to them don't mark materials dirty by their stale IDs.
+            // Unique materials re-register their callbacks below, in case the same material was added more than once.
+            for (const auto& pMaterial : mMaterials) pMaterial->registerUpdateCallback(nullptr);
+
             mMaterials = uniqueMaterials;
             mMaterialsChanged = true;
+
+            // Material IDs have changed. Rebuild the list of dirty materials.
+            mDirtyMaterialIDs.clear();
+            mIsMaterialDirty.clear();
+            for (uint32_t materialID = 0; materialID < (uint32_t)mMaterials.size(); ++materialID)
+            {
+                registerMaterialUpdates(materialID);
+            }
         }
 
         return removed;
@@ -341,26 +360,51 @@ namespace Falcor
 
         if (textures.empty()) return;
 
-        // Analyze the textures.
-        logInfo("Analyzing {} material textures.", textures.size());
+        // Use the results of the CPU analysis done by the texture manager when the textures were loaded.
+        // The remaining textures are analyzed on the GPU.
+        std::vector<TextureAnalyzer::Result> results(textures.size());
+        std::vector<size_t> gpuIndices;
+        std::vector<Texture::SharedPtr> gpuTextures;
+
+        for (size_t i = 0; i < textures.size(); i++)
+        {
+            if (auto analysis = mpTextureManager->getTextureAnalysis(textures[i].get()))
+            {
+                results[i] = *analysis;
+            }
+            else
+            {
+                gpuIndices.push_back(i);
+                gpuTextures.push_back(textures[i]);
+            }
+        }
+
+        logInfo("Analyzing {} material textures ({} analyzed at load time).", textures.size(), textures.size() - gpuTextures.size());
 
-        RenderContext* pRenderContext = mpDevice->getRenderContext();
+        if (!gpuTextures.empty())
+        {
+            RenderContext* pRenderContext = mpDevice->getRenderContext();
+
+            TextureAnalyzer::SharedPtr pAnalyzer = TextureAnalyzer::create(mpDevice);
+            auto pResults = Buffer::create(mpDevice.get(), gpuTextures.size() * TextureAnalyzer::getResultSize(), ResourceBindFlags::UnorderedAccess);
+            pAnalyzer->analyze(pRenderContext, gpuTextures, pResults);
 
-        TextureAnalyzer::SharedPtr pAnalyzer = TextureAnalyzer::create(mpDevice);
-        auto pResults = Buffer::create(mpDevice.get(), textures.size() * TextureAnalyzer::getResultSize(), ResourceBindFlags::UnorderedAccess);
-        pAnalyzer->analyze(pRenderContext, textures, pResults);
+            // Copy result to staging buffer for readback.
+            // This is mostly to avoid a full flush and the associated perf warning.
+            // We do not have any other useful GPU work, but unrelated GPU tasks can be in flight.
+            auto pResultsStaging = Buffer::create(mpDevice.get(), gpuTextures.size() * TextureAnalyzer::getResultSize(), ResourceBindFlags::None, Buffer::CpuAccess::Read);
+            pRenderContext->copyResource(pResultsStaging.get(), pResults.get());
+            pRenderContext->flush(false);
+            mpFence->gpuSignal(pRenderContext->getLowLevelData()->getCommandQueue());
 
-        // Copy result to staging buffer for readback.
-        // This is mostly to avoid a full flush and the associated perf warning.
-        // We do not have any other useful GPU work, but unrelated GPU tasks can be in flight.
-        auto pResultsStaging = Buffer::create(mpDevice.get(), textures.size() * TextureAnalyzer::getResultSize(), ResourceBindFlags::None, Buffer::CpuAccess::Read);
-        pRenderContext->copyResource(pResultsStaging.get(), pResults.get());
-        pRenderContext->flush(false);
-        mpFence->gpuSignal(pRenderContext->getLowLevelData()->getCommandQueue());
+            // Wait for results to become available.
+            mpFence->syncCpu();
+            const TextureAnalyzer::Result* gpuResults = static_cast<const TextureAnalyzer::Result*>(pResultsStaging->map(Buffer::MapType::Read));
+            for (size_t i = 0; i < gpuIndices.size(); i++) results[gpuIndices[i]] = gpuResults[i];
+            pResultsStaging->unmap();
+        }
 
-        // Wait for results to become available. Then optimize the materials.
-        mpFence->syncCpu();
-        const TextureAnalyzer::Result* results = static_cast<const TextureAnalyzer::Result*>(pResultsStaging->map(Buffer::MapType::Read));
+        // Optimize the materials.
         Material::TextureOptimizationStats stats = {};
 
         for (size_t i = 0; i < textures.size(); i++)
@@ -368,8 +412,6 @@ namespace Falcor
             materialSlots[i].first->optimizeTexture(materialSlots[i].second, results[i], stats);
         }
 
-        pResultsStaging->unmap();
-
         // Log optimization stats.
         if (size_t totalRemoved = std::accumulate(stats.texturesRemoved.begin(), stats.texturesRemoved.end(), 0ull); totalRemoved > 0)
         {
@@ -400,22 +442,49 @@ namespace Falcor
             mMaterialsChanged = false;
         }
 
-        mMaterialsUpdateFlags.resize(mMaterials.size());
+        mUpdateStats = {};
+
+        // Take the list of dirty materials before updating them.
+        // Materials that are marked dirty while updating are kept in the list and updated on the next update.
+        std::vector<uint32_t> dirtyMaterialIDs;
+        dirtyMaterialIDs.swap(mDirtyMaterialIDs);
+        for (uint32_t materialID : dirtyMaterialIDs) mIsMaterialDirty[materialID] = false;
+        mMaterialUpdates = Material::UpdateFlags::None;
+
+        // Update all materials that have changed since the last update.
+        // The list of changed materials is sorted so that materials with consecutive IDs can be uploaded together.
+        std::vector<uint32_t> materialIDs;
+        if (forceUpdate)
+        {
+            materialIDs.resize(mMaterials.size());
+            std::iota(materialIDs.begin(), materialIDs.end(), 0);
+        }
+        else
+        {
+            materialIDs = std::move(dirtyMaterialIDs);
+            std::sort(materialIDs.begin(), materialIDs.end());
+        }
 
-        // Update all materials.
-        if (forceUpdate || mMaterialUpdates != Material::UpdateFlags::None)
+        std::vector<uint32_t> updatedMaterialIDs;
+        if (!materialIDs.empty())
         {
             // To improve load time of large assets using the MxLayeredMaterial,
             // we defer texture loading and execute it in parallel during endDeferredLoading().
             mpTextureManager->beginDeferredLoading();
 
-            for (uint32_t materialID = 0; materialID < (uint32_t)mMaterials.size(); ++materialID)
+            for (uint32_t materialID : materialIDs)
             {
-                auto& pMaterial = mMaterials[materialID];
-                mMaterialsUpdateFlags[materialID] = pMaterial->update(this);
+                auto materialUpdates = mMaterials[materialID]->update(this);
+                if (materialUpdates != Material::UpdateFlags::None)
+                {
+                    updatedMaterialIDs.push_back(materialID);
+                    flags |= materialUpdates;
+                }
             }
 
             mpTextureManager->endDeferredLoading();
+
+            mUpdateStats.updatedMaterialCount = (uint32_t)materialIDs.size();
         }
 
         // Create parameter block if needed.
@@ -430,20 +499,13 @@ namespace Falcor
             forceUpdate = true; // Trigger full upload of all materials
         }
 
-        // Upload all modified materials
-        if (forceUpdate || mMaterialUpdates != Material::UpdateFlags::None)
+        // Upload all modified materials.
+        if (forceUpdate)
         {
-            for (uint32_t materialID = 0; materialID < (uint32_t)mMaterials.size(); ++materialID)
-            {
-                if (forceUpdate || mMaterialsUpdateFlags[materialID] != Material::UpdateFlags::None)
-                {
-                    uploadMaterial(materialID);
-
-                    flags |= mMaterialsUpdateFlags[materialID];
-                }
-            }
+            updatedMaterialIDs.resize(mMaterials.size());
+            std::iota(updatedMaterialIDs.begin(), updatedMaterialIDs.end(), 0);
         }
-
+        uploadMaterials(updatedMaterialIDs);
 
         // Update samplers.
         if (forceUpdate || mSamplersChanged)
@@ -497,8 +559,6 @@ namespace Falcor
             }
         }
 
-        mMaterialUpdates = Material::UpdateFlags::None;
-
         return flags;
     }
 
@@ -676,4 +736,53 @@ namespace Falcor
         FALCOR_ASSERT(mpMaterialDataBuffer);
         mpMaterialDataBuffer->setElement(materialID, pMaterial->getDataBlob());
     }
+
+    void MaterialSystem::uploadMaterials(const std::vector<uint32_t>& materialIDs)
+    {
+        FALCOR_ASSERT(std::is_sorted(materialIDs.begin(), materialIDs.end()));
+
+        // Upload each range of consecutive material IDs with a single buffer write.
+        std::vector<MaterialDataBlob> blobs;
+        for (size_t first = 0; first < materialIDs.size();)
+        {
+            size_t last = first + 1;
+            while (last < materialIDs.size() && materialIDs[last] == materialIDs[last - 1] + 1) last++;
+
+            blobs.clear();
+            for (size_t i = first; i < last; i++) blobs.push_back(mMaterials[materialIDs[i]]->getDataBlob());
+
+            FALCOR_ASSERT(mpMaterialDataBuffer);
+            const size_t byteSize = blobs.size() * sizeof(MaterialDataBlob);
+            mpMaterialDataBuffer->setBlob(blobs.data(), materialIDs[first] * sizeof(MaterialDataBlob), byteSize);
+
+            mUpdateStats.uploadedMaterialCount += (uint32_t)blobs.size();
+            mUpdateStats.uploadCount++;
+            mUpdateStats.uploadedBytes += byteSize;
+
+            first = last;
+        }
+    }
+
+    void MaterialSystem::registerMaterialUpdates(const uint32_t materialID)
+    {
+        FALCOR_ASSERT(materialID < mMaterials.size());
+        const auto& pMaterial = mMaterials[materialID];
+
+        pMaterial->registerUpdateCallback([this, materialID](auto flags) { markMaterialDirty(materialID, flags); });
+
+        // Materials may have pending updates from before they were added.
+        if (pMaterial->mUpdates != Material::UpdateFlags::None) markMaterialDirty(materialID, pMaterial->mUpdates);
+    }
+
+    void MaterialSystem::markMaterialDirty(const uint32_t materialID, Material::UpdateFlags updates)
+    {
+        mMaterialUpdates |= updates;
+
+        if (materialID >= mIsMaterialDirty.size()) mIsMaterialDirty.resize(mMaterials.size(), false);
+        if (!mIsMaterialDirty[materialID])
+        {
+            mIsMaterialDirty[materialID] = true;
+            mDirtyMaterialIDs.push_back(materialID);
+        }
+    }
 }
@@ -74,6 +74,16 @@ namespace Falcor
             uint64_t textureMemoryInBytes = 0;          ///< Total memory in bytes used by the textures.
         };
 
+        /** Statistics for the last call to update().
+        */
+        struct UpdateStats
+        {
+            uint32_t updatedMaterialCount = 0;          ///< Number of materials that were updated.
+            uint32_t uploadedMaterialCount = 0;         ///< Number of materials that were uploaded to the GPU.
+            uint32_t uploadCount = 0;                   ///< Number of uploads. Materials with consecutive IDs are uploaded together.
+            uint64_t uploadedBytes = 0;                 ///< Number of bytes uploaded.
+        };
+
         /** Create a material system.
             \return New object, or throws an exception if creation failed.
         */
@@ -216,6 +226,10 @@ namespace Falcor
         */
         MaterialStats getStats() const;
 
+        /** Get stats for the last call to update().
+        */
+        const UpdateStats& getUpdateStats() const { return mUpdateStats; }
+
         /** Get texture manager. This holds all textures.
         */
         const TextureManager::SharedPtr& getTextureManager() { return mpTextureManager; }
@@ -228,11 +242,15 @@ namespace Falcor
         void updateUI();
         void createParameterBlock();
         void uploadMaterial(const uint32_t materialID);
+        void uploadMaterials(const std::vector<uint32_t>& materialIDs);
+        void registerMaterialUpdates(const uint32_t materialID);
+        void markMaterialDirty(const uint32_t materialID, Material::UpdateFlags updates);
 
         std::shared_ptr<Device> mpDevice;
 
         std::vector<Material::SharedPtr> mMaterials;                ///< List of all materials.
-        std::vector<Material::UpdateFlags> mMaterialsUpdateFlags;   ///< List of all material update flags, after the update() calls
+        std::vector<uint32_t> mDirtyMaterialIDs;                    ///< List of materials with updates since last update.
+        std::vector<bool> mIsMaterialDirty;                         ///< Flag for each material indicating if it is in the list of dirty materials.
         TextureManager::SharedPtr mpTextureManager;                 ///< Texture manager holding all material textures.
         Program::ShaderModuleList mShaderModules;                   ///< Shader modules for all materials in use.
         std::map<MaterialType, Program::TypeConformanceList> mTypeConformances; ///< Type conformances for each material type in use.
@@ -250,6 +268,7 @@ namespace Falcor
         bool mMaterialsChanged = false;                             ///< Flag indicating if materials were added/removed since last update. Per-material updates are tracked by each material's update flags.
 
         Material::UpdateFlags mMaterialUpdates = Material::UpdateFlags::None; ///< Material updates across all materials since last update.
+        UpdateStats mUpdateStats;                                   ///< Stats for the last update.
 
         // GPU resources
         GpuFence::SharedPtr mpFence;
@@ -55,10 +55,25 @@ namespace Falcor
         // Request texture to be loaded.
         auto handle = mpTextureManager->loadTexture(path, true, srgb);
 
+        if (mPrioritizedMaterials.count(pMaterial.get()) > 0) mpTextureManager->setTexturePriority(handle, AsyncTextureLoader::Priority::High);
+        else mNormalPriorityHandles[pMaterial.get()].push_back(handle);
+
         // Store assignment to material for later.
         mTextureAssignments.emplace_back(TextureAssignment{ pMaterial, slot, handle });
     }
 
+    void MaterialTextureLoader::prioritizeMaterial(const Material::SharedPtr& pMaterial)
+    {
+        FALCOR_ASSERT(pMaterial);
+        if (!mPrioritizedMaterials.insert(pMaterial.get()).second) return;
+
+        if (auto it = mNormalPriorityHandles.find(pMaterial.get()); it != mNormalPriorityHandles.end())
+        {
+            for (const auto& handle : it->second) mpTextureManager->setTexturePriority(handle, AsyncTextureLoader::Priority::High);
+            mNormalPriorityHandles.erase(it);
+        }
+    }
+
     void MaterialTextureLoader::assignTextures()
     {
         mpTextureManager->waitForAllTexturesLoading();
@@ -30,6 +30,8 @@
 #include "Scene/Material/Material.h"
 #include "Utils/Image/TextureManager.h"
 #include <filesystem>
+#include <map>
+#include <set>
 #include <vector>
 
 namespace Falcor
@@ -41,6 +43,9 @@ namespace Falcor
         material assignment is stored. When the client destroys the instance of the
         `MaterialTextureLoader`, it blocks until all textures are loaded and assigns
         them to the materials.
+
+        Textures are loaded with normal priority. The textures of materials passed to
+        `prioritizeMaterial` (e.g. materials used by instanced geometry) are loaded first.
     */
     class MaterialTextureLoader
     {
@@ -55,6 +60,11 @@ namespace Falcor
         */
         void loadTexture(const Material::SharedPtr& pMaterial, Material::TextureSlot slot, const std::filesystem::path& path);
 
+        /** Load the textures of a material with high priority. This applies to textures that are already loading and to textures requested later.
+            \param[in] pMaterial Material.
+        */
+        void prioritizeMaterial(const Material::SharedPtr& pMaterial);
+
     private:
         void assignTextures();
 
@@ -67,6 +77,8 @@ namespace Falcor
 
         bool mUseSrgb;
         std::vector<TextureAssignment> mTextureAssignments;
+        std::set<const Material*> mPrioritizedMaterials;
+        std::map<const Material*, std::vector<TextureManager::TextureHandle>> mNormalPriorityHandles; ///< Textures loading with normal priority, by material.
         TextureManager::SharedPtr mpTextureManager;
     };
 }
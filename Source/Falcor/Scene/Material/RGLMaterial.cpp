@@ -138,6 +138,13 @@ namespace Falcor
         return true;
     }
 
+    size_t RGLMaterial::getHash() const
+    {
+        size_t hash = getBaseHash();
+        hashCombine(hash, std::filesystem::hash_value(mFilePath));
+        return hash;
+    }
+
     Program::ShaderModuleList RGLMaterial::getShaderModules() const
     {
         return { Program::ShaderModule(kShaderFile) };
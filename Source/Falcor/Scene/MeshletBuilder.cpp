@@ -0,0 +1,313 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "MeshletBuilder.h"
+#include "Core/Assert.h"
+#include "Core/Errors.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kInvalidIndex = 0xffffffff;
+
+        /** Helper for growing a single meshlet.
+        */
+        class MeshletAccumulator
+        {
+        public:
+            MeshletAccumulator(size_t vertexCount) : mLocalIndex(vertexCount, kInvalidIndex) {}
+
+            bool empty() const { return mTriangles.empty(); }
+            size_t getVertexCount() const { return mVertices.size(); }
+            size_t getTriangleCount() const { return mTriangles.size(); }
+            const std::vector<uint32_t>& getVertices() const { return mVertices; }
+
+            bool contains(uint32_t vertex) const { return mLocalIndex[vertex] != kInvalidIndex; }
+
+            /** Return the number of vertices the triangle would add to the meshlet.
+            */
+            uint32_t getNewVertexCount(const uint32_t* pTriangle) const
+            {
+                const uint32_t a = pTriangle[0], b = pTriangle[1], c = pTriangle[2];
+                uint32_t count = contains(a) ? 0 : 1;
+                if (!contains(b) && b != a) count++;
+                if (!contains(c) && c != a && c != b) count++;
+                return count;
+            }
+
+            float3 getCentroid() const { return mPositionSum / (float)mVertices.size(); }
+
+            void addTriangle(const uint32_t* pTriangle, const std::vector<float3>& positions)
+            {
+                uint32_t local[3];
+                for (uint32_t i = 0; i < 3; i++)
+                {
+                    const uint32_t v = pTriangle[i];
+                    if (!contains(v))
+                    {
+                        mLocalIndex[v] = (uint32_t)mVertices.size();
+                        mVertices.push_back(v);
+                        mPositionSum += positions[v];
+                    }
+                    local[i] = mLocalIndex[v];
+                }
+                mTriangles.push_back(MeshletBuilder::packTriangle(local[0], local[1], local[2]));
+            }
+
+            void flush(uint32_t meshID, MeshletData& data, const std::vector<float3>& positions)
+            {
+                MeshletDesc meshlet = {};
+                meshlet.meshID = meshID;
+                meshlet.vertexOffset = (uint32_t)data.vertices.size();
+                meshlet.triangleOffset = (uint32_t)data.triangles.size();
+                meshlet.counts = (uint32_t)mVertices.size() | ((uint32_t)mTriangles.size() << 16);
+
+                data.vertices.insert(data.vertices.end(), mVertices.begin(), mVertices.end());
+                data.triangles.insert(data.triangles.end(), mTriangles.begin(), mTriangles.end());
+                MeshletBuilder::computeBounds(meshlet, data, positions);
+                data.meshlets.push_back(meshlet);
+
+                for (auto v : mVertices) mLocalIndex[v] = kInvalidIndex;
+                mVertices.clear();
+                mTriangles.clear();
+                mPositionSum = float3(0.f);
+            }
+
+        private:
+            std::vector<uint32_t> mLocalIndex;  ///< Meshlet-local index per mesh vertex, or kInvalidIndex if not in the meshlet.
+            std::vector<uint32_t> mVertices;
+            std::vector<uint32_t> mTriangles;
+            float3 mPositionSum = float3(0.f);
+        };
+    }
+
+    void MeshletData::append(const MeshletData& other)
+    {
+        const uint32_t vertexOffset = (uint32_t)vertices.size();
+        const uint32_t triangleOffset = (uint32_t)triangles.size();
+
+        meshlets.reserve(meshlets.size() + other.meshlets.size());
+        for (auto meshlet : other.meshlets)
+        {
+            meshlet.vertexOffset += vertexOffset;
+            meshlet.triangleOffset += triangleOffset;
+            meshlets.push_back(meshlet);
+        }
+        vertices.insert(vertices.end(), other.vertices.begin(), other.vertices.end());
+        triangles.insert(triangles.end(), other.triangles.begin(), other.triangles.end());
+    }
+
+    bool MeshletData::operator==(const MeshletData& other) const
+    {
+        return meshlets.size() == other.meshlets.size() &&
+            std::memcmp(meshlets.data(), other.meshlets.data(), meshlets.size() * sizeof(MeshletDesc)) == 0 &&
+            vertices == other.vertices &&
+            triangles == other.triangles;
+    }
+
+    MeshletData MeshletBuilder::build(uint32_t meshID, const uint32_t* pIndices, size_t indexCount, const std::vector<float3>& positions, uint32_t maxVertices, uint32_t maxTriangles)
+    {
+        checkArgument(indexCount % 3 == 0, "'indexCount' must be a multiple of 3.");
+        checkArgument(maxVertices >= 3 && maxVertices <= kMaxVertices, "'maxVertices' must be in the range [3, {}].", kMaxVertices);
+        checkArgument(maxTriangles >= 1 && maxTriangles <= kMaxTriangles, "'maxTriangles' must be in the range [1, {}].", kMaxTriangles);
+
+        MeshletData data;
+        const size_t vertexCount = positions.size();
+        const size_t triangleCount = indexCount / 3;
+        if (triangleCount == 0) return data;
+
+        // Build vertex to triangle adjacency.
+        std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+        for (size_t i = 0; i < indexCount; i++)
+        {
+            FALCOR_ASSERT(pIndices[i] < vertexCount);
+            adjacencyOffsets[pIndices[i] + 1]++;
+        }
+        for (size_t v = 0; v < vertexCount; v++) adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+
+        std::vector<uint32_t> adjacency(indexCount);
+        {
+            std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+            for (size_t i = 0; i < indexCount; i++) adjacency[fill[pIndices[i]]++] = (uint32_t)(i / 3);
+        }
+
+        // Number of not yet emitted triangles per vertex. Used to skip exhausted vertices when searching for candidates.
+        std::vector<uint32_t> liveCount(vertexCount);
+        for (size_t v = 0; v < vertexCount; v++) liveCount[v] = adjacencyOffsets[v + 1] - adjacencyOffsets[v];
+
+        std::vector<bool> emitted(triangleCount, false);
+        MeshletAccumulator meshlet(vertexCount);
+        size_t seed = 0;
+
+        for (size_t emittedCount = 0; emittedCount < triangleCount; emittedCount++)
+        {
+            if (meshlet.getTriangleCount() == maxTriangles) meshlet.flush(meshID, data, positions);
+
+            // Find the best connected triangle that still fits into the current meshlet.
+            uint32_t best = kInvalidIndex;
+            if (!meshlet.empty())
+            {
+                const float3 centroid = meshlet.getCentroid();
+                uint32_t bestNewVertices = 4;
+                float bestDistance = std::numeric_limits<float>::infinity();
+
+                for (uint32_t v : meshlet.getVertices())
+                {
+                    if (liveCount[v] == 0) continue;
+                    for (uint32_t j = adjacencyOffsets[v]; j < adjacencyOffsets[v + 1]; j++)
+                    {
+                        const uint32_t t = adjacency[j];
+                        if (emitted[t]) continue;
+
+                        const uint32_t* pTriangle = pIndices + 3 * t;
+                        const uint32_t newVertices = meshlet.getNewVertexCount(pTriangle);
+                        if (meshlet.getVertexCount() + newVertices > maxVertices || newVertices > bestNewVertices) continue;
+
+                        const float3 d = (positions[pTriangle[0]] + positions[pTriangle[1]] + positions[pTriangle[2]]) / 3.f - centroid;
+                        const float distance = glm::dot(d, d);
+                        if (newVertices < bestNewVertices || distance < bestDistance)
+                        {
+                            best = t;
+                            bestNewVertices = newVertices;
+                            bestDistance = distance;
+                        }
+                    }
+                }
+            }
+
+            // Start a new meshlet from the first remaining triangle in index order if nothing fits.
+            if (best == kInvalidIndex)
+            {
+                if (!meshlet.empty()) meshlet.flush(meshID, data, positions);
+                while (emitted[seed]) seed++;
+                best = (uint32_t)seed;
+            }
+
+            const uint32_t* pTriangle = pIndices + 3 * best;
+            meshlet.addTriangle(pTriangle, positions);
+            emitted[best] = true;
+            for (uint32_t i = 0; i < 3; i++) liveCount[pTriangle[i]]--;
+        }
+
+        if (!meshlet.empty()) meshlet.flush(meshID, data, positions);
+
+        return data;
+    }
+
+    void MeshletBuilder::computeBounds(MeshletDesc& meshlet, const MeshletData& data, const std::vector<float3>& positions)
+    {
+        const uint32_t vertexCount = meshlet.getVertexCount();
+        const uint32_t triangleCount = meshlet.getTriangleCount();
+        FALCOR_ASSERT(meshlet.vertexOffset + vertexCount <= data.vertices.size());
+        FALCOR_ASSERT(meshlet.triangleOffset + triangleCount <= data.triangles.size());
+
+        auto getPosition = [&](uint32_t localIndex) { return positions[data.vertices[meshlet.vertexOffset + localIndex]]; };
+
+        // Compute bounding sphere using Ritter's algorithm.
+        // The initial sphere is spanned by two approximately most distant points and is then grown to include all points.
+        auto findFarthest = [&](const float3& p)
+        {
+            uint32_t farthest = 0;
+            float maxDistance = -1.f;
+            for (uint32_t i = 0; i < vertexCount; i++)
+            {
+                float3 d = getPosition(i) - p;
+                if (glm::dot(d, d) > maxDistance)
+                {
+                    maxDistance = glm::dot(d, d);
+                    farthest = i;
+                }
+            }
+            return getPosition(farthest);
+        };
+
+        float3 center(0.f);
+        float radius = 0.f;
+        if (vertexCount > 0)
+        {
+            const float3 p1 = findFarthest(getPosition(0));
+            const float3 p2 = findFarthest(p1);
+            center = (p1 + p2) * 0.5f;
+            radius = glm::length(p2 - p1) * 0.5f;
+
+            for (uint32_t i = 0; i < vertexCount; i++)
+            {
+                const float3 p = getPosition(i);
+                const float distance = glm::length(p - center);
+                if (distance > radius)
+                {
+                    const float newRadius = (radius + distance) * 0.5f;
+                    center += (p - center) * ((newRadius - radius) / distance);
+                    radius = newRadius;
+                }
+            }
+
+            // Make sure all points are inside the sphere despite rounding errors.
+            for (uint32_t i = 0; i < vertexCount; i++) radius = std::max(radius, glm::length(getPosition(i) - center));
+        }
+
+        meshlet.center = center;
+        meshlet.radius = radius;
+
+        // Compute normal cone from the normalized face normals. Degenerate triangles are ignored.
+        std::vector<float3> normals;
+        normals.reserve(triangleCount);
+        float3 normalSum(0.f);
+        for (uint32_t i = 0; i < triangleCount; i++)
+        {
+            const uint3 t = unpackTriangle(data.triangles[meshlet.triangleOffset + i]);
+            const float3 n = glm::cross(getPosition(t.y) - getPosition(t.x), getPosition(t.z) - getPosition(t.x));
+            const float len = glm::length(n);
+            if (len > 0.f)
+            {
+                normals.push_back(n / len);
+                normalSum += n / len;
+            }
+        }
+
+        meshlet.coneAxis = float3(0.f);
+        meshlet.coneCutoff = 1.f;
+
+        const float sumLength = glm::length(normalSum);
+        if (normals.empty() || sumLength == 0.f) return;
+
+        const float3 axis = normalSum / sumLength;
+        float minDot = 1.f;
+        for (const auto& n : normals) minDot = std::min(minDot, glm::dot(axis, n));
+
+        // Cones wider than ~84 degrees (half-angle) are not useful for culling.
+        if (minDot <= 0.1f) return;
+
+        meshlet.coneAxis = axis;
+        meshlet.coneCutoff = std::sqrt(1.f - minDot * minDot);
+    }
+}
@@ -0,0 +1,97 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "SceneTypes.slang"
+#include "Core/Macros.h"
+#include "Utils/Math/Vector.h"
+#include <cstdint>
+#include <vector>
+
+namespace Falcor
+{
+    /** Meshlet data for one or more meshes.
+        This is the CPU representation of the meshlet buffers used by the scene.
+    */
+    struct FALCOR_API MeshletData
+    {
+        std::vector<MeshletDesc> meshlets;  ///< Meshlet descriptors, sorted by mesh ID.
+        std::vector<uint32_t> vertices;     ///< Vertex indices referenced by the meshlets, relative to the first vertex of the mesh.
+        std::vector<uint32_t> triangles;    ///< Triangles of the meshlets, three meshlet-local vertex indices packed in 8 bits each.
+
+        bool empty() const { return meshlets.empty(); }
+
+        /** Append meshlet data. The vertex and triangle offsets of the appended meshlets are adjusted accordingly.
+            \param[in] other Meshlet data to append.
+        */
+        void append(const MeshletData& other);
+
+        bool operator==(const MeshletData& other) const;
+    };
+
+    /** Helper class for partitioning triangle meshes into meshlets.
+    */
+    class FALCOR_API MeshletBuilder
+    {
+    public:
+        static constexpr uint32_t kDefaultMaxVertices = 64;
+        static constexpr uint32_t kDefaultMaxTriangles = 124;
+        static constexpr uint32_t kMaxVertices = 256;       ///< Limit imposed by the 8-bit meshlet-local vertex indices.
+        static constexpr uint32_t kMaxTriangles = 0xffff;   ///< Limit imposed by the 16-bit triangle count.
+
+        /** Partition an indexed triangle list into meshlets.
+            Triangles are added greedily to the current meshlet, preferring triangles that share the most vertices with it,
+            then triangles closest to its centroid. A new meshlet is started when no connected triangle fits anymore.
+            The vertex order within each triangle is preserved, so the winding does not change.
+            \param[in] meshID Mesh ID to store in the meshlets.
+            \param[in] pIndices Triangle list indices.
+            \param[in] indexCount Number of indices. Must be a multiple of 3.
+            \param[in] positions Vertex positions in object space. All indices must be smaller than the number of positions.
+            \param[in] maxVertices Maximum number of vertices per meshlet.
+            \param[in] maxTriangles Maximum number of triangles per meshlet.
+            \return Meshlet data with offsets relative to the returned buffers.
+        */
+        static MeshletData build(uint32_t meshID, const uint32_t* pIndices, size_t indexCount, const std::vector<float3>& positions,
+            uint32_t maxVertices = kDefaultMaxVertices, uint32_t maxTriangles = kDefaultMaxTriangles);
+
+        /** Compute the bounding sphere and normal cone of a meshlet.
+            The vertex and triangle ranges of the meshlet must be set.
+            \param[in,out] meshlet Meshlet whose bounds are updated.
+            \param[in] data Meshlet data holding the vertices and triangles of the meshlet.
+            \param[in] positions Vertex positions of the mesh in object space.
+        */
+        static void computeBounds(MeshletDesc& meshlet, const MeshletData& data, const std::vector<float3>& positions);
+
+        /** Pack a meshlet-local triangle.
+        */
+        static uint32_t packTriangle(uint32_t v0, uint32_t v1, uint32_t v2) { return v0 | (v1 << 8) | (v2 << 16); }
+
+        /** Unpack a meshlet-local triangle.
+        */
+        static uint3 unpackTriangle(uint32_t packed) { return uint3(packed & 0xff, (packed >> 8) & 0xff, (packed >> 16) & 0xff); }
+    };
+}
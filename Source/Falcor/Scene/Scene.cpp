@@ -66,6 +66,9 @@ namespace Falcor
         const std::string kParameterBlockName = "gScene";
         const std::string kGeometryInstanceBufferName = "geometryInstances";
         const std::string kMeshBufferName = "meshes";
+        const std::string kMeshletBufferName = "meshlets";
+        const std::string kMeshletVertexBufferName = "meshletVertices";
+        const std::string kMeshletTriangleBufferName = "meshletTriangles";
         const std::string kIndexBufferName = "indexData";
         const std::string kVertexBufferName = "vertices";
         const std::string kPrevVertexBufferName = "prevVertices";
@@ -175,10 +178,12 @@ namespace Falcor
         mMeshBBs = std::move(sceneData.meshBBs);
         mMeshIdToInstanceIds = std::move(sceneData.meshIdToInstanceIds);
         mMeshGroups = std::move(sceneData.meshGroups);
+        mMeshletData = std::move(sceneData.meshletData);
 
         mUseCompressedHitInfo = sceneData.useCompressedHitInfo;
         mHas16BitIndices = sceneData.has16BitIndices;
         mHas32BitIndices = sceneData.has32BitIndices;
+        mVertexCacheStats = sceneData.meshVertexCacheStats;
 
         mCurveDesc = std::move(sceneData.curveDesc);
         mCurveBBs = std::move(sceneData.curveBBs);
@@ -755,6 +760,16 @@ namespace Falcor
             mpMeshesBuffer->setName("Scene::mpMeshesBuffer");
         }
 
+        if (!mMeshletData.empty() && !mpMeshletsBuffer)
+        {
+            mpMeshletsBuffer = Buffer::createStructured(mpDevice.get(), mpSceneBlock[kMeshletBufferName], (uint32_t)mMeshletData.meshlets.size(), Resource::BindFlags::ShaderResource, Buffer::CpuAccess::None, mMeshletData.meshlets.data(), false);
+            mpMeshletsBuffer->setName("Scene::mpMeshletsBuffer");
+            mpMeshletVerticesBuffer = Buffer::createStructured(mpDevice.get(), mpSceneBlock[kMeshletVertexBufferName], (uint32_t)mMeshletData.vertices.size(), Resource::BindFlags::ShaderResource, Buffer::CpuAccess::None, mMeshletData.vertices.data(), false);
+            mpMeshletVerticesBuffer->setName("Scene::mpMeshletVerticesBuffer");
+            mpMeshletTrianglesBuffer = Buffer::createStructured(mpDevice.get(), mpSceneBlock[kMeshletTriangleBufferName], (uint32_t)mMeshletData.triangles.size(), Resource::BindFlags::ShaderResource, Buffer::CpuAccess::None, mMeshletData.triangles.data(), false);
+            mpMeshletTrianglesBuffer->setName("Scene::mpMeshletTrianglesBuffer");
+        }
+
         if (!mCurveDesc.empty() &&
             (!mpCurvesBuffer || mpCurvesBuffer->getElementCount() < mCurveDesc.size()))
         {
@@ -788,6 +803,9 @@ namespace Falcor
         // Bind resources to parameter block.
         mpSceneBlock[kGeometryInstanceBufferName] = mpGeometryInstancesBuffer;
         mpSceneBlock[kMeshBufferName] = mpMeshesBuffer;
+        mpSceneBlock[kMeshletBufferName] = mpMeshletsBuffer;
+        mpSceneBlock[kMeshletVertexBufferName] = mpMeshletVerticesBuffer;
+        mpSceneBlock[kMeshletTriangleBufferName] = mpMeshletTrianglesBuffer;
         mpSceneBlock[kCurveBufferName] = mpCurvesBuffer;
         mpSceneBlock[kSpectralProfilesBufferName] = mpSpectralProfilesBuffer;
         mpSceneBlock[kLightsBufferName] = mpLightsBuffer;
@@ -1275,11 +1293,14 @@ namespace Falcor
         auto& s = mSceneStats;
 
         s.meshCount = getMeshCount();
+        s.meshletCount = getMeshletCount();
         s.meshInstanceCount = 0;
         s.meshInstanceOpaqueCount = 0;
         s.transformCount = getAnimationController()->getGlobalMatrices().size();
         s.uniqueVertexCount = 0;
         s.uniqueTriangleCount = 0;
+        s.vertexCacheACMR = mVertexCacheStats.getACMR();
+        s.vertexCacheATVR = mVertexCacheStats.getATVR();
         s.instancedVertexCount = 0;
         s.instancedTriangleCount = 0;
         s.curveCount = getCurveCount();
@@ -1379,6 +1400,9 @@ namespace Falcor
 
         s.geometryMemoryInBytes += mpGeometryInstancesBuffer ? mpGeometryInstancesBuffer->getSize() : 0;
         s.geometryMemoryInBytes += mpMeshesBuffer ? mpMeshesBuffer->getSize() : 0;
+        s.geometryMemoryInBytes += mpMeshletsBuffer ? mpMeshletsBuffer->getSize() : 0;
+        s.geometryMemoryInBytes += mpMeshletVerticesBuffer ? mpMeshletVerticesBuffer->getSize() : 0;
+        s.geometryMemoryInBytes += mpMeshletTrianglesBuffer ? mpMeshletTrianglesBuffer->getSize() : 0;
         s.geometryMemoryInBytes += mpCurvesBuffer ? mpCurvesBuffer->getSize() : 0;
         s.geometryMemoryInBytes += mpCustomPrimitivesBuffer ? mpCustomPrimitivesBuffer->getSize() : 0;
         s.geometryMemoryInBytes += mpRtAABBBuffer ? mpRtAABBBuffer->getSize() : 0;
@@ -2078,6 +2102,9 @@ namespace Falcor
                 << "  Unique vertex count: " << s.uniqueVertexCount << std::endl
                 << "  Instanced triangle count: " << s.instancedTriangleCount << std::endl
                 << "  Instanced vertex count: " << s.instancedVertexCount << std::endl
+                << "  Meshlet count: " << s.meshletCount << std::endl
+                << "  Vertex cache ACMR: " << s.vertexCacheACMR << std::endl
+                << "  Vertex cache ATVR: " << s.vertexCacheATVR << std::endl
                 << "  Index  buffer memory: " << formatByteSize(s.indexMemoryInBytes) << std::endl
                 << "  Vertex buffer memory: " << formatByteSize(s.vertexMemoryInBytes) << std::endl
                 << "  Geometry data memory: " << formatByteSize(s.geometryMemoryInBytes) << std::endl
@@ -4029,6 +4056,9 @@ namespace Falcor
         d["uniqueVertexCount"] = uniqueVertexCount;
         d["instancedTriangleCount"] = instancedTriangleCount;
         d["instancedVertexCount"] = instancedVertexCount;
+        d["meshletCount"] = meshletCount;
+        d["vertexCacheACMR"] = vertexCacheACMR;
+        d["vertexCacheATVR"] = vertexCacheATVR;
         d["indexMemoryInBytes"] = indexMemoryInBytes;
         d["vertexMemoryInBytes"] = vertexMemoryInBytes;
         d["geometryMemoryInBytes"] = geometryMemoryInBytes;
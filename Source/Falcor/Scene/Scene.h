@@ -29,6 +29,7 @@
 #include "SceneIDs.h"
 #include "SceneTypes.slang"
 #include "HitInfo.h"
+#include "MeshletBuilder.h"
 #include "Animation/Animation.h"
 #include "Animation/AnimationController.h"
 #include "Displacement/DisplacementUpdateTask.slang"
@@ -47,6 +48,7 @@
 #include "Core/Macros.h"
 #include "Core/API/VAO.h"
 #include "Core/API/RtAccelerationStructure.h"
+#include "Utils/Algorithm/VertexCacheOptimizer.h"
 #include "Utils/Math/AABB.h"
 #include "Utils/Math/Rectangle.h"
 #include "Utils/Math/Vector.h"
@@ -336,10 +338,12 @@ namespace Falcor
             bool has16BitIndices = false;                           ///< True if 16-bit mesh indices are used.
             bool has32BitIndices = false;                           ///< True if 32-bit mesh indices are used.
             uint32_t meshDrawCount = 0;                             ///< Number of meshes to draw.
+            VertexCacheStats meshVertexCacheStats;                  ///< Post-transform vertex cache statistics of all indexed meshes. Only computed if SceneBuilder::Flags::OptimizeVertexCache is set.
 
             std::vector<uint32_t> meshIndexData;                    ///< Vertex indices for all meshes in either 32-bit or 16-bit format packed tightly, decided per mesh.
             std::vector<PackedStaticVertexData> meshStaticData;     ///< Vertex attributes for all meshes in packed format.
             std::vector<SkinningVertexData> meshSkinningData;       ///< Additional vertex attributes for skinned meshes.
+            MeshletData meshletData;                                ///< Meshlets of all static meshes. Only generated if SceneBuilder::Flags::GenerateMeshlets is set.
 
             // Curve data
             std::vector<CurveDesc> curveDesc;                       ///< List of curve descriptors.
@@ -374,10 +378,13 @@ namespace Falcor
             uint64_t uniqueVertexCount = 0;             ///< Number of unique vertices. A vertex can be referenced by multiple triangles/instances.
             uint64_t instancedTriangleCount = 0;        ///< Number of instanced triangles. This is the total number of rendered triangles.
             uint64_t instancedVertexCount = 0;          ///< Number of instanced vertices. This is the total number of vertices in the rendered triangles.
+            uint64_t meshletCount = 0;                  ///< Number of meshlets.
             uint64_t indexMemoryInBytes = 0;            ///< Total memory in bytes used by the index buffer.
             uint64_t vertexMemoryInBytes = 0;           ///< Total memory in bytes used by the vertex buffer.
             uint64_t geometryMemoryInBytes = 0;         ///< Total memory in bytes used by the geometry data (meshes, curves, custom primitives, instances etc.).
             uint64_t animationMemoryInBytes = 0;        ///< Total memory in bytes used by the animation system (transforms, skinning buffers).
+            float vertexCacheACMR = 0.f;                ///< Average vertex cache miss ratio (vertex shader invocations per triangle) of the mesh index buffers. Only computed if SceneBuilder::Flags::OptimizeVertexCache is set, zero otherwise.
+            float vertexCacheATVR = 0.f;                ///< Average transform to vertex ratio (vertex shader invocations per vertex) of the mesh index buffers. Only computed if SceneBuilder::Flags::OptimizeVertexCache is set, zero otherwise.
 
             // Curve stats
             uint64_t curveCount = 0;                    ///< Number of curves.
@@ -720,6 +727,15 @@ namespace Falcor
         */
         const MeshDesc& getMesh(MeshID meshID) const { return mMeshDesc[meshID.get()]; }
 
+        /** Get the number of meshlets.
+        */
+        uint32_t getMeshletCount() const { return (uint32_t)mMeshletData.meshlets.size(); }
+
+        /** Get the meshlet data. This is a copy of the meshlet GPU buffers.
+            Meshlets are only generated if the scene was built with SceneBuilder::Flags::GenerateMeshlets.
+        */
+        const MeshletData& getMeshletData() const { return mMeshletData; }
+
         /** Get the number of curves.
         */
         uint32_t getCurveCount() const { return (uint32_t)mCurveDesc.size(); }
@@ -1247,6 +1263,7 @@ namespace Falcor
         bool mUseCompressedHitInfo = false;                         ///< True if scene should used compressed HitInfo (on scenes with triangles meshes only).
         bool mHas16BitIndices = false;                              ///< True if any meshes use 16-bit indices.
         bool mHas32BitIndices = false;                              ///< True if any meshes use 32-bit indices.
+        VertexCacheStats mVertexCacheStats;                         ///< Post-transform vertex cache statistics of the mesh index buffers.
 
         Vao::SharedPtr mpMeshVao;                                   ///< Vertex array object for the global mesh vertex/index buffers.
         Vao::SharedPtr mpMeshVao16Bit;                              ///< VAO for drawing meshes with 16-bit vertex indices.
@@ -1258,6 +1275,7 @@ namespace Falcor
         std::vector<std::vector<Rectangle>> mMeshUVTiles;           ///< Bounding tiles for the mesh UVs
         std::vector<MeshGroup> mMeshGroups;                         ///< Groups of meshes. Each group maps to a BLAS for ray tracing.
         std::vector<std::string> mMeshNames;                        ///< Mesh names, indxed by mesh ID
+        MeshletData mMeshletData;                                   ///< Copy of meshlet data GPU buffers (mpMeshletsBuffer etc.).
         std::vector<Node> mSceneGraph;                              ///< For each index i, the array element indicates the parent node. Indices are in relation to mLocalToWorldMatrices.
 
         // Displacement mapping.
@@ -1330,6 +1348,9 @@ namespace Falcor
         // Scene block resources
         Buffer::SharedPtr mpGeometryInstancesBuffer;
         Buffer::SharedPtr mpMeshesBuffer;
+        Buffer::SharedPtr mpMeshletsBuffer;
+        Buffer::SharedPtr mpMeshletVerticesBuffer;
+        Buffer::SharedPtr mpMeshletTrianglesBuffer;
         Buffer::SharedPtr mpCurvesBuffer;
         Buffer::SharedPtr mpCustomPrimitivesBuffer;
         Buffer::SharedPtr mpLightsBuffer;
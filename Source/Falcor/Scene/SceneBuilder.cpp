@@ -29,19 +29,28 @@
 #include "SceneBuilderAccess.h"
 #include "SceneCache.h"
 #include "Importer.h"
+#include "MeshletBuilder.h"
+#include "VertexWelder.h"
 #include "Curves/CurveConfig.h"
 #include "Material/StandardMaterial.h"
 #include "Rendering/Materials/PLT/PLTDiffuseMaterial.h"
 #include "Utils/Logger.h"
+#include "Utils/Threading.h"
+#include "Utils/Algorithm/VertexCacheOptimizer.h"
 #include "Utils/Math/Common.h"
 #include "Utils/Image/TextureAnalyzer.h"
+#include "Utils/Timing/Profiler.h"
 #include "Utils/Timing/TimeReport.h"
+#include "Utils/StringUtils.h"
 #include "Utils/Scripting/ScriptBindings.h"
 #include "Utils/Math/MathHelpers.h"
+#include "Utils/Color/SpectralDatabase.h"
 #include "Utils/Color/SpectrumUtils.h"
+#include "Utils/Math/FNVHash.h"
 #include <mikktspace.h>
 #include <filesystem>
 #include <cmath>
+#include <cstring>
 #include <random>
 
 namespace Falcor
@@ -165,20 +174,6 @@ namespace Falcor
             if (isZero(v.normal) || isZero(v.tangent.xyz())) zeroCount++;
         }
 
-        bool compareVertices(const SceneBuilder::Mesh::Vertex& lhs, const SceneBuilder::Mesh::Vertex& rhs, float threshold = 1e-6f)
-        {
-            using namespace glm;
-            if (lhs.position != rhs.position) return false; // Position need to be exact to avoid cracks
-            if (lhs.tangent.w != rhs.tangent.w) return false;
-            if (lhs.curveRadius != rhs.curveRadius) return false;
-            if (lhs.boneIDs != rhs.boneIDs) return false;
-            if (any(greaterThan(abs(lhs.normal - rhs.normal), float3(threshold)))) return false;
-            if (any(greaterThan(abs(lhs.tangent.xyz - rhs.tangent.xyz), float3(threshold)))) return false;
-            if (any(greaterThan(abs(lhs.texCrd - rhs.texCrd), float2(threshold)))) return false;
-            if (any(greaterThan(abs(lhs.boneWeights - rhs.boneWeights), float4(threshold)))) return false;
-            return true;
-        }
-
         std::vector<uint32_t> compact16BitIndices(const std::vector<uint32_t>& indices)
         {
             if (indices.empty()) return {};
@@ -195,7 +190,7 @@ namespace Falcor
 
         SceneCache::Key computeSceneCacheKey(const std::filesystem::path& path, SceneBuilder::Flags buildFlags)
         {
-            SceneBuilder::Flags cacheFlags = buildFlags & (~(SceneBuilder::Flags::UseCache | SceneBuilder::Flags::RebuildCache));
+            SceneBuilder::Flags cacheFlags = buildFlags & (~(SceneBuilder::Flags::UseCache | SceneBuilder::Flags::RebuildCache | SceneBuilder::Flags::UseAssetCache | SceneBuilder::Flags::UseTextureCache));
             SHA1 sha1;
             auto pathStr = path.string();
             sha1.update(pathStr.data(), pathStr.size());
@@ -203,6 +198,59 @@ namespace Falcor
             return sha1.finalize();
 
         }
+
+        /** Specifies the version of processed meshes in the asset cache.
+            This needs to be incremented every time processMesh() or the serialization below changes!
+        */
+        const uint32_t kProcessedMeshCacheVersion = 1;
+
+        std::vector<uint8_t> serializeProcessedMesh(const SceneBuilder::ProcessedMesh& mesh)
+        {
+            std::vector<uint8_t> data;
+            auto write = [&data](const void* pData, size_t size)
+            {
+                data.insert(data.end(), reinterpret_cast<const uint8_t*>(pData), reinterpret_cast<const uint8_t*>(pData) + size);
+            };
+            auto writeVector = [&write](const auto& vec)
+            {
+                uint64_t count = vec.size();
+                write(&count, sizeof(count));
+                write(vec.data(), count * sizeof(vec[0]));
+            };
+
+            write(&mesh.indexCount, sizeof(mesh.indexCount));
+            write(&mesh.use16BitIndices, sizeof(mesh.use16BitIndices));
+            writeVector(mesh.indexData);
+            writeVector(mesh.staticData);
+            writeVector(mesh.skinningData);
+            return data;
+        }
+
+        bool deserializeProcessedMesh(const std::vector<uint8_t>& data, SceneBuilder::ProcessedMesh& mesh)
+        {
+            size_t offset = 0;
+            auto read = [&](void* pData, size_t size)
+            {
+                if (size > data.size() - offset) return false;
+                std::memcpy(pData, data.data() + offset, size);
+                offset += size;
+                return true;
+            };
+            auto readVector = [&](auto& vec)
+            {
+                uint64_t count = 0;
+                if (!read(&count, sizeof(count)) || count > (data.size() - offset) / sizeof(vec[0])) return false;
+                vec.resize(count);
+                return read(vec.data(), count * sizeof(vec[0]));
+            };
+
+            return read(&mesh.indexCount, sizeof(mesh.indexCount)) &&
+                read(&mesh.use16BitIndices, sizeof(mesh.use16BitIndices)) &&
+                readVector(mesh.indexData) &&
+                readVector(mesh.staticData) &&
+                readVector(mesh.skinningData) &&
+                offset == data.size();
+        }
     }
 
     SceneBuilder::SceneBuilder(std::shared_ptr<Device> pDevice, const Settings& settings, Flags flags)
@@ -212,6 +260,17 @@ namespace Falcor
     {
         mpFence = GpuFence::create(mpDevice.get());
         mSceneData.pMaterials = MaterialSystem::create(mpDevice);
+        if (is_set(mFlags, Flags::UseAssetCache))
+        {
+            mpAssetCache = std::make_shared<AssetCache>();
+            mSceneData.pMaterials->getTextureManager()->setAnalysisCache(mpAssetCache);
+        }
+        if (is_set(mFlags, Flags::UseTextureCache))
+        {
+            TextureManager::TextureCacheDesc desc;
+            desc.enabled = true;
+            mSceneData.pMaterials->getTextureManager()->setTextureCache(desc);
+        }
     }
 
     SceneBuilder::SharedPtr SceneBuilder::create(std::shared_ptr<Device> pDevice, const Settings& settings, Flags flags)
@@ -279,9 +338,14 @@ namespace Falcor
     {
         if (mpScene) return mpScene;
 
+        FALCOR_PROFILE_CPU("SceneBuilder::getScene");
+
         // Finish loading textures. This blocks until all textures are loaded and assigned.
         mpMaterialTextureLoader.reset();
 
+        // Process meshes that were added with Flags::DeferMeshProcessing.
+        processDeferredMeshes();
+
         // If no meshes were added, we create a dummy mesh to keep the scene generation working.
         // Scenes with no meshes can be useful for example when using volumes in isolation.
         if (mMeshes.empty())
@@ -314,6 +378,8 @@ namespace Falcor
         createMeshGroups();
         optimizeGeometry();
         sortMeshes();
+        optimizeVertexCache();
+        createMeshlets();
         createGlobalBuffers();
         createCurveGlobalBuffers();
         collectVolumeGrids();
@@ -350,6 +416,19 @@ namespace Falcor
             timeReport.measure("Writing cache");
         }
 
+        if (mpAssetCache)
+        {
+            const auto stats = mpAssetCache->getStats();
+            logInfo("Asset cache: {} hits, {} misses, {} reused, {} written.", stats.hitCount, stats.missCount, formatByteSize(stats.bytesSaved), formatByteSize(stats.bytesWritten));
+        }
+
+        if (is_set(mFlags, Flags::UseTextureCache))
+        {
+            const auto stats = mSceneData.pMaterials->getTextureManager()->getStats();
+            logInfo("Texture cache: {} warm loads in {:.2f}s, {} cold loads in {:.2f}s, {} on disk.",
+                stats.textureCacheHitCount, stats.textureCacheHitLoadTime, stats.textureCacheMissCount, stats.textureCacheMissLoadTime, formatByteSize(stats.textureCacheDiskSizeInBytes));
+        }
+
         // Create the scene object.
         mpScene = Scene::create(mpDevice, std::move(mSceneData));
         mSceneData = {};
@@ -364,7 +443,98 @@ namespace Falcor
 
     MeshID SceneBuilder::addMesh(const Mesh& mesh)
     {
-        return addProcessedMesh(processMesh(mesh));
+        if (!is_set(mFlags, Flags::DeferMeshProcessing)) return addProcessedMesh(processMesh(mesh));
+
+        // Allocate the mesh ID and material ID up front so that IDs are the same as with immediate processing.
+        MeshSpec spec;
+        spec.name = mesh.name;
+        spec.topology = mesh.topology;
+        spec.materialId = addMaterial(mesh.pMaterial);
+        MeshID meshID = addMeshSpec(std::move(spec));
+
+        // Copy the mesh data as the caller retains ownership of it.
+        // The data pointers are redirected to the copies before processing in processDeferredMeshes().
+        auto& deferred = mDeferredMeshes.emplace_back();
+        deferred.meshID = meshID;
+        deferred.mesh = mesh;
+
+        auto copyAttribute = [&mesh](const auto& attribute, auto& data)
+        {
+            if (attribute.pData) data.assign(attribute.pData, attribute.pData + mesh.getAttributeCount(attribute));
+        };
+
+        if (mesh.pIndices) deferred.indices.assign(mesh.pIndices, mesh.pIndices + mesh.indexCount);
+        copyAttribute(mesh.positions, deferred.positions);
+        copyAttribute(mesh.normals, deferred.normals);
+        copyAttribute(mesh.tangents, deferred.tangents);
+        copyAttribute(mesh.texCrds, deferred.texCrds);
+        copyAttribute(mesh.curveRadii, deferred.curveRadii);
+        copyAttribute(mesh.boneIDs, deferred.boneIDs);
+        copyAttribute(mesh.boneWeights, deferred.boneWeights);
+
+        return meshID;
+    }
+
+    std::vector<MeshID> SceneBuilder::addMeshes(fstd::span<const Mesh> meshes)
+    {
+        FALCOR_PROFILE_CPU("SceneBuilder::addMeshes");
+
+        std::vector<ProcessedMesh> processedMeshes(meshes.size());
+        Threading::parallelFor(0, meshes.size(), 1, [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++) processedMeshes[i] = processMesh(meshes[i]);
+        });
+
+        // Add the meshes serially in input order to get deterministic mesh and material IDs.
+        std::vector<MeshID> meshIDs;
+        meshIDs.reserve(processedMeshes.size());
+        for (auto& processedMesh : processedMeshes)
+        {
+            MeshSpec spec;
+            spec.materialId = addMaterial(processedMesh.pMaterial);
+            setProcessedMeshData(spec, std::move(processedMesh));
+            meshIDs.push_back(addMeshSpec(std::move(spec)));
+        }
+
+        return meshIDs;
+    }
+
+    void SceneBuilder::processDeferredMeshes()
+    {
+        if (mDeferredMeshes.empty()) return;
+
+        FALCOR_PROFILE_CPU("SceneBuilder::processDeferredMeshes");
+
+        logInfo("Processing {} deferred meshes.", mDeferredMeshes.size());
+
+        // Each deferred mesh writes to its own mesh spec, so the specs can be updated in parallel.
+        Threading::parallelFor(0, mDeferredMeshes.size(), 1, [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++)
+            {
+                DeferredMesh& deferred = mDeferredMeshes[i];
+                Mesh& mesh = deferred.mesh;
+
+                auto bindAttribute = [](auto& attribute, const auto& data) { attribute.pData = data.empty() ? nullptr : data.data(); };
+
+                mesh.pIndices = deferred.indices.empty() ? nullptr : deferred.indices.data();
+                bindAttribute(mesh.positions, deferred.positions);
+                bindAttribute(mesh.normals, deferred.normals);
+                bindAttribute(mesh.tangents, deferred.tangents);
+                bindAttribute(mesh.texCrds, deferred.texCrds);
+                bindAttribute(mesh.curveRadii, deferred.curveRadii);
+                bindAttribute(mesh.boneIDs, deferred.boneIDs);
+                bindAttribute(mesh.boneWeights, deferred.boneWeights);
+
+                FALCOR_ASSERT(deferred.meshID.get() < mMeshes.size());
+                setProcessedMeshData(mMeshes[deferred.meshID.get()], processMesh(mesh));
+
+                // Release the copied mesh data as soon as possible.
+                deferred = {};
+            }
+        });
+
+        mDeferredMeshes.clear();
     }
 
     MeshID SceneBuilder::addTriangleMesh(const TriangleMesh::SharedPtr& pTriangleMesh, const Material::SharedPtr& pMaterial)
@@ -449,6 +619,17 @@ namespace Falcor
             if (mesh.boneWeights.pData == nullptr) throw_on_missing_element("bone weights");
         }
 
+        // Reuse the processed mesh from the asset cache if the mesh is unchanged.
+        // Attribute indices are not cached, so the cache is bypassed if they are requested.
+        const bool useAssetCache = mpAssetCache && !pAttributeIndices;
+        AssetCache::Key cacheKey;
+        if (useAssetCache)
+        {
+            cacheKey = computeMeshCacheKey(mesh);
+            auto data = mpAssetCache->read(cacheKey);
+            if (data && deserializeProcessedMesh(*data, processedMesh)) return processedMesh;
+        }
+
         // Generate tangent space if that's required.
         std::vector<float4> tangents;
         if (!(is_set(mFlags, Flags::UseOriginalTangentSpace) || mesh.useOriginalTangentSpace) || !mesh.tangents.pData)
@@ -500,7 +681,37 @@ namespace Falcor
             pAttributeIndices->reserve(mesh.vertexCount);
         }
 
-        if (mesh.mergeDuplicateVertices)
+        // Vertices can optionally be welded across original vertex indices using a hash table.
+        // This is more effective for meshes with non-indexed or poorly indexed data.
+        // A positive per-mesh 'vertexWelding:tolerance' attribute welds vertices whose positions are within the given tolerance.
+        // Welding is disabled if the caller needs the attribute indices, as a welded vertex can only record the indices of one of
+        // the original vertices (e.g. vertex cache animation looks up per-keyframe positions by these indices).
+        const float weldTolerance = mesh.mergeDuplicateVertices ? std::max(0.f, mSettings.getAttribute(mesh.name, "vertexWelding:tolerance", 0.f)) : 0.f;
+        const bool useVertexWelder = mesh.mergeDuplicateVertices && !pAttributeIndices && (is_set(mFlags, Flags::UseHashedVertexWelding) || weldTolerance > 0.f);
+
+        if (useVertexWelder)
+        {
+            vertices.reserve(mesh.vertexCount);
+
+            VertexWelder welder(mesh.vertexCount, weldTolerance);
+
+            for (uint32_t face = 0; face < mesh.faceCount; face++)
+            {
+                for (uint32_t vert = 0; vert < 3; vert++)
+                {
+                    const Mesh::Vertex v = mesh.getVertex(face, vert);
+
+                    uint32_t index = welder.find(v, vertices);
+                    if (index == VertexWelder::kInvalidIndex)
+                    {
+                        index = welder.insert(v, vertices);
+                    }
+
+                    indices[face * 3 + vert] = index;
+                }
+            }
+        }
+        else if (mesh.mergeDuplicateVertices)
         {
             vertices.reserve(mesh.vertexCount);
 
@@ -520,7 +731,7 @@ namespace Falcor
 
                     while (index != invalidIndex)
                     {
-                        if (compareVertices(v, vertices[index].first))
+                        if (VertexWelder::compareVertices(v, vertices[index].first))
                         {
                             found = true;
                             break;
@@ -639,9 +850,53 @@ namespace Falcor
             }
         }
 
+        if (useAssetCache) mpAssetCache->write(cacheKey, serializeProcessedMesh(processedMesh));
+
         return processedMesh;
     }
 
+    AssetCache::Key SceneBuilder::computeMeshCacheKey(const Mesh& mesh) const
+    {
+        SHA1 sha1;
+        sha1.update(kProcessedMeshCacheVersion);
+
+        // Build flags and settings used by processMesh().
+        const Flags processFlags = mFlags & (Flags::UseOriginalTangentSpace | Flags::NonIndexedVertices | Flags::Force32BitIndices | Flags::UseHashedVertexWelding);
+        sha1.update((uint32_t)processFlags);
+        sha1.update(mesh.mergeDuplicateVertices ? mSettings.getAttribute(mesh.name, "vertexWelding:tolerance", 0.f) : 0.f);
+
+        // Mesh properties.
+        sha1.update((uint32_t)mesh.topology);
+        sha1.update(mesh.faceCount);
+        sha1.update(mesh.vertexCount);
+        sha1.update(mesh.indexCount);
+        sha1.update(mesh.useOriginalTangentSpace);
+        sha1.update(mesh.mergeDuplicateVertices);
+
+        // Texture coordinates are pretransformed by the material's texture transform.
+        const rmcv::mat4 textureTransform = mesh.pMaterial->getTextureTransform().getMatrix();
+        sha1.update(&textureTransform, sizeof(textureTransform));
+
+        // Mesh data.
+        sha1.update(mesh.pIndices, mesh.indexCount * sizeof(uint32_t));
+
+        auto updateAttribute = [&](const auto& attribute)
+        {
+            sha1.update((uint32_t)attribute.frequency);
+            if (attribute.pData) sha1.update(attribute.pData, mesh.getAttributeCount(attribute) * sizeof(attribute.pData[0]));
+        };
+
+        updateAttribute(mesh.positions);
+        updateAttribute(mesh.normals);
+        updateAttribute(mesh.tangents);
+        updateAttribute(mesh.texCrds);
+        updateAttribute(mesh.curveRadii);
+        updateAttribute(mesh.boneIDs);
+        updateAttribute(mesh.boneWeights);
+
+        return sha1.finalize();
+    }
+
     void SceneBuilder::generateTangents(Mesh& mesh, std::vector<float4>& tangents) const
     {
         tangents = MikkTSpaceWrapper::generateTangents(mesh);
@@ -660,14 +915,31 @@ namespace Falcor
 
     MeshID SceneBuilder::addProcessedMesh(const ProcessedMesh& mesh)
     {
-        const bool isIndexed = !is_set(mFlags, Flags::NonIndexedVertices);
-
         MeshSpec spec;
+        spec.materialId = addMaterial(mesh.pMaterial);
+        setProcessedMeshData(spec, ProcessedMesh(mesh));
+        return addMeshSpec(std::move(spec));
+    }
+
+    MeshID SceneBuilder::addMeshSpec(MeshSpec&& spec)
+    {
+        mMeshes.push_back(std::move(spec));
+
+        if (mMeshes.size() > std::numeric_limits<uint32_t>::max())
+        {
+            throw RuntimeError("Trying to build a scene that exceeds supported number of meshes");
+        }
+
+        return MeshID(mMeshes.size() - 1);
+    }
+
+    void SceneBuilder::setProcessedMeshData(MeshSpec& spec, ProcessedMesh&& mesh) const
+    {
+        // Note this function needs to be thread safe, it is called in parallel on different specs from processDeferredMeshes().
+        const bool isIndexed = !is_set(mFlags, Flags::NonIndexedVertices);
 
-        // Add the mesh to the scene.
         spec.name = mesh.name;
         spec.topology = mesh.topology;
-        spec.materialId = addMaterial(mesh.pMaterial);
         spec.isFrontFaceCW = mesh.isFrontFaceCW;
         spec.skeletonNodeID = mesh.skeletonNodeId;
 
@@ -691,15 +963,6 @@ namespace Falcor
             spec.hasSkinningData = true;
             spec.prevVertexCount = spec.skinningVertexCount;
         }
-
-        mMeshes.push_back(spec);
-
-        if (mMeshes.size() > std::numeric_limits<uint32_t>::max())
-        {
-            throw RuntimeError("Trying to build a scene that exceeds supported number of meshes");
-        }
-
-        return MeshID(mMeshes.size() - 1);
     }
 
     void SceneBuilder::setCachedMeshes(std::vector<CachedMesh>&& cachedMeshes)
@@ -846,11 +1109,7 @@ namespace Falcor
     void SceneBuilder::loadMaterialTexture(const Material::SharedPtr& pMaterial, Material::TextureSlot slot, const std::filesystem::path& path)
     {
         checkArgument(pMaterial != nullptr, "'pMaterial' is missing");
-        if (!mpMaterialTextureLoader)
-        {
-            mpMaterialTextureLoader.reset(new MaterialTextureLoader(mSceneData.pMaterials->getTextureManager(), !is_set(mFlags, Flags::AssumeLinearSpaceTextures)));
-        }
-        mpMaterialTextureLoader->loadTexture(pMaterial, slot, path);
+        getMaterialTextureLoader().loadTexture(pMaterial, slot, path);
     }
     void SceneBuilder::loadMaterialTexture(const StandardMaterialPLTWrapper::SharedPtr& mat, Material::TextureSlot slot, const std::filesystem::path& path)
     {
@@ -862,6 +1121,21 @@ namespace Falcor
         mpMaterialTextureLoader.reset();
     }
 
+    MaterialTextureLoader& SceneBuilder::getMaterialTextureLoader()
+    {
+        if (!mpMaterialTextureLoader)
+        {
+            mpMaterialTextureLoader.reset(new MaterialTextureLoader(mSceneData.pMaterials->getTextureManager(), !is_set(mFlags, Flags::AssumeLinearSpaceTextures)));
+        }
+        return *mpMaterialTextureLoader;
+    }
+
+    void SceneBuilder::prioritizeMaterialTextures(MaterialID materialID)
+    {
+        // Materials used by instanced geometry are the ones that end up visible, so their textures are loaded first.
+        getMaterialTextureLoader().prioritizeMaterial(mSceneData.pMaterials->getMaterial(materialID));
+    }
+
     // GridVolumes
 
     GridVolume::SharedPtr SceneBuilder::getGridVolume(const std::string& name) const
@@ -961,8 +1235,21 @@ namespace Falcor
 
     SpectralProfileID SceneBuilder::addSpectralProfile(SampledSpectrum<float> spectralProfile, bool computeICdf)
     {
-        mSceneData.spectralProfiles.emplace_back(genSpectralProfile(std::move(spectralProfile), computeICdf));
-        return SpectralProfileID(mSceneData.spectralProfiles.size()-1);
+        SpectralProfile profile = genSpectralProfile(std::move(spectralProfile), computeICdf);
+
+        // Reuse an existing identical profile.
+        static_assert(sizeof(SpectralProfile) == 7 * sizeof(uint32_t) + 2 * sizeof(float) * SpectralProfile::kMaxBins, "SpectralProfile must not have padding");
+        uint64_t hash = fnvHashArray64(&profile, sizeof(profile));
+        auto range = mSpectralProfileIndex.equal_range(hash);
+        for (auto it = range.first; it != range.second; ++it)
+        {
+            if (std::memcmp(&mSceneData.spectralProfiles[it->second.get()], &profile, sizeof(profile)) == 0) return it->second;
+        }
+
+        mSceneData.spectralProfiles.push_back(profile);
+        SpectralProfileID id(mSceneData.spectralProfiles.size() - 1);
+        mSpectralProfileIndex.emplace(hash, id);
+        return id;
     }
     SpectralProfileID SceneBuilder::addSpectralProfileRGB(float3 rgb)
     {
@@ -974,28 +1261,25 @@ namespace Falcor
         SampledSpectrum<float> n(1.f), k(.0f);
         if (name != "none")
         {
-            n = SampledSpectrum<float>{ PiecewiseLinearSpectrum::fromFile(std::filesystem::path(_PROJECT_DIR_) / "../Tables/ior/" / (name + ".eta.spd")) };
-            k = SampledSpectrum<float>{ PiecewiseLinearSpectrum::fromFile(std::filesystem::path(_PROJECT_DIR_) / "../Tables/ior" / (name + ".k.spd")) };
+            const auto& database = SpectralDatabase::getDefault();
+            auto eta = database.getSpectrum("ior/" + name + ".eta");
+            auto kappa = database.getSpectrum("ior/" + name + ".k");
+            if (!eta || !kappa) throw RuntimeError("IOR profile '{}' not found.", name);
+            n = SampledSpectrum<float>{ *eta };
+            k = SampledSpectrum<float>{ *kappa };
         }
 
         return std::make_pair(addSpectralProfile(n, false), addSpectralProfile(k, false));
     }
     SpectralProfileID SceneBuilder::addSpectralProfileForEmitterType(const std::string& name, float scale)
     {
-        const auto dir = std::filesystem::path(_PROJECT_DIR_) / "../Tables/emission/";
-        for (auto const& file : std::filesystem::directory_iterator{ dir })
-        {
-            if (file.is_regular_file() && file.path().filename().string() == name + ".spd")
-            {
-                auto spectrum = PiecewiseLinearSpectrum::fromFile(file.path());
-                spectrum.scale(scale);
-                auto profile = SampledSpectrum<float>{ spectrum };
-                //profile.normalize();
-                return addSpectralProfile(std::move(profile));
-            }
-        }
+        auto spectrum = SpectralDatabase::getDefault().getSpectrum("emission/" + name);
+        if (!spectrum) throw RuntimeError("Emission profile '{}' not found.", name);
 
-        throw RuntimeError("Emission profile '{}' not found.", name);
+        spectrum->scale(scale);
+        auto profile = SampledSpectrum<float>{ *spectrum };
+        //profile.normalize();
+        return addSpectralProfile(std::move(profile));
     }
 
     void SceneBuilder::loadLightProfile(const std::string& filename, bool normalize)
@@ -1097,6 +1381,7 @@ namespace Falcor
 
         mSceneGraph[nodeID.get()].meshes.push_back(meshID);
         mMeshes[meshID.get()].instances.insert(nodeID);
+        prioritizeMaterialTextures(mMeshes[meshID.get()].materialId);
     }
 
     void SceneBuilder::addCurveInstance(NodeID nodeID, CurveID curveID)
@@ -1106,6 +1391,7 @@ namespace Falcor
 
         mSceneGraph[nodeID.get()].curves.push_back(curveID);
         mCurves[curveID.get()].instances.insert(nodeID);
+        prioritizeMaterialTextures(mCurves[curveID.get()].materialId);
     }
 
     void SceneBuilder::addSDFGridInstance(NodeID nodeID, SdfDescID sdfGridID)
@@ -1116,6 +1402,7 @@ namespace Falcor
         Scene::SDFGridDesc& desc = mSceneData.sdfGridDesc[sdfGridID.get()];
         mSceneGraph[nodeID.get()].sdfGrids.push_back(desc.sdfGridID);
         desc.instances.push_back(nodeID);
+        prioritizeMaterialTextures(desc.materialID);
 
         GeometryInstanceData instance(GeometryType::SDFGrid);
         // sdfGridID refers to the ID returned by SceneBuilder::addSDFGrid and does not necessarily reflect an ID in SceneData::sdfGrids.
@@ -2383,6 +2670,119 @@ namespace Falcor
         }
     }
 
+    void SceneBuilder::optimizeVertexCache()
+    {
+        // This function reorders the triangles and vertices of indexed meshes for rasterization performance:
+        //  - Triangles are reordered for post-transform vertex cache locality (Tipsify).
+        //  - Triangle clusters are reordered to reduce overdraw.
+        //  - Vertices are reordered in order of first use for vertex fetch locality.
+        //
+        // Vertex-animated meshes are left untouched as their cached keyframe data relies on the original vertex order.
+
+        if (!is_set(mFlags, Flags::OptimizeVertexCache) || is_set(mFlags, Flags::NonIndexedVertices)) return;
+
+        std::vector<VertexCacheStats> statsBefore(mMeshes.size());
+        std::vector<VertexCacheStats> statsAfter(mMeshes.size());
+
+        Threading::parallelFor(0, mMeshes.size(), 1, [&](size_t begin, size_t end)
+        {
+            for (size_t meshIdx = begin; meshIdx < end; meshIdx++)
+            {
+                auto& mesh = mMeshes[meshIdx];
+                if (mesh.topology != Vao::Topology::TriangleList || mesh.indexCount == 0 || mesh.isAnimated) continue;
+
+                const size_t vertexCount = mesh.staticData.size();
+                FALCOR_ASSERT(vertexCount == mesh.vertexCount);
+
+                std::vector<uint32_t> indices(mesh.indexCount);
+                for (size_t i = 0; i < indices.size(); i++) indices[i] = mesh.getIndex(i);
+
+                statsBefore[meshIdx] = analyzeVertexCache(indices.data(), indices.size(), vertexCount);
+
+                std::vector<uint32_t> clusterOffsets;
+                Falcor::optimizeVertexCache(indices.data(), indices.size(), vertexCount, kDefaultVertexCacheSize, &clusterOffsets);
+
+                std::vector<float3> positions(vertexCount);
+                for (size_t i = 0; i < vertexCount; i++) positions[i] = mesh.staticData[i].position;
+                optimizeOverdraw(indices.data(), indices.size(), positions, clusterOffsets);
+
+                std::vector<uint32_t> remap = optimizeVertexFetch(indices.data(), indices.size(), vertexCount);
+
+                std::vector<StaticVertexData> staticData(vertexCount);
+                for (size_t i = 0; i < vertexCount; i++) staticData[remap[i]] = mesh.staticData[i];
+                mesh.staticData = std::move(staticData);
+
+                // Skinning data is stored per static vertex and references the mesh local static vertex.
+                // Keep both in the same order as the previous vertex positions are indexed by skinned vertex.
+                if (!mesh.skinningData.empty())
+                {
+                    FALCOR_ASSERT(mesh.skinningData.size() == vertexCount);
+                    std::vector<SkinningVertexData> skinningData(vertexCount);
+                    for (size_t i = 0; i < vertexCount; i++)
+                    {
+                        skinningData[remap[i]] = mesh.skinningData[i];
+                        skinningData[remap[i]].staticIndex = remap[i];
+                    }
+                    mesh.skinningData = std::move(skinningData);
+                }
+
+                statsAfter[meshIdx] = analyzeVertexCache(indices.data(), indices.size(), vertexCount);
+
+                mesh.indexData = mesh.use16BitIndices ? compact16BitIndices(indices) : std::move(indices);
+            }
+        });
+
+        VertexCacheStats totalBefore;
+        VertexCacheStats totalAfter;
+        for (size_t i = 0; i < mMeshes.size(); i++)
+        {
+            totalBefore += statsBefore[i];
+            totalAfter += statsAfter[i];
+        }
+
+        logInfo("Optimized vertex cache: ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}.", totalBefore.getACMR(), totalAfter.getACMR(), totalBefore.getATVR(), totalAfter.getATVR());
+
+        mSceneData.meshVertexCacheStats = totalAfter;
+    }
+
+    void SceneBuilder::createMeshlets()
+    {
+        // This function partitions the static triangle meshes into meshlets. The meshlets reference the mesh vertices
+        // relative to the first vertex of the mesh, so this can run before the global buffers are created.
+        // Dynamic meshes are skipped as their bounds are not known at build time.
+
+        if (!is_set(mFlags, Flags::GenerateMeshlets)) return;
+
+        const uint32_t maxVertices = mSettings.getOption("meshlets:maxVertices", MeshletBuilder::kDefaultMaxVertices);
+        const uint32_t maxTriangles = mSettings.getOption("meshlets:maxTriangles", MeshletBuilder::kDefaultMaxTriangles);
+
+        std::vector<MeshletData> meshletData(mMeshes.size());
+
+        Threading::parallelFor(0, mMeshes.size(), 1, [&](size_t begin, size_t end)
+        {
+            for (size_t meshIdx = begin; meshIdx < end; meshIdx++)
+            {
+                const auto& mesh = mMeshes[meshIdx];
+                if (mesh.topology != Vao::Topology::TriangleList || mesh.isDynamic()) continue;
+
+                const size_t vertexCount = mesh.staticData.size();
+                std::vector<float3> positions(vertexCount);
+                for (size_t i = 0; i < vertexCount; i++) positions[i] = mesh.staticData[i].position;
+
+                std::vector<uint32_t> indices(mesh.indexCount > 0 ? mesh.indexCount : vertexCount);
+                for (size_t i = 0; i < indices.size(); i++) indices[i] = mesh.indexCount > 0 ? mesh.getIndex(i) : (uint32_t)i;
+
+                meshletData[meshIdx] = MeshletBuilder::build((uint32_t)meshIdx, indices.data(), indices.size(), positions, maxVertices, maxTriangles);
+            }
+        });
+
+        auto& data = mSceneData.meshletData;
+        data = {};
+        for (const auto& d : meshletData) data.append(d);
+
+        logInfo("Created {} meshlets ({} vertices, {} triangles per meshlet max).", data.meshlets.size(), maxVertices, maxTriangles);
+    }
+
     void SceneBuilder::createGlobalBuffers()
     {
         FALCOR_ASSERT(mSceneData.meshIndexData.empty());
@@ -2958,8 +3358,14 @@ namespace Falcor
         flags.value("DontUseDisplacement", SceneBuilder::Flags::DontUseDisplacement);
         flags.value("UseCompressedHitInfo", SceneBuilder::Flags::UseCompressedHitInfo);
         flags.value("TessellateCurvesIntoPolyTubes", SceneBuilder::Flags::TessellateCurvesIntoPolyTubes);
+        flags.value("DeferMeshProcessing", SceneBuilder::Flags::DeferMeshProcessing);
+        flags.value("UseHashedVertexWelding", SceneBuilder::Flags::UseHashedVertexWelding);
+        flags.value("OptimizeVertexCache", SceneBuilder::Flags::OptimizeVertexCache);
+        flags.value("GenerateMeshlets", SceneBuilder::Flags::GenerateMeshlets);
         flags.value("UseCache", SceneBuilder::Flags::UseCache);
         flags.value("RebuildCache", SceneBuilder::Flags::RebuildCache);
+        flags.value("UseAssetCache", SceneBuilder::Flags::UseAssetCache);
+        flags.value("UseTextureCache", SceneBuilder::Flags::UseTextureCache);
         ScriptBindings::addEnumBinaryOperators(flags);
 
         pybind11::class_<SceneBuilder, SceneBuilder::SharedPtr> sceneBuilder(m, "SceneBuilder");
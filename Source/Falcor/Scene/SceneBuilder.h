@@ -27,6 +27,7 @@
  **************************************************************************/
 #pragma once
 #include "Scene.h"
+#include "AssetCache.h"
 #include "SceneCache.h"
 #include "SceneIDs.h"
 #include "Transform.h"
@@ -44,9 +45,12 @@
 #include "Utils/Scripting/Dictionary.h"
 #include "Utils/Settings.h"
 
+#include <fstd/span.h> // TODO C++20: Replace with <span>
+
 #include <filesystem>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace Falcor
@@ -78,9 +82,15 @@ namespace Falcor
             DontUseDisplacement             = 0x4000,   ///< Don't use displacement mapping.
             UseCompressedHitInfo            = 0x8000,   ///< Use compressed hit info (on scenes with triangle meshes only).
             TessellateCurvesIntoPolyTubes   = 0x10000,  ///< Tessellate curves into poly-tubes (the default is linear swept spheres).
+            DeferMeshProcessing             = 0x20000,  ///< Defer processing of meshes added with addMesh() until getScene(), where all meshes are processed in parallel. The mesh data is copied when the mesh is added.
+            UseHashedVertexWelding          = 0x40000,  ///< Merge duplicate vertices using a hash table over the vertex attributes instead of per original vertex index. This also merges identical vertices that have different original indices. Not used for meshes whose attribute indices are needed, e.g. meshes with vertex cache animation.
+            OptimizeVertexCache             = 0x80000,  ///< Reorder triangles and vertices of indexed meshes for post-transform vertex cache locality, reduced overdraw and vertex fetch locality.
+            GenerateMeshlets                = 0x100000, ///< Partition static triangle meshes into meshlets with bounding spheres and normal cones for culling.
 
+            UseTextureCache                 = 0x8000000,  ///< Enable the texture cache. This stores textures loaded from image files as mipmapped, block compressed DDS files on disk to reduce load time.
             UseCache                        = 0x10000000, ///< Enable scene caching. This caches the runtime scene representation on disk to reduce load time.
             RebuildCache                    = 0x20000000, ///< Rebuild scene cache.
+            UseAssetCache                   = 0x40000000, ///< Enable the per-asset cache. This caches processed meshes and texture analysis results on disk keyed by their content, so unchanged assets are reused when other parts of the scene change.
 
             Default = None
         };
@@ -169,7 +179,7 @@ namespace Falcor
             }
 
             template<typename T>
-            size_t getAttributeCount(const Attribute<T>& attribute)
+            size_t getAttributeCount(const Attribute<T>& attribute) const
             {
                 switch (attribute.frequency)
                 {
@@ -355,6 +365,11 @@ namespace Falcor
         */
         Flags getFlags() const { return mFlags; }
 
+        /** Get the per-asset cache statistics.
+            \return Cache statistics, all zero if Flags::UseAssetCache is not set.
+        */
+        AssetCache::Stats getAssetCacheStats() const { return mpAssetCache ? mpAssetCache->getStats() : AssetCache::Stats(); }
+
         /** Set the render settings.
         */
         void setRenderSettings(const Scene::RenderSettings& renderSettings) { mSceneData.renderSettings = renderSettings; }
@@ -383,11 +398,19 @@ namespace Falcor
 
         /** Add a mesh.
             Throws an exception if something went wrong.
+            If Flags::DeferMeshProcessing is set, the mesh data is copied and processed later in getScene(). Errors in the mesh data are reported there.
             \param mesh The mesh to add.
             \return The ID of the mesh in the scene. Note that all of the instances share the same mesh ID.
         */
         MeshID addMesh(const Mesh& mesh);
 
+        /** Add a batch of meshes. The meshes are processed in parallel on the global thread pool.
+            Throws an exception if something went wrong.
+            \param meshes The meshes to add.
+            \return The IDs of the meshes in the scene, in the same order as the input meshes.
+        */
+        std::vector<MeshID> addMeshes(fstd::span<const Mesh> meshes);
+
         /** Add a triangle mesh.
             \param The triangle mesh to add.
             \param pMaterial The material to use for the mesh.
@@ -745,9 +768,11 @@ namespace Falcor
         const Flags mFlags;
 
         Scene::SceneData mSceneData;
+        std::unordered_multimap<uint64_t, SpectralProfileID> mSpectralProfileIndex; ///< Spectral profiles by content hash, used for deduplication.
         Scene::SharedPtr mpScene;
         SceneCache::Key mSceneCacheKey;
         bool mWriteSceneCache = false;  ///< True if scene cache should be written after import.
+        std::shared_ptr<AssetCache> mpAssetCache; ///< Per-asset cache, only created if Flags::UseAssetCache is set.
 
         SceneGraph mSceneGraph;
 
@@ -756,11 +781,36 @@ namespace Falcor
 
         CurveList mCurves;
 
+        /** Mesh added with Flags::DeferMeshProcessing set.
+            Holds a copy of the mesh data, as the caller retains ownership of the original data.
+        */
+        struct DeferredMesh
+        {
+            MeshID meshID;
+            Mesh mesh;
+            std::vector<uint32_t> indices;
+            std::vector<float3> positions;
+            std::vector<float3> normals;
+            std::vector<float4> tangents;
+            std::vector<float2> texCrds;
+            std::vector<float> curveRadii;
+            std::vector<uint4> boneIDs;
+            std::vector<float4> boneWeights;
+        };
+
+        std::vector<DeferredMesh> mDeferredMeshes; ///< Meshes waiting to be processed in getScene().
+
         std::unique_ptr<MaterialTextureLoader> mpMaterialTextureLoader;
         GpuFence::SharedPtr mpFence;
 
         // Helpers
         bool doesNodeHaveAnimation(NodeID nodeID) const;
+        MeshID addMeshSpec(MeshSpec&& spec);
+        void setProcessedMeshData(MeshSpec& spec, ProcessedMesh&& mesh) const;
+        void processDeferredMeshes();
+        MaterialTextureLoader& getMaterialTextureLoader();
+        void prioritizeMaterialTextures(MaterialID materialID);
+        AssetCache::Key computeMeshCacheKey(const Mesh& mesh) const;
         void updateLinkedObjects(NodeID oldNodeID, NodeID newNodeID);
         bool collapseNodes(NodeID parentNodeID, NodeID childNodeID);
         bool mergeNodes(NodeID dstNodeID, NodeID srcNodeID);
@@ -796,6 +846,8 @@ namespace Falcor
         void createMeshGroups();
         void optimizeGeometry();
         void sortMeshes();
+        void optimizeVertexCache();
+        void createMeshlets();
         void createGlobalBuffers();
         void createCurveGlobalBuffers();
         void optimizeMaterials();
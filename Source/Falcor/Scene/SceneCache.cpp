@@ -28,9 +28,14 @@
 #include "SceneCache.h"
 #include "Material/StandardMaterial.h"
 #include "Material/MaterialTextureLoader.h"
+#include "Core/Platform/MemoryMappedFile.h"
 #include "Utils/Logger.h"
+#include "Utils/Threading.h"
+#include "Utils/Math/Common.h"
+#include "Utils/Timing/CpuTimer.h"
+#include "Utils/Timing/Profiler.h"
 
-#include <lz4_stream/lz4_stream.h>
+#include <lz4.h>
 
 #include <sstream>
 #include <fstream>
@@ -42,25 +47,261 @@ namespace Falcor
         /** Specfies the current cache file version.
             This needs to be incremented every time the file format changes!
         */
-        const uint32_t kVersion = 25;
+        const uint32_t kVersion = 30;
 
         /** Scene cache directory (subdirectory in the application data directory).
         */
         const std::string kDirectory = "NVIDIA/Falcor/SceneCache";
 
-        const size_t kBlockSize = 1 * 1024 * 1024;
+        /** The cache file consists of an uncompressed header and section table, followed by the sections.
+            Each section starts at a 64B aligned file offset. The large geometry buffers are stored in separate,
+            uncompressed sections so that they can be copied directly from the memory-mapped file. Each volume grid
+            and each batch of animations is stored in its own compressed section, and all remaining scene data is
+            stored in a single compressed section. Compressed sections are split into independently compressed
+            blocks so that they can be compressed and decompressed in parallel. The file contents only depend on
+            the scene data, not on the number of threads used to write it.
+        */
+        const size_t kSectionAlignment = 64;
+
+        /** Size of independently compressed blocks in compressed sections.
+        */
+        const size_t kBlockSize = 4 * 1024 * 1024;
+
+        /** Size of the chunks uncompressed sections are split into when copied in parallel.
+        */
+        const size_t kCopyChunkSize = 16 * 1024 * 1024;
+
+        /** Number of animations per animation section.
+        */
+        const size_t kAnimationBatchSize = 256;
 
         const char* kMagic = "FalcorS$";
         struct Header
         {
             uint8_t magic[8]{};
             uint32_t version{};
+            uint32_t sectionCount{};
 
             bool isValid() const
             {
                 return std::memcmp(magic, kMagic, sizeof(Header::magic)) == 0 && version == kVersion;
             }
         };
+
+        enum class SectionID : uint32_t
+        {
+            SceneData,
+            MeshIndexData,
+            MeshStaticData,
+            MeshSkinningData,
+            CurveIndexData,
+            CurveStaticData,
+            GridData,           ///< NanoVDB buffer of a grid. There is one section per grid.
+            AnimationData,      ///< Batch of animations. There is one section per batch.
+
+            Count
+        };
+
+        enum class SectionCompression : uint32_t
+        {
+            None,
+            LZ4,
+        };
+
+        /** Returns true if there can be multiple sections with the given ID.
+        */
+        bool isIndexedSection(SectionID id)
+        {
+            return id == SectionID::GridData || id == SectionID::AnimationData;
+        }
+
+        /** Entry in the section table.
+        */
+        struct SectionDesc
+        {
+            SectionID id = SectionID::SceneData;
+            SectionCompression compression = SectionCompression::None;
+            uint32_t index = 0;         ///< Index of the section among the sections with the same ID.
+            uint32_t reserved = 0;      ///< Always zero, keeps the table free of uninitialized padding.
+            uint64_t offset = 0;        ///< File offset in bytes.
+            uint64_t storedSize = 0;    ///< Size of the stored (possibly compressed) data in bytes.
+            uint64_t size = 0;          ///< Size of the uncompressed data in bytes.
+        };
+
+        /** Header of compressed sections. This is followed by the compressed size of each block and the block data.
+        */
+        struct CompressedSectionHeader
+        {
+            uint32_t blockCount = 0;
+            uint32_t blockSize = 0;
+        };
+
+        /** Section data to be written.
+        */
+        struct SectionSource
+        {
+            SectionID id;
+            uint32_t index;
+            SectionCompression compression;
+            const void* pData;
+            size_t size;
+        };
+
+        /** Compress all LZ4 sections into independently compressed blocks.
+            The blocks of all sections are compressed in parallel. Blocks have a fixed size, so the output does not
+            depend on the number of threads.
+            \param[in] sources Section sources.
+            \return Compressed data of each section (empty for uncompressed sections).
+        */
+        std::vector<std::vector<uint8_t>> compressSections(const std::vector<SectionSource>& sources)
+        {
+            struct BlockJob
+            {
+                size_t section;
+                size_t block;
+            };
+
+            std::vector<BlockJob> jobs;
+            std::vector<std::vector<std::vector<uint8_t>>> blocks(sources.size());
+            for (size_t i = 0; i < sources.size(); i++)
+            {
+                if (sources[i].compression != SectionCompression::LZ4) continue;
+                blocks[i].resize(div_round_up(sources[i].size, kBlockSize));
+                for (size_t j = 0; j < blocks[i].size(); j++) jobs.push_back({ i, j });
+            }
+
+            Threading::parallelFor(0, jobs.size(), 1, [&](size_t begin, size_t end)
+            {
+                for (size_t i = begin; i < end; i++)
+                {
+                    const auto& source = sources[jobs[i].section];
+                    const size_t srcOffset = jobs[i].block * kBlockSize;
+                    const char* pSrc = reinterpret_cast<const char*>(source.pData) + srcOffset;
+                    const int srcSize = (int)std::min(kBlockSize, source.size - srcOffset);
+                    auto& block = blocks[jobs[i].section][jobs[i].block];
+                    block.resize(LZ4_compressBound(srcSize));
+                    const int compressedSize = LZ4_compress_default(pSrc, reinterpret_cast<char*>(block.data()), srcSize, (int)block.size());
+                    if (compressedSize <= 0) throw RuntimeError("Failed to compress scene cache section.");
+                    block.resize(compressedSize);
+                }
+            });
+
+            std::vector<std::vector<uint8_t>> compressedData(sources.size());
+            for (size_t i = 0; i < sources.size(); i++)
+            {
+                if (sources[i].compression != SectionCompression::LZ4) continue;
+
+                CompressedSectionHeader header;
+                header.blockCount = (uint32_t)blocks[i].size();
+                header.blockSize = (uint32_t)kBlockSize;
+
+                size_t totalSize = sizeof(header) + blocks[i].size() * sizeof(uint32_t);
+                for (const auto& block : blocks[i]) totalSize += block.size();
+
+                auto& data = compressedData[i];
+                data.reserve(totalSize);
+                auto append = [&data](const void* p, size_t len) { data.insert(data.end(), reinterpret_cast<const uint8_t*>(p), reinterpret_cast<const uint8_t*>(p) + len); };
+                append(&header, sizeof(header));
+                for (const auto& block : blocks[i])
+                {
+                    uint32_t blockSize = (uint32_t)block.size();
+                    append(&blockSize, sizeof(blockSize));
+                }
+                for (const auto& block : blocks[i]) append(block.data(), block.size());
+                FALCOR_ASSERT(data.size() == totalSize);
+            }
+
+            return compressedData;
+        }
+
+        /** Job for reading part of a section from the memory-mapped file.
+        */
+        struct ReadJob
+        {
+            const uint8_t* pSrc;
+            size_t srcSize;
+            uint8_t* pDst;
+            size_t dstSize;
+            SectionCompression compression;
+        };
+
+        /** Create the read jobs for a section.
+            \param[in] pFileData Memory-mapped file.
+            \param[in] section Section desc. The stored range must be within the file.
+            \param[in] pDst Destination buffer holding 'section.size' bytes.
+            \param[out] jobs Read jobs are appended here.
+        */
+        void createReadJobs(const uint8_t* pFileData, const SectionDesc& section, uint8_t* pDst, std::vector<ReadJob>& jobs)
+        {
+            const uint8_t* pSrc = pFileData + section.offset;
+
+            if (section.compression == SectionCompression::None)
+            {
+                if (section.storedSize != section.size) throw RuntimeError("Invalid scene cache section size.");
+                for (size_t offset = 0; offset < section.size; offset += kCopyChunkSize)
+                {
+                    const size_t size = std::min(kCopyChunkSize, (size_t)section.size - offset);
+                    jobs.push_back({ pSrc + offset, size, pDst + offset, size, SectionCompression::None });
+                }
+            }
+            else if (section.compression == SectionCompression::LZ4)
+            {
+                CompressedSectionHeader header;
+                if (section.storedSize < sizeof(header)) throw RuntimeError("Invalid scene cache section size.");
+                std::memcpy(&header, pSrc, sizeof(header));
+                if (header.blockSize == 0 || div_round_up<uint64_t>(section.size, header.blockSize) != header.blockCount ||
+                    section.storedSize < sizeof(header) + (uint64_t)header.blockCount * sizeof(uint32_t))
+                {
+                    throw RuntimeError("Invalid scene cache section header.");
+                }
+
+                const uint8_t* pBlockSizes = pSrc + sizeof(header);
+                uint64_t srcOffset = sizeof(header) + (uint64_t)header.blockCount * sizeof(uint32_t);
+                for (uint32_t i = 0; i < header.blockCount; i++)
+                {
+                    uint32_t blockSize;
+                    std::memcpy(&blockSize, pBlockSizes + i * sizeof(uint32_t), sizeof(blockSize));
+                    if (srcOffset + blockSize > section.storedSize) throw RuntimeError("Invalid scene cache section block size.");
+
+                    const uint64_t dstOffset = (uint64_t)i * header.blockSize;
+                    const size_t dstSize = std::min<uint64_t>(header.blockSize, section.size - dstOffset);
+                    jobs.push_back({ pSrc + srcOffset, blockSize, pDst + dstOffset, dstSize, SectionCompression::LZ4 });
+                    srcOffset += blockSize;
+                }
+            }
+            else
+            {
+                throw RuntimeError("Unknown scene cache section compression.");
+            }
+        }
+
+        void executeReadJob(const ReadJob& job)
+        {
+            if (job.compression == SectionCompression::None)
+            {
+                std::memcpy(job.pDst, job.pSrc, job.dstSize);
+            }
+            else
+            {
+                const int size = LZ4_decompress_safe(reinterpret_cast<const char*>(job.pSrc), reinterpret_cast<char*>(job.pDst), (int)job.srcSize, (int)job.dstSize);
+                if (size != (int)job.dstSize) throw RuntimeError("Failed to decompress scene cache section.");
+            }
+        }
+
+        /** Stream buffer reading from a memory block.
+        */
+        class MemoryStreamBuf : public std::streambuf
+        {
+        public:
+            MemoryStreamBuf(char* pData, size_t size) { setg(pData, pData, pData + size); }
+        };
+
+        template<typename T>
+        void resizeForSection(std::vector<T>& vec, const SectionDesc& section)
+        {
+            if (section.size % sizeof(T) != 0) throw RuntimeError("Invalid scene cache section size.");
+            vec.resize(section.size / sizeof(T));
+        }
     }
 
     /** Wrapper around std::ostream to ease serialization of basic types.
@@ -207,50 +448,256 @@ namespace Falcor
 
     void SceneCache::writeCache(const Scene::SceneData& sceneData, const Key& key)
     {
+        FALCOR_PROFILE_CPU("SceneCache::writeCache");
+
         auto cachePath = getCachePath(key);
 
         logInfo("Writing scene cache to '{}'.", cachePath);
+        const auto startTime = CpuTimer::getCurrentTimePoint();
 
         // Create directories if not existing.
         std::filesystem::create_directories(cachePath.parent_path());
 
-        // Open file.
-        std::ofstream fs(cachePath.c_str(), std::ios_base::binary);
-        if (fs.bad()) throw RuntimeError("Failed to create scene cache file '{}'.", cachePath);
+        // Serialize the scene data and the animation batches in parallel.
+        // The geometry buffers and grids are stored in separate sections as is.
+        const size_t animationBatchCount = div_round_up(sceneData.animations.size(), kAnimationBatchSize);
+        std::vector<std::string> blobs(1 + animationBatchCount);
+        Threading::parallelFor(0, blobs.size(), 1, [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++)
+            {
+                std::ostringstream ss(std::ios_base::binary);
+                OutputStream stream(ss);
+                if (i == 0)
+                {
+                    writeSceneData(stream, sceneData);
+                }
+                else
+                {
+                    const size_t first = (i - 1) * kAnimationBatchSize;
+                    const size_t last = std::min(first + kAnimationBatchSize, sceneData.animations.size());
+                    stream.write((uint32_t)(last - first));
+                    for (size_t j = first; j < last; j++) writeAnimation(stream, sceneData.animations[j]);
+                }
+                blobs[i] = ss.str();
+            }
+        });
+
+        auto getSource = [](SectionID id, const auto& vec) -> SectionSource
+        {
+            return { id, 0, SectionCompression::None, vec.data(), vec.size() * sizeof(vec[0]) };
+        };
+
+        std::vector<SectionSource> sources =
+        {
+            { SectionID::SceneData, 0, SectionCompression::LZ4, blobs[0].data(), blobs[0].size() },
+            getSource(SectionID::MeshIndexData, sceneData.meshIndexData),
+            getSource(SectionID::MeshStaticData, sceneData.meshStaticData),
+            getSource(SectionID::MeshSkinningData, sceneData.meshSkinningData),
+            getSource(SectionID::CurveIndexData, sceneData.curveIndexData),
+            getSource(SectionID::CurveStaticData, sceneData.curveStaticData),
+        };
+        for (size_t i = 0; i < sceneData.grids.size(); i++)
+        {
+            const nanovdb::HostBuffer& buffer = sceneData.grids[i]->mGridHandle.buffer();
+            sources.push_back({ SectionID::GridData, (uint32_t)i, SectionCompression::LZ4, buffer.data(), buffer.size() });
+        }
+        for (size_t i = 0; i < animationBatchCount; i++)
+        {
+            sources.push_back({ SectionID::AnimationData, (uint32_t)i, SectionCompression::LZ4, blobs[1 + i].data(), blobs[1 + i].size() });
+        }
+
+        // Compress sections.
+        std::vector<std::vector<uint8_t>> compressedData = compressSections(sources);
 
-        // Write header (uncompressed).
+        // Create section table.
         Header header;
         std::memcpy(header.magic, kMagic, sizeof(Header::magic));
         header.version = kVersion;
+        header.sectionCount = (uint32_t)sources.size();
+
+        std::vector<SectionDesc> sections(sources.size());
+        uint64_t offset = align_to<uint64_t>(kSectionAlignment, sizeof(Header) + sections.size() * sizeof(SectionDesc));
+        uint64_t totalSize = 0;
+        for (size_t i = 0; i < sources.size(); i++)
+        {
+            auto& section = sections[i];
+            section.id = sources[i].id;
+            section.index = sources[i].index;
+            section.compression = sources[i].compression;
+            section.offset = offset;
+            section.storedSize = section.compression == SectionCompression::None ? sources[i].size : compressedData[i].size();
+            section.size = sources[i].size;
+            offset = align_to<uint64_t>(kSectionAlignment, offset + section.storedSize);
+            totalSize += section.size;
+        }
+
+        // Open file.
+        std::ofstream fs(cachePath.c_str(), std::ios_base::binary);
+        if (fs.bad()) throw RuntimeError("Failed to create scene cache file '{}'.", cachePath);
+
+        // Write header, section table and sections.
         fs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        fs.write(reinterpret_cast<const char*>(sections.data()), sections.size() * sizeof(SectionDesc));
+
+        for (size_t i = 0; i < sources.size(); i++)
+        {
+            const auto& section = sections[i];
+            const char padding[kSectionAlignment] = {};
+            fs.write(padding, section.offset - (uint64_t)fs.tellp());
+
+            const void* pData = section.compression == SectionCompression::None ? sources[i].pData : compressedData[i].data();
+            fs.write(reinterpret_cast<const char*>(pData), section.storedSize);
+        }
 
-        // Write cache (compressed).
-        lz4_stream::basic_ostream<kBlockSize> zs(fs);
-        OutputStream stream(zs);
-        writeSceneData(stream, sceneData);
         if (fs.bad()) throw RuntimeError("Failed to write scene cache file to '{}'.", cachePath);
+
+        const double seconds = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint()) / 1000.0;
+        logInfo("Wrote {} sections ({:.1f} MB) in {:.2f} s ({:.0f} MB/s, {} threads).", sections.size(), totalSize / 1e6, seconds,
+            totalSize / 1e6 / std::max(seconds, 1e-6), Threading::getThreadCount());
     }
 
     Scene::SceneData SceneCache::readCache(std::shared_ptr<Device> pDevice, const Key& key)
     {
+        FALCOR_PROFILE_CPU("SceneCache::readCache");
+
         auto cachePath = getCachePath(key);
 
         logInfo("Loading scene cache from '{}'.", cachePath);
+        const auto startTime = CpuTimer::getCurrentTimePoint();
 
-        // Open file.
-        std::ifstream fs(cachePath.c_str(), std::ios_base::binary);
-        if (fs.bad()) throw RuntimeError("Failed to open scene cache file '{}'.", cachePath);
+        // Map file.
+        MemoryMappedFile file(cachePath, MemoryMappedFile::kWholeFile, MemoryMappedFile::AccessHint::SequentialScan);
+        if (!file.isOpen()) throw RuntimeError("Failed to open scene cache file '{}'.", cachePath);
+        const uint8_t* pFileData = reinterpret_cast<const uint8_t*>(file.getData());
+        const size_t fileSize = file.getMappedSize();
 
-        // Read header (uncompressed).
+        // Read header and section table (uncompressed).
         Header header;
-        fs.read(reinterpret_cast<char*>(&header), sizeof(header));
+        if (fileSize < sizeof(header)) throw RuntimeError("Invalid header in scene cache file '{}'.", cachePath);
+        std::memcpy(&header, pFileData, sizeof(header));
         if (!header.isValid()) throw RuntimeError("Invalid header in scene cache file '{}'.", cachePath);
 
-        // Read cache (compressed).
-        lz4_stream::basic_istream<kBlockSize, kBlockSize> zs(fs);
-        InputStream stream(zs);
-        auto sceneData = readSceneData(stream, pDevice);
-        if (fs.bad()) throw RuntimeError("Failed to read scene cache file from '{}'.", cachePath);
+        if (fileSize < sizeof(header) + (uint64_t)header.sectionCount * sizeof(SectionDesc)) throw RuntimeError("Invalid section table in scene cache file '{}'.", cachePath);
+        std::vector<SectionDesc> sections(header.sectionCount);
+        std::memcpy(sections.data(), pFileData + sizeof(header), sections.size() * sizeof(SectionDesc));
+
+        // Sections with a unique ID are looked up by ID, indexed sections (grids and animation batches) by ID and index.
+        std::vector<const SectionDesc*> sectionByID((size_t)SectionID::Count, nullptr);
+        std::vector<std::vector<const SectionDesc*>> indexedSections((size_t)SectionID::Count);
+        for (const auto& section : sections)
+        {
+            if ((size_t)section.id >= sectionByID.size() || section.offset > fileSize || section.storedSize > fileSize - section.offset)
+            {
+                throw RuntimeError("Invalid section table in scene cache file '{}'.", cachePath);
+            }
+
+            if (isIndexedSection(section.id))
+            {
+                auto& list = indexedSections[(size_t)section.id];
+                if (section.index >= sections.size()) throw RuntimeError("Invalid section table in scene cache file '{}'.", cachePath);
+                if (section.index >= list.size()) list.resize(section.index + 1, nullptr);
+                if (list[section.index]) throw RuntimeError("Invalid section table in scene cache file '{}'.", cachePath);
+                list[section.index] = &section;
+            }
+            else
+            {
+                if (sectionByID[(size_t)section.id] || section.index != 0) throw RuntimeError("Invalid section table in scene cache file '{}'.", cachePath);
+                sectionByID[(size_t)section.id] = &section;
+            }
+        }
+        for (size_t id = 0; id < sectionByID.size(); id++)
+        {
+            if (!isIndexedSection((SectionID)id) && !sectionByID[id]) throw RuntimeError("Missing section in scene cache file '{}'.", cachePath);
+            for (auto pSection : indexedSections[id])
+            {
+                if (!pSection) throw RuntimeError("Missing section in scene cache file '{}'.", cachePath);
+            }
+        }
+        const auto& gridSections = indexedSections[(size_t)SectionID::GridData];
+        const auto& animationSections = indexedSections[(size_t)SectionID::AnimationData];
+
+        // Allocate destination buffers and create read jobs for all sections.
+        Scene::SceneData sceneData;
+        std::vector<char> sceneDataBlob(sectionByID[(size_t)SectionID::SceneData]->size);
+        resizeForSection(sceneData.meshIndexData, *sectionByID[(size_t)SectionID::MeshIndexData]);
+        resizeForSection(sceneData.meshStaticData, *sectionByID[(size_t)SectionID::MeshStaticData]);
+        resizeForSection(sceneData.meshSkinningData, *sectionByID[(size_t)SectionID::MeshSkinningData]);
+        resizeForSection(sceneData.curveIndexData, *sectionByID[(size_t)SectionID::CurveIndexData]);
+        resizeForSection(sceneData.curveStaticData, *sectionByID[(size_t)SectionID::CurveStaticData]);
+
+        std::vector<nanovdb::HostBuffer> gridBuffers(gridSections.size());
+        for (size_t i = 0; i < gridSections.size(); i++) gridBuffers[i] = nanovdb::HostBuffer::create(gridSections[i]->size);
+
+        std::vector<std::vector<char>> animationBlobs(animationSections.size());
+        for (size_t i = 0; i < animationSections.size(); i++) animationBlobs[i].resize(animationSections[i]->size);
+
+        auto getDestination = [&](const SectionDesc& section) -> uint8_t*
+        {
+            switch (section.id)
+            {
+            case SectionID::SceneData: return reinterpret_cast<uint8_t*>(sceneDataBlob.data());
+            case SectionID::MeshIndexData: return reinterpret_cast<uint8_t*>(sceneData.meshIndexData.data());
+            case SectionID::MeshStaticData: return reinterpret_cast<uint8_t*>(sceneData.meshStaticData.data());
+            case SectionID::MeshSkinningData: return reinterpret_cast<uint8_t*>(sceneData.meshSkinningData.data());
+            case SectionID::CurveIndexData: return reinterpret_cast<uint8_t*>(sceneData.curveIndexData.data());
+            case SectionID::CurveStaticData: return reinterpret_cast<uint8_t*>(sceneData.curveStaticData.data());
+            case SectionID::GridData: return gridBuffers[section.index].data();
+            case SectionID::AnimationData: return reinterpret_cast<uint8_t*>(animationBlobs[section.index].data());
+            default: FALCOR_UNREACHABLE(); return nullptr;
+            }
+        };
+
+        std::vector<ReadJob> jobs;
+        uint64_t totalSize = 0;
+        for (const auto& section : sections)
+        {
+            createReadJobs(pFileData, section, getDestination(section), jobs);
+            totalSize += section.size;
+        }
+
+        // Copy and decompress all sections in parallel.
+        Threading::parallelFor(0, jobs.size(), 1, [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++) executeReadJob(jobs[i]);
+        });
+
+        file.close();
+
+        // Deserialize the animation batches in parallel.
+        std::vector<std::vector<Animation::SharedPtr>> animationBatches(animationBlobs.size());
+        Threading::parallelFor(0, animationBlobs.size(), 1, [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++)
+            {
+                MemoryStreamBuf streamBuf(animationBlobs[i].data(), animationBlobs[i].size());
+                std::istream is(&streamBuf);
+                InputStream stream(is);
+                animationBatches[i].resize(stream.read<uint32_t>());
+                for (auto& pAnimation : animationBatches[i]) pAnimation = readAnimation(stream);
+                if (is.fail()) throw RuntimeError("Failed to read animations from scene cache file '{}'.", cachePath);
+            }
+        });
+        for (auto& batch : animationBatches) sceneData.animations.insert(sceneData.animations.end(), batch.begin(), batch.end());
+
+        // Create the grids. This uploads the grid data to the GPU, see the note on material texture loading in readSceneData().
+        sceneData.grids.resize(gridBuffers.size());
+        for (size_t i = 0; i < gridBuffers.size(); i++)
+        {
+            sceneData.grids[i] = Grid::SharedPtr(new Grid(pDevice, nanovdb::GridHandle<nanovdb::HostBuffer>(std::move(gridBuffers[i]))));
+        }
+
+        // Deserialize the remaining scene data.
+        MemoryStreamBuf streamBuf(sceneDataBlob.data(), sceneDataBlob.size());
+        std::istream is(&streamBuf);
+        InputStream stream(is);
+        readSceneData(stream, sceneData, pDevice);
+        if (is.fail()) throw RuntimeError("Failed to read scene cache file from '{}'.", cachePath);
+
+        const double seconds = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint()) / 1000.0;
+        logInfo("Read {} sections ({:.1f} MB) in {:.2f} s ({:.0f} MB/s, {} threads).", sections.size(), totalSize / 1e6, seconds,
+            totalSize / 1e6 / std::max(seconds, 1e-6), Threading::getThreadCount());
+
         return sceneData;
     }
 
@@ -283,9 +730,9 @@ namespace Falcor
         stream.write((uint32_t)sceneData.spectralProfiles.size());
         for (const auto& SP : sceneData.spectralProfiles) writeSpectralProfile(stream, SP);
 
+        // The grid data is stored in separate sections.
         writeMarker(stream, "Grids");
         stream.write((uint32_t)sceneData.grids.size());
-        for (const auto& pGrid : sceneData.grids) writeGrid(stream, pGrid);
 
         writeMarker(stream, "GridVolumes");
         stream.write((uint32_t)sceneData.gridVolumes.size());
@@ -310,12 +757,9 @@ namespace Falcor
             stream.write(node.localToBindSpace);
         }
 
+        // The animations are stored in separate sections.
         writeMarker(stream, "Animations");
         stream.write((uint32_t)sceneData.animations.size());
-        for (const auto& pAnimation : sceneData.animations)
-        {
-            writeAnimation(stream, pAnimation);
-        }
 
         writeMarker(stream, "Metadata");
         writeMetadata(stream, sceneData.metadata);
@@ -349,16 +793,13 @@ namespace Falcor
         stream.write(sceneData.has16BitIndices);
         stream.write(sceneData.has32BitIndices);
         stream.write(sceneData.meshDrawCount);
-        stream.write(sceneData.meshIndexData);
-        stream.write(sceneData.meshStaticData);
-        stream.write(sceneData.meshSkinningData);
+        stream.write(sceneData.meshVertexCacheStats);
+        writeMeshletData(stream, sceneData.meshletData);
 
         writeMarker(stream, "Curves");
         stream.write(sceneData.curveDesc);
         stream.write(sceneData.curveBBs);
         stream.write(sceneData.curveInstanceData);
-        stream.write(sceneData.curveIndexData);
-        stream.write(sceneData.curveStaticData);
 
         stream.write((uint32_t)sceneData.cachedCurves.size());
         for (const auto& cachedCurve : sceneData.cachedCurves)
@@ -378,9 +819,8 @@ namespace Falcor
         writeMarker(stream, "End");
     }
 
-    Scene::SceneData SceneCache::readSceneData(InputStream& stream, std::shared_ptr<Device> pDevice)
+    void SceneCache::readSceneData(InputStream& stream, Scene::SceneData& sceneData, std::shared_ptr<Device> pDevice)
     {
-        Scene::SceneData sceneData;
         sceneData.pMaterials = MaterialSystem::create(pDevice);
 
         readMarker(stream, "Path");
@@ -403,9 +843,9 @@ namespace Falcor
         sceneData.spectralProfiles.resize(stream.read<uint32_t>());
         for (auto& SP : sceneData.spectralProfiles) SP = readSpectralProfile(stream);
 
+        // The grids are created from separate sections before reading the scene data.
         readMarker(stream, "Grids");
-        sceneData.grids.resize(stream.read<uint32_t>());
-        for (auto& pGrid : sceneData.grids) pGrid = readGrid(stream, pDevice);
+        if (stream.read<uint32_t>() != sceneData.grids.size()) throw RuntimeError("Mismatching grid count in scene cache.");
 
         readMarker(stream, "GridVolumes");
         sceneData.gridVolumes.resize(stream.read<uint32_t>());
@@ -438,9 +878,9 @@ namespace Falcor
             stream.read(node.localToBindSpace);
         }
 
+        // The animations are read from separate sections before reading the scene data.
         readMarker(stream, "Animations");
-        sceneData.animations.resize(stream.read<uint32_t>());
-        for (auto& pAnimation : sceneData.animations) pAnimation = readAnimation(stream);
+        if (stream.read<uint32_t>() != sceneData.animations.size()) throw RuntimeError("Mismatching animation count in scene cache.");
 
         readMarker(stream, "Metadata");
         sceneData.metadata = readMetadata(stream);
@@ -474,16 +914,13 @@ namespace Falcor
         stream.read(sceneData.has16BitIndices);
         stream.read(sceneData.has32BitIndices);
         stream.read(sceneData.meshDrawCount);
-        stream.read(sceneData.meshIndexData);
-        stream.read(sceneData.meshStaticData);
-        stream.read(sceneData.meshSkinningData);
+        stream.read(sceneData.meshVertexCacheStats);
+        sceneData.meshletData = readMeshletData(stream);
 
         readMarker(stream, "Curves");
         stream.read(sceneData.curveDesc);
         stream.read(sceneData.curveBBs);
         stream.read(sceneData.curveInstanceData);
-        stream.read(sceneData.curveIndexData);
-        stream.read(sceneData.curveStaticData);
 
         sceneData.cachedCurves.resize(stream.read<uint32_t>());
         for (auto& cachedCurve : sceneData.cachedCurves)
@@ -503,8 +940,6 @@ namespace Falcor
         readMarker(stream, "End");
 
         pMaterialTextureLoader.reset();
-
-        return sceneData;
     }
 
     // Metadata
@@ -864,23 +1299,6 @@ namespace Falcor
         return pGridVolume;
     }
 
-    // Grid
-
-    void SceneCache::writeGrid(OutputStream& stream, const Grid::SharedPtr& pGrid)
-    {
-        const nanovdb::HostBuffer& buffer = pGrid->mGridHandle.buffer();
-        stream.write((uint64_t)buffer.size());
-        stream.write(buffer.data(), buffer.size());
-    }
-
-    Grid::SharedPtr SceneCache::readGrid(InputStream& stream, std::shared_ptr<Device> pDevice)
-    {
-        uint64_t size = stream.read<uint64_t>();
-        auto buffer = nanovdb::HostBuffer::create(size);
-        stream.read(buffer.data(), buffer.size());
-        return Grid::SharedPtr(new Grid(std::move(pDevice), nanovdb::GridHandle<nanovdb::HostBuffer>(std::move(buffer))));
-    }
-
     // EnvMap
 
     void SceneCache::writeEnvMap(OutputStream& stream, const EnvMap::SharedPtr& pEnvMap)
@@ -901,6 +1319,46 @@ namespace Falcor
         return pEnvMap;
     }
 
+    // Meshlets
+
+    void SceneCache::writeMeshletData(std::ostream& stream, const MeshletData& meshletData)
+    {
+        OutputStream outputStream(stream);
+        writeMeshletData(outputStream, meshletData);
+    }
+
+    MeshletData SceneCache::readMeshletData(std::istream& stream)
+    {
+        InputStream inputStream(stream);
+        return readMeshletData(inputStream);
+    }
+
+    void SceneCache::writeMeshletData(OutputStream& stream, const MeshletData& meshletData)
+    {
+        stream.write(meshletData.meshlets);
+        stream.write(meshletData.vertices);
+        stream.write(meshletData.triangles);
+    }
+
+    MeshletData SceneCache::readMeshletData(InputStream& stream)
+    {
+        MeshletData meshletData;
+        stream.read(meshletData.meshlets);
+        stream.read(meshletData.vertices);
+        stream.read(meshletData.triangles);
+
+        for (const auto& meshlet : meshletData.meshlets)
+        {
+            if ((uint64_t)meshlet.vertexOffset + meshlet.getVertexCount() > meshletData.vertices.size() ||
+                (uint64_t)meshlet.triangleOffset + meshlet.getTriangleCount() > meshletData.triangles.size())
+            {
+                throw RuntimeError("Invalid meshlet data in scene cache.");
+            }
+        }
+
+        return meshletData;
+    }
+
     // Transform
 
     void SceneCache::writeTransform(OutputStream& stream, const Transform& transform)
@@ -930,7 +1388,10 @@ namespace Falcor
         stream.write(pAnimation->mPostInfinityBehavior);
         stream.write(pAnimation->mInterpolationMode);
         stream.write(pAnimation->mEnableWarping);
-        stream.write(pAnimation->mKeyframes);
+        stream.write(pAnimation->mTimes);
+        stream.write(pAnimation->mTranslations);
+        stream.write(pAnimation->mScalings);
+        stream.write(pAnimation->mRotations);
     }
 
     Animation::SharedPtr SceneCache::readAnimation(InputStream& stream)
@@ -943,7 +1404,10 @@ namespace Falcor
         stream.read(pAnimation->mPostInfinityBehavior);
         stream.read(pAnimation->mInterpolationMode);
         stream.read(pAnimation->mEnableWarping);
-        stream.read(pAnimation->mKeyframes);
+        stream.read(pAnimation->mTimes);
+        stream.read(pAnimation->mTranslations);
+        stream.read(pAnimation->mScalings);
+        stream.read(pAnimation->mRotations);
         return pAnimation;
     }
 
@@ -50,6 +50,10 @@ namespace Falcor
     /** Helper class for reading and writing scene cache files.
         The scene cache is used to heavily reduce load times of more complex assets.
         The cache stores a binary representation of `Scene::SceneData` which contains everything to re-create a `Scene`.
+        The file is organized in sections listed in an uncompressed section table. The large geometry buffers are stored
+        uncompressed and are read directly from the memory-mapped file, while the remaining data is stored in independently
+        compressed blocks. Volume grids and batches of animations are stored in their own sections. Sections are serialized,
+        compressed and decompressed in parallel, and the written file does not depend on the number of threads.
     */
     class FALCOR_API SceneCache
     {
@@ -75,14 +79,34 @@ namespace Falcor
         */
         static Scene::SceneData readCache(std::shared_ptr<Device> pDevice, const Key& key);
 
+        /** Write meshlet data to an uncompressed binary stream.
+            This uses the same encoding as the meshlet data in the scene cache.
+            \param[in] stream Output stream.
+            \param[in] meshletData Meshlet data.
+        */
+        static void writeMeshletData(std::ostream& stream, const MeshletData& meshletData);
+
+        /** Read meshlet data from an uncompressed binary stream.
+            Throws an exception if the meshlet data is inconsistent.
+            \param[in] stream Input stream.
+            \return Returns the loaded meshlet data.
+        */
+        static MeshletData readMeshletData(std::istream& stream);
+
     private:
         class OutputStream;
         class InputStream;
 
         static std::filesystem::path getCachePath(const Key& key);
 
+        /** Write all scene data except for the large geometry buffers, grids and animations, which are stored in separate cache sections.
+        */
         static void writeSceneData(OutputStream& stream, const Scene::SceneData& sceneData);
-        static Scene::SceneData readSceneData(InputStream& stream, std::shared_ptr<Device> pDevice);
+
+        /** Read all scene data except for the large geometry buffers, grids and animations, which are read from separate cache sections
+            before calling this function.
+        */
+        static void readSceneData(InputStream& stream, Scene::SceneData& sceneData, std::shared_ptr<Device> pDevice);
 
         static void writeMetadata(OutputStream& stream, const Scene::Metadata& metadata);
         static Scene::Metadata readMetadata(InputStream& stream);
@@ -109,12 +133,12 @@ namespace Falcor
         static void writeGridVolume(OutputStream& stream, const GridVolume::SharedPtr& pVolume, const std::vector<Grid::SharedPtr>& grids);
         static GridVolume::SharedPtr readGridVolume(InputStream& stream, const std::vector<Grid::SharedPtr>& grids, std::shared_ptr<Device> pDevice);
 
-        static void writeGrid(OutputStream& stream, const Grid::SharedPtr& pGrid);
-        static Grid::SharedPtr readGrid(InputStream& stream, std::shared_ptr<Device> pDevice);
-
         static void writeEnvMap(OutputStream& stream, const EnvMap::SharedPtr& pEnvMap);
         static EnvMap::SharedPtr readEnvMap(InputStream& stream, std::shared_ptr<Device> pDevice);
 
+        static void writeMeshletData(OutputStream& stream, const MeshletData& meshletData);
+        static MeshletData readMeshletData(InputStream& stream);
+
         static void writeTransform(OutputStream& stream, const Transform& transform);
         static Transform readTransform(InputStream& stream);
 
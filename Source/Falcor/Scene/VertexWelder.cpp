@@ -0,0 +1,186 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "VertexWelder.h"
+#include "Core/Assert.h"
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace Falcor
+{
+    namespace
+    {
+        bool isFinite(const float3& p) { return std::isfinite(p.x) && std::isfinite(p.y) && std::isfinite(p.z); }
+
+        uint64_t mix(uint64_t h)
+        {
+            // MurmurHash3 64-bit finalizer.
+            h ^= h >> 33;
+            h *= 0xff51afd7ed558ccdull;
+            h ^= h >> 33;
+            h *= 0xc4ceb9fe1a85ec53ull;
+            h ^= h >> 33;
+            return h;
+        }
+
+        uint32_t floatBits(float f)
+        {
+            // Adding zero maps -0 to +0, so that values comparing equal hash equally.
+            f += 0.f;
+            uint32_t bits;
+            std::memcpy(&bits, &f, sizeof(bits));
+            return bits;
+        }
+
+        int3 quantizeExact(const float3& p) { return int3(floatBits(p.x), floatBits(p.y), floatBits(p.z)); }
+
+        uint64_t computeHash(const VertexWelder::Vertex& v, const int3& cell)
+        {
+            uint64_t h = 0;
+            auto combine = [&h](uint32_t value) { h = mix(h ^ (value + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2))); };
+            combine((uint32_t)cell.x);
+            combine((uint32_t)cell.y);
+            combine((uint32_t)cell.z);
+            combine(floatBits(v.tangent.w));
+            combine(floatBits(v.curveRadius));
+            combine(v.boneIDs.x);
+            combine(v.boneIDs.y);
+            combine(v.boneIDs.z);
+            combine(v.boneIDs.w);
+            return h;
+        }
+    }
+
+    VertexWelder::VertexWelder(size_t expectedVertexCount, float positionTolerance)
+        : mPositionTolerance(positionTolerance)
+        , mCellSize(2.f * positionTolerance)
+    {
+        size_t capacity = 64;
+        while (capacity < 2 * expectedVertexCount) capacity *= 2;
+        mSlots.resize(capacity);
+    }
+
+    uint32_t VertexWelder::find(const Vertex& v, const VertexList& vertices) const
+    {
+        if (mPositionTolerance == 0.f || !isFinite(v.position)) return findInChain(computeHash(v, quantizeExact(v.position)), v, vertices);
+
+        int3 minCell = quantizeCell(v.position - mPositionTolerance);
+        int3 maxCell = quantizeCell(v.position + mPositionTolerance);
+        for (int z = minCell.z; z <= maxCell.z; z++)
+        {
+            for (int y = minCell.y; y <= maxCell.y; y++)
+            {
+                for (int x = minCell.x; x <= maxCell.x; x++)
+                {
+                    uint32_t index = findInChain(computeHash(v, int3(x, y, z)), v, vertices);
+                    if (index != kInvalidIndex) return index;
+                }
+            }
+        }
+        return kInvalidIndex;
+    }
+
+    uint32_t VertexWelder::insert(const Vertex& v, VertexList& vertices)
+    {
+        if (2 * (mUsedSlots + 1) > mSlots.size()) grow();
+
+        FALCOR_ASSERT(vertices.size() < std::numeric_limits<uint32_t>::max());
+        uint32_t index = (uint32_t)vertices.size();
+
+        bool exact = mPositionTolerance == 0.f || !isFinite(v.position);
+        uint64_t hash = computeHash(v, exact ? quantizeExact(v.position) : quantizeCell(v.position));
+        Slot& slot = mSlots[findSlot(hash)];
+        if (slot.head == kInvalidIndex)
+        {
+            slot.hash = hash;
+            mUsedSlots++;
+        }
+        vertices.push_back({ v, slot.head });
+        slot.head = index;
+
+        return index;
+    }
+
+    bool VertexWelder::compareVertices(const Vertex& lhs, const Vertex& rhs, float threshold, float positionTolerance)
+    {
+        using namespace glm;
+        if (positionTolerance == 0.f)
+        {
+            if (lhs.position != rhs.position) return false; // Position need to be exact to avoid cracks
+        }
+        else
+        {
+            if (any(greaterThan(abs(lhs.position - rhs.position), float3(positionTolerance)))) return false;
+        }
+        if (lhs.tangent.w != rhs.tangent.w) return false;
+        if (lhs.curveRadius != rhs.curveRadius) return false;
+        if (lhs.boneIDs != rhs.boneIDs) return false;
+        if (any(greaterThan(abs(lhs.normal - rhs.normal), float3(threshold)))) return false;
+        if (any(greaterThan(abs(lhs.tangent.xyz - rhs.tangent.xyz), float3(threshold)))) return false;
+        if (any(greaterThan(abs(lhs.texCrd - rhs.texCrd), float2(threshold)))) return false;
+        if (any(greaterThan(abs(lhs.boneWeights - rhs.boneWeights), float4(threshold)))) return false;
+        return true;
+    }
+
+    int3 VertexWelder::quantizeCell(const float3& p) const
+    {
+        float3 cell = glm::floor(p / mCellSize);
+        cell = glm::clamp(cell, float3(-2147483520.f), float3(2147483520.f));
+        return int3(cell);
+    }
+
+    uint32_t VertexWelder::findInChain(uint64_t hash, const Vertex& v, const VertexList& vertices) const
+    {
+        const Slot& slot = mSlots[findSlot(hash)];
+        for (uint32_t index = slot.head; index != kInvalidIndex; index = vertices[index].second)
+        {
+            if (compareVertices(v, vertices[index].first, 1e-6f, mPositionTolerance)) return index;
+        }
+        return kInvalidIndex;
+    }
+
+    size_t VertexWelder::findSlot(uint64_t hash) const
+    {
+        size_t mask = mSlots.size() - 1;
+        for (size_t i = hash & mask;; i = (i + 1) & mask)
+        {
+            const Slot& slot = mSlots[i];
+            if (slot.head == kInvalidIndex || slot.hash == hash) return i;
+        }
+    }
+
+    void VertexWelder::grow()
+    {
+        std::vector<Slot> oldSlots(mSlots.size() * 2);
+        std::swap(oldSlots, mSlots);
+        for (const Slot& slot : oldSlots)
+        {
+            if (slot.head != kInvalidIndex) mSlots[findSlot(slot.hash)] = slot;
+        }
+    }
+}
@@ -0,0 +1,100 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "SceneBuilder.h"
+#include "Core/Macros.h"
+#include "Utils/Math/Vector.h"
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace Falcor
+{
+    /** Hash-based vertex welding.
+        Vertices are bucketed in an open-addressing hash table keyed by a hash of the attributes that need to match exactly
+        (position, tangent sign, curve radius and bone IDs). Vertices sharing a hash are chained using the next-pointers
+        stored in the vertex list, and candidates are resolved with a full attribute comparison.
+
+        If a position tolerance is given, positions are snapped to a grid with cell size 2*tolerance. All vertices within
+        the tolerance of a position fall in at most 2x2x2 cells, which are all searched.
+
+        Vertices are welded regardless of their original vertex index, so the welder must not be used when the
+        attribute indices of the welded vertices are needed later on.
+    */
+    class FALCOR_API VertexWelder
+    {
+    public:
+        using Vertex = SceneBuilder::Mesh::Vertex;
+        using VertexList = std::vector<std::pair<Vertex, uint32_t>>;
+
+        static constexpr uint32_t kInvalidIndex = 0xffffffff;
+
+        /** Create a vertex welder.
+            \param[in] expectedVertexCount Expected number of vertices, used to size the hash table.
+            \param[in] positionTolerance Maximum per-component position difference of welded vertices. Zero means exact positions.
+        */
+        VertexWelder(size_t expectedVertexCount, float positionTolerance);
+
+        /** Find a vertex matching 'v' in the vertex list.
+            \return Index of the matching vertex, or kInvalidIndex if none was found.
+        */
+        uint32_t find(const Vertex& v, const VertexList& vertices) const;
+
+        /** Append vertex 'v' to the vertex list and insert it into the table.
+            \return Index of the new vertex.
+        */
+        uint32_t insert(const Vertex& v, VertexList& vertices);
+
+        /** Compare two vertices.
+            \param[in] threshold Maximum per-component difference of the normal, tangent, texture coordinate and bone weights.
+            \param[in] positionTolerance Maximum per-component position difference. Zero means positions must match exactly.
+            \return True if the vertices are considered identical.
+        */
+        static bool compareVertices(const Vertex& lhs, const Vertex& rhs, float threshold = 1e-6f, float positionTolerance = 0.f);
+
+    private:
+        struct Slot
+        {
+            uint64_t hash = 0;
+            uint32_t head = kInvalidIndex;
+        };
+
+        int3 quantizeCell(const float3& p) const;
+        uint32_t findInChain(uint64_t hash, const Vertex& v, const VertexList& vertices) const;
+
+        /** Returns the index of the slot holding 'hash', or of the empty slot where it should be inserted (linear probing).
+        */
+        size_t findSlot(uint64_t hash) const;
+        void grow();
+
+        float mPositionTolerance;
+        float mCellSize;
+        std::vector<Slot> mSlots;
+        size_t mUsedSlots = 0;
+    };
+}
@@ -0,0 +1,272 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "VertexCacheOptimizer.h"
+#include "Core/Assert.h"
+#include <algorithm>
+#include <numeric>
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kInvalidIndex = 0xffffffff;
+
+        /** Vertex to triangle adjacency in compressed sparse row format.
+        */
+        struct TriangleAdjacency
+        {
+            std::vector<uint32_t> offsets;      ///< Offset into 'triangles' for each vertex. Has vertexCount + 1 entries.
+            std::vector<uint32_t> triangles;    ///< Adjacent triangles for all vertices.
+
+            TriangleAdjacency(const uint32_t* pIndices, size_t indexCount, size_t vertexCount)
+            {
+                offsets.assign(vertexCount + 1, 0);
+                for (size_t i = 0; i < indexCount; i++) offsets[pIndices[i] + 1]++;
+                for (size_t v = 0; v < vertexCount; v++) offsets[v + 1] += offsets[v];
+
+                triangles.resize(indexCount);
+                std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+                for (size_t i = 0; i < indexCount; i++) triangles[fill[pIndices[i]]++] = (uint32_t)(i / 3);
+            }
+
+            uint32_t getCount(uint32_t v) const { return offsets[v + 1] - offsets[v]; }
+        };
+    }
+
+    VertexCacheStats analyzeVertexCache(const uint32_t* pIndices, size_t indexCount, size_t vertexCount, uint32_t cacheSize)
+    {
+        FALCOR_ASSERT(indexCount % 3 == 0);
+        FALCOR_ASSERT(cacheSize > 0);
+
+        VertexCacheStats stats;
+        stats.triangleCount = indexCount / 3;
+
+        // A vertex is in the FIFO cache if it was inserted less than 'cacheSize' insertions ago.
+        std::vector<uint64_t> insertTime(vertexCount, 0);
+        std::vector<bool> referenced(vertexCount, false);
+        uint64_t time = uint64_t(cacheSize) + 1;
+
+        for (size_t i = 0; i < indexCount; i++)
+        {
+            uint32_t v = pIndices[i];
+            FALCOR_ASSERT(v < vertexCount);
+            if (!referenced[v])
+            {
+                referenced[v] = true;
+                stats.vertexCount++;
+            }
+            if (time - insertTime[v] > cacheSize)
+            {
+                insertTime[v] = time++;
+                stats.cacheMissCount++;
+            }
+        }
+
+        return stats;
+    }
+
+    void optimizeVertexCache(uint32_t* pIndices, size_t indexCount, size_t vertexCount, uint32_t cacheSize, std::vector<uint32_t>* pClusterOffsets)
+    {
+        FALCOR_ASSERT(indexCount % 3 == 0);
+        FALCOR_ASSERT(cacheSize > 0);
+
+        if (pClusterOffsets) pClusterOffsets->clear();
+        if (indexCount == 0) return;
+
+        const size_t triangleCount = indexCount / 3;
+        const TriangleAdjacency adjacency(pIndices, indexCount, vertexCount);
+
+        std::vector<uint32_t> liveCount(vertexCount);
+        for (uint32_t v = 0; v < vertexCount; v++) liveCount[v] = adjacency.getCount(v);
+
+        std::vector<uint64_t> cacheTime(vertexCount, 0);
+        std::vector<bool> emitted(triangleCount, false);
+        std::vector<uint32_t> deadEndStack;
+        std::vector<uint32_t> candidates;
+        std::vector<uint32_t> output;
+        output.reserve(indexCount);
+
+        uint64_t time = uint64_t(cacheSize) + 1;
+        uint32_t cursor = 0;
+
+        // Returns the most recently referenced vertex with live triangles,
+        // or the next vertex in input order with live triangles if there is none.
+        auto skipDeadEnd = [&]() -> uint32_t
+        {
+            while (!deadEndStack.empty())
+            {
+                uint32_t v = deadEndStack.back();
+                deadEndStack.pop_back();
+                if (liveCount[v] > 0) return v;
+            }
+            for (; cursor < vertexCount; cursor++)
+            {
+                if (liveCount[cursor] > 0) return cursor;
+            }
+            return kInvalidIndex;
+        };
+
+        uint32_t fanningVertex = skipDeadEnd();
+        if (pClusterOffsets) pClusterOffsets->push_back(0);
+
+        while (fanningVertex != kInvalidIndex)
+        {
+            // Emit all remaining triangles around the fanning vertex.
+            candidates.clear();
+            for (uint32_t i = adjacency.offsets[fanningVertex]; i < adjacency.offsets[fanningVertex + 1]; i++)
+            {
+                uint32_t t = adjacency.triangles[i];
+                if (emitted[t]) continue;
+
+                for (uint32_t k = 0; k < 3; k++)
+                {
+                    uint32_t v = pIndices[3 * t + k];
+                    output.push_back(v);
+                    deadEndStack.push_back(v);
+                    candidates.push_back(v);
+                    liveCount[v]--;
+                    if (time - cacheTime[v] > cacheSize) cacheTime[v] = time++;
+                }
+                emitted[t] = true;
+            }
+
+            // Pick the candidate that is furthest back in the cache while still remaining in the cache after its live triangles are emitted.
+            uint32_t nextVertex = kInvalidIndex;
+            int64_t bestPriority = -1;
+            for (uint32_t v : candidates)
+            {
+                if (liveCount[v] == 0) continue;
+                int64_t priority = 0;
+                int64_t age = (int64_t)(time - cacheTime[v]);
+                if (age + 2 * (int64_t)liveCount[v] <= (int64_t)cacheSize) priority = age;
+                if (priority > bestPriority)
+                {
+                    bestPriority = priority;
+                    nextVertex = v;
+                }
+            }
+
+            if (nextVertex == kInvalidIndex)
+            {
+                nextVertex = skipDeadEnd();
+                if (nextVertex != kInvalidIndex && pClusterOffsets) pClusterOffsets->push_back((uint32_t)(output.size() / 3));
+            }
+
+            fanningVertex = nextVertex;
+        }
+
+        FALCOR_ASSERT(output.size() == indexCount);
+        std::copy(output.begin(), output.end(), pIndices);
+    }
+
+    void optimizeOverdraw(uint32_t* pIndices, size_t indexCount, const std::vector<float3>& positions, const std::vector<uint32_t>& clusterOffsets)
+    {
+        FALCOR_ASSERT(indexCount % 3 == 0);
+
+        const size_t triangleCount = indexCount / 3;
+        const size_t clusterCount = clusterOffsets.size();
+        if (clusterCount <= 1) return;
+
+        // Compute area weighted centroid and normal of each cluster.
+        std::vector<float3> clusterCentroids(clusterCount, float3(0.f));
+        std::vector<float3> clusterNormals(clusterCount, float3(0.f));
+        std::vector<float> clusterAreas(clusterCount, 0.f);
+        float3 meshCentroid(0.f);
+        float meshArea = 0.f;
+
+        for (size_t c = 0; c < clusterCount; c++)
+        {
+            size_t begin = clusterOffsets[c];
+            size_t end = c + 1 < clusterCount ? clusterOffsets[c + 1] : triangleCount;
+            FALCOR_ASSERT(begin < end && end <= triangleCount);
+
+            for (size_t t = begin; t < end; t++)
+            {
+                const float3& p0 = positions[pIndices[3 * t + 0]];
+                const float3& p1 = positions[pIndices[3 * t + 1]];
+                const float3& p2 = positions[pIndices[3 * t + 2]];
+                float3 n = glm::cross(p1 - p0, p2 - p0);
+                float area = 0.5f * glm::length(n);
+                clusterCentroids[c] += area * (p0 + p1 + p2) / 3.f;
+                clusterNormals[c] += n;
+                clusterAreas[c] += area;
+            }
+
+            meshCentroid += clusterCentroids[c];
+            meshArea += clusterAreas[c];
+            if (clusterAreas[c] > 0.f) clusterCentroids[c] /= clusterAreas[c];
+        }
+        if (meshArea > 0.f) meshCentroid /= meshArea;
+
+        // Sort clusters by decreasing occlusion potential. Clusters facing away from the mesh centroid are likely to occlude the others.
+        std::vector<float> occlusion(clusterCount, 0.f);
+        for (size_t c = 0; c < clusterCount; c++)
+        {
+            float len = glm::length(clusterNormals[c]);
+            if (len > 0.f) occlusion[c] = glm::dot(clusterCentroids[c] - meshCentroid, clusterNormals[c] / len);
+        }
+
+        std::vector<uint32_t> order(clusterCount);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&occlusion](uint32_t a, uint32_t b) { return occlusion[a] > occlusion[b]; });
+
+        std::vector<uint32_t> output;
+        output.reserve(indexCount);
+        for (uint32_t c : order)
+        {
+            size_t begin = clusterOffsets[c];
+            size_t end = c + 1 < clusterCount ? clusterOffsets[c + 1] : triangleCount;
+            output.insert(output.end(), pIndices + 3 * begin, pIndices + 3 * end);
+        }
+
+        FALCOR_ASSERT(output.size() == indexCount);
+        std::copy(output.begin(), output.end(), pIndices);
+    }
+
+    std::vector<uint32_t> optimizeVertexFetch(uint32_t* pIndices, size_t indexCount, size_t vertexCount)
+    {
+        std::vector<uint32_t> remap(vertexCount, kInvalidIndex);
+        uint32_t nextVertex = 0;
+
+        for (size_t i = 0; i < indexCount; i++)
+        {
+            uint32_t& v = pIndices[i];
+            FALCOR_ASSERT(v < vertexCount);
+            if (remap[v] == kInvalidIndex) remap[v] = nextVertex++;
+            v = remap[v];
+        }
+
+        // Place unreferenced vertices last, in their original order.
+        for (auto& r : remap)
+        {
+            if (r == kInvalidIndex) r = nextVertex++;
+        }
+
+        return remap;
+    }
+}
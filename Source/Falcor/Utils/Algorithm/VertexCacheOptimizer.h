@@ -0,0 +1,105 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Utils/Math/Vector.h"
+#include <cstdint>
+#include <vector>
+
+namespace Falcor
+{
+    /** Post-transform vertex cache statistics for an indexed triangle list.
+        The counts are additive, so statistics of multiple meshes can be accumulated.
+    */
+    struct VertexCacheStats
+    {
+        uint64_t triangleCount = 0;     ///< Number of triangles.
+        uint64_t vertexCount = 0;       ///< Number of distinct vertices referenced by the triangles.
+        uint64_t cacheMissCount = 0;    ///< Number of vertex cache misses, i.e. number of vertex shader invocations.
+
+        /** Average cache miss ratio (vertex shader invocations per triangle). Ranges from 0.5 (best) to 3 (worst).
+        */
+        float getACMR() const { return triangleCount > 0 ? (float)cacheMissCount / triangleCount : 0.f; }
+
+        /** Average transform to vertex ratio (vertex shader invocations per vertex). The optimum is 1.
+        */
+        float getATVR() const { return vertexCount > 0 ? (float)cacheMissCount / vertexCount : 0.f; }
+
+        VertexCacheStats& operator+=(const VertexCacheStats& other)
+        {
+            triangleCount += other.triangleCount;
+            vertexCount += other.vertexCount;
+            cacheMissCount += other.cacheMissCount;
+            return *this;
+        }
+    };
+
+    /** Default size of the simulated post-transform vertex cache (FIFO).
+    */
+    inline constexpr uint32_t kDefaultVertexCacheSize = 16;
+
+    /** Simulate a FIFO post-transform vertex cache over an indexed triangle list.
+        \param[in] pIndices Triangle list indices.
+        \param[in] indexCount Number of indices. Must be a multiple of 3.
+        \param[in] vertexCount Number of vertices. All indices must be smaller than this.
+        \param[in] cacheSize Number of entries in the simulated cache.
+        \return Cache statistics.
+    */
+    FALCOR_API VertexCacheStats analyzeVertexCache(const uint32_t* pIndices, size_t indexCount, size_t vertexCount, uint32_t cacheSize = kDefaultVertexCacheSize);
+
+    /** Reorder triangles for post-transform vertex cache locality.
+        This implements the Tipsify algorithm by Sander et al. 2007, "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw".
+        The vertex order within each triangle is preserved, so the winding does not change.
+        \param[in,out] pIndices Triangle list indices. These are reordered in place.
+        \param[in] indexCount Number of indices. Must be a multiple of 3.
+        \param[in] vertexCount Number of vertices. All indices must be smaller than this.
+        \param[in] cacheSize Number of entries in the targeted cache.
+        \param[out] pClusterOffsets Optional. If specified, the first triangle of each cluster is written here. Clusters are separated
+                    by the points where the algorithm had to jump to a disconnected part of the mesh. This is used by optimizeOverdraw().
+    */
+    FALCOR_API void optimizeVertexCache(uint32_t* pIndices, size_t indexCount, size_t vertexCount, uint32_t cacheSize = kDefaultVertexCacheSize, std::vector<uint32_t>* pClusterOffsets = nullptr);
+
+    /** Reorder triangle clusters to reduce overdraw.
+        Clusters are sorted by their view-independent occlusion potential, i.e. how much they face outwards from the mesh centroid,
+        such that outward facing clusters are drawn first. The order of triangles within each cluster is preserved.
+        \param[in,out] pIndices Triangle list indices, ordered by optimizeVertexCache(). These are reordered in place.
+        \param[in] indexCount Number of indices. Must be a multiple of 3.
+        \param[in] positions Vertex positions.
+        \param[in] clusterOffsets First triangle of each cluster as returned by optimizeVertexCache().
+    */
+    FALCOR_API void optimizeOverdraw(uint32_t* pIndices, size_t indexCount, const std::vector<float3>& positions, const std::vector<uint32_t>& clusterOffsets);
+
+    /** Reorder vertices for vertex fetch locality.
+        Vertices are renumbered in the order they are first referenced by the index buffer. Unreferenced vertices are placed last.
+        \param[in,out] pIndices Triangle list indices. These are rewritten to use the new vertex numbering.
+        \param[in] indexCount Number of indices.
+        \param[in] vertexCount Number of vertices. All indices must be smaller than this.
+        \return Remapping table from old to new vertex index. The caller is responsible for reordering the vertex data accordingly.
+    */
+    FALCOR_API std::vector<uint32_t> optimizeVertexFetch(uint32_t* pIndices, size_t indexCount, size_t vertexCount);
+}
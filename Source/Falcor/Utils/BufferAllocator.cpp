@@ -27,9 +27,23 @@
  **************************************************************************/
 #include "BufferAllocator.h"
 #include "Utils/Math/Common.h"
+#include <cstring>
 
 namespace Falcor
 {
+    namespace
+    {
+        /** Get the size class of a memory block, which is the floor of log2 of the size.
+        */
+        size_t getSizeClass(size_t byteSize)
+        {
+            FALCOR_ASSERT(byteSize > 0);
+            size_t sizeClass = 0;
+            while (byteSize >>= 1) sizeClass++;
+            return sizeClass;
+        }
+    }
+
     BufferAllocator::BufferAllocator(size_t alignment, size_t elementSize, size_t cacheLineSize, ResourceBindFlags bindFlags)
         : mAlignment(alignment)
         , mElementSize(elementSize)
@@ -54,10 +68,41 @@ namespace Falcor
 
     size_t BufferAllocator::allocate(size_t byteSize)
     {
+        size_t byteOffset = 0;
+        if (allocFromFreeList(byteSize, byteOffset)) return byteOffset;
+
         computeAndAllocatePadding(byteSize);
         return allocInternal(byteSize);
     }
 
+    void BufferAllocator::free(size_t byteOffset, size_t byteSize)
+    {
+        checkArgument(byteOffset + byteSize <= mBuffer.size(), "Memory region is out of range.");
+        if (byteSize == 0) return;
+
+        // Check that the region is not already released.
+        auto next = mFreeBlocks.lower_bound(byteOffset);
+        auto prev = next != mFreeBlocks.begin() ? std::prev(next) : mFreeBlocks.end();
+        checkArgument(next == mFreeBlocks.end() || byteOffset + byteSize <= next->first, "Memory region is already released.");
+        checkArgument(prev == mFreeBlocks.end() || prev->first + prev->second <= byteOffset, "Memory region is already released.");
+
+        // Merge with adjacent released blocks.
+        size_t start = byteOffset;
+        size_t end = byteOffset + byteSize;
+        if (next != mFreeBlocks.end() && next->first == end)
+        {
+            end += next->second;
+            removeFreeBlock(next);
+        }
+        if (prev != mFreeBlocks.end() && prev->first + prev->second == start)
+        {
+            start = prev->first;
+            removeFreeBlock(prev);
+        }
+
+        insertFreeBlock(start, end - start);
+    }
+
     void BufferAllocator::setBlob(const void* pData, size_t byteOffset, size_t byteSize)
     {
         checkArgument(pData != nullptr, "Invalid pointer.");
@@ -75,7 +120,10 @@ namespace Falcor
     void BufferAllocator::clear()
     {
         mBuffer.clear();
-        mDirty = {};
+        mDirtyRanges.clear();
+        mFreeBlocks.clear();
+        mFreeLists.clear();
+        mFreeSize = 0;
     }
 
     Buffer::SharedPtr BufferAllocator::getGPUBuffer(Device* pDevice)
@@ -93,6 +141,9 @@ namespace Falcor
 
         if (mpGpuBuffer == nullptr || mpGpuBuffer->getSize() < bufSize)
         {
+            // Grow an existing buffer geometrically, so that adding allocations over time doesn't recreate it every time.
+            if (mpGpuBuffer) bufSize = align_to(elemSize, std::max(bufSize, mpGpuBuffer->getSize() + mpGpuBuffer->getSize() / 2));
+
             if (mElementSize > 0)
             {
                 size_t elemCount = bufSize / mElementSize;
@@ -104,30 +155,27 @@ namespace Falcor
                 mpGpuBuffer = Buffer::create(pDevice, bufSize, mBindFlags, Buffer::CpuAccess::None, nullptr);
             }
 
-            mDirty = Range(0, mBuffer.size()); // Mark entire buffer as dirty so the data gets uploaded.
+            // Mark entire buffer as dirty so the data gets uploaded.
+            mDirtyRanges.clear();
+            mDirtyRanges.emplace(0, mBuffer.size());
         }
 
-        // If any range is dirty, upload the data from the CPU to the GPU.
-        if (mDirty.start < mDirty.end)
+        // Upload each dirty range from the CPU to the GPU.
+        FALCOR_ASSERT(mBuffer.size() <= mpGpuBuffer->getSize());
+        for (const auto& [start, end] : mDirtyRanges)
         {
-            size_t byteSize = mDirty.end - mDirty.start;
-            size_t byteOffset = mDirty.start;
-            FALCOR_ASSERT(byteOffset + byteSize <= mBuffer.size());
-            FALCOR_ASSERT(mBuffer.size() <= mpGpuBuffer->getSize());
-            mpGpuBuffer->setBlob(mBuffer.data() + byteOffset, byteOffset, byteSize);
-
-            mDirty = { mBuffer.size(), 0 }; // Reset dirty range to inverted range. Any min/max operation on it will work.
+            FALCOR_ASSERT(start < end && end <= mBuffer.size());
+            mpGpuBuffer->setBlob(mBuffer.data() + start, start, end - start);
         }
+        mDirtyRanges.clear();
 
         return mpGpuBuffer;
     }
 
     // Private
 
-    void BufferAllocator::computeAndAllocatePadding(size_t byteSize)
+    size_t BufferAllocator::computeAlignedOffset(size_t currentOffset, size_t byteSize) const
     {
-        size_t currentOffset = mBuffer.size();
-
         if (mAlignment > 0 && currentOffset % mAlignment > 0)
         {
             // We're not at the minimum alignment; get aligned.
@@ -145,6 +193,13 @@ namespace Falcor
             }
         }
 
+        return currentOffset;
+    }
+
+    void BufferAllocator::computeAndAllocatePadding(size_t byteSize)
+    {
+        size_t currentOffset = computeAlignedOffset(mBuffer.size(), byteSize);
+
         size_t pad = currentOffset - mBuffer.size();
         if (pad > 0)
         {
@@ -157,13 +212,79 @@ namespace Falcor
     {
         size_t byteOffset = mBuffer.size();
         mBuffer.insert(mBuffer.end(), byteSize, {});
+        // The GPU buffer may already be large enough to hold the new memory, so it needs to be uploaded.
+        markAsDirty(byteOffset, byteSize);
         return byteOffset;
     }
 
-    void BufferAllocator::markAsDirty(const Range& range)
+    bool BufferAllocator::allocFromFreeList(size_t byteSize, size_t& byteOffset)
     {
-        FALCOR_ASSERT(range.start < range.end);
-        mDirty.start = std::min(mDirty.start, range.start);
-        mDirty.end = std::max(mDirty.end, range.end);
+        if (mFreeBlocks.empty() || byteSize == 0) return false;
+
+        // Search the free lists starting at the size class of the allocation.
+        // Blocks in the first size class may be too small, blocks in larger classes may not fit after alignment.
+        for (size_t sizeClass = getSizeClass(byteSize); sizeClass < mFreeLists.size(); sizeClass++)
+        {
+            for (size_t blockOffset : mFreeLists[sizeClass])
+            {
+                auto it = mFreeBlocks.find(blockOffset);
+                FALCOR_ASSERT(it != mFreeBlocks.end());
+                const size_t blockEnd = blockOffset + it->second;
+                const size_t offset = computeAlignedOffset(blockOffset, byteSize);
+                if (offset + byteSize > blockEnd) continue;
+
+                // Use the block and release the memory before and after the allocation.
+                removeFreeBlock(it);
+                if (offset > blockOffset) insertFreeBlock(blockOffset, offset - blockOffset);
+                if (offset + byteSize < blockEnd) insertFreeBlock(offset + byteSize, blockEnd - offset - byteSize);
+
+                // Clear the memory to match newly allocated memory.
+                std::memset(mBuffer.data() + offset, 0, byteSize);
+                markAsDirty(offset, byteSize);
+
+                byteOffset = offset;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void BufferAllocator::insertFreeBlock(size_t byteOffset, size_t byteSize)
+    {
+        FALCOR_ASSERT(byteSize > 0);
+        mFreeBlocks.emplace(byteOffset, byteSize);
+        size_t sizeClass = getSizeClass(byteSize);
+        if (sizeClass >= mFreeLists.size()) mFreeLists.resize(sizeClass + 1);
+        mFreeLists[sizeClass].insert(byteOffset);
+        mFreeSize += byteSize;
+    }
+
+    void BufferAllocator::removeFreeBlock(std::map<size_t, size_t>::iterator it)
+    {
+        mFreeLists[getSizeClass(it->second)].erase(it->first);
+        mFreeSize -= it->second;
+        mFreeBlocks.erase(it);
+    }
+
+    void BufferAllocator::markAsDirty(size_t byteOffset, size_t byteSize)
+    {
+        if (byteSize == 0) return;
+        size_t start = byteOffset;
+        size_t end = byteOffset + byteSize;
+
+        // Find the first range that overlaps or touches the new range.
+        auto it = mDirtyRanges.upper_bound(start);
+        if (it != mDirtyRanges.begin() && std::prev(it)->second >= start) --it;
+
+        // Merge all ranges that overlap or touch the new range.
+        while (it != mDirtyRanges.end() && it->first <= end)
+        {
+            start = std::min(start, it->first);
+            end = std::max(end, it->second);
+            it = mDirtyRanges.erase(it);
+        }
+
+        mDirtyRanges.emplace_hint(it, start, end);
     }
 }
@@ -30,6 +30,8 @@
 #include "Core/Macros.h"
 #include "Core/API/Buffer.h"
 
+#include <map>
+#include <set>
 #include <vector>
 
 namespace Falcor
@@ -42,6 +44,12 @@ namespace Falcor
         The caller should not hold on to pointers into the buffers as the
         memory may get reallocated at any time.
 
+        Allocations can be released with free(). Released memory is kept in
+        size-class free lists and reused by later allocations, but the buffer
+        never shrinks. Modified memory is tracked as a sorted set of disjoint
+        ranges, each of which is uploaded separately when the GPU buffer is
+        requested. The GPU buffer grows geometrically.
+
         BufferAllocator can enforce various alignment requirements,
         including minimum byte alignment and (optionally) that allocated
         objects don't span multiple cache lines if possible.
@@ -83,8 +91,7 @@ namespace Falcor
         template <typename T> size_t pushBack(const T& obj)
         {
             const size_t byteSize = sizeof(T);
-            computeAndAllocatePadding(byteSize);
-            size_t byteOffset = allocInternal(byteSize);
+            size_t byteOffset = allocate(byteSize);
             T* ptr = reinterpret_cast<T*>(mBuffer.data() + byteOffset);
             *ptr = obj;
             markAsDirty(byteOffset, byteSize);
@@ -98,14 +105,30 @@ namespace Falcor
         template <typename T, typename ...Args> size_t emplaceBack(Args&&... args)
         {
             const size_t byteSize = sizeof(T);
-            computeAndAllocatePadding(byteSize);
-            size_t byteOffset = allocInternal(byteSize);
+            size_t byteOffset = allocate(byteSize);
             void* ptr = mBuffer.data() + byteOffset;
             new (ptr) T(std::forward<Args>(args)...);
             markAsDirty(byteOffset, byteSize);
             return byteOffset;
         }
 
+        /** Releases a memory region so that it can be reused by later allocations.
+            Adjacent released regions are merged. The buffer size is not reduced.
+            \param[in] byteOffset Offset in bytes returned by the allocation.
+            \param[in] byteSize Size in bytes of the allocation.
+        */
+        void free(size_t byteOffset, size_t byteSize);
+
+        /** Releases memory holding an array of the given type.
+            \param[in] byteOffset Offset in bytes returned by the allocation.
+            \param[in] count Number of array elements.
+        */
+        template<typename T>
+        void free(size_t byteOffset, size_t count = 1)
+        {
+            free(byteOffset, count * sizeof(T));
+        }
+
         /** Set data into a memory region.
             \param[in] pData Pointer to the source data.
             \param[in] byteOffset Offset in bytes to the destination memory region.
@@ -165,6 +188,16 @@ namespace Falcor
         */
         size_t getSize() const { return mBuffer.size(); }
 
+        /** Get the total size of released memory available for reuse.
+            \return Size in bytes.
+        */
+        size_t getFreeSize() const { return mFreeSize; }
+
+        /** Get the memory ranges that are uploaded on the next call to getGPUBuffer().
+            \return Sorted, disjoint and non-adjacent ranges, mapping start offset to end offset in bytes.
+        */
+        const std::map<size_t, size_t>& getDirtyRanges() const { return mDirtyRanges; }
+
         /** Clear buffer. This removes all allocations.
         */
         void clear();
@@ -175,28 +208,27 @@ namespace Falcor
         Buffer::SharedPtr getGPUBuffer(Device* pDevice);
 
     private:
+        size_t computeAlignedOffset(size_t currentOffset, size_t byteSize) const;
         void computeAndAllocatePadding(size_t byteSize);
         size_t allocInternal(size_t byteSize);
+        bool allocFromFreeList(size_t byteSize, size_t& byteOffset);
 
-        struct Range
-        {
-            size_t start = 0;
-            size_t end = 0;
-            Range() {};
-            Range(size_t s, size_t e) : start(s), end(e) {}
-        };
+        void insertFreeBlock(size_t byteOffset, size_t byteSize);
+        void removeFreeBlock(std::map<size_t, size_t>::iterator it);
 
-        void markAsDirty(const Range& range);
-        void markAsDirty(size_t byteOffset, size_t byteSize) { markAsDirty(Range(byteOffset, byteOffset + byteSize)); }
+        void markAsDirty(size_t byteOffset, size_t byteSize);
 
-        const size_t mAlignment;            ///< Minimum alignment for allocations from base address. A value of zero means no aligment is performed.
-        const size_t mElementSize;          ///< Element size for structured buffers. A value of zero means a raw buffer is created.
-        const size_t mCacheLineSize;        ///< Allocation are aligned to not span multiple cache lines (if possible). A value of zero means do not care about cache line alignment.
-        const ResourceBindFlags mBindFlags; ///< Bind flags for the GPU buffer.
+        const size_t mAlignment;                  ///< Minimum alignment for allocations from base address. A value of zero means no aligment is performed.
+        const size_t mElementSize;                ///< Element size for structured buffers. A value of zero means a raw buffer is created.
+        const size_t mCacheLineSize;              ///< Allocation are aligned to not span multiple cache lines (if possible). A value of zero means do not care about cache line alignment.
+        const ResourceBindFlags mBindFlags;       ///< Bind flags for the GPU buffer.
 
-        Range mDirty;                       ///< Range of buffer that is dirty and needs to be updatd on the GPU. We track a single dirty range for now to minimize the number of uploads, but this could be changed.
+        std::map<size_t, size_t> mDirtyRanges;    ///< Ranges of the buffer that are dirty and need to be updated on the GPU (start -> end). Overlapping and adjacent ranges are merged.
+        std::map<size_t, size_t> mFreeBlocks;     ///< Released memory blocks (offset -> size). Adjacent blocks are merged.
+        std::vector<std::set<size_t>> mFreeLists; ///< Offsets of released memory blocks, indexed by size class (floor of log2 of the size).
+        size_t mFreeSize = 0;                     ///< Total size of released memory blocks.
 
-        std::vector<uint8_t> mBuffer;       ///< CPU buffer holding a copy of the data.
-        Buffer::SharedPtr mpGpuBuffer;      ///< GPU buffer holding the data.
+        std::vector<uint8_t> mBuffer;             ///< CPU buffer holding a copy of the data.
+        Buffer::SharedPtr mpGpuBuffer;            ///< GPU buffer holding the data.
     };
 }
@@ -0,0 +1,267 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "SpectralDatabase.h"
+#include "Core/Assert.h"
+#include "Core/Errors.h"
+#include "Core/Platform/OS.h"
+#include "Utils/CryptoUtils.h"
+#include "Utils/Logger.h"
+#include "Utils/Threading.h"
+#include "Utils/Timing/CpuTimer.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <random>
+
+namespace Falcor
+{
+    namespace
+    {
+        const char kMagic[4] = { 'F', 'S', 'P', 'D' };
+        const uint32_t kVersion = 1;
+
+        const char kDatabaseDirectory[] = "NVIDIA/Falcor/SpectralDatabase";
+        const char kSpectrumExtension[] = ".spd";
+
+        /** File header. It is followed by the entries, the sample block (floats) and the name block (chars).
+        */
+        struct Header
+        {
+            char magic[4];
+            uint32_t version;
+            uint32_t entryCount;
+            uint32_t sampleCount;   ///< Number of floats in the sample block.
+            uint32_t namesSize;     ///< Size of the name block in bytes.
+        };
+
+        /** Find all spectrum files in a directory and its subdirectories.
+            \return List of (name, path) pairs sorted by name.
+        */
+        std::vector<std::pair<std::string, std::filesystem::path>> findSpectrumFiles(const std::filesystem::path& directory)
+        {
+            std::vector<std::pair<std::string, std::filesystem::path>> files;
+            for (const auto& entry : std::filesystem::recursive_directory_iterator(directory))
+            {
+                if (!entry.is_regular_file() || entry.path().extension() != kSpectrumExtension) continue;
+                auto name = std::filesystem::relative(entry.path(), directory).replace_extension().generic_string();
+                files.emplace_back(std::move(name), entry.path());
+            }
+            std::sort(files.begin(), files.end());
+            return files;
+        }
+    }
+
+    struct SpectralDatabase::Entry
+    {
+        uint32_t nameOffset;    ///< Offset of the name in the name block.
+        uint32_t nameLength;    ///< Length of the name.
+        uint32_t sampleOffset;  ///< Offset of the wavelengths in the sample block. The values follow the wavelengths.
+        uint32_t sampleCount;   ///< Number of wavelength/value pairs.
+    };
+
+    const SpectralDatabase& SpectralDatabase::getDefault()
+    {
+        static std::unique_ptr<SpectralDatabase> spDatabase;
+        static std::once_flag sFlag;
+
+        std::call_once(sFlag, []()
+        {
+            const auto tablesDirectory = std::filesystem::path(_PROJECT_DIR_) / "../Tables";
+
+            // Key the database by the names, sizes and modification times of the tables so it's recompiled when they change.
+            SHA1 sha1;
+            sha1.update(kVersion);
+            for (const auto& [name, path] : findSpectrumFiles(tablesDirectory))
+            {
+                sha1.update(std::string_view(name));
+                sha1.update((uint64_t)std::filesystem::file_size(path));
+                sha1.update((int64_t)std::filesystem::last_write_time(path).time_since_epoch().count());
+            }
+
+            const auto path = getAppDataDirectory() / kDatabaseDirectory / (SHA1::toString(sha1.finalize()) + ".bin");
+            if (!std::filesystem::exists(path))
+            {
+                auto startTime = CpuTimer::getCurrentTimePoint();
+                std::filesystem::create_directories(path.parent_path());
+                compile(tablesDirectory, path);
+                logInfo("Compiled spectral database '{}' in {:.1f} ms.", path, CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint()));
+            }
+
+            spDatabase = std::make_unique<SpectralDatabase>(path);
+        });
+
+        FALCOR_ASSERT(spDatabase);
+        return *spDatabase;
+    }
+
+    void SpectralDatabase::compile(const std::filesystem::path& tablesDirectory, const std::filesystem::path& path)
+    {
+        const auto files = findSpectrumFiles(tablesDirectory);
+
+        // Parse the files in parallel.
+        std::vector<std::optional<PiecewiseLinearSpectrum>> spectra(files.size());
+        Threading::parallelFor(0, files.size(), 1, [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++) spectra[i] = PiecewiseLinearSpectrum::fromFile(files[i].second);
+        });
+
+        std::vector<Entry> entries(files.size());
+        std::vector<float> samples;
+        std::string names;
+        for (size_t i = 0; i < files.size(); i++)
+        {
+            const auto& wavelengths = spectra[i]->getWavelengths();
+            const auto& values = spectra[i]->getValues();
+            FALCOR_ASSERT(wavelengths.size() == values.size());
+
+            entries[i] = { (uint32_t)names.size(), (uint32_t)files[i].first.size(), (uint32_t)samples.size(), (uint32_t)wavelengths.size() };
+            names += files[i].first;
+            samples.insert(samples.end(), wavelengths.begin(), wavelengths.end());
+            samples.insert(samples.end(), values.begin(), values.end());
+        }
+        checkInvariant(samples.size() <= std::numeric_limits<uint32_t>::max() && names.size() <= std::numeric_limits<uint32_t>::max(), "Spectral database is too large.");
+
+        Header header;
+        std::memcpy(header.magic, kMagic, sizeof(kMagic));
+        header.version = kVersion;
+        header.entryCount = (uint32_t)entries.size();
+        header.sampleCount = (uint32_t)samples.size();
+        header.namesSize = (uint32_t)names.size();
+
+        // Write to a uniquely named temporary file first so that a partially written database is never opened,
+        // and processes compiling the same database concurrently don't write to the same file.
+        std::random_device rd;
+        auto tempPath = path;
+        tempPath += fmt::format(".{:08x}{:08x}.tmp", rd(), rd());
+        std::error_code ec;
+        {
+            std::ofstream stream(tempPath, std::ios::binary | std::ios::trunc);
+            if (!stream) throw RuntimeError("Failed to create spectral database '{}'.", path);
+            stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            stream.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(Entry));
+            stream.write(reinterpret_cast<const char*>(samples.data()), samples.size() * sizeof(float));
+            stream.write(names.data(), names.size());
+            if (!stream)
+            {
+                stream.close();
+                std::filesystem::remove(tempPath, ec);
+                throw RuntimeError("Failed to write spectral database '{}'.", path);
+            }
+        }
+
+        std::filesystem::rename(tempPath, path, ec);
+        if (ec)
+        {
+            std::filesystem::remove(tempPath, ec);
+
+            // Another process may have written the same database in the meantime (and may have it open, which makes the rename fail on Windows).
+            try
+            {
+                SpectralDatabase database(path);
+                return;
+            }
+            catch (const RuntimeError&)
+            {
+                throw RuntimeError("Failed to write spectral database '{}'.", path);
+            }
+        }
+    }
+
+    SpectralDatabase::SpectralDatabase(const std::filesystem::path& path)
+    {
+        if (!mFile.open(path, MemoryMappedFile::kWholeFile, MemoryMappedFile::AccessHint::RandomAccess))
+        {
+            throw RuntimeError("Failed to open spectral database '{}'.", path);
+        }
+
+        const uint8_t* pData = static_cast<const uint8_t*>(mFile.getData());
+        const size_t size = mFile.getSize();
+
+        Header header;
+        if (size < sizeof(Header)) throw RuntimeError("'{}' is not a valid spectral database.", path);
+        std::memcpy(&header, pData, sizeof(Header));
+        if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion)
+        {
+            throw RuntimeError("'{}' is not a valid spectral database.", path);
+        }
+
+        const size_t entriesSize = (size_t)header.entryCount * sizeof(Entry);
+        const size_t samplesSize = (size_t)header.sampleCount * sizeof(float);
+        if (size != sizeof(Header) + entriesSize + samplesSize + header.namesSize)
+        {
+            throw RuntimeError("Spectral database '{}' has unexpected size.", path);
+        }
+
+        mEntryCount = header.entryCount;
+        mpEntries = reinterpret_cast<const Entry*>(pData + sizeof(Header));
+        mpSamples = reinterpret_cast<const float*>(pData + sizeof(Header) + entriesSize);
+        mpNames = reinterpret_cast<const char*>(pData + sizeof(Header) + entriesSize + samplesSize);
+
+        // Validate the entries so that lookups never read outside the file.
+        for (size_t i = 0; i < mEntryCount; i++)
+        {
+            const Entry& entry = mpEntries[i];
+            if ((uint64_t)entry.nameOffset + entry.nameLength > header.namesSize || (uint64_t)entry.sampleOffset + 2ull * entry.sampleCount > header.sampleCount)
+            {
+                throw RuntimeError("Spectral database '{}' is corrupt.", path);
+            }
+        }
+    }
+
+    std::vector<std::string> SpectralDatabase::getSpectrumNames() const
+    {
+        std::vector<std::string> names;
+        names.reserve(mEntryCount);
+        for (size_t i = 0; i < mEntryCount; i++) names.emplace_back(getName(mpEntries[i]));
+        return names;
+    }
+
+    std::optional<PiecewiseLinearSpectrum> SpectralDatabase::getSpectrum(std::string_view name) const
+    {
+        const Entry* pEntry = findEntry(name);
+        if (!pEntry) return {};
+
+        const float* pWavelengths = mpSamples + pEntry->sampleOffset;
+        const float* pValues = pWavelengths + pEntry->sampleCount;
+        return PiecewiseLinearSpectrum(fstd::span<const float>(pWavelengths, pEntry->sampleCount), fstd::span<const float>(pValues, pEntry->sampleCount));
+    }
+
+    const SpectralDatabase::Entry* SpectralDatabase::findEntry(std::string_view name) const
+    {
+        const Entry* pEnd = mpEntries + mEntryCount;
+        const Entry* pEntry = std::lower_bound(mpEntries, pEnd, name, [this](const Entry& entry, std::string_view name) { return getName(entry) < name; });
+        return pEntry != pEnd && getName(*pEntry) == name ? pEntry : nullptr;
+    }
+
+    std::string_view SpectralDatabase::getName(const Entry& entry) const
+    {
+        return std::string_view(mpNames + entry.nameOffset, entry.nameLength);
+    }
+}
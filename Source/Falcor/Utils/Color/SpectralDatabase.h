@@ -0,0 +1,107 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Spectrum.h"
+#include "Core/Macros.h"
+#include "Core/Platform/MemoryMappedFile.h"
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Falcor
+{
+    /** Read-only database of named piecewise linear spectra.
+
+        The database is a single binary file holding the samples of all spectra and a sorted name index.
+        It is compiled from a directory of .spd text files (as read by PiecewiseLinearSpectrum::fromFile()).
+        Each spectrum is named by its path relative to that directory, without the extension,
+        e.g. "ior/Ag.eta" for the file "ior/Ag.eta.spd".
+
+        Opening a database memory-maps the file, and looking up a spectrum is a binary search over the names.
+    */
+    class FALCOR_API SpectralDatabase
+    {
+    public:
+        /** Get the database of the spectral tables shipped with Falcor (emission spectra and IORs).
+            The database is compiled on first use and stored in the application data directory.
+            It is recompiled whenever the tables change.
+            This function is thread-safe.
+            \return The database, or throws an exception if it could not be created.
+        */
+        static const SpectralDatabase& getDefault();
+
+        /** Compile a database from a directory of .spd files.
+            All .spd files in the directory and its subdirectories are included.
+            \param[in] tablesDirectory Directory containing the .spd files.
+            \param[in] path Path of the database file to write.
+        */
+        static void compile(const std::filesystem::path& tablesDirectory, const std::filesystem::path& path);
+
+        /** Open a database file.
+            Throws an exception if the file does not exist or is not a valid database.
+            \param[in] path Path of the database file.
+        */
+        explicit SpectralDatabase(const std::filesystem::path& path);
+
+        SpectralDatabase(const SpectralDatabase&) = delete;
+        SpectralDatabase& operator=(const SpectralDatabase&) = delete;
+
+        /** Get the number of spectra in the database.
+        */
+        size_t getSpectrumCount() const { return mEntryCount; }
+
+        /** Get the names of all spectra in sorted order.
+        */
+        std::vector<std::string> getSpectrumNames() const;
+
+        /** Check if the database contains a spectrum.
+            \param[in] name Spectrum name.
+        */
+        bool hasSpectrum(std::string_view name) const { return findEntry(name) != nullptr; }
+
+        /** Get a spectrum.
+            \param[in] name Spectrum name.
+            \return The spectrum, or an empty optional if the database doesn't contain a spectrum with this name.
+        */
+        std::optional<PiecewiseLinearSpectrum> getSpectrum(std::string_view name) const;
+
+    private:
+        struct Entry;
+
+        const Entry* findEntry(std::string_view name) const;
+        std::string_view getName(const Entry& entry) const;
+
+        MemoryMappedFile mFile;
+        const Entry* mpEntries = nullptr;
+        const float* mpSamples = nullptr;
+        const char* mpNames = nullptr;
+        size_t mEntryCount = 0;
+    };
+}
@@ -132,6 +132,14 @@ namespace Falcor
 
         auto getBins() const { return mValues.size(); }
 
+        /** Get the wavelengths in nm.
+        */
+        const std::vector<float>& getWavelengths() const { return mWavelengths; }
+
+        /** Get the values at each wavelength.
+        */
+        const std::vector<float>& getValues() const { return mValues; }
+
     private:
         std::vector<float> mWavelengths;    ///< Wavelengths in nm.
         std::vector<float> mValues;         ///< Values at each wavelength.
@@ -26,107 +26,339 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "AsyncTextureLoader.h"
+#include "Bitmap.h"
+#include "ImageIO.h"
+#include "Core/Errors.h"
 #include "Core/API/Device.h"
-#include "Utils/Threading.h"
+#include "Core/Platform/OS.h"
+#include "Utils/Logger.h"
+#include <algorithm>
+#include <exception>
 
 namespace Falcor
 {
-    namespace
-    {
-        constexpr size_t kUploadsPerFlush = 16; ///< Number of texture uploads before issuing a flush (to keep upload heap from growing).
-    }
-
     AsyncTextureLoader::AsyncTextureLoader(std::shared_ptr<Device> pDevice, size_t threadCount)
         : mpDevice(std::move(pDevice))
     {
-        runWorkers(threadCount);
+        runWorkers(std::max<size_t>(threadCount, 1));
     }
 
     AsyncTextureLoader::~AsyncTextureLoader()
     {
         terminateWorkers();
 
-        mpDevice->flushAndSync();
+        if (mpDevice) mpDevice->flushAndSync();
     }
 
-    std::future<Texture::SharedPtr> AsyncTextureLoader::loadFromFile(const std::filesystem::path& path, bool generateMipLevels, bool loadAsSrgb, Resource::BindFlags bindFlags, LoadCallback callback)
+    std::future<Texture::SharedPtr> AsyncTextureLoader::loadFromFile(const std::filesystem::path& path, bool generateMipLevels, bool loadAsSrgb, Resource::BindFlags bindFlags, LoadCallback callback, Priority priority)
+    {
+        auto decodeFunction = [pDevice = mpDevice.get(), path, generateMipLevels, loadAsSrgb, bindFlags]() -> DecodedTexture
+        {
+            std::filesystem::path fullPath;
+            if (!findFileInDataDirectories(path, fullPath))
+            {
+                logWarning("Error when loading image file. Can't find image file '{}'.", path);
+                return {};
+            }
+
+            // DDS files are uploaded as stored. The file is read here and the texture is created on the upload thread.
+            if (hasExtension(fullPath, "dds"))
+            {
+                std::shared_ptr<const ImageIO::DDSData> pData;
+                try
+                {
+                    pData = std::make_shared<ImageIO::DDSData>(ImageIO::loadDDSData(fullPath, loadAsSrgb));
+                }
+                catch (const RuntimeError& e)
+                {
+                    logWarning("Failed to load DDS image from '{}': {}", fullPath, e.what());
+                    return {};
+                }
+
+                auto upload = [pDevice, pData, fullPath, bindFlags]()
+                {
+                    Texture::SharedPtr pTexture = ImageIO::createTextureFromDDSData(pDevice, *pData, bindFlags);
+                    if (pTexture) pTexture->setSourcePath(fullPath);
+                    return pTexture;
+                };
+                return { upload, pData->imageData.size() };
+            }
+
+            std::shared_ptr<const Bitmap> pBitmap = Bitmap::createFromFile(fullPath, true);
+            if (!pBitmap) return {};
+
+            auto upload = [pDevice, pBitmap, fullPath, generateMipLevels, loadAsSrgb, bindFlags]()
+            {
+                ResourceFormat format = loadAsSrgb ? linearToSrgbFormat(pBitmap->getFormat()) : pBitmap->getFormat();
+                Texture::SharedPtr pTexture = Texture::create2D(
+                    pDevice, pBitmap->getWidth(), pBitmap->getHeight(), format, 1, generateMipLevels ? Texture::kMaxPossible : 1,
+                    pBitmap->getData(), bindFlags
+                );
+                pTexture->setSourcePath(fullPath);
+                return pTexture;
+            };
+            return { upload, pBitmap->getSize() };
+        };
+
+        return submit(decodeFunction, callback, priority).future;
+    }
+
+    AsyncTextureLoader::Request AsyncTextureLoader::load(LoadFunction loadFunction, LoadCallback callback, Priority priority)
+    {
+        // The load function creates GPU resources, so it runs as the upload stage to keep device access on the upload thread.
+        auto decodeFunction = [loadFunction = std::move(loadFunction)]() -> DecodedTexture
+        {
+            return { loadFunction, 0 };
+        };
+
+        return submit(decodeFunction, std::move(callback), priority);
+    }
+
+    AsyncTextureLoader::Request AsyncTextureLoader::submit(DecodeFunction decodeFunction, LoadCallback callback, Priority priority)
     {
         std::lock_guard<std::mutex> lock(mMutex);
-        mLoadRequestQueue.push(LoadRequest{path, generateMipLevels, loadAsSrgb, bindFlags, callback });
-        mCondition.notify_one();
-        return mLoadRequestQueue.back().promise.get_future();
+        RequestID id = mNextRequestID++;
+        LoadRequest& request = mRequests[id];
+        request.decodeFunction = std::move(decodeFunction);
+        request.callback = std::move(callback);
+        request.priority = priority;
+        mDecodeQueue.insert(getQueueKey(priority, id));
+        mCondition.notify_all();
+        return { id, request.promise.get_future() };
     }
 
-    void AsyncTextureLoader::runWorkers(size_t threadCount)
+    void AsyncTextureLoader::setPriority(RequestID id, Priority priority)
     {
-        // Create a barrier to synchronize worker threads before issuing a global flush.
-        mFlushBarrier = std::make_shared<Barrier>(threadCount, [&]() {
-            mpDevice->flushAndSync();
-            mFlushPending = false;
-            mUploadCounter = 0;
-            });
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto it = mRequests.find(id);
+        if (it == mRequests.end()) return;
+
+        LoadRequest& request = it->second;
+        if (request.state != RequestState::Decoding)
+        {
+            auto& queue = request.state == RequestState::Queued ? mDecodeQueue : mUploadQueue;
+            queue.erase(getQueueKey(request.priority, id));
+            queue.insert(getQueueKey(priority, id));
+        }
+        request.priority = priority;
+    }
+
+    bool AsyncTextureLoader::cancel(RequestID id)
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        auto it = mRequests.find(id);
+        if (it == mRequests.end()) return false;
+
+        LoadRequest& request = it->second;
+        switch (request.state)
+        {
+        case RequestState::Decoding:
+            // The worker decoding the request completes it when decoding has finished.
+            request.cancelled = true;
+            return true;
+        case RequestState::Queued:
+            mDecodeQueue.erase(getQueueKey(request.priority, id));
+            break;
+        case RequestState::Decoded:
+            mUploadQueue.erase(getQueueKey(request.priority, id));
+            mStats.hostMemoryInUse -= request.decoded.hostMemorySize;
+            break;
+        }
+
+        LoadRequest cancelled = std::move(request);
+        mRequests.erase(it);
+        mStats.cancelledCount++;
+        mCondition.notify_all();
+        lock.unlock();
 
+        cancelled.decoded = {};
+        complete(cancelled, nullptr);
+        return true;
+    }
+
+    void AsyncTextureLoader::setHostMemoryBudget(size_t bytes)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mHostMemoryBudget = bytes;
+        mCondition.notify_all();
+    }
+
+    void AsyncTextureLoader::setMaxUploadBatchSize(size_t count)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mMaxUploadBatchSize = std::max<size_t>(count, 1);
+    }
+
+    AsyncTextureLoader::Stats AsyncTextureLoader::getStats() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mStats;
+    }
+
+    void AsyncTextureLoader::complete(LoadRequest& request, Texture::SharedPtr pTexture, std::exception_ptr pException)
+    {
+        if (pException) request.promise.set_exception(pException);
+        else request.promise.set_value(pTexture);
+
+        if (request.callback)
+        {
+            request.callback(pTexture);
+        }
+    }
+
+    void AsyncTextureLoader::runWorkers(size_t threadCount)
+    {
         for (size_t i = 0; i < threadCount; ++i)
         {
             mThreads.emplace_back(&AsyncTextureLoader::runWorker, this);
         }
+
+        mUploadThread = std::thread(&AsyncTextureLoader::runUploader, this);
     }
 
     void AsyncTextureLoader::runWorker()
     {
-        // This function is the entry point for worker threads.
-        // The workers wait on the load request queue and load a texture when woken up.
-        // To avoid the upload heap growing too large, we synchronize the threads and
-        // issue a global GPU flush at regular intervals.
+        // This function is the entry point for the decode worker threads.
+        // The workers take the highest priority request from the decode queue and decode it into host memory.
+        // No new decodes are started while the decoded textures waiting for upload exceed the host memory budget.
+
+        std::unique_lock<std::mutex> lock(mMutex);
 
         while (true)
         {
             // Wait on condition until more work is ready.
-            std::unique_lock<std::mutex> lock(mMutex);
-            mCondition.wait(lock, [&]() { return mTerminate || !mLoadRequestQueue.empty() || mFlushPending; });
+            mCondition.wait(lock, [&]() {
+                bool hasMemory = mStats.hostMemoryInUse < mHostMemoryBudget || mStats.hostMemoryInUse == 0;
+                return (mTerminate && mDecodeQueue.empty()) || (!mDecodeQueue.empty() && hasMemory);
+            });
+
+            // Terminate thread unless there is more work to do.
+            if (mDecodeQueue.empty()) break;
+
+            // Pop next request from queue.
+            RequestID id = mDecodeQueue.begin()->second;
+            mDecodeQueue.erase(mDecodeQueue.begin());
+            LoadRequest& request = mRequests.at(id);
+            request.state = RequestState::Decoding;
+            DecodeFunction decodeFunction = std::move(request.decodeFunction);
+
+            lock.unlock();
+
+            // Decode the texture (this part is running in parallel).
+            // Exceptions are returned through the future instead of terminating the worker thread.
+            DecodedTexture decoded;
+            std::exception_ptr pException;
+            try
+            {
+                decoded = decodeFunction();
+            }
+            catch (...)
+            {
+                pException = std::current_exception();
+            }
 
-            // Sync thread if a flush is pending.
-            if (mFlushPending)
+            lock.lock();
+
+            // Requests are not removed from the map while they are being decoded, so the reference is still valid.
+            if (request.cancelled || pException)
             {
+                if (request.cancelled) pException = nullptr;
+                LoadRequest finished = std::move(request);
+                mRequests.erase(id);
+                if (pException) mStats.failedCount++;
+                else mStats.cancelledCount++;
+                mCondition.notify_all();
                 lock.unlock();
-                mFlushBarrier->wait();
-                mCondition.notify_one();
+
+                decoded = {};
+                complete(finished, nullptr, pException);
+
+                lock.lock();
                 continue;
             }
 
-            // Terminate thread unless there is more work to do.
-            if (mTerminate && mLoadRequestQueue.empty() && !mFlushPending) break;
+            mStats.hostMemoryInUse += decoded.hostMemorySize;
+            mStats.peakHostMemoryInUse = std::max(mStats.peakHostMemoryInUse, mStats.hostMemoryInUse);
+            request.decoded = std::move(decoded);
+            request.state = RequestState::Decoded;
+            mUploadQueue.insert(getQueueKey(request.priority, id));
+            mCondition.notify_all();
+        }
+    }
+
+    void AsyncTextureLoader::runUploader()
+    {
+        // This function is the entry point for the upload thread.
+        // The uploader takes batches of decoded textures in priority order and creates the GPU textures.
+        // The decoded data is released after each upload, and the GPU is flushed once per batch
+        // to keep the upload heap from growing.
+
+        std::unique_lock<std::mutex> lock(mMutex);
+
+        while (true)
+        {
+            mCondition.wait(lock, [&]() { return !mUploadQueue.empty() || (mTerminate && mRequests.empty()); });
 
-            // Go back waiting if queue is currently empty.
-            if (mLoadRequestQueue.empty()) continue;
+            // Terminate thread when all requests have completed.
+            if (mUploadQueue.empty()) break;
 
-            // Pop next load request from queue.
-            auto request = std::move(mLoadRequestQueue.front());
-            mLoadRequestQueue.pop();
+            // Pop next batch from queue.
+            std::vector<LoadRequest> batch;
+            while (!mUploadQueue.empty() && batch.size() < mMaxUploadBatchSize)
+            {
+                auto it = mRequests.find(mUploadQueue.begin()->second);
+                mUploadQueue.erase(mUploadQueue.begin());
+                batch.push_back(std::move(it->second));
+                mRequests.erase(it);
+            }
 
             lock.unlock();
 
-            // Load the textures (this part is running in parallel).
-            Texture::SharedPtr pTexture = Texture::createFromFile(mpDevice.get(), request.path, request.generateMipLevels, request.loadAsSRGB, request.bindFlags);
-            request.promise.set_value(pTexture);
+            // Upload the textures and release the decoded data.
+            std::vector<Texture::SharedPtr> textures(batch.size());
+            std::vector<std::exception_ptr> exceptions(batch.size());
+            size_t failedCount = 0;
+            size_t releasedMemory = 0;
+            for (size_t i = 0; i < batch.size(); ++i)
+            {
+                try
+                {
+                    if (batch[i].decoded.upload) textures[i] = batch[i].decoded.upload();
+                }
+                catch (...)
+                {
+                    exceptions[i] = std::current_exception();
+                    failedCount++;
+                }
+                releasedMemory += batch[i].decoded.hostMemorySize;
+                batch[i].decoded = {};
+            }
+
+            // Let the workers continue decoding while waiting for the GPU.
+            lock.lock();
+            mStats.hostMemoryInUse -= releasedMemory;
+            mCondition.notify_all();
+            lock.unlock();
 
-            if (request.callback)
+            if (mpDevice)
             {
-                request.callback(pTexture);
+                // Textures created on other threads lock the same mutex, see Texture::apiInit().
+                std::lock_guard<std::mutex> gfxLock(mpDevice->getGlobalGfxMutex());
+                mpDevice->flushAndSync();
             }
 
             lock.lock();
+            mStats.loadedCount += batch.size() - failedCount;
+            mStats.failedCount += failedCount;
+            mStats.uploadBatchCount++;
+            lock.unlock();
 
-            // Issue a global flush if necessary.
-            // TODO: It would be better to check the size of the upload heap instead.
-            if (!mTerminate && pTexture != nullptr &&
-                ++mUploadCounter >= kUploadsPerFlush)
+            for (size_t i = 0; i < batch.size(); ++i)
             {
-                mFlushPending = true;
-                mCondition.notify_all();
+                complete(batch[i], textures[i], exceptions[i]);
             }
 
-            mCondition.notify_one();
+            lock.lock();
         }
     }
 
@@ -140,5 +372,6 @@ namespace Falcor
         mCondition.notify_all();
 
         for (auto& thread : mThreads) thread.join();
+        mUploadThread.join();
     }
 }
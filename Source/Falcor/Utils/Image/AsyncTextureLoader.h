@@ -31,32 +31,88 @@
 #include "Core/API/Resource.h"
 #include "Core/API/Texture.h"
 #include <condition_variable>
+#include <exception>
 #include <filesystem>
 #include <functional>
 #include <future>
+#include <map>
 #include <mutex>
-#include <queue>
+#include <set>
 #include <thread>
+#include <utility>
 #include <vector>
 
 namespace Falcor
 {
-    class Barrier;
-
     /** Utility class to load textures asynchronously using multiple worker threads.
+
+        Loading is split into two stages. Worker threads decode textures into host memory in priority order.
+        A single upload thread creates the GPU textures from the decoded data in batches, and flushes the GPU
+        once per batch. The host memory held by decoded textures waiting for upload is bounded by a budget.
+        Workers stop decoding while the budget is exhausted, so the budget can only be exceeded by the textures
+        that are being decoded at that point.
+
+        Exceptions thrown by decode and upload functions are caught and returned through the request's future.
+        The callback is called with nullptr in that case.
+
+        If the loader is created without a device, no GPU flushes are issued. This allows using it with
+        custom decode functions and stub uploads on the CPU only.
     */
     class FALCOR_API AsyncTextureLoader
     {
     public:
         using LoadCallback = std::function<void(Texture::SharedPtr pTexture)>;
+        using LoadFunction = std::function<Texture::SharedPtr()>;
+        using RequestID = uint64_t;
+
+        static constexpr RequestID kInvalidRequestID = 0;
+
+        /** Request priority. Requests with higher priority are decoded and uploaded first.
+            Requests with the same priority are processed in submission order.
+        */
+        enum class Priority : uint32_t
+        {
+            Low,
+            Normal,
+            High,       ///< Use for textures that are currently needed, e.g., by visible materials.
+        };
+
+        /** Decoded texture data waiting for upload.
+        */
+        struct DecodedTexture
+        {
+            LoadFunction upload;            ///< Function creating the texture from the decoded data. Called from the upload thread. If empty, the load failed.
+            size_t hostMemorySize = 0;      ///< Host memory in bytes held by the decoded data until the upload function has been released.
+        };
+
+        using DecodeFunction = std::function<DecodedTexture()>;
+
+        /** Handle to a submitted request.
+        */
+        struct Request
+        {
+            RequestID id = kInvalidRequestID;           ///< Request ID, used for changing the priority and cancelling the request.
+            std::future<Texture::SharedPtr> future;     ///< Future to the new texture, or nullptr if loading failed or the request was cancelled. Holds the exception if the decode or upload function threw.
+        };
+
+        struct Stats
+        {
+            uint64_t loadedCount = 0;           ///< Number of completed requests that were not cancelled and did not fail.
+            uint64_t cancelledCount = 0;        ///< Number of cancelled requests.
+            uint64_t failedCount = 0;           ///< Number of requests whose decode or upload function threw an exception.
+            uint64_t uploadBatchCount = 0;      ///< Number of upload batches, i.e., GPU flushes.
+            size_t hostMemoryInUse = 0;         ///< Current host memory in bytes held by decoded textures.
+            size_t peakHostMemoryInUse = 0;     ///< Peak host memory in bytes held by decoded textures.
+        };
 
         /** Constructor.
-            \param[in] threadCount Number of worker threads.
+            \param[in] pDevice GPU device, or nullptr to run without GPU flushes (CPU only).
+            \param[in] threadCount Number of decode worker threads.
         */
         AsyncTextureLoader(std::shared_ptr<Device> pDevice, size_t threadCount = std::thread::hardware_concurrency());
 
         /** Destructor.
-            Blocks until all threads have terminated.
+            Blocks until all requests have finished and all threads have terminated.
         */
         ~AsyncTextureLoader();
 
@@ -66,6 +122,7 @@ namespace Falcor
             \param[in] loadAsSRGB Load the texture as sRGB format if supported, otherwise linear color.
             \param[in] bindFlags The bind flags for the texture resource.
             \param[in] callback Function called after the texture load has finished.
+            \param[in] priority Request priority.
             \return A future to a new texture, or nullptr if the texture failed to load.
         */
         std::future<Texture::SharedPtr> loadFromFile(
@@ -73,36 +130,101 @@ namespace Falcor
             bool generateMipLevels,
             bool loadAsSRGB,
             Resource::BindFlags bindFlags = Resource::BindFlags::ShaderResource,
-            LoadCallback callback = {}
+            LoadCallback callback = {},
+            Priority priority = Priority::Normal
         );
 
+        /** Request loading a texture using a custom load function.
+            The load function is called from the upload thread, as it creates GPU resources. The texture is not accounted in the host memory budget.
+            \param[in] loadFunction Function creating the texture.
+            \param[in] callback Function called after the texture load has finished.
+            \param[in] priority Request priority.
+            \return The request.
+        */
+        Request load(LoadFunction loadFunction, LoadCallback callback = {}, Priority priority = Priority::Normal);
+
+        /** Request loading a texture using a custom decode function.
+            \param[in] decodeFunction Function decoding the texture into host memory. It is called from a worker thread.
+            \param[in] callback Function called after the texture load has finished. It is called with nullptr if the request is cancelled.
+            \param[in] priority Request priority.
+            \return The request.
+        */
+        Request submit(DecodeFunction decodeFunction, LoadCallback callback = {}, Priority priority = Priority::Normal);
+
+        /** Change the priority of a request that has not been decoded or uploaded yet.
+            \param[in] id Request ID.
+            \param[in] priority New priority.
+        */
+        void setPriority(RequestID id, Priority priority);
+
+        /** Cancel a request. A request that is being decoded is cancelled once decoding finishes.
+            Cancelled requests complete with a nullptr texture.
+            \param[in] id Request ID.
+            \return True if the request was cancelled, false if it has already been uploaded or does not exist.
+        */
+        bool cancel(RequestID id);
+
+        /** Set the budget for host memory held by decoded textures waiting for upload.
+            \param[in] bytes Budget in bytes.
+        */
+        void setHostMemoryBudget(size_t bytes);
+
+        /** Set the maximum number of textures uploaded per batch. The GPU is flushed once per batch.
+            \param[in] count Maximum batch size.
+        */
+        void setMaxUploadBatchSize(size_t count);
+
+        /** Get loader statistics.
+        */
+        Stats getStats() const;
+
     private:
         void runWorkers(size_t threadCount);
         void runWorker();
+        void runUploader();
         void terminateWorkers();
 
+        enum class RequestState
+        {
+            Queued,     ///< Waiting to be decoded.
+            Decoding,   ///< Being decoded by a worker thread.
+            Decoded,    ///< Waiting to be uploaded.
+        };
+
         struct LoadRequest
         {
-            std::filesystem::path path;
-            bool generateMipLevels;
-            bool loadAsSRGB;
-            Resource::BindFlags bindFlags;
+            DecodeFunction decodeFunction;
             LoadCallback callback;
             std::promise<Texture::SharedPtr> promise;
+            Priority priority;
+            RequestState state = RequestState::Queued;
+            bool cancelled = false;
+            DecodedTexture decoded;
         };
 
+        /// Queue key ordering requests by descending priority and then by ascending ID (submission order).
+        using QueueKey = std::pair<uint32_t, RequestID>;
+        static QueueKey getQueueKey(Priority priority, RequestID id) { return { (uint32_t)Priority::High - (uint32_t)priority, id }; }
+
+        static void complete(LoadRequest& request, Texture::SharedPtr pTexture, std::exception_ptr pException = nullptr);
+
         std::shared_ptr<Device> mpDevice;
 
-        std::mutex mMutex;                          ///< Mutex for synchronizing access to shared resources.
-        std::condition_variable mCondition;         ///< Condition variable for workers to wait on.
-        std::shared_ptr<Barrier> mFlushBarrier;     ///< Barrier for flushing the GPU to upload textures.
-        std::vector<std::thread> mThreads;          ///< Worker threads.
+        mutable std::mutex mMutex;                  ///< Mutex for synchronizing access to shared resources.
+        std::condition_variable mCondition;         ///< Condition variable for threads to wait on.
+        std::vector<std::thread> mThreads;          ///< Decode worker threads.
+        std::thread mUploadThread;                  ///< Upload thread.
 
         // Internal state. Do not access outside of critical section.
-        std::queue<LoadRequest> mLoadRequestQueue;  ///< Texture loading request queue.
+        std::map<RequestID, LoadRequest> mRequests; ///< All requests that have not completed yet.
+        std::set<QueueKey> mDecodeQueue;            ///< Requests waiting to be decoded.
+        std::set<QueueKey> mUploadQueue;            ///< Requests waiting to be uploaded.
+
+        RequestID mNextRequestID = 1;
+        size_t mHostMemoryBudget = size_t(4) << 30; ///< Budget in bytes for host memory held by decoded textures.
+        size_t mMaxUploadBatchSize = 16;            ///< Maximum number of textures per upload batch.
+        Stats mStats;
 
         bool mTerminate = false;                    ///< Flag to terminate worker threads.
-        bool mFlushPending = false;                 ///< Flag to indicate a GPU flush is pending.
-        uint32_t mUploadCounter = 0;                ///< Counter to issue a flush every few uploads.
     };
 }
@@ -35,6 +35,7 @@
 #include <dds_header/DDSHeader.h>
 #include <nvtt/nvtt.h>
 
+#include <algorithm>
 #include <filesystem>
 
 namespace Falcor
@@ -550,45 +551,82 @@ namespace Falcor
         return Bitmap::create(data.width, data.height, data.format, data.imageData.data());
     }
 
-    Texture::SharedPtr ImageIO::loadTextureFromDDS(Device* pDevice, const std::filesystem::path& path, bool loadAsSrgb)
+    ImageIO::DDSData ImageIO::loadDDSData(const std::filesystem::path& path, bool loadAsSrgb)
     {
         ImportData data;
-        try
+        loadDDS(path, loadAsSrgb, data);
+
+        // Check that the file holds all subresources described by the header, so that creating the texture does not read past the data.
+        if (data.format == ResourceFormat::Unknown)
         {
-            loadDDS(path, loadAsSrgb, data);
+            throw RuntimeError("Unsupported DDS format.");
         }
-        catch (const RuntimeError& e)
+        const uint32_t blockWidth = getFormatWidthCompressionRatio(data.format);
+        const uint32_t blockHeight = getFormatHeightCompressionRatio(data.format);
+        uint64_t expectedSize = 0;
+        for (uint32_t mip = 0; mip < data.mipLevels; mip++)
         {
-            logWarning("Failed to load DDS image from '{}': {}", path, e.what());
-            return nullptr;
+            uint64_t rowCount = (std::max(data.height >> mip, 1u) + blockHeight - 1) / blockHeight;
+            uint64_t rowSize = uint64_t((std::max(data.width >> mip, 1u) + blockWidth - 1) / blockWidth) * getFormatBytesPerBlock(data.format);
+            expectedSize += rowSize * rowCount * std::max(data.depth >> mip, 1u);
+        }
+        expectedSize *= data.arraySize;
+        if (data.imageData.size() < expectedSize)
+        {
+            throw RuntimeError("DDS image data is truncated (expected {} bytes, got {} bytes).", expectedSize, data.imageData.size());
         }
 
-        Texture::SharedPtr pTex;
+        DDSData result;
+        result.format = data.format;
+        result.type = data.type;
+        result.width = data.width;
+        result.height = data.height;
+        result.depth = data.depth;
+        result.arraySize = data.arraySize;
+        result.mipLevels = data.mipLevels;
+        result.imageData = std::move(data.imageData);
+        return result;
+    }
+
+    Texture::SharedPtr ImageIO::createTextureFromDDSData(Device* pDevice, const DDSData& data, Resource::BindFlags bindFlags)
+    {
         // TODO: Automatic mip generation
         switch (data.type)
         {
         case Resource::Type::Texture1D:
-            pTex = Texture::create1D(pDevice, data.width, data.format, data.arraySize, data.mipLevels, data.imageData.data());
-            break;
+            return Texture::create1D(pDevice, data.width, data.format, data.arraySize, data.mipLevels, data.imageData.data(), bindFlags);
         case Resource::Type::Texture2D:
-            pTex = Texture::create2D(pDevice, data.width, data.height, data.format, data.arraySize, data.mipLevels, data.imageData.data());
-            break;
+            return Texture::create2D(pDevice, data.width, data.height, data.format, data.arraySize, data.mipLevels, data.imageData.data(), bindFlags);
         case Resource::Type::TextureCube:
-            pTex = Texture::createCube(pDevice, data.width, data.height, data.format, data.arraySize / 6, data.mipLevels, data.imageData.data());
-            break;
+            return Texture::createCube(pDevice, data.width, data.height, data.format, data.arraySize / 6, data.mipLevels, data.imageData.data(), bindFlags);
         case Resource::Type::Texture3D:
-            pTex = Texture::create3D(pDevice, data.width, data.height, data.depth, data.format, data.mipLevels, data.imageData.data());
-            break;
+            return Texture::create3D(pDevice, data.width, data.height, data.depth, data.format, data.mipLevels, data.imageData.data(), bindFlags);
         default:
-            logWarning("Failed to load DDS image from '{}': Unrecognized texture type.", path);
+            return nullptr;
+        }
+    }
+
+    Texture::SharedPtr ImageIO::loadTextureFromDDS(Device* pDevice, const std::filesystem::path& path, bool loadAsSrgb, Resource::BindFlags bindFlags)
+    {
+        DDSData data;
+        try
+        {
+            data = loadDDSData(path, loadAsSrgb);
+        }
+        catch (const RuntimeError& e)
+        {
+            logWarning("Failed to load DDS image from '{}': {}", path, e.what());
             return nullptr;
         }
 
-        if (pTex != nullptr)
+        Texture::SharedPtr pTex = createTextureFromDDSData(pDevice, data, bindFlags);
+        if (pTex == nullptr)
         {
-            pTex->setSourcePath(path);
+            logWarning("Failed to load DDS image from '{}': Unrecognized texture type.", path);
+            return nullptr;
         }
 
+        pTex->setSourcePath(path);
         return pTex;
     }
 
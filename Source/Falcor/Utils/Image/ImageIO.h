@@ -30,6 +30,7 @@
 #include "Core/Macros.h"
 #include "Core/API/Texture.h"
 #include <filesystem>
+#include <vector>
 
 namespace Falcor
 {
@@ -87,13 +88,44 @@ namespace Falcor
         */
         static Bitmap::UniqueConstPtr loadBitmapFromDDS(const std::filesystem::path& path); // top down = true
 
+        /** DDS image data loaded into host memory. All array slices and mips are stored as in the file.
+        */
+        struct DDSData
+        {
+            ResourceFormat format = ResourceFormat::Unknown;
+            Resource::Type type = Resource::Type::Texture2D;
+            uint32_t width = 0;
+            uint32_t height = 0;
+            uint32_t depth = 0;
+            uint32_t arraySize = 0;
+            uint32_t mipLevels = 0;
+            std::vector<uint8_t> imageData;
+        };
+
+        /** Load a DDS file into host memory without creating a texture.
+            This allows reading the file on a different thread than the one creating the texture.
+            Throws an exception if the DDS file is malformed or holds less image data than the header describes.
+            \param[in] path Path of file to load.
+            \param[in] loadAsSrgb If true, convert the image format property to a corresponding sRGB format if available. Image data is not changed.
+            \return The image data.
+        */
+        static DDSData loadDDSData(const std::filesystem::path& path, bool loadAsSrgb);
+
+        /** Create a texture from DDS image data loaded with loadDDSData().
+            \param[in] data Image data.
+            \param[in] bindFlags The bind flags for the texture resource.
+            \return Texture object, or nullptr if the texture type is not supported.
+        */
+        static Texture::SharedPtr createTextureFromDDSData(Device* pDevice, const DDSData& data, Resource::BindFlags bindFlags = Resource::BindFlags::ShaderResource);
+
         /** Load a DDS file to a Texture.
             Throws an exception if the DDS file is malformed.
             \param[in] path Path of file to load.
             \param[in] loadAsSrgb If true, convert the image format property to a corresponding sRGB format if available. Image data is not changed.
+            \param[in] bindFlags The bind flags for the texture resource.
             \return Texture object containing image data if loading was successful. Otherwise, nullptr.
         */
-        static Texture::SharedPtr loadTextureFromDDS(Device* pDevice, const std::filesystem::path& path, bool loadAsSrgb);
+        static Texture::SharedPtr loadTextureFromDDS(Device* pDevice, const std::filesystem::path& path, bool loadAsSrgb, Resource::BindFlags bindFlags = Resource::BindFlags::ShaderResource);
 
         /** Saves a bitmap to a DDS file.
             Throws an exception if path is invalid or the image cannot be saved.
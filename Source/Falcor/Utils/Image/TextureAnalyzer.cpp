@@ -26,7 +26,11 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "TextureAnalyzer.h"
+#include "Bitmap.h"
 #include "Core/API/RenderContext.h"
+#include "Utils/Color/ColorHelpers.slang"
+#include <algorithm>
+#include <cmath>
 
 namespace Falcor
 {
@@ -39,6 +43,169 @@ namespace Falcor
         static_assert((uint32_t)TextureChannelFlags::Alpha == 0x8);
 
         const char kShaderFilename[] = "Utils/Image/TextureAnalyzer.cs.slang";
+
+        using RangeFlags = TextureAnalyzer::Result::RangeFlags;
+
+        enum class ComponentType
+        {
+            Unorm8,
+            Unorm16,
+            Float16,
+            Float32,
+        };
+
+        /** Memory layout of a bitmap format supported by the CPU analysis.
+        */
+        struct BitmapLayout
+        {
+            ComponentType type;
+            uint32_t componentCount;    ///< Number of components stored per texel.
+            int channels[4];            ///< Index of the component holding each RGBA channel, or -1 if the channel is not stored.
+        };
+
+        std::optional<BitmapLayout> getBitmapLayout(ResourceFormat format)
+        {
+            switch (format)
+            {
+            case ResourceFormat::R8Unorm: return BitmapLayout{ ComponentType::Unorm8, 1, { 0, -1, -1, -1 } };
+            case ResourceFormat::RG8Unorm: return BitmapLayout{ ComponentType::Unorm8, 2, { 0, 1, -1, -1 } };
+            case ResourceFormat::RGBA8Unorm: return BitmapLayout{ ComponentType::Unorm8, 4, { 0, 1, 2, 3 } };
+            case ResourceFormat::BGRA8Unorm: return BitmapLayout{ ComponentType::Unorm8, 4, { 2, 1, 0, 3 } };
+            case ResourceFormat::BGRX8Unorm: return BitmapLayout{ ComponentType::Unorm8, 4, { 2, 1, 0, -1 } };
+            case ResourceFormat::R16Unorm: return BitmapLayout{ ComponentType::Unorm16, 1, { 0, -1, -1, -1 } };
+            case ResourceFormat::R16Float: return BitmapLayout{ ComponentType::Float16, 1, { 0, -1, -1, -1 } };
+            case ResourceFormat::RG16Float: return BitmapLayout{ ComponentType::Float16, 2, { 0, 1, -1, -1 } };
+            case ResourceFormat::RGBA16Float: return BitmapLayout{ ComponentType::Float16, 4, { 0, 1, 2, 3 } };
+            case ResourceFormat::R32Float: return BitmapLayout{ ComponentType::Float32, 1, { 0, -1, -1, -1 } };
+            case ResourceFormat::RG32Float: return BitmapLayout{ ComponentType::Float32, 2, { 0, 1, -1, -1 } };
+            case ResourceFormat::RGB32Float: return BitmapLayout{ ComponentType::Float32, 3, { 0, 1, 2, -1 } };
+            case ResourceFormat::RGBA32Float: return BitmapLayout{ ComponentType::Float32, 4, { 0, 1, 2, 3 } };
+            default: return {};
+            }
+        }
+
+        /** Analysis result for one stored component, in the same form as the GPU analysis.
+        */
+        struct ComponentResult
+        {
+            float value = 0.f;          ///< Value of the first texel.
+            float minValue = 0.f;       ///< Minimum value, clamped to zero.
+            float maxValue = 0.f;       ///< Maximum value, clamped to zero.
+            uint32_t range = 0;         ///< Union of RangeFlags.
+            bool isConstant = true;     ///< True if all texels have the same value.
+        };
+
+        /** Scan a bitmap with N unsigned normalized components of type T per texel.
+            The min/max and comparison against the first texel are done on the integer values, which is equivalent to
+            doing them on the normalized values since the conversion is monotonic and injective. The inner loop has no
+            branches to allow the compiler to vectorize it.
+        */
+        template<typename T, uint32_t N>
+        void scanUnorm(const Bitmap& bitmap, bool isSrgb, ComponentResult* pResults)
+        {
+            const T* pFirst = reinterpret_cast<const T*>(bitmap.getData());
+
+            T ref[N], minValue[N], maxValue[N], diff[N];
+            for (uint32_t c = 0; c < N; c++)
+            {
+                ref[c] = minValue[c] = maxValue[c] = pFirst[c];
+                diff[c] = 0;
+            }
+
+            for (uint32_t y = 0; y < bitmap.getHeight(); y++)
+            {
+                const T* pRow = reinterpret_cast<const T*>(bitmap.getData() + (size_t)y * bitmap.getRowPitch());
+                for (uint32_t x = 0; x < bitmap.getWidth(); x++)
+                {
+                    for (uint32_t c = 0; c < N; c++)
+                    {
+                        T v = pRow[x * N + c];
+                        minValue[c] = std::min(minValue[c], v);
+                        maxValue[c] = std::max(maxValue[c], v);
+                        diff[c] |= v ^ ref[c];
+                    }
+                }
+            }
+
+            for (uint32_t c = 0; c < N; c++)
+            {
+                // The first three components of sRGB formats hold color, the last one alpha (or is unused).
+                auto normalize = [&](T v)
+                {
+                    float f = v / (float)std::numeric_limits<T>::max();
+                    return isSrgb && c < 3 ? sRGBToLinear(f) : f;
+                };
+
+                auto& result = pResults[c];
+                result.value = normalize(ref[c]);
+                result.minValue = normalize(minValue[c]);
+                result.maxValue = normalize(maxValue[c]);
+                result.range = maxValue[c] > 0 ? (uint32_t)RangeFlags::Pos : 0;
+                result.isConstant = diff[c] == 0;
+            }
+        }
+
+        /** Scan a bitmap with N floating-point components of type T per texel.
+            This replicates the comparisons done by the GPU analysis, e.g., NaN values are never considered constant.
+        */
+        template<typename T, uint32_t N>
+        void scanFloat(const Bitmap& bitmap, ComponentResult* pResults)
+        {
+            const T* pFirst = reinterpret_cast<const T*>(bitmap.getData());
+
+            float ref[N], minValue[N], maxValue[N];
+            uint32_t range[N];
+            bool diff[N];
+            for (uint32_t c = 0; c < N; c++)
+            {
+                ref[c] = (float)pFirst[c];
+                minValue[c] = std::numeric_limits<float>::max();
+                maxValue[c] = 0.f;
+                range[c] = 0;
+                diff[c] = false;
+            }
+
+            for (uint32_t y = 0; y < bitmap.getHeight(); y++)
+            {
+                const T* pRow = reinterpret_cast<const T*>(bitmap.getData() + (size_t)y * bitmap.getRowPitch());
+                for (uint32_t x = 0; x < bitmap.getWidth(); x++)
+                {
+                    for (uint32_t c = 0; c < N; c++)
+                    {
+                        float v = (float)pRow[x * N + c];
+                        float clamped = v > 0.f ? v : 0.f; // NaN is clamped to zero like max(v, 0) on the GPU.
+                        minValue[c] = std::min(minValue[c], clamped);
+                        maxValue[c] = std::max(maxValue[c], clamped);
+                        range[c] |= (v > 0.f ? (uint32_t)RangeFlags::Pos : 0) | (v < 0.f ? (uint32_t)RangeFlags::Neg : 0) |
+                            (std::isinf(v) ? (uint32_t)RangeFlags::Inf : 0) | (std::isnan(v) ? (uint32_t)RangeFlags::NaN : 0);
+                        diff[c] |= v != ref[c];
+                    }
+                }
+            }
+
+            for (uint32_t c = 0; c < N; c++)
+            {
+                auto& result = pResults[c];
+                result.value = ref[c];
+                result.minValue = minValue[c];
+                result.maxValue = maxValue[c];
+                result.range = range[c];
+                result.isConstant = !diff[c];
+            }
+        }
+
+        template<typename T>
+        void scanFloat(const Bitmap& bitmap, uint32_t componentCount, ComponentResult* pResults)
+        {
+            switch (componentCount)
+            {
+            case 1: scanFloat<T, 1>(bitmap, pResults); break;
+            case 2: scanFloat<T, 2>(bitmap, pResults); break;
+            case 3: scanFloat<T, 3>(bitmap, pResults); break;
+            case 4: scanFloat<T, 4>(bitmap, pResults); break;
+            default: FALCOR_UNREACHABLE();
+            }
+        }
     }
 
     // Verify that the result struct matches the size expected by the shader.
@@ -106,6 +273,57 @@ namespace Falcor
         }
     }
 
+    std::optional<TextureAnalyzer::Result> TextureAnalyzer::analyze(const Bitmap& bitmap, bool isSrgb)
+    {
+        auto layout = getBitmapLayout(bitmap.getFormat());
+        if (!layout || bitmap.getWidth() == 0 || bitmap.getHeight() == 0) return {};
+
+        isSrgb = isSrgb && isSrgbFormat(linearToSrgbFormat(bitmap.getFormat()));
+
+        ComponentResult components[4];
+        switch (layout->type)
+        {
+        case ComponentType::Unorm8:
+            if (layout->componentCount == 1) scanUnorm<uint8_t, 1>(bitmap, isSrgb, components);
+            else if (layout->componentCount == 2) scanUnorm<uint8_t, 2>(bitmap, isSrgb, components);
+            else scanUnorm<uint8_t, 4>(bitmap, isSrgb, components);
+            break;
+        case ComponentType::Unorm16:
+            scanUnorm<uint16_t, 1>(bitmap, false, components);
+            break;
+        case ComponentType::Float16:
+            scanFloat<float16_t>(bitmap, layout->componentCount, components);
+            break;
+        case ComponentType::Float32:
+            scanFloat<float>(bitmap, layout->componentCount, components);
+            break;
+        }
+
+        // Assemble the result. Channels not stored in the bitmap read as (0, 0, 0, 1) on the GPU.
+        Result result = {};
+        for (uint32_t i = 0; i < 4; i++)
+        {
+            ComponentResult channel;
+            if (layout->channels[i] >= 0)
+            {
+                channel = components[layout->channels[i]];
+            }
+            else if (i == 3)
+            {
+                channel.value = channel.minValue = channel.maxValue = 1.f;
+                channel.range = (uint32_t)RangeFlags::Pos;
+            }
+
+            if (!channel.isConstant) result.mask |= 1u << i;
+            result.mask |= channel.range << (4 + 4 * i);
+            result.value[i] = channel.value;
+            result.minValue[i] = channel.minValue;
+            result.maxValue[i] = channel.maxValue;
+        }
+
+        return result;
+    }
+
     void TextureAnalyzer::clear(RenderContext* pRenderContext, Buffer::SharedPtr pResult, uint64_t resultOffset, size_t resultCount) const
     {
         FALCOR_ASSERT(pRenderContext);
@@ -33,11 +33,13 @@
 #include "RenderGraph/BasePasses/ComputePass.h"
 #include "Utils/Math/Vector.h"
 #include <memory>
+#include <optional>
 #include <vector>
 
 namespace Falcor
 {
     class RenderContext;
+    class Bitmap;
 
     /** A class for analyzing texture contents.
     */
@@ -121,6 +123,16 @@ namespace Falcor
         */
         void analyze(RenderContext* pRenderContext, const std::vector<Texture::SharedPtr>& inputs, Buffer::SharedPtr pResult, bool clearResult = true);
 
+        /** Analyze bitmap contents on the CPU.
+            This produces the same result as analyzing a texture created from the bitmap on the GPU, which allows
+            textures to be analyzed before they are uploaded. Values of sRGB formats are converted to linear
+            like the GPU does when the texture is read, so the results may differ by rounding for these formats.
+            \param[in] bitmap The bitmap.
+            \param[in] isSrgb Analyze the bitmap as if it was stored in the sRGB variant of its format.
+            \return The result, or an empty optional if the bitmap format is not supported.
+        */
+        static std::optional<Result> analyze(const Bitmap& bitmap, bool isSrgb = false);
+
         /** Helper function to clear the results buffer.
             \param[in] pRenderContext The context.
             \param[in] pResult GPU buffer to clear. This is expected to have UAV bind flag.
@@ -26,11 +26,20 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "TextureManager.h"
+#include "Bitmap.h"
+#include "ImageIO.h"
 #include "Core/API/Device.h"
+#include "Core/Platform/OS.h"
+#include "Scene/AssetCache.h"
 #include "Utils/Logger.h"
 #include "Utils/NumericRange.h"
+#include "Utils/Timing/CpuTimer.h"
+#include "Utils/Timing/Profiler.h"
 
+#include <cstring>
 #include <execution>
+#include <fstream>
+#include <random>
 
 // Temporarily disable asynchronous texture loader until Falcor supports parallel GPU work submission.
 // Until then `TextureManager` should only called from the main thread.
@@ -42,6 +51,102 @@ namespace Falcor
     {
         const size_t kMaxTextureHandleCount = std::numeric_limits<uint32_t>::max();
         static_assert(TextureManager::TextureHandle::kInvalidID >= kMaxTextureHandleCount);
+
+        const uint32_t kAnalysisCacheVersion = 1;
+
+        /** Texture analysis result stored in the asset cache.
+            The first texel is stored so that constant textures can be created without decoding the image file.
+        */
+        struct CachedAnalysis
+        {
+            TextureAnalyzer::Result result;
+            ResourceFormat format;
+            uint8_t texel[16];
+        };
+
+        std::optional<AssetCache::Key> computeAnalysisCacheKey(const std::filesystem::path& path, bool loadAsSRGB)
+        {
+            std::error_code ec;
+            auto fileSize = std::filesystem::file_size(path, ec);
+            if (ec) return {};
+            auto writeTime = std::filesystem::last_write_time(path, ec);
+            if (ec) return {};
+
+            SHA1 sha1;
+            sha1.update(kAnalysisCacheVersion);
+            sha1.update(path.string());
+            sha1.update(uint64_t(fileSize));
+            sha1.update(int64_t(writeTime.time_since_epoch().count()));
+            sha1.update(loadAsSRGB);
+            return sha1.finalize();
+        }
+
+        const char kTextureCacheDirectory[] = "NVIDIA/Falcor/TextureCache";
+        const uint32_t kTextureCacheVersion = 1;
+
+        /** Compute the path of the texture cache entry for an image file.
+            The entry is keyed by the file contents and all settings that affect the stored texture.
+            \return The entry path, or an empty path if the image file cannot be read.
+        */
+        std::filesystem::path computeTextureCachePath(const std::filesystem::path& directory, const std::filesystem::path& path, bool generateMipLevels, bool loadAsSRGB, Resource::BindFlags bindFlags, bool useCompression)
+        {
+            std::ifstream fs(path, std::ios_base::binary);
+            if (!fs.good()) return {};
+
+            SHA1 sha1;
+            sha1.update(kTextureCacheVersion);
+            std::vector<char> buffer(1 << 20);
+            while (fs)
+            {
+                fs.read(buffer.data(), buffer.size());
+                sha1.update(buffer.data(), (size_t)fs.gcount());
+            }
+            sha1.update(generateMipLevels);
+            sha1.update(loadAsSRGB);
+            sha1.update((uint32_t)bindFlags);
+            sha1.update(useCompression);
+
+            return directory / (SHA1::toString(sha1.finalize()) + ".dds");
+        }
+
+        /** Select how a bitmap is stored in the texture cache.
+            8-bit textures are block compressed if enabled and the dimensions are a multiple of the block size.
+            Otherwise only formats that are stored without changing their channel count can be cached. For example, RGB32Float
+            is padded to RGBA when written, so those textures bypass the cache.
+            \return The compression mode, or an empty optional if the bitmap cannot be cached.
+        */
+        std::optional<ImageIO::CompressionMode> getTextureCacheCompressionMode(const Bitmap& bitmap, bool useCompression)
+        {
+            ResourceFormat format = bitmap.getFormat();
+            bool isUnorm8 = getFormatType(format) == FormatType::Unorm && getNumChannelBits(format, 0) == 8;
+            if (isUnorm8 && useCompression && bitmap.getWidth() % 4 == 0 && bitmap.getHeight() % 4 == 0)
+            {
+                switch (getFormatChannelCount(format))
+                {
+                case 1: return ImageIO::CompressionMode::BC4;
+                case 2: return ImageIO::CompressionMode::BC5;
+                default: return ImageIO::CompressionMode::BC7;
+                }
+            }
+
+            switch (format)
+            {
+            case ResourceFormat::RGBA8Unorm:
+            case ResourceFormat::BGRA8Unorm:
+            case ResourceFormat::BGRX8Unorm:
+            case ResourceFormat::R32Float:
+            case ResourceFormat::RGBA32Float:
+            case ResourceFormat::RGBA16Float:
+                return ImageIO::CompressionMode::None;
+            default:
+                return {};
+            }
+        }
+
+        uint64_t toNanoseconds(CpuTimer::TimePoint start)
+        {
+            return (uint64_t)(CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint()) * 1e6);
+        }
     }
 
     TextureManager::SharedPtr TextureManager::create(std::shared_ptr<Device> pDevice, size_t maxTextureCount, size_t threadCount)
@@ -225,6 +330,7 @@ namespace Falcor
 
             // Function called by the async texture loader when loading finishes.
             // It's called by a worker thread so needs to acquire the mutex before changing any state.
+            auto pAnalysis = std::make_shared<std::optional<TextureAnalyzer::Result>>();
             auto callback = [=](Texture::SharedPtr pTexture)
             {
                 std::unique_lock<std::mutex> lock(mMutex);
@@ -233,22 +339,27 @@ namespace Falcor
                 auto& desc = getDesc(handle);
                 desc.state = TextureState::Loaded;
                 desc.pTexture = pTexture;
+                desc.analysis = *pAnalysis;
 
                 // Add to texture-to-handle map.
                 if (pTexture) mTextureToHandle[pTexture.get()] = handle;
 
+                mLoadRequests.erase(handle.getID());
                 mLoadRequestsInProgress--;
                 mCondition.notify_all();
             };
 
-            // Issue load request to texture loader.
-            mAsyncTextureLoader.loadFromFile(fullPath, generateMipLevels, loadAsSRGB, bindFlags, callback);
+            // Issue load request to texture loader. The image is decoded on a worker thread and the texture is created on the upload thread.
+            // The request ID is stored while the mutex is held, so the callback always finds it.
+            auto request = mAsyncTextureLoader.submit([=]() { return decodeTextureFromFile(textureKey, *pAnalysis); }, callback);
+            mLoadRequests[handle.getID()] = request.id;
 #else
             // Load texture from main thread.
-            Texture::SharedPtr pTexture = Texture::createFromFile(mpDevice.get(), fullPath, generateMipLevels, loadAsSRGB, bindFlags);
+            std::optional<TextureAnalyzer::Result> analysis;
+            Texture::SharedPtr pTexture = loadTextureFromFile(textureKey, analysis);
 
             // Add new texture desc.
-            TextureDesc desc = { TextureState::Loaded, pTexture };
+            TextureDesc desc = { TextureState::Loaded, pTexture, analysis };
             handle = addDesc(desc);
 
             // Add to key-to-handle map.
@@ -271,6 +382,198 @@ namespace Falcor
         return handle;
     }
 
+    Texture::SharedPtr TextureManager::loadTextureFromFile(const TextureKey& key, std::optional<TextureAnalyzer::Result>& analysis) const
+    {
+        AsyncTextureLoader::DecodedTexture decoded = decodeTextureFromFile(key, analysis);
+        if (!decoded.upload) return nullptr;
+
+        // Errors must not escape, as this runs in parallel from endDeferredLoading().
+        try
+        {
+            return decoded.upload();
+        }
+        catch (const std::exception& e)
+        {
+            logWarning("Failed to create texture for '{}': {}", key.fullPath, e.what());
+            return nullptr;
+        }
+    }
+
+    AsyncTextureLoader::DecodedTexture TextureManager::decodeTextureFromFile(const TextureKey& key, std::optional<TextureAnalyzer::Result>& analysis) const
+    {
+        FALCOR_PROFILE_CPU("TextureManager::decodeTextureFromFile");
+
+        Device* pDevice = mpDevice.get();
+
+        // Textures loaded from DDS data are created as stored.
+        auto uploadDDSData = [pDevice, &key](std::shared_ptr<const ImageIO::DDSData> pData) -> AsyncTextureLoader::DecodedTexture
+        {
+            size_t hostMemorySize = pData->imageData.size();
+            auto upload = [pDevice, pData, fullPath = key.fullPath, bindFlags = key.bindFlags]()
+            {
+                Texture::SharedPtr pTexture = ImageIO::createTextureFromDDSData(pDevice, *pData, bindFlags);
+                if (pTexture) pTexture->setSourcePath(fullPath);
+                return pTexture;
+            };
+            return { upload, hostMemorySize };
+        };
+
+        // DDS files are typically block compressed and are uploaded as stored.
+        if (hasExtension(key.fullPath, "dds"))
+        {
+            try
+            {
+                return uploadDDSData(std::make_shared<ImageIO::DDSData>(ImageIO::loadDDSData(key.fullPath, key.loadAsSRGB)));
+            }
+            catch (const RuntimeError& e)
+            {
+                logWarning("Failed to load DDS image from '{}': {}", key.fullPath, e.what());
+                return {};
+            }
+        }
+
+        // Constant textures are uploaded as a single texel.
+        auto createConstantTexture = [&](ResourceFormat format, const void* pTexel) -> AsyncTextureLoader::DecodedTexture
+        {
+            const uint8_t* pTexelData = static_cast<const uint8_t*>(pTexel);
+            std::vector<uint8_t> texel(pTexelData, pTexelData + std::min<size_t>(getFormatBytesPerBlock(format), sizeof(CachedAnalysis::texel)));
+            auto upload = [pDevice, format, texel, fullPath = key.fullPath, bindFlags = key.bindFlags]()
+            {
+                auto pTexture = Texture::create2D(pDevice, 1, 1, format, 1, 1, texel.data(), bindFlags);
+                pTexture->setSourcePath(fullPath);
+                return pTexture;
+            };
+            return { upload, texel.size() };
+        };
+
+        // Look up the analysis result in the cache. Constant textures are created without decoding the image file.
+        std::optional<AssetCache::Key> cacheKey;
+        if (mpAnalysisCache) cacheKey = computeAnalysisCacheKey(key.fullPath, key.loadAsSRGB);
+        if (cacheKey)
+        {
+            if (auto data = mpAnalysisCache->read(*cacheKey); data && data->size() == sizeof(CachedAnalysis))
+            {
+                CachedAnalysis cached;
+                std::memcpy(&cached, data->data(), sizeof(cached));
+                analysis = cached.result;
+                if (cached.result.isConstant(TextureChannelFlags::RGBA)) return createConstantTexture(cached.format, cached.texel);
+            }
+        }
+
+        // Load the texture from the texture cache if there is an entry.
+        // Constant textures are never written to the cache, so a hit means the texture is not constant.
+        std::filesystem::path cachePath;
+        if (mTextureCacheDesc.enabled)
+        {
+            cachePath = computeTextureCachePath(mTextureCacheDesc.directory, key.fullPath, key.generateMipLevels, key.loadAsSRGB, key.bindFlags, mTextureCacheDesc.useCompression);
+        }
+
+        // Read the texture cache entry. Entries that fail to load (e.g. truncated or corrupt files) are deleted and the
+        // image is decoded instead. Errors must not escape, as this runs in parallel from endDeferredLoading().
+        auto loadCachedData = [&]() -> std::shared_ptr<const ImageIO::DDSData>
+        {
+            try
+            {
+                return std::make_shared<ImageIO::DDSData>(ImageIO::loadDDSData(cachePath, key.loadAsSRGB));
+            }
+            catch (const std::exception& e)
+            {
+                logWarning("Deleting invalid texture cache entry '{}' for '{}': {}", cachePath, key.fullPath, e.what());
+                std::error_code ec;
+                std::filesystem::remove(cachePath, ec);
+                return nullptr;
+            }
+        };
+
+        if (!cachePath.empty())
+        {
+            auto startTime = CpuTimer::getCurrentTimePoint();
+            std::error_code ec;
+            if (uint64_t fileSize = std::filesystem::file_size(cachePath, ec); !ec)
+            {
+                if (auto pData = loadCachedData())
+                {
+                    mTextureCacheHitCount++;
+                    mTextureCacheHitLoadTimeNs += toNanoseconds(startTime);
+                    mTextureCacheDiskSize += fileSize;
+                    return uploadDDSData(std::move(pData));
+                }
+            }
+        }
+
+        auto startTime = CpuTimer::getCurrentTimePoint();
+
+        std::shared_ptr<const Bitmap> pBitmap = Bitmap::createFromFile(key.fullPath, true);
+        if (!pBitmap) return {};
+
+        ResourceFormat format = key.loadAsSRGB ? linearToSrgbFormat(pBitmap->getFormat()) : pBitmap->getFormat();
+
+        if (!analysis)
+        {
+            analysis = TextureAnalyzer::analyze(*pBitmap, key.loadAsSRGB);
+            if (analysis && cacheKey)
+            {
+                CachedAnalysis cached = {};
+                cached.result = *analysis;
+                cached.format = format;
+                std::memcpy(cached.texel, pBitmap->getData(), std::min<size_t>(getFormatBytesPerBlock(format), sizeof(cached.texel)));
+                const uint8_t* pData = reinterpret_cast<const uint8_t*>(&cached);
+                mpAnalysisCache->write(*cacheKey, std::vector<uint8_t>(pData, pData + sizeof(cached)));
+            }
+        }
+
+        if (analysis && analysis->isConstant(TextureChannelFlags::RGBA)) return createConstantTexture(format, pBitmap->getData());
+
+        // Write the texture to the texture cache and load it from there, so that cold and warm loads give the same texture.
+        // Write to a temporary file first and rename it, so that concurrent readers never see partially written entries.
+        if (auto mode = cachePath.empty() ? std::nullopt : getTextureCacheCompressionMode(*pBitmap, mTextureCacheDesc.useCompression))
+        {
+            auto tempPath = cachePath;
+            tempPath.replace_extension(fmt::format("{:016x}.{}.tmp.dds", mTextureCacheNonce, mTextureCacheTempFileCounter++));
+            std::error_code ec;
+            try
+            {
+                std::filesystem::create_directories(cachePath.parent_path(), ec);
+                ImageIO::saveToDDS(tempPath, *pBitmap, *mode, key.generateMipLevels);
+                std::filesystem::rename(tempPath, cachePath, ec);
+                if (ec) std::filesystem::remove(tempPath, ec);
+            }
+            catch (const RuntimeError& e)
+            {
+                std::filesystem::remove(tempPath, ec);
+                logWarning("Failed to write texture cache entry for '{}': {}", key.fullPath, e.what());
+            }
+
+            uint64_t fileSize = std::filesystem::file_size(cachePath, ec);
+            if (auto pData = ec ? nullptr : loadCachedData())
+            {
+                mTextureCacheMissCount++;
+                mTextureCacheMissLoadTimeNs += toNanoseconds(startTime);
+                mTextureCacheDiskSize += fileSize;
+                return uploadDDSData(std::move(pData));
+            }
+        }
+
+        auto upload = [pDevice, pBitmap, format, key]()
+        {
+            auto pTexture = Texture::create2D(
+                pDevice, pBitmap->getWidth(), pBitmap->getHeight(), format, 1, key.generateMipLevels ? Texture::kMaxPossible : 1,
+                pBitmap->getData(), key.bindFlags
+            );
+            pTexture->setSourcePath(key.fullPath);
+            return pTexture;
+        };
+        return { upload, pBitmap->getSize() };
+    }
+
+    void TextureManager::setTexturePriority(const TextureHandle& handle, AsyncTextureLoader::Priority priority)
+    {
+        if (!handle || handle.isUdim()) return;
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (auto it = mLoadRequests.find(handle.getID()); it != mLoadRequests.end()) mAsyncTextureLoader.setPriority(it->second, priority);
+    }
+
     void TextureManager::waitForTextureLoading(const TextureHandle& handle)
     {
         if (!handle) return;
@@ -298,6 +601,8 @@ namespace Falcor
 
     void TextureManager::endDeferredLoading()
     {
+        FALCOR_PROFILE_CPU("TextureManager::endDeferredLoading");
+
         struct Job {
             TextureKey key;
             TextureHandle handle;
@@ -320,7 +625,7 @@ namespace Falcor
             {
                 const auto& job = jobs[i];
                 auto& desc = getDesc(job.handle);
-                desc.pTexture = Texture::createFromFile(mpDevice.get(), job.key.fullPath, job.key.generateMipLevels, job.key.loadAsSRGB, job.key.bindFlags);
+                desc.pTexture = loadTextureFromFile(job.key, desc.analysis);
                 logDebug("Loading texture from '{}'", job.key.fullPath);
                 if (texturesLoaded.fetch_add(1) % 10 == 9)
                 {
@@ -351,6 +656,15 @@ namespace Falcor
         }
         if (!handle) return;
 
+        // Cancel the load request if the texture is still loading. The request then completes with a nullptr texture.
+        // The mutex must not be held while cancelling, as the completion callback acquires it.
+        AsyncTextureLoader::RequestID requestID = AsyncTextureLoader::kInvalidRequestID;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (auto it = mLoadRequests.find(handle.getID()); it != mLoadRequests.end()) requestID = it->second;
+        }
+        if (requestID != AsyncTextureLoader::kInvalidRequestID) mAsyncTextureLoader.cancel(requestID);
+
         waitForTextureLoading(handle);
 
         std::lock_guard<std::mutex> lock(mMutex);
@@ -451,9 +765,34 @@ namespace Falcor
             s.textureMemoryInBytes += t.pTexture->getTextureSizeInBytes();
             if (isCompressedFormat(t.pTexture->getFormat())) s.textureCompressedCount++;
         }
+        s.textureCacheHitCount = mTextureCacheHitCount;
+        s.textureCacheMissCount = mTextureCacheMissCount;
+        s.textureCacheHitLoadTime = mTextureCacheHitLoadTimeNs * 1e-9;
+        s.textureCacheMissLoadTime = mTextureCacheMissLoadTimeNs * 1e-9;
+        s.textureCacheDiskSizeInBytes = mTextureCacheDiskSize;
         return s;
     }
 
+    void TextureManager::setTextureCache(const TextureCacheDesc& desc)
+    {
+        mTextureCacheDesc = desc;
+        if (mTextureCacheDesc.directory.empty()) mTextureCacheDesc.directory = getAppDataDirectory() / kTextureCacheDirectory;
+
+        std::random_device rd;
+        mTextureCacheNonce = ((uint64_t)rd() << 32) | rd();
+    }
+
+    std::optional<TextureAnalyzer::Result> TextureManager::getTextureAnalysis(const Texture* pTexture) const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (auto it = mTextureToHandle.find(pTexture); it != mTextureToHandle.end())
+        {
+            FALCOR_ASSERT(it->second.getID() < mTextureDescs.size());
+            return mTextureDescs[it->second.getID()].analysis;
+        }
+        return {};
+    }
+
     TextureManager::TextureHandle TextureManager::addDesc(const TextureDesc& desc)
     {
         TextureHandle handle;
@@ -27,21 +27,27 @@
  **************************************************************************/
 #pragma once
 #include "AsyncTextureLoader.h"
+#include "TextureAnalyzer.h"
 #include "Core/Macros.h"
 #include "Core/API/fwd.h"
 #include "Core/API/Resource.h"
 #include "Core/API/Texture.h"
 #include "Core/Program/ShaderVar.h"
+#include <atomic>
 #include <condition_variable>
+#include <filesystem>
 #include <limits>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <thread>
 
 namespace Falcor
 {
     class SearchDirectories;
+    class AssetCache;
+    class Bitmap;
 
     /** Multi-threaded texture manager.
 
@@ -75,6 +81,24 @@ namespace Falcor
             uint64_t textureTexelCount = 0;             ///< Total number of texels in all textures.
             uint64_t textureTexelChannelCount = 0;      ///< Total number of texel channels in all textures.
             uint64_t textureMemoryInBytes = 0;          ///< Total memory in bytes used by the textures.
+
+            uint64_t textureCacheHitCount = 0;          ///< Number of textures loaded from the texture cache (warm loads).
+            uint64_t textureCacheMissCount = 0;         ///< Number of textures decoded and written to the texture cache (cold loads).
+            double textureCacheHitLoadTime = 0.0;       ///< Total time in seconds spent on warm loads.
+            double textureCacheMissLoadTime = 0.0;      ///< Total time in seconds spent on cold loads, including writing the cache files.
+            uint64_t textureCacheDiskSizeInBytes = 0;   ///< Total size in bytes of the texture cache files read or written.
+        };
+
+        /** Texture cache settings.
+            The texture cache stores textures loaded from image files as DDS files with a precomputed mip chain and
+            optional block compression. Later loads of the same image file with the same settings read the DDS file
+            directly, which avoids decoding the image and generating mips on the GPU.
+        */
+        struct TextureCacheDesc
+        {
+            bool enabled = false;               ///< Enable the texture cache.
+            std::filesystem::path directory;    ///< Cache directory. If empty, a subdirectory in the application data directory is used.
+            bool useCompression = true;         ///< Store 8-bit textures with BC4/BC5/BC7 compression. Other formats are stored uncompressed.
         };
 
         /** Handle to a managed texture.
@@ -116,6 +140,7 @@ namespace Falcor
         {
             TextureState state = TextureState::Invalid;     ///< Current state of the texture.
             Texture::SharedPtr pTexture;                    ///< Valid texture object when state is 'Loaded', or nullptr if loading failed.
+            std::optional<TextureAnalyzer::Result> analysis; ///< Result of the CPU analysis done when loading the texture, if available.
 
             bool isValid() const { return state != TextureState::Invalid; }
         };
@@ -155,6 +180,13 @@ namespace Falcor
         */
         TextureHandle loadUdimTexture(const std::filesystem::path& path, bool generateMipLevels, bool loadAsSRGB, Resource::BindFlags bindFlags = Resource::BindFlags::ShaderResource, bool async = true, const SearchDirectories* searchDirectories = nullptr, size_t* loadedTextureCount = nullptr);
 
+        /** Change the loading priority of a texture that is still loading asynchronously.
+            Textures with higher priority are decoded and uploaded first. The call has no effect if the texture has been loaded.
+            \param[in] handle Texture handle.
+            \param[in] priority New priority.
+        */
+        void setTexturePriority(const TextureHandle& handle, AsyncTextureLoader::Priority priority);
+
         /** Wait for a requested texture to load.
             If the handle is valid, the call blocks until the texture is loaded (or failed to load).
             \param[in] handle Texture handle.
@@ -174,7 +206,7 @@ namespace Falcor
         void beginDeferredLoading();
         void endDeferredLoading();
 
-        /** Remove a texture.
+        /** Remove a texture. If the texture is still loading, the load request is cancelled.
             \param[in] handle Texture handle.
         */
         void removeTexture(const TextureHandle& handle);
@@ -216,6 +248,30 @@ namespace Falcor
         /** Returns stats for the textures
         */
         Stats getStats() const;
+
+        /** Set a cache for the results of the CPU texture analysis.
+            Textures loaded from image files are analyzed on the CPU before they are uploaded. The cached results
+            allow constant textures to be created without decoding their image files again.
+            \param[in] pCache Asset cache, or nullptr to disable caching.
+        */
+        void setAnalysisCache(std::shared_ptr<AssetCache> pCache) { mpAnalysisCache = std::move(pCache); }
+
+        /** Configure the on-disk texture cache. This should be called before textures are loaded.
+            \param[in] desc Texture cache settings.
+        */
+        void setTextureCache(const TextureCacheDesc& desc);
+
+        /** Get the texture cache settings.
+        */
+        const TextureCacheDesc& getTextureCache() const { return mTextureCacheDesc; }
+
+        /** Get the result of the CPU analysis of a texture.
+            Textures loaded from image files of a supported format are analyzed on the CPU before they are uploaded.
+            Textures found to be constant are uploaded as a single texel.
+            \param[in] pTexture The texture.
+            \return The analysis result, or an empty optional if the texture is not managed or was not analyzed.
+        */
+        std::optional<TextureAnalyzer::Result> getTextureAnalysis(const Texture* pTexture) const;
     private:
         TextureManager(std::shared_ptr<Device> pDevice, size_t maxTextureCount, size_t threadCount);
         size_t getUdimRange(size_t requiredSize);
@@ -247,6 +303,8 @@ namespace Falcor
         };
 
         TextureHandle addDesc(const TextureDesc& desc);
+        Texture::SharedPtr loadTextureFromFile(const TextureKey& key, std::optional<TextureAnalyzer::Result>& analysis) const;
+        AsyncTextureLoader::DecodedTexture decodeTextureFromFile(const TextureKey& key, std::optional<TextureAnalyzer::Result>& analysis) const;
         TextureDesc& getDesc(const TextureHandle& handle);
 
         std::shared_ptr<Device> mpDevice;
@@ -271,6 +329,18 @@ namespace Falcor
 
         bool mUseDeferredLoading = false;
 
+        std::shared_ptr<AssetCache> mpAnalysisCache;                ///< Cache for texture analysis results, or nullptr if disabled.
+
+        TextureCacheDesc mTextureCacheDesc;                         ///< Texture cache settings.
+        mutable std::atomic<uint64_t> mTextureCacheHitCount = 0;
+        mutable std::atomic<uint64_t> mTextureCacheMissCount = 0;
+        mutable std::atomic<uint64_t> mTextureCacheHitLoadTimeNs = 0;
+        mutable std::atomic<uint64_t> mTextureCacheMissLoadTimeNs = 0;
+        mutable std::atomic<uint64_t> mTextureCacheDiskSize = 0;
+        mutable std::atomic<uint64_t> mTextureCacheTempFileCounter = 0;
+        uint64_t mTextureCacheNonce = 0;                            ///< Random nonce to make temporary file names unique across processes.
+
+        std::map<uint32_t, AsyncTextureLoader::RequestID> mLoadRequests; ///< Asynchronous load requests in progress, by texture ID. Declared before the loader, whose callbacks access it.
         AsyncTextureLoader mAsyncTextureLoader;                     ///< Utility for asynchronous texture loading.
         size_t mLoadRequestsInProgress = 0;                         ///< Number of load requests currently in progress.
 
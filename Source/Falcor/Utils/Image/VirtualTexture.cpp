@@ -0,0 +1,279 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "VirtualTexture.h"
+#include "Core/Assert.h"
+#include "Core/Errors.h"
+#include <fstd/bit.h> // TODO: Replace with C++20 <bit> when available on all targets
+#include <algorithm>
+
+namespace Falcor
+{
+    VirtualTextureLayout::VirtualTextureLayout(uint32_t width, uint32_t height, uint32_t mipCount, uint32_t tileSize)
+        : mWidth(width)
+        , mHeight(height)
+        , mTileSize(tileSize)
+    {
+        checkArgument(width > 0 && height > 0, "Virtual texture dimensions must be non-zero.");
+        checkArgument(tileSize > 0, "Virtual texture tile size must be non-zero.");
+
+        uint32_t fullMipCount = 1;
+        while ((std::max(width, height) >> fullMipCount) > 0) fullMipCount++;
+        mMipCount = std::clamp(mipCount, 1u, fullMipCount);
+
+        mMipOffsets.resize(mMipCount + 1);
+        mMipOffsets[0] = 0;
+        for (uint32_t mip = 0; mip < mMipCount; mip++)
+        {
+            mMipOffsets[mip + 1] = mMipOffsets[mip] + getTileCountX(mip) * getTileCountY(mip);
+        }
+    }
+
+    uint32_t VirtualTextureLayout::getMipWidth(uint32_t mip) const
+    {
+        return std::max(mWidth >> mip, 1u);
+    }
+
+    uint32_t VirtualTextureLayout::getMipHeight(uint32_t mip) const
+    {
+        return std::max(mHeight >> mip, 1u);
+    }
+
+    uint32_t VirtualTextureLayout::getTileCountX(uint32_t mip) const
+    {
+        return (getMipWidth(mip) + mTileSize - 1) / mTileSize;
+    }
+
+    uint32_t VirtualTextureLayout::getTileCountY(uint32_t mip) const
+    {
+        return (getMipHeight(mip) + mTileSize - 1) / mTileSize;
+    }
+
+    uint32_t VirtualTextureLayout::getTileIndex(const TileCoord& coord) const
+    {
+        FALCOR_ASSERT(coord.mip < mMipCount && coord.x < getTileCountX(coord.mip) && coord.y < getTileCountY(coord.mip));
+        return mMipOffsets[coord.mip] + coord.y * getTileCountX(coord.mip) + coord.x;
+    }
+
+    VirtualTextureLayout::TileCoord VirtualTextureLayout::getTileCoord(uint32_t tileIndex) const
+    {
+        FALCOR_ASSERT(tileIndex < getTileCount());
+        uint32_t mip = (uint32_t)(std::upper_bound(mMipOffsets.begin(), mMipOffsets.end(), tileIndex) - mMipOffsets.begin()) - 1;
+        uint32_t index = tileIndex - mMipOffsets[mip];
+        uint32_t tileCountX = getTileCountX(mip);
+        return { mip, index % tileCountX, index / tileCountX };
+    }
+
+    uint32_t VirtualTextureLayout::getParentTileIndex(uint32_t tileIndex) const
+    {
+        TileCoord coord = getTileCoord(tileIndex);
+        if (coord.mip + 1 == mMipCount) return tileIndex;
+        // Mip dimensions are rounded down, so the last row/column of tiles can map past the tiles of the next mip level
+        // (e.g. 257 texels with 128 texel tiles gives 3 tiles in mip 0 and 1 tile in mip 1). Those are covered by the last tile.
+        uint32_t parentMip = coord.mip + 1;
+        return getTileIndex({ parentMip, std::min(coord.x / 2, getTileCountX(parentMip) - 1), std::min(coord.y / 2, getTileCountY(parentMip) - 1) });
+    }
+
+    VirtualTextureResidency::VirtualTextureResidency(const VirtualTexturePoolDesc& poolDesc, uint32_t maxLoadsPerUpdate)
+        : mPoolDesc(poolDesc)
+        , mMaxLoadsPerUpdate(maxLoadsPerUpdate)
+    {
+        checkArgument(poolDesc.tileSize > 0, "Virtual texture tile size must be non-zero.");
+        checkArgument(poolDesc.pageCount > 0 && poolDesc.pageCount <= (1u << VirtualTexturePageEntry::kPageBits), "Invalid virtual texture page count.");
+
+        mPages.resize(poolDesc.pageCount);
+        mFreePages.resize(poolDesc.pageCount);
+        // Hand out pages in increasing order.
+        for (uint32_t i = 0; i < poolDesc.pageCount; i++) mFreePages[i] = poolDesc.pageCount - 1 - i;
+    }
+
+    VirtualTextureResidency::TextureID VirtualTextureResidency::addTexture(uint32_t width, uint32_t height, uint32_t mipCount)
+    {
+        TextureInfo info = { VirtualTextureLayout(width, height, mipCount, mPoolDesc.tileSize), (uint32_t)mPageTable.size() };
+        const uint32_t tileCount = info.layout.getTileCount();
+
+        mPageTable.resize(mPageTable.size() + tileCount);
+        mEntryToPage.resize(mPageTable.size(), kNoPage);
+        mEntryRequested.resize(mPageTable.size(), 0);
+
+        mTextures.push_back(std::move(info));
+        return (TextureID)(mTextures.size() - 1);
+    }
+
+    VirtualTextureDesc VirtualTextureResidency::getDesc(TextureID textureID) const
+    {
+        const auto& info = mTextures[textureID];
+        VirtualTextureDesc desc;
+        desc.pageTableOffset = info.pageTableOffset;
+        desc.width = info.layout.getWidth();
+        desc.height = info.layout.getHeight();
+        desc.mipCount = info.layout.getMipCount();
+        return desc;
+    }
+
+    bool VirtualTextureResidency::isResident(TextureID textureID, uint32_t tileIndex) const
+    {
+        return mEntryToPage[mTextures[textureID].pageTableOffset + tileIndex] != kNoPage;
+    }
+
+    VirtualTextureResidency::UpdateStats VirtualTextureResidency::update(const uint32_t* pFeedback, size_t wordCount, const LoadTileFunction& loadTile)
+    {
+        UpdateStats stats;
+        mUpdateIndex++;
+
+        // Gather the requested tiles and the coarser tiles covering them.
+        std::vector<uint32_t> requested;
+        wordCount = std::min(wordCount, getFeedbackWordCount());
+        for (size_t word = 0; word < wordCount; word++)
+        {
+            for (uint32_t bits = pFeedback[word]; bits != 0; bits &= bits - 1)
+            {
+                uint32_t entry = (uint32_t)(word * 32) + (uint32_t)fstd::countr_zero(bits);
+                if (entry >= mPageTable.size()) break;
+
+                const auto& info = mTextures[findTexture(entry)];
+                uint32_t tileIndex = entry - info.pageTableOffset;
+                while (mEntryRequested[entry] != mUpdateIndex)
+                {
+                    mEntryRequested[entry] = mUpdateIndex;
+                    requested.push_back(entry);
+
+                    uint32_t parentIndex = info.layout.getParentTileIndex(tileIndex);
+                    if (parentIndex == tileIndex) break;
+                    tileIndex = parentIndex;
+                    entry = info.pageTableOffset + tileIndex;
+                }
+            }
+        }
+        stats.requestedTileCount = (uint32_t)requested.size();
+
+        // Mark resident tiles as used and gather the tiles to load.
+        std::vector<std::pair<uint32_t, uint32_t>> toLoad; // (mip, entry)
+        for (uint32_t entry : requested)
+        {
+            if (uint32_t page = mEntryToPage[entry]; page != kNoPage)
+            {
+                mPages[page].lastUsed = mUpdateIndex;
+                mLRU.splice(mLRU.end(), mLRU, mPages[page].lruIt);
+            }
+            else
+            {
+                const auto& info = mTextures[findTexture(entry)];
+                toLoad.push_back({ info.layout.getTileCoord(entry - info.pageTableOffset).mip, entry });
+            }
+        }
+
+        // Load coarse tiles first, as they are the fallback for the finer ones.
+        std::sort(toLoad.begin(), toLoad.end(), [](const auto& a, const auto& b) { return a.first != b.first ? a.first > b.first : a.second < b.second; });
+
+        std::vector<bool> textureChanged(mTextures.size(), false);
+        for (const auto& [mip, entry] : toLoad)
+        {
+            if (stats.loadedTileCount >= mMaxLoadsPerUpdate) break;
+
+            // Allocate a page. Evict the least recently used tile if there are no free pages.
+            uint32_t page = kNoPage;
+            if (!mFreePages.empty())
+            {
+                page = mFreePages.back();
+                mFreePages.pop_back();
+            }
+            else if (mPages[mLRU.front()].lastUsed != mUpdateIndex)
+            {
+                page = mLRU.front();
+                mLRU.pop_front();
+                uint32_t evictedEntry = mPages[page].entry;
+                mEntryToPage[evictedEntry] = kNoPage;
+                textureChanged[findTexture(evictedEntry)] = true;
+                stats.evictedTileCount++;
+            }
+            else
+            {
+                // All pages hold tiles used in this update.
+                break;
+            }
+
+            TextureID textureID = findTexture(entry);
+            const auto& info = mTextures[textureID];
+            loadTile(textureID, info.layout.getTileCoord(entry - info.pageTableOffset), page);
+
+            mEntryToPage[entry] = page;
+            mPages[page].entry = entry;
+            mPages[page].lastUsed = mUpdateIndex;
+            mPages[page].lruIt = mLRU.insert(mLRU.end(), page);
+            textureChanged[textureID] = true;
+            stats.loadedTileCount++;
+        }
+        stats.pendingTileCount = (uint32_t)toLoad.size() - stats.loadedTileCount;
+
+        for (TextureID textureID = 0; textureID < (TextureID)mTextures.size(); textureID++)
+        {
+            if (textureChanged[textureID])
+            {
+                updatePageTable(textureID);
+                stats.pageTableChanged = true;
+            }
+        }
+
+        return stats;
+    }
+
+    VirtualTextureResidency::TextureID VirtualTextureResidency::findTexture(uint32_t entry) const
+    {
+        FALCOR_ASSERT(entry < mPageTable.size());
+        auto it = std::upper_bound(mTextures.begin(), mTextures.end(), entry, [](uint32_t e, const TextureInfo& info) { return e < info.pageTableOffset; });
+        return (TextureID)(it - mTextures.begin()) - 1;
+    }
+
+    void VirtualTextureResidency::updatePageTable(TextureID textureID)
+    {
+        // Walk the mip chain from coarse to fine. Non-resident tiles inherit the entry of the covering coarser tile.
+        const auto& info = mTextures[textureID];
+        const auto& layout = info.layout;
+        for (uint32_t mip = layout.getMipCount(); mip-- > 0;)
+        {
+            for (uint32_t y = 0; y < layout.getTileCountY(mip); y++)
+            {
+                for (uint32_t x = 0; x < layout.getTileCountX(mip); x++)
+                {
+                    uint32_t tileIndex = layout.getTileIndex({ mip, x, y });
+                    uint32_t entry = info.pageTableOffset + tileIndex;
+                    VirtualTexturePageEntry pageEntry;
+                    if (uint32_t page = mEntryToPage[entry]; page != kNoPage)
+                    {
+                        pageEntry.setPage(page, mip);
+                    }
+                    else if (uint32_t parentIndex = layout.getParentTileIndex(tileIndex); parentIndex != tileIndex)
+                    {
+                        pageEntry = mPageTable[info.pageTableOffset + parentIndex];
+                    }
+                    mPageTable[entry] = pageEntry;
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,214 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "VirtualTextureData.slang"
+#include "Core/Macros.h"
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <vector>
+
+namespace Falcor
+{
+    /** Tile layout of a virtual texture.
+
+        The mip chain is split into square tiles of a fixed size. Tiles are indexed linearly, starting with
+        the tiles of mip 0 in row-major order, followed by the tiles of mip 1 and so on. Mip levels smaller
+        than a tile occupy a single tile. A tile at (mip, x, y) is covered by the tile at (mip + 1, x / 2, y / 2),
+        clamped to the tiles of mip + 1 for dimensions that are not a power of two.
+    */
+    class FALCOR_API VirtualTextureLayout
+    {
+    public:
+        struct TileCoord
+        {
+            uint32_t mip = 0;
+            uint32_t x = 0;
+            uint32_t y = 0;
+
+            bool operator==(const TileCoord& rhs) const { return mip == rhs.mip && x == rhs.x && y == rhs.y; }
+        };
+
+        /** Constructor.
+            \param[in] width Width of mip 0 in texels.
+            \param[in] height Height of mip 0 in texels.
+            \param[in] mipCount Number of mip levels. This is clamped to the size of the full mip chain.
+            \param[in] tileSize Tile size in texels.
+        */
+        VirtualTextureLayout(uint32_t width, uint32_t height, uint32_t mipCount, uint32_t tileSize);
+
+        uint32_t getWidth() const { return mWidth; }
+        uint32_t getHeight() const { return mHeight; }
+        uint32_t getMipCount() const { return mMipCount; }
+        uint32_t getTileSize() const { return mTileSize; }
+
+        /** Get the width/height of a mip level in texels.
+        */
+        uint32_t getMipWidth(uint32_t mip) const;
+        uint32_t getMipHeight(uint32_t mip) const;
+
+        /** Get the number of tiles in x/y in a mip level.
+        */
+        uint32_t getTileCountX(uint32_t mip) const;
+        uint32_t getTileCountY(uint32_t mip) const;
+
+        /** Get the total number of tiles in all mip levels.
+        */
+        uint32_t getTileCount() const { return mMipOffsets.back(); }
+
+        /** Get the linear index of a tile.
+        */
+        uint32_t getTileIndex(const TileCoord& coord) const;
+
+        /** Get the coordinate of a tile from its linear index.
+        */
+        TileCoord getTileCoord(uint32_t tileIndex) const;
+
+        /** Get the linear index of the tile in the next coarser mip level covering a tile.
+            \return The parent tile index, or the tile index itself if the tile is in the coarsest mip level.
+        */
+        uint32_t getParentTileIndex(uint32_t tileIndex) const;
+
+    private:
+        uint32_t mWidth;
+        uint32_t mHeight;
+        uint32_t mMipCount;
+        uint32_t mTileSize;
+        std::vector<uint32_t> mMipOffsets;  ///< Index of the first tile of each mip level. The last element is the total tile count.
+    };
+
+    /** Residency manager for virtual textures.
+
+        Manages which tiles of a set of virtual textures are resident in a pool of physical pages.
+        The page table of all textures is stored in a single array, in which each texture occupies a
+        contiguous range of entries. Shaders mark the tiles they sample by setting one bit per page table
+        entry in a feedback buffer. Each update reads the feedback, loads the requested tiles coarse to fine,
+        and evicts the least recently used tiles when the pool is full. Tiles used in the current update are
+        never evicted. Requesting a tile also requests all coarser tiles covering it, so that there is always
+        a resident fallback to sample from.
+
+        The class has no GPU dependencies. Uploading tile data and the page table is done by the caller.
+        Note that the material system does not use virtual textures yet: material textures are still bound fully
+        resident through TextureManager. This class and VirtualTexture.slang are the building blocks for streaming them.
+    */
+    class FALCOR_API VirtualTextureResidency
+    {
+    public:
+        using TextureID = uint32_t;
+
+        /** Function called to load a tile into a physical page.
+        */
+        using LoadTileFunction = std::function<void(TextureID textureID, const VirtualTextureLayout::TileCoord& tile, uint32_t page)>;
+
+        struct UpdateStats
+        {
+            uint32_t requestedTileCount = 0;    ///< Number of requested tiles, including the coarser tiles covering them.
+            uint32_t loadedTileCount = 0;       ///< Number of tiles loaded.
+            uint32_t evictedTileCount = 0;      ///< Number of tiles evicted.
+            uint32_t pendingTileCount = 0;      ///< Number of requested tiles not loaded because of the load limit or the pool size.
+            bool pageTableChanged = false;      ///< True if the page table needs to be uploaded again.
+        };
+
+        /** Constructor.
+            \param[in] poolDesc Physical page pool description. The page count is the residency budget.
+            \param[in] maxLoadsPerUpdate Maximum number of tiles loaded per update.
+        */
+        VirtualTextureResidency(const VirtualTexturePoolDesc& poolDesc, uint32_t maxLoadsPerUpdate = UINT32_MAX);
+
+        /** Add a virtual texture. The tile size is given by the page pool.
+            \param[in] width Width of mip 0 in texels.
+            \param[in] height Height of mip 0 in texels.
+            \param[in] mipCount Number of mip levels.
+            \return ID of the texture.
+        */
+        TextureID addTexture(uint32_t width, uint32_t height, uint32_t mipCount);
+
+        const VirtualTextureLayout& getLayout(TextureID textureID) const { return mTextures[textureID].layout; }
+        const VirtualTexturePoolDesc& getPoolDesc() const { return mPoolDesc; }
+
+        /** Get the shader description of a texture.
+        */
+        VirtualTextureDesc getDesc(TextureID textureID) const;
+
+        /** Get the page table of all textures.
+        */
+        const std::vector<VirtualTexturePageEntry>& getPageTable() const { return mPageTable; }
+
+        /** Get the size of the feedback buffer in 32-bit words. The buffer holds one bit per page table entry.
+        */
+        size_t getFeedbackWordCount() const { return (mPageTable.size() + 31) / 32; }
+
+        /** Update residency from shader feedback.
+            \param[in] pFeedback Feedback bits, one per page table entry. May be nullptr if wordCount is zero.
+            \param[in] wordCount Number of 32-bit words in the feedback.
+            \param[in] loadTile Function called for each tile to load.
+            \return Statistics of the update.
+        */
+        UpdateStats update(const uint32_t* pFeedback, size_t wordCount, const LoadTileFunction& loadTile);
+
+        /** Check if a tile is resident.
+        */
+        bool isResident(TextureID textureID, uint32_t tileIndex) const;
+
+        /** Get the number of resident tiles.
+        */
+        uint32_t getResidentTileCount() const { return mPoolDesc.pageCount - (uint32_t)mFreePages.size(); }
+
+    private:
+        static constexpr uint32_t kNoPage = UINT32_MAX;
+
+        struct TextureInfo
+        {
+            VirtualTextureLayout layout;
+            uint32_t pageTableOffset;
+        };
+
+        struct Page
+        {
+            uint32_t entry = kNoPage;                   ///< Page table entry of the tile stored in the page.
+            uint64_t lastUsed = 0;                      ///< Update in which the tile was last requested.
+            std::list<uint32_t>::iterator lruIt;        ///< Position in the LRU list.
+        };
+
+        TextureID findTexture(uint32_t entry) const;
+        void updatePageTable(TextureID textureID);
+
+        VirtualTexturePoolDesc mPoolDesc;
+        uint32_t mMaxLoadsPerUpdate;
+        uint64_t mUpdateIndex = 0;
+
+        std::vector<TextureInfo> mTextures;
+        std::vector<VirtualTexturePageEntry> mPageTable;
+        std::vector<uint32_t> mEntryToPage;             ///< Physical page of each page table entry, or kNoPage if not resident.
+        std::vector<uint64_t> mEntryRequested;          ///< Update in which each page table entry was last requested.
+
+        std::vector<Page> mPages;
+        std::vector<uint32_t> mFreePages;
+        std::list<uint32_t> mLRU;                       ///< Resident pages ordered from least to most recently used.
+    };
+}
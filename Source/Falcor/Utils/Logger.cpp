@@ -1,5 +1,5 @@
 /***************************************************************************
- # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
  #
  # Redistribution and use in source and binary forms, with or without
  # modification, are permitted provided that the following conditions
@@ -28,14 +28,23 @@
 #include "Logger.h"
 #include "Core/Assert.h"
 #include "Core/Platform/OS.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
 #include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 namespace Falcor
 {
     namespace
     {
-        Logger::Level sVerbosity = Logger::Level::Info;
-        Logger::OutputFlags sOutputs = Logger::OutputFlags::Console | Logger::OutputFlags::File | Logger::OutputFlags::DebugWindow;
+        std::atomic<Logger::Level> sVerbosity{Logger::Level::Info};
+        std::atomic<Logger::OutputFlags> sOutputs{Logger::OutputFlags::Console | Logger::OutputFlags::File | Logger::OutputFlags::DebugWindow};
         std::filesystem::path sLogFilePath;
 
 #if FALCOR_ENABLE_LOGGER
@@ -80,21 +89,363 @@ namespace Falcor
 
             if (sLogFile)
             {
-                std::fprintf(sLogFile, "%s", s.c_str());
-                std::fflush(sLogFile);
+                std::fwrite(s.data(), 1, s.size(), sLogFile);
             }
         }
-#endif
-    }
 
-    void Logger::shutdown()
-    {
-#if FALCOR_ENABLE_LOGGER
-        if(sLogFile)
+        using Clock = std::chrono::steady_clock;
+
+        /** Log message passed from the logging threads to the writer.
+        */
+        struct Message
+        {
+            Logger::Level level = Logger::Level::Disabled;
+            uint64_t hash = 0;          ///< Hash of the message text used for rate limiting.
+            Clock::time_point time;     ///< Time the message was logged.
+            std::string text;
+        };
+
+        /** Bounded lock-free multi-producer queue of log messages.
+            Each slot of the ring buffer has a sequence number that tells whether it is ready to be written or read
+            (D. Vyukov's bounded MPMC queue). Pushing never locks. Popping must be serialized by the caller.
+        */
+        class MessageQueue
+        {
+        public:
+            explicit MessageQueue(size_t capacity)
+                : mSlots(capacity)
+                , mMask(capacity - 1)
+            {
+                FALCOR_ASSERT(capacity > 0 && (capacity & mMask) == 0);
+                for (size_t i = 0; i < capacity; i++) mSlots[i].sequence.store(i, std::memory_order_relaxed);
+            }
+
+            size_t getCapacity() const { return mSlots.size(); }
+
+            /** Try to push a message.
+                \return True if the message was pushed, false if the queue is full.
+            */
+            bool tryPush(Message& msg)
+            {
+                size_t pos = mPushPos.load(std::memory_order_relaxed);
+                while (true)
+                {
+                    Slot& slot = mSlots[pos & mMask];
+                    size_t sequence = slot.sequence.load(std::memory_order_acquire);
+                    auto diff = static_cast<std::ptrdiff_t>(sequence - pos);
+                    if (diff == 0)
+                    {
+                        // The slot is free, try to claim it.
+                        if (mPushPos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        {
+                            slot.msg = std::move(msg);
+                            slot.sequence.store(pos + 1, std::memory_order_release);
+                            return true;
+                        }
+                    }
+                    else if (diff < 0)
+                    {
+                        // The slot has not been popped since the last round.
+                        return false;
+                    }
+                    else
+                    {
+                        // Another thread claimed the slot.
+                        pos = mPushPos.load(std::memory_order_relaxed);
+                    }
+                }
+            }
+
+            /** Try to pop the next message.
+                \return True if a message was popped, false if the queue is empty or the next message is still being pushed.
+            */
+            bool tryPop(Message& msg)
+            {
+                Slot& slot = mSlots[mPopPos & mMask];
+                if (slot.sequence.load(std::memory_order_acquire) != mPopPos + 1) return false;
+                msg = std::move(slot.msg);
+                slot.sequence.store(mPopPos + mSlots.size(), std::memory_order_release);
+                mPopPos++;
+                return true;
+            }
+
+            /** Get the number of messages claimed by producers so far.
+            */
+            size_t getPushCount() const { return mPushPos.load(std::memory_order_acquire); }
+
+            /** Get the number of messages popped so far.
+            */
+            size_t getPopCount() const { return mPopPos; }
+
+        private:
+            struct Slot
+            {
+                std::atomic<size_t> sequence;
+                Message msg;
+            };
+
+            std::vector<Slot> mSlots;
+            const size_t mMask;
+            alignas(64) std::atomic<size_t> mPushPos{0};
+            alignas(64) size_t mPopPos = 0;
+        };
+
+        class LogWriter;
+        LogWriter& getLogWriter();
+
+        /** Asynchronous log writer.
+            Messages are pushed to a queue from any thread. The queue is drained by a background thread,
+            or by the logging thread itself when the queue is full, the message is an error, or the log is flushed.
+            Draining is serialized by a mutex, which also protects the outputs and the rate limiting state.
+        */
+        class LogWriter
+        {
+        public:
+            void log(Logger::Level level, std::string_view msg)
+            {
+                if (tDraining)
+                {
+                    // Logging while writing messages (e.g. on an error opening the log file), the write mutex is already held.
+                    write(level, msg);
+                    return;
+                }
+
+                Message message;
+                message.level = level;
+                message.hash = std::hash<std::string_view>()(msg);
+                message.time = Clock::now();
+                message.text = msg;
+
+                if (mState.load(std::memory_order_acquire) != State::Running) startThread();
+
+                while (!mQueue.tryPush(message))
+                {
+                    // The queue is full, help the writer.
+                    std::lock_guard<std::mutex> lock(mWriteMutex);
+                    drain(false);
+                }
+
+                if (level <= Logger::Level::Error || mState.load(std::memory_order_acquire) == State::Stopped)
+                {
+                    // Errors are written before returning, as the application may terminate right after.
+                    std::lock_guard<std::mutex> lock(mWriteMutex);
+                    drain(false);
+                }
+                else if (!mWakeRequested.exchange(true, std::memory_order_acq_rel))
+                {
+                    // Wake up the writer on the first message since it last drained the queue.
+                    std::lock_guard<std::mutex> lock(mWakeMutex);
+                    mWakeCondition.notify_one();
+                }
+            }
+
+            void flush()
+            {
+                std::lock_guard<std::mutex> lock(mWriteMutex);
+                drain(true);
+            }
+
+            /** Stop the writer thread and write all pending messages.
+                Messages logged afterwards are written immediately.
+            */
+            void stop()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mThreadMutex);
+                    if (mState.load() == State::Running)
+                    {
+                        {
+                            std::lock_guard<std::mutex> wakeLock(mWakeMutex);
+                            mStopRequested = true;
+                            mWakeCondition.notify_one();
+                        }
+                        mThread.join();
+                    }
+                    mState.store(State::Stopped, std::memory_order_release);
+                }
+
+                std::lock_guard<std::mutex> lock(mWriteMutex);
+                drain(true);
+            }
+
+            void shutdown()
+            {
+                stop();
+
+                std::lock_guard<std::mutex> lock(mWriteMutex);
+                if (sLogFile)
+                {
+                    std::fclose(sLogFile);
+                    sLogFile = nullptr;
+                    sInitialized = false;
+                }
+            }
+
+            void setRateLimit(uint32_t maxMessages, double windowSeconds)
+            {
+                std::lock_guard<std::mutex> lock(mWriteMutex);
+                drain(true);
+                mRateLimitCount = maxMessages;
+                mRateLimitWindow = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(windowSeconds));
+                mRecentMessages.clear();
+            }
+
+        private:
+            enum class State
+            {
+                Idle,
+                Running,
+                Stopped,
+            };
+
+            /** Rate limiting state of a message.
+            */
+            struct RecentMessage
+            {
+                Clock::time_point windowStart;
+                uint32_t count = 0;             ///< Number of times the message was written in the current window.
+                uint32_t suppressedCount = 0;   ///< Number of times the message was suppressed in the current window.
+                Logger::Level suppressedLevel = Logger::Level::Disabled;
+                std::string text;               ///< Message text, only stored once the message is suppressed.
+            };
+
+            static constexpr size_t kQueueCapacity = 8192;
+            static thread_local bool tDraining;         ///< True while the current thread is writing messages.
+            static constexpr auto kWriterWaitTime = std::chrono::milliseconds(100);
+
+            void startThread()
+            {
+                std::lock_guard<std::mutex> lock(mThreadMutex);
+                if (mState.load() != State::Idle) return;
+                mThread = std::thread([this] { writerThread(); });
+                mState.store(State::Running, std::memory_order_release);
+                // Write pending messages at exit if the application doesn't shut down the logger.
+                // The log file is kept open for messages logged during static destruction.
+                std::atexit([] { getLogWriter().stop(); });
+            }
+
+            void writerThread()
+            {
+                std::unique_lock<std::mutex> wakeLock(mWakeMutex);
+                while (!mStopRequested)
+                {
+                    mWakeCondition.wait_for(wakeLock, kWriterWaitTime, [this] { return mStopRequested || mWakeRequested.load(); });
+                    wakeLock.unlock();
+                    {
+                        std::lock_guard<std::mutex> lock(mWriteMutex);
+                        mWakeRequested.store(false, std::memory_order_release);
+                        drain(false);
+                    }
+                    wakeLock.lock();
+                }
+            }
+
+            /** Write all messages pushed so far. Must be called with the write mutex held.
+                \param[in] reportSuppressed Report all suppressed messages, not only those whose window ended.
+            */
+            void drain(bool reportSuppressed)
+            {
+                tDraining = true;
+                const size_t end = mQueue.getPushCount();
+                Message msg;
+                while (mQueue.getPopCount() < end)
+                {
+                    // Wait for messages that are still being pushed.
+                    if (!mQueue.tryPop(msg))
+                    {
+                        std::this_thread::yield();
+                        continue;
+                    }
+                    process(msg);
+                }
+
+                auto now = Clock::now();
+                if (reportSuppressed || now - mLastSweep >= kWriterWaitTime) sweepRecentMessages(now, reportSuppressed);
+
+                if (mWritten)
+                {
+                    std::cout.flush();
+                    if (sLogFile) std::fflush(sLogFile);
+                    mWritten = false;
+                }
+                tDraining = false;
+            }
+
+            void process(Message& msg)
+            {
+                if (msg.level > Logger::Level::Error && mRateLimitCount > 0)
+                {
+                    auto& recent = mRecentMessages[msg.hash];
+                    if (msg.time - recent.windowStart >= mRateLimitWindow)
+                    {
+                        reportSuppressed(recent);
+                        recent.windowStart = msg.time;
+                        recent.count = 0;
+                    }
+
+                    if (recent.count >= mRateLimitCount)
+                    {
+                        if (recent.suppressedCount++ == 0) recent.text = std::move(msg.text);
+                        recent.suppressedLevel = msg.level;
+                        return;
+                    }
+                    recent.count++;
+                }
+
+                write(msg.level, msg.text);
+            }
+
+            /** Report suppressed messages and remove messages that are no longer rate limited.
+            */
+            void sweepRecentMessages(Clock::time_point now, bool all)
+            {
+                for (auto it = mRecentMessages.begin(); it != mRecentMessages.end();)
+                {
+                    bool expired = now - it->second.windowStart >= mRateLimitWindow;
+                    if (expired || all) reportSuppressed(it->second);
+                    it = expired ? mRecentMessages.erase(it) : std::next(it);
+                }
+                mLastSweep = now;
+            }
+
+            void reportSuppressed(RecentMessage& recent)
+            {
+                if (recent.suppressedCount == 0) return;
+                write(recent.suppressedLevel, fmt::format("{} [{} identical message{} suppressed]", recent.text, recent.suppressedCount, recent.suppressedCount > 1 ? "s" : ""));
+                recent.suppressedCount = 0;
+                recent.text.clear();
+            }
+
+            void write(Logger::Level level, std::string_view msg);
+
+            MessageQueue mQueue{kQueueCapacity};
+
+            std::atomic<State> mState{State::Idle};
+            std::mutex mThreadMutex;                    ///< Mutex for starting and stopping the writer thread.
+            std::thread mThread;
+
+            std::mutex mWakeMutex;                      ///< Mutex for waking up the writer thread.
+            std::condition_variable mWakeCondition;
+            std::atomic<bool> mWakeRequested{false};
+            bool mStopRequested = false;
+
+            // State below is protected by the write mutex.
+            std::mutex mWriteMutex;
+            std::string mLine;
+            bool mWritten = false;
+            uint32_t mRateLimitCount = Logger::kDefaultRateLimitCount;
+            Clock::duration mRateLimitWindow = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(Logger::kDefaultRateLimitWindow));
+            std::unordered_map<uint64_t, RecentMessage> mRecentMessages;
+            Clock::time_point mLastSweep;
+        };
+
+        thread_local bool LogWriter::tDraining = false;
+
+        LogWriter& getLogWriter()
         {
-            fclose(sLogFile);
-            sLogFile = nullptr;
-            sInitialized = false;
+            // Intentionally leaked, so that logging works during static destruction.
+            static LogWriter* pWriter = new LogWriter();
+            return *pWriter;
         }
 #endif
     }
@@ -119,32 +470,71 @@ namespace Falcor
         }
     }
 
-    void Logger::log(Level level, const std::string_view msg)
-    {
 #if FALCOR_ENABLE_LOGGER
-        if (level <= sVerbosity)
-        {
-            std::string s = fmt::format("{} {}\n", getLogLevelString(level), msg);
+    void LogWriter::write(Logger::Level level, std::string_view msg)
+    {
+        mLine.clear();
+        fmt::format_to(std::back_inserter(mLine), "{} {}\n", getLogLevelString(level), msg);
+        Logger::OutputFlags outputs = sOutputs.load(std::memory_order_relaxed);
 
-            // Write to console.
-            if (is_set(sOutputs, OutputFlags::Console))
+        // Write to console.
+        if (is_set(outputs, Logger::OutputFlags::Console))
+        {
+            if (level > Logger::Level::Error)
             {
-                auto& os = level > Logger::Level::Error ? std::cout : std::cerr;
-                os << s;
-                os.flush();
+                std::cout << mLine;
             }
-
-            // Write to file.
-            if (is_set(sOutputs, OutputFlags::File))
+            else
             {
-                printToLogFile(s);
+                std::cout.flush();
+                std::cerr << mLine;
+                std::cerr.flush();
             }
+        }
 
-            // Write to debug window if debugger is attached.
-            if (is_set(sOutputs, OutputFlags::DebugWindow) && isDebuggerPresent())
-            {
-                printToDebugWindow(s);
-            }
+        // Write to file.
+        if (is_set(outputs, Logger::OutputFlags::File))
+        {
+            printToLogFile(mLine);
+        }
+
+        // Write to debug window if debugger is attached.
+        if (is_set(outputs, Logger::OutputFlags::DebugWindow) && isDebuggerPresent())
+        {
+            printToDebugWindow(mLine);
+        }
+
+        mWritten = true;
+    }
+#endif
+
+    void Logger::shutdown()
+    {
+#if FALCOR_ENABLE_LOGGER
+        getLogWriter().shutdown();
+#endif
+    }
+
+    void Logger::flush()
+    {
+#if FALCOR_ENABLE_LOGGER
+        getLogWriter().flush();
+#endif
+    }
+
+    void Logger::setRateLimit(uint32_t maxMessages, double windowSeconds)
+    {
+#if FALCOR_ENABLE_LOGGER
+        getLogWriter().setRateLimit(maxMessages, windowSeconds);
+#endif
+    }
+
+    void Logger::log(Level level, const std::string_view msg)
+    {
+#if FALCOR_ENABLE_LOGGER
+        if (level <= sVerbosity.load(std::memory_order_relaxed))
+        {
+            getLogWriter().log(level, msg);
         }
 #endif
     }
@@ -30,6 +30,7 @@
 #include "Core/FalcorConfig.h"
 #include "Utils/StringFormatters.h"
 #include <fmt/core.h>
+#include <cstdint>
 #include <string_view>
 #include <filesystem>
 
@@ -38,6 +39,15 @@ namespace Falcor
     /** Container class for logging messages.
         To enable log messages, make sure FALCOR_ENABLE_LOGGER is set to `1` in FalcorConfig.h.
         Messages are only printed to the selected outputs if they match the verbosity level.
+
+        Logging is thread-safe. Messages are placed in a lock-free queue and written to the
+        outputs by a background thread, which flushes the log file once per batch of messages.
+        Error and fatal messages are written before the log call returns.
+
+        Identical warning, info and debug messages are rate limited. Within a time window, repeats of
+        a message beyond the rate limit are suppressed, while different messages are always written.
+        The number of suppressed repeats is reported together with the message when the window ends
+        or the log is flushed.
     */
     class FALCOR_API Logger
     {
@@ -65,10 +75,25 @@ namespace Falcor
             DebugWindow     = 0x4,  ///< Output to debug window (if debugger is attached).
         };
 
-        /** Shutdown the logger and close the log file.
+        static constexpr uint32_t kDefaultRateLimitCount = 16;     ///< Default maximum number of identical messages per time window.
+        static constexpr double kDefaultRateLimitWindow = 1.0;     ///< Default rate limiting time window in seconds.
+
+        /** Shutdown the logger. This writes all pending messages and closes the log file.
+            Messages logged after shutdown are written immediately.
         */
         static void shutdown();
 
+        /** Write all pending messages to the outputs and report suppressed messages.
+            Returns when the messages have been written.
+        */
+        static void flush();
+
+        /** Set the rate limit for identical messages.
+            \param[in] maxMessages Maximum number of identical messages within the time window. Zero disables rate limiting.
+            \param[in] windowSeconds Length of the time window in seconds.
+        */
+        static void setRateLimit(uint32_t maxMessages, double windowSeconds);
+
         /** Set the logger verbosity.
             \param level Log level.
         */
@@ -105,6 +130,10 @@ namespace Falcor
         */
         static constexpr bool enabled() { return FALCOR_ENABLE_LOGGER != 0; }
 
+        /** Check if messages of a given level are logged with the current verbosity.
+        */
+        static bool isLogged(Level level) { return enabled() && level <= getVerbosity(); }
+
         /** Log a message.
             \param[in] level Log level.
             \param[in] msg Log message.
@@ -129,7 +158,8 @@ namespace Falcor
     template<typename... Args>
     inline void logDebug(fmt::format_string<Args...> format, Args&&... args)
     {
-        Logger::log(Logger::Level::Debug, fmt::format(format, std::forward<Args>(args)...));
+        if (Logger::isLogged(Logger::Level::Debug))
+            Logger::log(Logger::Level::Debug, fmt::format(format, std::forward<Args>(args)...));
     }
 
     inline void logInfo(const std::string_view msg)
@@ -140,7 +170,8 @@ namespace Falcor
     template<typename... Args>
     inline void logInfo(fmt::format_string<Args...> format, Args&&... args)
     {
-        Logger::log(Logger::Level::Info, fmt::format(format, std::forward<Args>(args)...));
+        if (Logger::isLogged(Logger::Level::Info))
+            Logger::log(Logger::Level::Info, fmt::format(format, std::forward<Args>(args)...));
     }
 
     inline void logWarning(const std::string_view msg)
@@ -151,7 +182,8 @@ namespace Falcor
     template<typename... Args>
     inline void logWarning(fmt::format_string<Args...> format, Args&&... args)
     {
-        Logger::log(Logger::Level::Warning, fmt::format(format, std::forward<Args>(args)...));
+        if (Logger::isLogged(Logger::Level::Warning))
+            Logger::log(Logger::Level::Warning, fmt::format(format, std::forward<Args>(args)...));
     }
 
     inline void logError(const std::string_view msg)
@@ -162,7 +194,8 @@ namespace Falcor
     template<typename... Args>
     inline void logError(fmt::format_string<Args...> format, Args&&... args)
     {
-        Logger::log(Logger::Level::Error, fmt::format(format, std::forward<Args>(args)...));
+        if (Logger::isLogged(Logger::Level::Error))
+            Logger::log(Logger::Level::Error, fmt::format(format, std::forward<Args>(args)...));
     }
 
     inline void logFatal(const std::string_view msg)
@@ -173,6 +206,7 @@ namespace Falcor
     template<typename... Args>
     inline void logFatal(fmt::format_string<Args...> format, Args&&... args)
     {
-        Logger::log(Logger::Level::Fatal, fmt::format(format, std::forward<Args>(args)...));
+        if (Logger::isLogged(Logger::Level::Fatal))
+            Logger::log(Logger::Level::Fatal, fmt::format(format, std::forward<Args>(args)...));
     }
 }
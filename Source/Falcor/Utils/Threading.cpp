@@ -27,68 +27,368 @@
  **************************************************************************/
 #include "Threading.h"
 #include "Core/Assert.h"
+#include "Utils/Timing/Profiler.h"
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <exception>
 
 namespace Falcor
 {
-    namespace
+    struct Threading::TaskState
     {
-        struct ThreadingData
+        std::function<void(void)> func;
+        std::atomic<uint32_t> pendingDependencies{0};
+        std::atomic<bool> done{false};
+        std::exception_ptr pException;                      ///< Exception thrown by func (if any). Written before done is set.
+        uint64_t flowId = 0;                                ///< CPU trace flow from the dispatching thread to the executing thread (0 if not traced).
+
+        std::mutex mutex;
+        std::condition_variable condition;
+        std::vector<std::shared_ptr<TaskState>> dependents; ///< Tasks waiting for this task to finish. Protected by mutex.
+    };
+
+    class Threading::Scheduler
+    {
+    public:
+        Scheduler(uint32_t threadCount)
+            : mQueues(std::max(threadCount, 1u))
         {
-            bool initialized = false;
-            std::vector<std::thread> threads;
-            uint32_t current;
-        } gData; // TODO: REMOVEGLOBAL
-    }
+            mWorkers.reserve(mQueues.size());
+            for (uint32_t i = 0; i < (uint32_t)mQueues.size(); i++)
+            {
+                mWorkers.emplace_back([this, i]() { workerLoop(i); });
+            }
+        }
+
+        ~Scheduler()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mSleepMutex);
+                mStop = true;
+            }
+            mSleepCondition.notify_all();
+            for (auto& t : mWorkers) t.join();
+        }
+
+        uint32_t getThreadCount() const { return (uint32_t)mWorkers.size(); }
+
+        /** Submit a task whose dependencies are all resolved.
+        */
+        void schedule(std::shared_ptr<TaskState> pTask)
+        {
+            // Workers push to their own queue, other threads distribute work round-robin.
+            size_t queueIndex = sWorkerIndex != kInvalidWorker && sWorkerScheduler == this
+                ? sWorkerIndex
+                : mNextQueue.fetch_add(1, std::memory_order_relaxed) % mQueues.size();
+            // Count the task before it becomes visible in a queue so the count never underflows.
+            {
+                std::lock_guard<std::mutex> lock(mSleepMutex);
+                mQueuedCount++;
+            }
+            {
+                std::lock_guard<std::mutex> lock(mQueues[queueIndex].mutex);
+                mQueues[queueIndex].tasks.push_back(std::move(pTask));
+            }
+            mSleepCondition.notify_one();
+        }
+
+        /** Register a task that was created and will eventually be scheduled.
+        */
+        void addOutstanding() { mOutstandingCount.fetch_add(1, std::memory_order_relaxed); }
+
+        /** Try to execute a single pending task on the calling thread.
+            \return True if a task was executed.
+        */
+        bool tryRunOne()
+        {
+            size_t home = sWorkerScheduler == this && sWorkerIndex != kInvalidWorker ? sWorkerIndex : 0;
+            std::shared_ptr<TaskState> pTask = popTask(home);
+            if (!pTask) return false;
+            run(pTask);
+            return true;
+        }
+
+        /** Wait until all dispatched tasks have finished. The calling thread helps executing tasks.
+        */
+        void waitIdle()
+        {
+            while (mOutstandingCount.load(std::memory_order_acquire) > 0)
+            {
+                if (!tryRunOne())
+                {
+                    std::unique_lock<std::mutex> lock(mIdleMutex);
+                    mIdleCondition.wait_for(lock, std::chrono::milliseconds(1), [this]() { return mOutstandingCount.load() == 0; });
+                }
+            }
+        }
+
+    private:
+        static constexpr size_t kInvalidWorker = size_t(-1);
+
+        struct TaskQueue
+        {
+            std::mutex mutex;
+            std::deque<std::shared_ptr<TaskState>> tasks;
+        };
+
+        std::shared_ptr<TaskState> popTask(size_t home)
+        {
+            // Take the most recently pushed task from our own queue (LIFO, cache friendly).
+            {
+                auto& queue = mQueues[home];
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                if (!queue.tasks.empty())
+                {
+                    auto pTask = std::move(queue.tasks.back());
+                    queue.tasks.pop_back();
+                    onDequeued();
+                    return pTask;
+                }
+            }
+
+            // Steal the oldest task from one of the other queues (FIFO).
+            for (size_t i = 1; i < mQueues.size(); i++)
+            {
+                auto& queue = mQueues[(home + i) % mQueues.size()];
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                if (!queue.tasks.empty())
+                {
+                    auto pTask = std::move(queue.tasks.front());
+                    queue.tasks.pop_front();
+                    onDequeued();
+                    return pTask;
+                }
+            }
+
+            return nullptr;
+        }
+
+        void onDequeued()
+        {
+            std::lock_guard<std::mutex> lock(mSleepMutex);
+            FALCOR_ASSERT(mQueuedCount > 0);
+            mQueuedCount--;
+        }
+
+        void run(const std::shared_ptr<TaskState>& pTask)
+        {
+            {
+                FALCOR_PROFILE_CPU("Task");
+                if (pTask->flowId != 0) Profiler::recordCpuFlowEnd(pTask->flowId, "Task");
+                // Exceptions must not leave the worker thread. They are stored and rethrown by Task::finish().
+                try
+                {
+                    pTask->func();
+                }
+                catch (...)
+                {
+                    pTask->pException = std::current_exception();
+                }
+            }
+            pTask->func = nullptr;
+
+            std::vector<std::shared_ptr<TaskState>> dependents;
+            {
+                std::lock_guard<std::mutex> lock(pTask->mutex);
+                pTask->done.store(true, std::memory_order_release);
+                dependents.swap(pTask->dependents);
+            }
+            pTask->condition.notify_all();
+
+            for (auto& pDependent : dependents)
+            {
+                if (pDependent->pendingDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1) schedule(std::move(pDependent));
+            }
+
+            if (mOutstandingCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                std::lock_guard<std::mutex> lock(mIdleMutex);
+                mIdleCondition.notify_all();
+            }
+        }
+
+        void workerLoop(size_t workerIndex)
+        {
+            sWorkerIndex = workerIndex;
+            sWorkerScheduler = this;
+            Profiler::setCpuThreadName("Worker " + std::to_string(workerIndex));
+
+            while (true)
+            {
+                if (auto pTask = popTask(workerIndex))
+                {
+                    run(pTask);
+                    continue;
+                }
+
+                std::unique_lock<std::mutex> lock(mSleepMutex);
+                mSleepCondition.wait(lock, [this]() { return mStop || mQueuedCount > 0; });
+                if (mStop && mQueuedCount == 0) break;
+            }
+
+            sWorkerIndex = kInvalidWorker;
+            sWorkerScheduler = nullptr;
+        }
+
+        std::vector<TaskQueue> mQueues;
+        std::vector<std::thread> mWorkers;
+        std::atomic<size_t> mNextQueue{0};
+
+        std::mutex mSleepMutex;
+        std::condition_variable mSleepCondition;
+        size_t mQueuedCount = 0;            ///< Number of tasks sitting in the queues. Protected by mSleepMutex.
+        bool mStop = false;                 ///< Protected by mSleepMutex.
+
+        std::atomic<size_t> mOutstandingCount{0}; ///< Number of dispatched tasks that have not finished yet.
+        std::mutex mIdleMutex;
+        std::condition_variable mIdleCondition;
+
+        static thread_local size_t sWorkerIndex;
+        static thread_local Scheduler* sWorkerScheduler;
+
+    public:
+        static std::mutex sInstanceMutex;
+        static std::unique_ptr<Scheduler> spInstance;
+    };
+
+    thread_local size_t Threading::Scheduler::sWorkerIndex = Threading::Scheduler::kInvalidWorker;
+    thread_local Threading::Scheduler* Threading::Scheduler::sWorkerScheduler = nullptr;
+
+    std::mutex Threading::Scheduler::sInstanceMutex;
+    std::unique_ptr<Threading::Scheduler> Threading::Scheduler::spInstance; // TODO: REMOVEGLOBAL
 
     void Threading::start(uint32_t threadCount)
     {
-        if (gData.initialized) return;
+        std::lock_guard<std::mutex> lock(Scheduler::sInstanceMutex);
+        if (Scheduler::spInstance) return;
 
-        gData.threads.resize(threadCount);
-        gData.initialized = true;
+        Scheduler::spInstance = std::make_unique<Scheduler>(threadCount);
     }
 
     void Threading::shutdown()
     {
-        for (auto& t : gData.threads)
-        {
-            if (t.joinable()) t.join();
-        }
+        std::lock_guard<std::mutex> lock(Scheduler::sInstanceMutex);
+        if (!Scheduler::spInstance) return;
 
-        gData.initialized = false;
+        Scheduler::spInstance->waitIdle();
+        Scheduler::spInstance.reset();
+    }
+
+    bool Threading::isStarted()
+    {
+        return Scheduler::spInstance != nullptr;
+    }
+
+    uint32_t Threading::getThreadCount()
+    {
+        return Scheduler::spInstance ? Scheduler::spInstance->getThreadCount() : 0;
     }
 
     Threading::Task Threading::dispatchTask(const std::function<void(void)>& func)
     {
-        FALCOR_ASSERT(gData.initialized);
+        return dispatchTask(func, {});
+    }
+
+    Threading::Task Threading::dispatchTask(const std::function<void(void)>& func, const std::vector<Task>& dependencies)
+    {
+        FALCOR_ASSERT(Scheduler::spInstance);
+        Scheduler& scheduler = *Scheduler::spInstance;
+
+        auto pState = std::make_shared<TaskState>();
+        pState->func = func;
+        scheduler.addOutstanding();
+
+        if (Profiler::isCpuTracing())
+        {
+            pState->flowId = Profiler::createCpuFlowId();
+            Profiler::recordCpuFlowStart(pState->flowId, "Task");
+        }
 
-        std::thread& t = gData.threads[gData.current];
-        if (t.joinable()) t.join();
-        t = std::thread(func);
-        gData.current = (gData.current + 1) % gData.threads.size();
+        // Hold an extra reference on the dependency counter while registering with the dependencies,
+        // so that the task is not scheduled before all of them have been visited.
+        pState->pendingDependencies.store(1, std::memory_order_relaxed);
+        for (const auto& dependency : dependencies)
+        {
+            if (!dependency.mpState) continue;
+            std::lock_guard<std::mutex> lock(dependency.mpState->mutex);
+            if (dependency.mpState->done.load(std::memory_order_acquire)) continue;
+            pState->pendingDependencies.fetch_add(1, std::memory_order_relaxed);
+            dependency.mpState->dependents.push_back(pState);
+        }
+        if (pState->pendingDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1) scheduler.schedule(pState);
 
-        return Task();
+        return Task(pState);
     }
 
-    void Threading::finish()
+    void Threading::parallelFor(size_t begin, size_t end, size_t grainSize, const std::function<void(size_t, size_t)>& func)
     {
-        for (auto& t : gData.threads)
+        if (begin >= end) return;
+
+        FALCOR_PROFILE_CPU("parallelFor");
+
+        size_t count = end - begin;
+        if (grainSize == 0)
+        {
+            // Aim for a few chunks per worker to balance uneven work.
+            size_t chunkCount = size_t(std::max(getThreadCount(), 1u)) * 4;
+            grainSize = std::max<size_t>(1, (count + chunkCount - 1) / chunkCount);
+        }
+
+        if (!Scheduler::spInstance || count <= grainSize)
+        {
+            func(begin, end);
+            return;
+        }
+
+        std::vector<Task> tasks;
+        tasks.reserve((count + grainSize - 1) / grainSize);
+        for (size_t chunkBegin = begin; chunkBegin < end; chunkBegin += grainSize)
         {
-            if (t.joinable()) t.join();
+            size_t chunkEnd = std::min(end, chunkBegin + grainSize);
+            tasks.push_back(dispatchTask([&func, chunkBegin, chunkEnd]() { func(chunkBegin, chunkEnd); }));
         }
+
+        // Wait for all chunks before rethrowing, as the tasks reference func.
+        std::exception_ptr pException;
+        for (auto& task : tasks)
+        {
+            try
+            {
+                task.finish();
+            }
+            catch (...)
+            {
+                if (!pException) pException = std::current_exception();
+            }
+        }
+
+        if (pException) std::rethrow_exception(pException);
     }
 
-    Threading::Task::Task()
+    void Threading::finish()
     {
+        if (Scheduler::spInstance) Scheduler::spInstance->waitIdle();
     }
 
-    bool Threading::Task::isRunning()
+    bool Threading::Task::isRunning() const
     {
-        FALCOR_UNIMPLEMENTED();
+        return mpState && !mpState->done.load(std::memory_order_acquire);
     }
 
     void Threading::Task::finish()
     {
-        FALCOR_UNIMPLEMENTED();
+        if (!mpState) return;
+
+        while (!mpState->done.load(std::memory_order_acquire))
+        {
+            // Help executing pending work. This avoids deadlocks when waiting from within a task.
+            if (Scheduler::spInstance && Scheduler::spInstance->tryRunOne()) continue;
+
+            std::unique_lock<std::mutex> lock(mpState->mutex);
+            mpState->condition.wait_for(lock, std::chrono::milliseconds(1), [this]() { return mpState->done.load(); });
+        }
+
+        if (mpState->pException) std::rethrow_exception(mpState->pException);
     }
 }
@@ -29,58 +29,110 @@
 #include "Core/Macros.h"
 #include <condition_variable>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <thread>
+#include <vector>
 #include <cstdint>
 
 namespace Falcor
 {
+    /** Global task scheduler.
+
+        Tasks are executed by a persistent pool of worker threads. Each worker owns a task deque;
+        a worker pops tasks from the back of its own deque and steals from the front of the other
+        workers' deques when it runs out of work. Tasks can depend on other tasks, in which case
+        they are not scheduled until all their dependencies have finished executing.
+    */
     class FALCOR_API Threading
     {
+    private:
+        struct TaskState;
+        class Scheduler;
+
     public:
         const static uint32_t kDefaultThreadCount = 16;
 
-        /** Handle to a dispatched task
-
-            TODO: Implementation
+        /** Handle to a dispatched task.
+            The handle is cheap to copy. Copies refer to the same task.
         */
-        class Task
+        class FALCOR_API Task
         {
         public:
-            /** Check if task is still executing
+            /** Create an empty task handle. An empty handle is never running.
+            */
+            Task() = default;
+
+            /** Check if the handle refers to a task.
+            */
+            bool isValid() const { return mpState != nullptr; }
+
+            /** Check if task is still executing (or waiting to be executed).
             */
-            bool isRunning();
+            bool isRunning() const;
 
-            /** Wait for task to finish executing
+            /** Wait for task to finish executing.
+                The calling thread helps executing pending tasks while waiting, so it is safe to call this from within a task.
+                If the task threw an exception, it is rethrown here (on every call).
             */
             void finish();
 
         private:
-            Task();
+            Task(std::shared_ptr<TaskState> pState) : mpState(std::move(pState)) {}
+            std::shared_ptr<TaskState> mpState;
             friend class Threading;
         };
 
         /** Initializes the global thread pool
-            \param[in] threadCount Number of threads in the pool
+            \param[in] threadCount Number of worker threads in the pool
         */
         static void start(uint32_t threadCount = kDefaultThreadCount);
 
-        /** Waits for all currently executing threads to finish
+        /** Waits for all currently dispatched tasks to finish
         */
         static void finish();
 
-        /** Waits for all currently executing threads to finish and shuts down the thread pool
+        /** Waits for all currently dispatched tasks to finish and shuts down the thread pool
         */
         static void shutdown();
 
+        /** Returns true if the thread pool is running.
+        */
+        static bool isStarted();
+
+        /** Returns the number of worker threads in the pool, or 0 if the pool is not running.
+        */
+        static uint32_t getThreadCount();
+
         /** Returns the maximum number of concurrent threads supported by the hardware
         */
         static uint32_t getLogicalThreadCount() { return std::thread::hardware_concurrency(); }
 
         /** Starts a task on an available thread.
+            An exception thrown by the task is caught on the worker thread and rethrown by Task::finish().
+            Tasks depending on a task that threw are still executed.
             \return Handle to the task
         */
         static Task dispatchTask(const std::function<void(void)>& func);
+
+        /** Starts a task on an available thread once all its dependencies have finished.
+            \param[in] func Function to execute.
+            \param[in] dependencies Tasks that need to finish before the task is started. Empty handles are ignored.
+            \return Handle to the task
+        */
+        static Task dispatchTask(const std::function<void(void)>& func, const std::vector<Task>& dependencies);
+
+        /** Executes a function over a range of indices in parallel.
+            The range is split into chunks of (at most) grainSize indices that are executed as separate tasks.
+            The calling thread takes part in the execution and the call returns once all chunks have finished.
+            If the thread pool is not running, the function is executed on the calling thread.
+            If any of the chunks throws, the first exception is rethrown on the calling thread after all chunks have finished.
+            \param[in] begin First index of the range.
+            \param[in] end One past the last index of the range.
+            \param[in] grainSize Maximum number of indices per task. Use 0 to pick a size based on the number of worker threads.
+            \param[in] func Function called as func(chunkBegin, chunkEnd) for each chunk.
+        */
+        static void parallelFor(size_t begin, size_t end, size_t grainSize, const std::function<void(size_t, size_t)>& func);
     };
 
     /** Simple thread barrier class.
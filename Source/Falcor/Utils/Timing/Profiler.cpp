@@ -30,7 +30,19 @@
 #include "Core/API/GpuTimer.h"
 #include "Utils/Logger.h"
 #include "Utils/Scripting/ScriptBindings.h"
+#include "Core/Platform/OS.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <atomic>
 #include <fstream>
+#include <mutex>
+#include <unordered_set>
+
+#if FALCOR_MSVC
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
 
 namespace Falcor
 {
@@ -44,6 +56,220 @@ namespace Falcor
         // Size of the event history. The event history is keeping track of event times to allow
         // for computing statistics (min, max, mean, stddev) over the recent history.
         const size_t kMaxHistorySize = 512;
+
+        /** Buffer of CPU trace records of a single thread.
+            Records are appended by the owning thread only. They are stored in a linked list of fixed size chunks
+            that are never reallocated, so that the trace can be read by another thread while the owner keeps appending.
+            The buffer is reset lazily by the owner when it records the first event of a new trace session.
+            On reset, all chunks but the first are freed, so that the memory of a long trace is not held forever.
+        */
+        class CpuTraceBuffer
+        {
+        public:
+            struct Record
+            {
+                Profiler::CpuTrace::EventType type;
+                bool isTimestamp;                   ///< True if the times are timestamps from getCpuTimestamp(), false if they are CpuTimer time points in nanoseconds.
+                const char* name;
+                int64_t startTime;
+                int64_t endTime;
+                uint64_t flowId;
+            };
+
+            CpuTraceBuffer(uint32_t index) : mIndex(index) {}
+
+            ~CpuTraceBuffer()
+            {
+                freeChunks(mpHead);
+            }
+
+            uint32_t getIndex() const { return mIndex; }
+
+            /** Append a record. Must only be called by the owning thread.
+                \param[in] session Trace session the record belongs to.
+                \param[in] record The record.
+            */
+            void append(uint32_t session, const Record& record)
+            {
+                if (mSession.load(std::memory_order_relaxed) != session)
+                {
+                    // The previous session has been read, keep the first chunk for reuse and free the others.
+                    if (mpHead)
+                    {
+                        freeChunks(mpHead->pNext);
+                        mpHead->pNext = nullptr;
+                    }
+                    mCount.store(0, std::memory_order_relaxed);
+                    mpWriteChunk = mpHead;
+                    mSession.store(session, std::memory_order_release);
+                }
+
+                size_t count = mCount.load(std::memory_order_relaxed);
+                size_t index = count % kChunkSize;
+                if (!mpWriteChunk)
+                {
+                    mpHead = mpWriteChunk = new Chunk();
+                }
+                else if (index == 0 && count > 0)
+                {
+                    if (!mpWriteChunk->pNext) mpWriteChunk->pNext = new Chunk();
+                    mpWriteChunk = mpWriteChunk->pNext;
+                }
+                mpWriteChunk->records[index] = record;
+
+                // Publish the record to readers.
+                mCount.store(count + 1, std::memory_order_release);
+            }
+
+            /** Get the number of records of a trace session. Can be called from any thread.
+            */
+            size_t getCount(uint32_t session) const
+            {
+                if (mSession.load(std::memory_order_acquire) != session) return 0;
+                return mCount.load(std::memory_order_acquire);
+            }
+
+            /** Read the records of a trace session. Can be called from any thread.
+                \param[in] session Trace session to read.
+                \param[in] func Function called for each record.
+            */
+            template<typename F>
+            void read(uint32_t session, F func) const
+            {
+                if (mSession.load(std::memory_order_acquire) != session) return;
+                size_t count = mCount.load(std::memory_order_acquire);
+                const Chunk* pChunk = mpHead;
+                for (size_t i = 0; i < count; i++)
+                {
+                    if (i > 0 && i % kChunkSize == 0) pChunk = pChunk->pNext;
+                    func(pChunk->records[i % kChunkSize]);
+                }
+            }
+
+            /** Free all records. Must only be called with the registry mutex held while no thread owns the buffer.
+            */
+            void release()
+            {
+                freeChunks(mpHead);
+                mpHead = mpWriteChunk = nullptr;
+                mCount.store(0, std::memory_order_relaxed);
+            }
+
+            bool owned = true;          ///< True if the buffer is owned by a running thread. Protected by the registry mutex.
+            std::string threadName;     ///< Name of the owning thread. Protected by the registry mutex.
+
+        private:
+            static constexpr size_t kChunkSize = 4096; // Power of two.
+
+            struct Chunk
+            {
+                Record records[kChunkSize];
+                Chunk* pNext = nullptr;
+            };
+
+            static void freeChunks(Chunk* pChunk)
+            {
+                while (pChunk)
+                {
+                    Chunk* pNext = pChunk->pNext;
+                    delete pChunk;
+                    pChunk = pNext;
+                }
+            }
+
+            const uint32_t mIndex;
+            std::atomic<uint32_t> mSession{0};  ///< Trace session of the records in the buffer.
+            std::atomic<size_t> mCount{0};      ///< Number of records published to readers.
+            Chunk* mpHead = nullptr;
+            Chunk* mpWriteChunk = nullptr;
+        };
+
+        /** Global state of the CPU trace.
+        */
+        struct CpuTraceRegistry
+        {
+            std::mutex mutex;
+            std::vector<std::unique_ptr<CpuTraceBuffer>> buffers;   ///< Buffers of all threads that recorded events. Buffers of exited threads are reused.
+            uint32_t lastSession = 0;                               ///< Last trace session ID.
+            CpuTimer::TimePoint startTime;                          ///< Start time of the active trace session.
+            uint64_t startTimestamp = 0;                            ///< Start timestamp of the active trace session, used for converting timestamps to time.
+
+            std::atomic<uint64_t> nextFlowId{1};
+
+            std::mutex namesMutex;
+            std::unordered_set<std::string> names;                  ///< Persistent copies of event names.
+        };
+
+        CpuTraceRegistry& getCpuTraceRegistry()
+        {
+            // Intentionally leaked, threads may record events during static destruction.
+            static CpuTraceRegistry* pRegistry = new CpuTraceRegistry();
+            return *pRegistry;
+        }
+
+        std::atomic<uint32_t> sCpuTraceSession{0}; ///< Active trace session ID, or zero if no trace is running.
+
+        thread_local CpuTraceBuffer* tpCpuTraceBuffer = nullptr; ///< Trace buffer of the calling thread (trivial type to keep the access cheap).
+
+        /** Releases the trace buffer of the calling thread for reuse when the thread exits.
+        */
+        struct CpuTraceBufferRelease
+        {
+            ~CpuTraceBufferRelease()
+            {
+                if (!tpCpuTraceBuffer) return;
+                std::lock_guard<std::mutex> lock(getCpuTraceRegistry().mutex);
+                tpCpuTraceBuffer->owned = false;
+                tpCpuTraceBuffer = nullptr;
+            }
+        };
+
+        thread_local CpuTraceBufferRelease tCpuTraceBufferRelease;
+
+        /** Get the trace buffer of the calling thread. The buffer is acquired on first use.
+        */
+        CpuTraceBuffer& getThreadCpuTraceBuffer()
+        {
+            if (tpCpuTraceBuffer) return *tpCpuTraceBuffer;
+
+            // Touch the release helper to register its destructor for this thread.
+            (void)tCpuTraceBufferRelease;
+
+            auto& registry = getCpuTraceRegistry();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+
+            // Reuse the buffer of an exited thread, unless it holds events of the active trace.
+            CpuTraceBuffer* pBuffer = nullptr;
+            uint32_t session = sCpuTraceSession.load(std::memory_order_relaxed);
+            for (auto& pCandidate : registry.buffers)
+            {
+                if (pCandidate->owned || (session != 0 && pCandidate->getCount(session) > 0)) continue;
+                pBuffer = pCandidate.get();
+                break;
+            }
+            if (!pBuffer)
+            {
+                registry.buffers.push_back(std::make_unique<CpuTraceBuffer>((uint32_t)registry.buffers.size()));
+                pBuffer = registry.buffers.back().get();
+            }
+
+            pBuffer->owned = true;
+            pBuffer->threadName = fmt::format("Thread {}", pBuffer->getIndex());
+            tpCpuTraceBuffer = pBuffer;
+            return *pBuffer;
+        }
+
+        void recordCpuTraceRecord(const CpuTraceBuffer::Record& record)
+        {
+            uint32_t session = sCpuTraceSession.load(std::memory_order_acquire);
+            if (session == 0) return;
+            getThreadCpuTraceBuffer().append(session, record);
+        }
+
+        int64_t toNanoseconds(CpuTimer::TimePoint time)
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+        }
     }
 
     // Profiler::Stats
@@ -136,7 +362,15 @@ namespace Falcor
         auto& frameData = mFrameData[frameIndex % 2];
 
         // Update CPU time.
-        frameData.cpuTotalTime += (float)CpuTimer::calcDuration(frameData.cpuStartTime, CpuTimer::getCurrentTimePoint());
+        auto cpuEndTime = CpuTimer::getCurrentTimePoint();
+        frameData.cpuTotalTime += (float)CpuTimer::calcDuration(frameData.cpuStartTime, cpuEndTime);
+
+        // Record the event in the CPU trace.
+        if (isCpuTracing())
+        {
+            if (!mTraceName) mTraceName = getCpuEventName(mName);
+            recordCpuEvent(mTraceName, frameData.cpuStartTime, cpuEndTime);
+        }
 
         // Update GPU time.
         FALCOR_ASSERT(frameData.pActiveTimer != nullptr);
@@ -277,6 +511,58 @@ namespace Falcor
         mFinalized = true;
     }
 
+    // Profiler::CpuTrace
+
+    std::string Profiler::CpuTrace::toJsonString() const
+    {
+        using json = nlohmann::json;
+
+        const uint32_t kProcessId = 1;
+
+        json events = json::array();
+        events.push_back({ {"name", "process_name"}, {"ph", "M"}, {"pid", kProcessId}, {"args", { {"name", getExecutableName()} }} });
+        for (const auto& thread : mThreads)
+        {
+            events.push_back({ {"name", "thread_name"}, {"ph", "M"}, {"pid", kProcessId}, {"tid", thread.index}, {"args", { {"name", thread.name} }} });
+            events.push_back({ {"name", "thread_sort_index"}, {"ph", "M"}, {"pid", kProcessId}, {"tid", thread.index}, {"args", { {"sort_index", thread.index} }} });
+        }
+
+        for (const auto& event : mEvents)
+        {
+            json e = { {"name", event.name}, {"pid", kProcessId}, {"tid", event.threadIndex}, {"ts", event.startTime} };
+            switch (event.type)
+            {
+            case EventType::Span:
+                e["cat"] = "cpu";
+                e["ph"] = "X";
+                e["dur"] = event.duration;
+                break;
+            case EventType::FlowStart:
+                e["cat"] = "flow";
+                e["ph"] = "s";
+                e["id"] = event.flowId;
+                break;
+            case EventType::FlowEnd:
+                e["cat"] = "flow";
+                e["ph"] = "f";
+                e["bp"] = "e";
+                e["id"] = event.flowId;
+                break;
+            }
+            events.push_back(std::move(e));
+        }
+
+        json trace = { {"traceEvents", std::move(events)}, {"displayTimeUnit", "ms"} };
+        return trace.dump();
+    }
+
+    void Profiler::CpuTrace::writeToFile(const std::filesystem::path& path) const
+    {
+        auto json = toJsonString();
+        std::ofstream ofs(path);
+        ofs.write(json.data(), json.size());
+    }
+
     // Profiler
 
     Profiler::Profiler(Device* pDevice)
@@ -407,6 +693,123 @@ namespace Falcor
         return result;
     }
 
+    void Profiler::startCpuTrace()
+    {
+        auto& registry = getCpuTraceRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+
+        // Session IDs are never zero, which denotes that no trace is running.
+        if (++registry.lastSession == 0) ++registry.lastSession;
+        registry.startTime = CpuTimer::getCurrentTimePoint();
+        registry.startTimestamp = getCpuTimestamp();
+        sCpuTraceSession.store(registry.lastSession, std::memory_order_release);
+    }
+
+    Profiler::CpuTrace::SharedPtr Profiler::endCpuTrace()
+    {
+        auto& registry = getCpuTraceRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+
+        uint32_t session = sCpuTraceSession.exchange(0, std::memory_order_acq_rel);
+        if (session == 0) return nullptr;
+
+        auto endTime = CpuTimer::getCurrentTimePoint();
+        uint64_t endTimestamp = getCpuTimestamp();
+
+        // Convert times to microseconds relative to the start of the trace.
+        // The timestamp frequency is calibrated against CpuTimer over the duration of the trace.
+        const int64_t startTime = toNanoseconds(registry.startTime);
+        const int64_t startTimestamp = (int64_t)registry.startTimestamp;
+        const double duration = CpuTimer::calcDuration(registry.startTime, endTime) * 1000.0;
+        const double timestampScale = endTimestamp > registry.startTimestamp ? duration / double(endTimestamp - registry.startTimestamp) : 0.0;
+        auto toMicroseconds = [&] (int64_t time, bool isTimestamp)
+        {
+            double t = isTimestamp ? (time - startTimestamp) * timestampScale : (time - startTime) * 1e-3;
+            return std::max(0.0, t);
+        };
+
+        auto pTrace = CpuTrace::SharedPtr(new CpuTrace());
+        pTrace->mDuration = duration;
+
+        for (const auto& pBuffer : registry.buffers)
+        {
+            size_t eventCount = pTrace->mEvents.size();
+            pBuffer->read(session, [&] (const CpuTraceBuffer::Record& record)
+            {
+                CpuTrace::Event event = { record.type, record.name, pBuffer->getIndex(), toMicroseconds(record.startTime, record.isTimestamp), 0.0, record.flowId };
+                // Spans that started before the trace are clipped to the start of the trace.
+                if (record.type == CpuTrace::EventType::Span) event.duration = std::max(0.0, toMicroseconds(record.endTime, record.isTimestamp) - event.startTime);
+                pTrace->mEvents.push_back(event);
+            });
+            if (pTrace->mEvents.size() > eventCount) pTrace->mThreads.push_back({ pBuffer->getIndex(), pBuffer->threadName });
+        }
+
+        std::stable_sort(pTrace->mEvents.begin(), pTrace->mEvents.end(), [] (const CpuTrace::Event& a, const CpuTrace::Event& b) { return a.startTime < b.startTime; });
+
+        // Free the records of exited threads. Running threads free theirs when they record the first event of the next trace.
+        for (const auto& pBuffer : registry.buffers)
+        {
+            if (!pBuffer->owned) pBuffer->release();
+        }
+
+        return pTrace;
+    }
+
+    bool Profiler::isCpuTracing()
+    {
+        return sCpuTraceSession.load(std::memory_order_relaxed) != 0;
+    }
+
+    uint64_t Profiler::getCpuTimestamp()
+    {
+#if FALCOR_MSVC || defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return (uint64_t)toNanoseconds(CpuTimer::getCurrentTimePoint());
+#endif
+    }
+
+    void Profiler::recordCpuEvent(const char* name, uint64_t startTimestamp, uint64_t endTimestamp)
+    {
+        recordCpuTraceRecord({ CpuTrace::EventType::Span, true, name, (int64_t)startTimestamp, (int64_t)endTimestamp, 0 });
+    }
+
+    void Profiler::recordCpuEvent(const char* name, CpuTimer::TimePoint startTime, CpuTimer::TimePoint endTime)
+    {
+        recordCpuTraceRecord({ CpuTrace::EventType::Span, false, name, toNanoseconds(startTime), toNanoseconds(endTime), 0 });
+    }
+
+    uint64_t Profiler::createCpuFlowId()
+    {
+        return getCpuTraceRegistry().nextFlowId.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void Profiler::recordCpuFlowStart(uint64_t flowId, const char* name)
+    {
+        int64_t timestamp = (int64_t)getCpuTimestamp();
+        recordCpuTraceRecord({ CpuTrace::EventType::FlowStart, true, name, timestamp, timestamp, flowId });
+    }
+
+    void Profiler::recordCpuFlowEnd(uint64_t flowId, const char* name)
+    {
+        int64_t timestamp = (int64_t)getCpuTimestamp();
+        recordCpuTraceRecord({ CpuTrace::EventType::FlowEnd, true, name, timestamp, timestamp, flowId });
+    }
+
+    const char* Profiler::getCpuEventName(std::string_view name)
+    {
+        auto& registry = getCpuTraceRegistry();
+        std::lock_guard<std::mutex> lock(registry.namesMutex);
+        return registry.names.emplace(name).first->c_str();
+    }
+
+    void Profiler::setCpuThreadName(const std::string& name)
+    {
+        auto& buffer = getThreadCpuTraceBuffer();
+        std::lock_guard<std::mutex> lock(getCpuTraceRegistry().mutex);
+        buffer.threadName = name;
+    }
+
     Profiler::Event* Profiler::createEvent(const std::string& name)
     {
         auto pEvent = std::shared_ptr<Event>(new Event(name));
@@ -453,5 +856,14 @@ namespace Falcor
         profiler.def_property_readonly("events", &Profiler::getPythonEvents);
         profiler.def("startCapture", &Profiler::startCapture, "reservedFrames"_a = 1000);
         profiler.def("endCapture", endCapture);
+
+        auto endCpuTrace = [] (const std::filesystem::path& path) {
+            auto pTrace = Profiler::endCpuTrace();
+            if (pTrace) pTrace->writeToFile(path);
+        };
+
+        profiler.def_static("startCpuTrace", &Profiler::startCpuTrace);
+        profiler.def_static("endCpuTrace", endCpuTrace, "path"_a);
+        profiler.def_property_readonly_static("isCpuTracing", [] (pybind11::object) { return Profiler::isCpuTracing(); });
     }
 }
@@ -27,12 +27,14 @@
  **************************************************************************/
 #pragma once
 #include "CpuTimer.h"
+#include "Core/FalcorConfig.h"
 #include "Core/Macros.h"
 #include "Core/API/GpuTimer.h"
 #include <pybind11/pytypes.h>
 #include <filesystem>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
@@ -45,6 +47,10 @@ namespace Falcor
         It automatically creates event hierarchies based on the order and nesting of the calls made.
         This class uses a double-buffering scheme for GPU profiling to avoid GPU stalls.
         ProfilerEvent is a wrapper class which together with scoping can simplify event profiling.
+
+        In addition, CPU events can be traced from any thread using the static CPU trace interface
+        (see startCpuTrace() and ScopedCpuProfilerEvent). Each thread records into its own event buffer,
+        and the captured trace can be exported in the Chrome Trace Event format.
     */
     class FALCOR_API Profiler
     {
@@ -105,6 +111,7 @@ namespace Falcor
             size_t mHistorySize = 0;                        ///< History size.
 
             uint32_t mTriggered = 0;                        ///< Keeping track of nested calls to start().
+            const char* mTraceName = nullptr;               ///< Event name for CPU traces (created on first use).
 
             struct FrameData
             {
@@ -158,6 +165,69 @@ namespace Falcor
             friend class Profiler;
         };
 
+        /** CPU events captured from all threads between startCpuTrace() and endCpuTrace().
+            The trace can be exported in the Chrome Trace Event format, which can be viewed
+            in chrome://tracing or the Perfetto UI (https://ui.perfetto.dev).
+        */
+        class FALCOR_API CpuTrace
+        {
+        public:
+            using SharedPtr = std::shared_ptr<CpuTrace>;
+
+            enum class EventType
+            {
+                Span,       ///< Time span on a single thread.
+                FlowStart,  ///< Start of a flow between threads (e.g. dispatch of a task).
+                FlowEnd,    ///< End of a flow between threads (e.g. start of execution of a task).
+            };
+
+            struct Event
+            {
+                EventType type;
+                const char* name;           ///< Event name. Points to a string literal or a name returned by getCpuEventName().
+                uint32_t threadIndex;       ///< Index of the thread that recorded the event.
+                double startTime;           ///< Start time in microseconds relative to the start of the trace.
+                double duration;            ///< Duration in microseconds (spans only).
+                uint64_t flowId;            ///< Flow ID (flow events only).
+            };
+
+            struct Thread
+            {
+                uint32_t index;
+                std::string name;
+            };
+
+            /** Get the threads that recorded events.
+            */
+            const std::vector<Thread>& getThreads() const { return mThreads; }
+
+            /** Get the recorded events, sorted by start time.
+            */
+            const std::vector<Event>& getEvents() const { return mEvents; }
+
+            /** Get the duration of the trace in microseconds.
+            */
+            double getDuration() const { return mDuration; }
+
+            /** Convert the trace to a JSON string in the Chrome Trace Event format.
+                Each thread is exported as a separate track. Flow events connect the spans they are recorded in.
+            */
+            std::string toJsonString() const;
+
+            /** Write the trace to a JSON file in the Chrome Trace Event format.
+            */
+            void writeToFile(const std::filesystem::path& path) const;
+
+        private:
+            CpuTrace() = default;
+
+            std::vector<Thread> mThreads;
+            std::vector<Event> mEvents;
+            double mDuration = 0.0;
+
+            friend class Profiler;
+        };
+
         /** Constructor.
         */
         Profiler(Device* pDevice);
@@ -231,6 +301,72 @@ namespace Falcor
         */
         pybind11::dict getPythonEvents() const;
 
+        /** Start tracing CPU events on all threads.
+            If a trace is already running, it is restarted and its events are discarded.
+        */
+        static void startCpuTrace();
+
+        /** End tracing CPU events.
+            Events recorded by other threads after this call are ignored.
+            \return Returns the captured trace, or nullptr if no trace was running.
+        */
+        static CpuTrace::SharedPtr endCpuTrace();
+
+        /** Check if CPU events are being traced.
+            This is cheap and safe to call from any thread.
+        */
+        static bool isCpuTracing();
+
+        /** Get a timestamp for recording CPU trace events.
+            Timestamps are read from the CPU time stamp counter where available, which is considerably cheaper
+            than reading CpuTimer. They are converted to time when the trace ends.
+            \return Returns the current timestamp.
+        */
+        static uint64_t getCpuTimestamp();
+
+        /** Record a CPU time span on the calling thread. Does nothing if no trace is running.
+            \param[in] name Event name. Must be a string literal or a name returned by getCpuEventName().
+            \param[in] startTimestamp Start of the span, returned by getCpuTimestamp().
+            \param[in] endTimestamp End of the span, returned by getCpuTimestamp().
+        */
+        static void recordCpuEvent(const char* name, uint64_t startTimestamp, uint64_t endTimestamp);
+
+        /** Record a CPU time span on the calling thread. Does nothing if no trace is running.
+            \param[in] name Event name. Must be a string literal or a name returned by getCpuEventName().
+            \param[in] startTime Start time of the span.
+            \param[in] endTime End time of the span.
+        */
+        static void recordCpuEvent(const char* name, CpuTimer::TimePoint startTime, CpuTimer::TimePoint endTime);
+
+        /** Create a new unique ID for connecting events on different threads with a flow.
+        */
+        static uint64_t createCpuFlowId();
+
+        /** Record the start of a flow on the calling thread. The flow starts at the innermost span that is open on the thread.
+            \param[in] flowId Flow ID created with createCpuFlowId().
+            \param[in] name Flow name. Must be a string literal or a name returned by getCpuEventName().
+        */
+        static void recordCpuFlowStart(uint64_t flowId, const char* name = "flow");
+
+        /** Record the end of a flow on the calling thread. The flow ends at the innermost span that is open on the thread.
+            \param[in] flowId Flow ID passed to recordCpuFlowStart().
+            \param[in] name Flow name. Must match the name passed to recordCpuFlowStart().
+        */
+        static void recordCpuFlowEnd(uint64_t flowId, const char* name = "flow");
+
+        /** Get a persistent copy of an event name for names that are not string literals.
+            The returned pointer stays valid for the lifetime of the application.
+            Note: This takes a lock, so it should not be called for every event in hot code.
+            \param[in] name The event name.
+            \return Returns a pointer to the null-terminated name.
+        */
+        static const char* getCpuEventName(std::string_view name);
+
+        /** Set the name of the calling thread, shown as the track name in exported traces.
+            \param[in] name The thread name.
+        */
+        static void setCpuThreadName(const std::string& name);
+
     private:
         /** Create a new event.
             \param[in] name The event name.
@@ -280,12 +416,52 @@ namespace Falcor
         const std::string mName;
         Profiler::Flags mFlags;
     };
+
+    /** Helper class for recording CPU trace spans using RAII. It can be used from any thread.
+        The constructor records the start time and the destructor records the span, if a CPU trace is running.
+        The FALCOR_PROFILE_CPU macro wraps creation of local ScopedCpuProfilerEvent objects when profiling is enabled.
+    */
+    class FALCOR_API ScopedCpuProfilerEvent
+    {
+    public:
+        /** Constructor.
+            \param[in] name Event name. Must be a string literal or a name returned by Profiler::getCpuEventName().
+        */
+        ScopedCpuProfilerEvent(const char* name)
+            : mpName(Profiler::isCpuTracing() ? name : nullptr)
+        {
+            if (mpName) mStartTimestamp = Profiler::getCpuTimestamp();
+        }
+
+        /** Constructor for dynamic event names. The name is only copied if a CPU trace is running.
+            \param[in] name Event name.
+        */
+        ScopedCpuProfilerEvent(const std::string& name)
+            : mpName(Profiler::isCpuTracing() ? Profiler::getCpuEventName(name) : nullptr)
+        {
+            if (mpName) mStartTimestamp = Profiler::getCpuTimestamp();
+        }
+
+        ~ScopedCpuProfilerEvent()
+        {
+            if (mpName) Profiler::recordCpuEvent(mpName, mStartTimestamp, Profiler::getCpuTimestamp());
+        }
+
+        ScopedCpuProfilerEvent(const ScopedCpuProfilerEvent&) = delete;
+        ScopedCpuProfilerEvent& operator=(const ScopedCpuProfilerEvent&) = delete;
+
+    private:
+        const char* mpName;
+        uint64_t mStartTimestamp = 0;
+    };
 }
 
 #if FALCOR_ENABLE_PROFILER
 #define FALCOR_PROFILE(_pRenderContext, _name) Falcor::ScopedProfilerEvent _profileEvent##__LINE__(_pRenderContext, _name)
 #define FALCOR_PROFILE_CUSTOM(_pRenderContext, _name, _flags) Falcor::ScopedProfilerEvent _profileEvent##__LINE__(_pRenderContext, _name, _flags)
+#define FALCOR_PROFILE_CPU(_name) Falcor::ScopedCpuProfilerEvent FALCOR_CONCAT_STRINGS(_profileCpuEvent, __LINE__)(_name)
 #else
 #define FALCOR_PROFILE(_pRenderContext, _name)
 #define FALCOR_PROFILE_CUSTOM(_pRenderContext, _name, _flags)
+#define FALCOR_PROFILE_CPU(_name)
 #endif
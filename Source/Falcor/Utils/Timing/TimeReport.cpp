@@ -26,6 +26,7 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "TimeReport.h"
+#include "Profiler.h"
 #include "Utils/Logger.h"
 #include "Utils/StringUtils.h"
 #include <numeric>
@@ -62,6 +63,7 @@ namespace Falcor
     {
         auto currentTime = CpuTimer::getCurrentTimePoint();
         std::chrono::duration<double> duration = currentTime - mLastMeasureTime;
+        if (Profiler::isCpuTracing()) Profiler::recordCpuEvent(Profiler::getCpuEventName(name), mLastMeasureTime, currentTime);
         mLastMeasureTime = currentTime;
         mMeasurements.push_back({name, duration.count()});
     }
@@ -56,6 +56,7 @@ namespace Falcor
 
         /** Records a time measurement.
             Measures time since last call to reset() or measure(), whichever happened more recently.
+            The measurement is also recorded as a span if a CPU trace is running (see Profiler::startCpuTrace()).
             \param[in] name Name of the record.
         */
         void measure(const std::string& name);
@@ -0,0 +1,184 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Core/Program/ProgramReflection.h"
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+static_assert(ShaderVarName("").getHash() == UINT64_C(14695981039346656037));
+static_assert(ShaderVarName("a").getHash() == UINT64_C(0xaf63dc4c8601ec8c));
+
+ReflectionVar::SharedPtr createVar(const std::string& name, const ReflectionType::SharedConstPtr& pType, size_t byteOffset)
+{
+    return ReflectionVar::create(name, pType, ShaderVarOffset(UniformShaderVarOffset(byteOffset), ResourceShaderVarOffset::kZero));
+}
+
+/** Create a synthetic struct type with the given number of float members.
+    The members are added in random order.
+*/
+ReflectionStructType::SharedPtr createFlatStruct(uint32_t memberCount, std::mt19937& rng)
+{
+    auto pFloat = ReflectionBasicType::create(ReflectionBasicType::Type::Float, false, 4, nullptr);
+    auto pStruct = ReflectionStructType::create(memberCount * 4, "Flat", nullptr);
+
+    std::vector<uint32_t> order(memberCount);
+    for (uint32_t i = 0; i < memberCount; i++)
+        order[i] = i;
+    std::shuffle(order.begin(), order.end(), rng);
+
+    ReflectionStructType::BuildState buildState;
+    for (uint32_t i : order)
+        pStruct->addMember(createVar("member" + std::to_string(i), pFloat, i * 4), buildState);
+    return pStruct;
+}
+
+/** Create a synthetic tree of nested struct types.
+    Each level has `fanout` struct members named "child<i>" and a float member "value" at the end.
+*/
+ReflectionType::SharedPtr createTree(uint32_t depth, uint32_t fanout)
+{
+    auto pFloat = ReflectionBasicType::create(ReflectionBasicType::Type::Float, false, 4, nullptr);
+    if (depth == 0)
+        return pFloat;
+
+    auto pChild = createTree(depth - 1, fanout);
+    size_t childSize = pChild->getByteSize();
+    auto pStruct = ReflectionStructType::create(fanout * childSize + 4, "Level" + std::to_string(depth), nullptr);
+
+    ReflectionStructType::BuildState buildState;
+    for (uint32_t i = 0; i < fanout; i++)
+        pStruct->addMember(createVar("child" + std::to_string(i), pChild, i * childSize), buildState);
+    pStruct->addMember(createVar("value", pFloat, fanout * childSize), buildState);
+    return pStruct;
+}
+} // namespace
+
+CPU_TEST(ReflectionStructType_MemberLookup)
+{
+    std::mt19937 rng;
+    const uint32_t kMemberCount = 200;
+    auto pStruct = createFlatStruct(kMemberCount, rng);
+    EXPECT_EQ(pStruct->getMemberCount(), kMemberCount);
+
+    for (uint32_t i = 0; i < kMemberCount; i++)
+    {
+        std::string name = "member" + std::to_string(i);
+        int32_t index = pStruct->getMemberIndex(name);
+        EXPECT_NE(index, ReflectionStructType::kInvalidMemberIndex) << name;
+        if (index == ReflectionStructType::kInvalidMemberIndex)
+            continue;
+
+        EXPECT_EQ(pStruct->getMember(index)->getName(), name);
+        EXPECT_EQ(pStruct->getMemberIndex(name.c_str()), index);
+        EXPECT_EQ(pStruct->getMemberIndex(std::string_view(name)), index);
+        EXPECT(pStruct->getMember(name) == pStruct->getMember(index));
+    }
+
+    static constexpr ShaderVarName kMember("member17");
+    EXPECT_EQ(pStruct->getMember(kMember)->getName(), "member17");
+    EXPECT_EQ(pStruct->getMemberIndex("member"), ReflectionStructType::kInvalidMemberIndex);
+    EXPECT_EQ(pStruct->getMemberIndex("member200"), ReflectionStructType::kInvalidMemberIndex);
+    EXPECT(pStruct->getMember("missing") == nullptr);
+
+    // Adding a member with an existing name is ignored.
+    ReflectionStructType::BuildState buildState;
+    EXPECT_EQ(pStruct->addMember(pStruct->getMember(kMember), buildState), -1);
+    EXPECT_EQ(pStruct->getMemberCount(), kMemberCount);
+}
+
+CPU_TEST(ReflectionStructType_MemberLookupByOffset)
+{
+    std::mt19937 rng;
+    const uint32_t kMemberCount = 200;
+    auto pStruct = createFlatStruct(kMemberCount, rng);
+
+    for (size_t offset = 0; offset < kMemberCount * 4; offset++)
+    {
+        // Reference: linear search in declaration order.
+        int32_t refIndex = ReflectionStructType::kInvalidMemberIndex;
+        for (uint32_t i = 0; i < pStruct->getMemberCount(); i++)
+        {
+            const auto& pMember = pStruct->getMember(i);
+            if (offset >= pMember->getByteOffset() && offset < pMember->getByteOffset() + pMember->getType()->getByteSize())
+            {
+                refIndex = i;
+                break;
+            }
+        }
+        EXPECT_NE(refIndex, ReflectionStructType::kInvalidMemberIndex);
+        EXPECT_EQ(pStruct->getMemberIndexByOffset(offset), refIndex) << "offset = " << offset;
+
+        TypedShaderVarOffset memberOffset = pStruct->findMemberByOffset(offset);
+        EXPECT(memberOffset.isValid());
+        EXPECT_EQ(memberOffset.getByteOffset(), offset & ~size_t(3));
+    }
+
+    EXPECT_EQ(pStruct->getMemberIndexByOffset(kMemberCount * 4), ReflectionStructType::kInvalidMemberIndex);
+    EXPECT(!pStruct->findMemberByOffset(kMemberCount * 4).isValid());
+}
+
+CPU_TEST(ReflectionStructType_CachedPaths)
+{
+    // Look up every leaf of a synthetic tree with 4^4 leaves, both by chained lookups and through cached offsets.
+    const uint32_t kDepth = 4;
+    const uint32_t kFanout = 4;
+    auto pRoot = createTree(kDepth, kFanout);
+
+    const std::string childNames[kFanout] = {"child0", "child1", "child2", "child3"};
+    const size_t rootChildSize = (pRoot->getByteSize() - 4) / kFanout;
+    std::vector<TypedShaderVarOffset> cachedOffsets;
+
+    for (uint32_t leaf = 0; leaf < 256; leaf++)
+    {
+        TypedShaderVarOffset offset = pRoot->getZeroOffset();
+        size_t refByteOffset = 0;
+        const ReflectionType* pType = pRoot.get();
+        for (uint32_t level = 0, path = leaf; level < kDepth; level++, path /= kFanout)
+        {
+            uint32_t child = path % kFanout;
+            size_t childSize = (pType->getByteSize() - 4) / kFanout;
+            offset = offset[childNames[child]];
+            refByteOffset += child * childSize;
+            pType = offset.getType().get();
+        }
+        EXPECT(offset.isValid());
+        EXPECT_EQ(offset.getByteOffset(), refByteOffset);
+        EXPECT_EQ(pRoot->findMemberByOffset(refByteOffset).getByteOffset(), (leaf % kFanout) * rootChildSize);
+        cachedOffsets.push_back(offset);
+    }
+
+    // Re-resolving the paths gives the same offsets.
+    static constexpr ShaderVarName kChild1("child1");
+    TypedShaderVarOffset offset = pRoot->getZeroOffset()[kChild1][kChild1][kChild1][kChild1];
+    EXPECT(offset == cachedOffsets[1 + 4 + 16 + 64]);
+    EXPECT(pRoot->getZeroOffset()["value"].getType()->asBasicType() != nullptr);
+}
+} // namespace Falcor
@@ -0,0 +1,174 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "RenderGraph/ResourceCache.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+    using Request = ResourceCache::AliasingRequest;
+
+    Request makeRequest(uint32_t compatibilityClass, uint32_t first, uint32_t last, uint64_t size, bool canAlias = true)
+    {
+        Request request;
+        request.compatibilityClass = compatibilityClass;
+        request.lifetime = { first, last };
+        request.size = size;
+        request.canAlias = canAlias;
+        return request;
+    }
+
+    bool overlaps(const Request& a, const Request& b)
+    {
+        return a.lifetime.first <= b.lifetime.second && b.lifetime.first <= a.lifetime.second;
+    }
+}
+
+    CPU_TEST(ResourceAliasing_Chain)
+    {
+        // A chain of passes where each output is consumed by the next pass.
+        std::vector<Request> requests =
+        {
+            makeRequest(0, 0, 1, 100),
+            makeRequest(0, 1, 2, 100),
+            makeRequest(0, 2, 3, 100),
+            makeRequest(0, 3, 4, 100),
+        };
+
+        auto assignment = ResourceCache::planResourceAliasing(requests);
+        EXPECT_EQ(assignment[0], 0u);
+        EXPECT_EQ(assignment[1], 1u);
+        EXPECT_EQ(assignment[2], 0u);
+        EXPECT_EQ(assignment[3], 1u);
+
+        auto stats = ResourceCache::computeMemoryStats(requests, assignment);
+        EXPECT_EQ(stats.fieldCount, 4u);
+        EXPECT_EQ(stats.resourceCount, 2u);
+        EXPECT_EQ(stats.naiveBytes, 400u);
+        EXPECT_EQ(stats.allocatedBytes, 200u);
+        EXPECT_EQ(stats.peakLiveBytes, 200u);
+    }
+
+    CPU_TEST(ResourceAliasing_Restrictions)
+    {
+        std::vector<Request> requests =
+        {
+            makeRequest(0, 0, 0, 10),
+            makeRequest(1, 1, 1, 20),                   // Different compatibility class.
+            makeRequest(0, 2, 2, 10, false),            // Needs a dedicated resource.
+            makeRequest(0, 3, 3, 10),                   // Can reuse the first resource, but not the dedicated one.
+            makeRequest(0, 4, uint32_t(-1), 10, false), // Graph output.
+        };
+
+        auto assignment = ResourceCache::planResourceAliasing(requests);
+        EXPECT_EQ(assignment[0], 0u);
+        EXPECT_EQ(assignment[1], 1u);
+        EXPECT_EQ(assignment[2], 2u);
+        EXPECT_EQ(assignment[3], 0u);
+        EXPECT_EQ(assignment[4], 3u);
+
+        auto stats = ResourceCache::computeMemoryStats(requests, assignment);
+        EXPECT_EQ(stats.resourceCount, 4u);
+        EXPECT_EQ(stats.naiveBytes, 60u);
+        EXPECT_EQ(stats.allocatedBytes, 50u);
+        EXPECT_EQ(stats.peakLiveBytes, 20u);
+    }
+
+    CPU_TEST(ResourceAliasing_Random)
+    {
+        std::mt19937 rng(1);
+
+        for (uint32_t iteration = 0; iteration < 100; iteration++)
+        {
+            const uint32_t requestCount = 1 + rng() % 64;
+            const uint32_t classCount = 1 + rng() % 4;
+            const uint32_t timeCount = 1 + rng() % 32;
+
+            std::vector<Request> requests;
+            for (uint32_t i = 0; i < requestCount; i++)
+            {
+                uint32_t first = rng() % timeCount;
+                uint32_t last = first + rng() % (timeCount - first);
+                requests.push_back(makeRequest(rng() % classCount, first, last, 1 + rng() % 1000, rng() % 8 != 0));
+            }
+
+            auto assignment = ResourceCache::planResourceAliasing(requests);
+            EXPECT_EQ(assignment.size(), requests.size());
+
+            // Resource indices are dense.
+            const uint32_t resourceCount = *std::max_element(assignment.begin(), assignment.end()) + 1;
+            std::vector<uint32_t> requestsPerResource(resourceCount, 0);
+            for (uint32_t index : assignment) requestsPerResource[index]++;
+            for (uint32_t count : requestsPerResource) EXPECT_GT(count, 0u);
+
+            // Requests sharing a resource are compatible and used at disjoint times.
+            for (uint32_t i = 0; i < requestCount; i++)
+            {
+                for (uint32_t j = i + 1; j < requestCount; j++)
+                {
+                    if (assignment[i] != assignment[j]) continue;
+                    EXPECT(requests[i].canAlias && requests[j].canAlias) << "i = " << i << ", j = " << j;
+                    EXPECT_EQ(requests[i].compatibilityClass, requests[j].compatibilityClass) << "i = " << i << ", j = " << j;
+                    EXPECT(!overlaps(requests[i], requests[j])) << "i = " << i << ", j = " << j;
+                }
+            }
+
+            // The number of shared resources per compatibility class is the maximum number of aliasable requests in use at the same time.
+            uint32_t expectedResourceCount = 0;
+            for (uint32_t c = 0; c < classCount; c++)
+            {
+                uint32_t maxOverlap = 0;
+                for (uint32_t t = 0; t < timeCount; t++)
+                {
+                    uint32_t overlap = 0;
+                    for (const auto& request : requests)
+                    {
+                        if (request.canAlias && request.compatibilityClass == c && request.lifetime.first <= t && t <= request.lifetime.second) overlap++;
+                    }
+                    maxOverlap = std::max(maxOverlap, overlap);
+                }
+                expectedResourceCount += maxOverlap;
+            }
+            for (const auto& request : requests)
+            {
+                if (!request.canAlias) expectedResourceCount++;
+            }
+            EXPECT_EQ(resourceCount, expectedResourceCount);
+
+            auto stats = ResourceCache::computeMemoryStats(requests, assignment);
+            EXPECT_EQ(stats.resourceCount, resourceCount);
+            EXPECT_LE(stats.peakLiveBytes, stats.allocatedBytes);
+            EXPECT_LE(stats.allocatedBytes, stats.naiveBytes);
+        }
+    }
+}
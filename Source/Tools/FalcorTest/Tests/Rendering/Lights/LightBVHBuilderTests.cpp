@@ -0,0 +1,169 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Rendering/Lights/LightBVHBuilder.h"
+#include "Utils/Logger.h"
+#include "Utils/Threading.h"
+#include "Utils/Timing/CpuTimer.h"
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+/** Creates a random emissive triangle set. Triangles are grouped in clusters of varying size and orientation,
+    and a fraction of them has zero flux so that the culling path is exercised.
+*/
+std::vector<LightCollection::MeshLightTriangle> createRandomTriangles(uint32_t triangleCount, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> u(0.f, 1.f);
+
+    std::vector<LightCollection::MeshLightTriangle> triangles(triangleCount);
+    float3 clusterCenter(0.f);
+    float clusterSize = 1.f;
+    for (uint32_t i = 0; i < triangleCount; i++)
+    {
+        if (i % 1000 == 0)
+        {
+            clusterCenter = float3(u(rng), u(rng), u(rng)) * 100.f;
+            clusterSize = 0.01f + u(rng) * 10.f;
+        }
+
+        auto& tri = triangles[i];
+        const float3 p = clusterCenter + float3(u(rng), u(rng), u(rng)) * clusterSize;
+        for (auto& v : tri.vtx)
+            v.pos = p + (float3(u(rng), u(rng), u(rng)) - 0.5f) * 0.1f * clusterSize;
+
+        const float3 n = glm::cross(tri.vtx[1].pos - tri.vtx[0].pos, tri.vtx[2].pos - tri.vtx[0].pos);
+        const float len = glm::length(n);
+        tri.normal = len > 0.f ? n / len : float3(0.f, 0.f, 1.f);
+        tri.area = 0.5f * len;
+        tri.averageRadiance = float3(u(rng));
+        tri.flux = u(rng) < 0.05f ? 0.f : tri.averageRadiance.x * tri.area;
+        tri.lightIdx = i / 1000;
+    }
+    return triangles;
+}
+
+struct BuildResult
+{
+    std::vector<PackedNode> nodes;
+    std::vector<uint32_t> triangleIndices;
+    std::vector<uint64_t> triangleBitmasks;
+    double buildTime = 0.0; ///< Time spent in LightBVHBuilder::buildNodes() in ms.
+};
+
+/** Builds the BVH using a thread pool of the given size. A thread count of zero builds without a thread pool.
+*/
+BuildResult buildWithThreads(const LightBVHBuilder::Options& options, const std::vector<LightCollection::MeshLightTriangle>& triangles, uint32_t threadCount)
+{
+    Threading::shutdown();
+    if (threadCount > 0) Threading::start(threadCount);
+
+    BuildResult result;
+    LightBVHBuilder builder(options);
+    auto startTime = CpuTimer::getCurrentTimePoint();
+    builder.buildNodes(triangles, result.nodes, result.triangleIndices, result.triangleBitmasks);
+    result.buildTime = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+    return result;
+}
+}
+
+CPU_TEST(LightBVHBuilder_ThreadCountInvariance)
+{
+    // Large enough to trigger both the parallel subtree build and the parallel binning.
+    const auto triangles = createRandomTriangles(100000, 1);
+
+    const LightBVHBuilder::SplitHeuristic heuristics[] = {
+        LightBVHBuilder::SplitHeuristic::Equal,
+        LightBVHBuilder::SplitHeuristic::BinnedSAH,
+        LightBVHBuilder::SplitHeuristic::BinnedSAOH,
+    };
+    const uint32_t threadCounts[] = { 1, 4, 16 };
+
+    for (auto heuristic : heuristics)
+    {
+        LightBVHBuilder::Options options;
+        options.splitHeuristicSelection = heuristic;
+
+        const BuildResult ref = buildWithThreads(options, triangles, 0);
+        ASSERT(!ref.nodes.empty());
+        EXPECT_EQ(ref.triangleBitmasks.size(), triangles.size());
+
+        for (uint32_t threadCount : threadCounts)
+        {
+            const BuildResult result = buildWithThreads(options, triangles, threadCount);
+
+            ASSERT_EQ(result.nodes.size(), ref.nodes.size()) << "heuristic = " << (uint32_t)heuristic << ", threadCount = " << threadCount;
+            size_t matchingNodes = 0;
+            while (matchingNodes < ref.nodes.size() && std::memcmp(&result.nodes[matchingNodes], &ref.nodes[matchingNodes], sizeof(PackedNode)) == 0)
+                matchingNodes++;
+            EXPECT_EQ(matchingNodes, ref.nodes.size()) << "heuristic = " << (uint32_t)heuristic << ", threadCount = " << threadCount;
+            EXPECT(result.triangleIndices == ref.triangleIndices) << "heuristic = " << (uint32_t)heuristic << ", threadCount = " << threadCount;
+            EXPECT(result.triangleBitmasks == ref.triangleBitmasks) << "heuristic = " << (uint32_t)heuristic << ", threadCount = " << threadCount;
+        }
+    }
+
+    // Restore the default thread pool.
+    Threading::shutdown();
+    Threading::start();
+}
+
+CPU_TEST(LightBVHBuilder_Performance)
+{
+    const auto triangles = createRandomTriangles(1000000, 2);
+    const uint32_t threadCount = Threading::getLogicalThreadCount();
+
+    const LightBVHBuilder::SplitHeuristic heuristics[] = {
+        LightBVHBuilder::SplitHeuristic::Equal,
+        LightBVHBuilder::SplitHeuristic::BinnedSAH,
+        LightBVHBuilder::SplitHeuristic::BinnedSAOH,
+    };
+
+    for (auto heuristic : heuristics)
+    {
+        LightBVHBuilder::Options options;
+        options.splitHeuristicSelection = heuristic;
+
+        const BuildResult serial = buildWithThreads(options, triangles, 1);
+        const BuildResult parallel = buildWithThreads(options, triangles, threadCount);
+        EXPECT_EQ(parallel.nodes.size(), serial.nodes.size()) << "heuristic = " << (uint32_t)heuristic;
+
+        logInfo("Light BVH build of {} triangles (heuristic {}): {:.1f} ms with 1 thread, {:.1f} ms with {} threads ({:.2f}x).",
+            triangles.size(), (uint32_t)heuristic, serial.buildTime, parallel.buildTime, threadCount, serial.buildTime / parallel.buildTime);
+    }
+
+    // Restore the default thread pool.
+    Threading::shutdown();
+    Threading::start();
+}
+} // namespace Falcor
@@ -0,0 +1,300 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Rendering/Lights/LightBVHBuilder.h"
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+    struct TestBVH
+    {
+        std::vector<PackedNode> nodes;
+        std::vector<uint32_t> triangleIndices;
+        uint32_t triangleCount = 0;
+    };
+
+    SharedNodeAttributes makeRandomAttributes(std::mt19937& rng)
+    {
+        std::uniform_real_distribution<float> u(0.f, 1.f);
+        SharedNodeAttributes attribs;
+        attribs.setAABB(float3(-u(rng), -u(rng), -u(rng)), float3(u(rng), u(rng), u(rng)));
+        attribs.flux = u(rng);
+        attribs.cosConeAngle = u(rng);
+        attribs.coneDirection = glm::normalize(float3(u(rng) + 0.1f, u(rng), u(rng)));
+        return attribs;
+    }
+
+    /** Recursively builds a random binary BVH in depth-first order over a range of triangle indices.
+    */
+    void buildRandomNode(std::mt19937& rng, uint32_t begin, uint32_t end, TestBVH& bvh)
+    {
+        const uint32_t nodeIndex = (uint32_t)bvh.nodes.size();
+        bvh.nodes.emplace_back();
+
+        const uint32_t count = end - begin;
+        const uint32_t maxLeafCount = 1 + rng() % 4;
+        if (count <= maxLeafCount)
+        {
+            LeafNode leaf;
+            leaf.attribs = makeRandomAttributes(rng);
+            leaf.triangleCount = count;
+            leaf.triangleOffset = begin;
+            bvh.nodes[nodeIndex].setLeafNode(leaf);
+            return;
+        }
+
+        // Use unbalanced splits to get subtrees of different sizes and depths.
+        const uint32_t split = begin + 1 + rng() % (count - 1);
+        buildRandomNode(rng, begin, split, bvh);
+
+        InternalNode node;
+        node.attribs = makeRandomAttributes(rng);
+        node.rightChildIdx = (uint32_t)bvh.nodes.size();
+        bvh.nodes[nodeIndex].setInternalNode(node);
+        buildRandomNode(rng, split, end, bvh);
+    }
+
+    /** Builds a random binary BVH. Every other triangle is left out of the BVH, similar to culled triangles.
+    */
+    TestBVH buildRandomBVH(uint32_t triangleCount, uint32_t seed)
+    {
+        std::mt19937 rng(seed);
+        TestBVH bvh;
+        bvh.triangleCount = triangleCount;
+        for (uint32_t i = 0; i < triangleCount; i += 2) bvh.triangleIndices.push_back(i);
+        std::shuffle(bvh.triangleIndices.begin(), bvh.triangleIndices.end(), rng);
+        buildRandomNode(rng, 0, (uint32_t)bvh.triangleIndices.size(), bvh);
+        return bvh;
+    }
+
+    /** Recursively builds a complete binary subtree with large bounds.
+    */
+    void buildCompleteNode(uint32_t depth, TestBVH& bvh)
+    {
+        const uint32_t nodeIndex = (uint32_t)bvh.nodes.size();
+        bvh.nodes.emplace_back();
+
+        SharedNodeAttributes attribs;
+        attribs.setAABB(float3(-100.f), float3(100.f));
+        attribs.flux = 1.f;
+        attribs.coneDirection = float3(0.f, 0.f, 1.f);
+
+        if (depth == 0)
+        {
+            LeafNode leaf;
+            leaf.attribs = attribs;
+            leaf.triangleCount = 1;
+            leaf.triangleOffset = (uint32_t)bvh.triangleIndices.size();
+            bvh.triangleIndices.push_back(bvh.triangleCount++);
+            bvh.nodes[nodeIndex].setLeafNode(leaf);
+            return;
+        }
+
+        InternalNode node;
+        node.attribs = attribs;
+        buildCompleteNode(depth - 1, bvh);
+        node.rightChildIdx = (uint32_t)bvh.nodes.size();
+        bvh.nodes[nodeIndex].setInternalNode(node);
+        buildCompleteNode(depth - 1, bvh);
+    }
+
+    /** Builds a degenerate binary BVH along a spine of small internal nodes. The left child of each spine node is a large
+        complete subtree, which fills the wide nodes when collapsing, so that each spine node ends up in its own wide node.
+        Similar to a dense cluster of lights next to a long chain of small, distant lights.
+    */
+    TestBVH buildDegenerateBVH(uint32_t spineLength)
+    {
+        TestBVH bvh;
+        for (uint32_t i = 0; i < spineLength; i++)
+        {
+            const uint32_t nodeIndex = (uint32_t)bvh.nodes.size();
+            bvh.nodes.emplace_back();
+
+            InternalNode node;
+            node.attribs.setAABB(float3(0.f), float3(1e-3f));
+            node.attribs.flux = 1.f;
+            node.attribs.coneDirection = float3(0.f, 0.f, 1.f);
+            buildCompleteNode(3, bvh);
+            node.rightChildIdx = (uint32_t)bvh.nodes.size();
+            bvh.nodes[nodeIndex].setInternalNode(node);
+        }
+        buildCompleteNode(0, bvh);
+        return bvh;
+    }
+
+    const uint64_t kInvalidBitmask = std::numeric_limits<uint64_t>::max();
+}
+
+    CPU_TEST(LightBVHCollapse)
+    {
+        for (uint32_t width : { 4u, 8u })
+        {
+            for (uint32_t triangleCount : { 17u, 1000u, 20000u })
+            {
+                TestBVH bvh = buildRandomBVH(triangleCount, triangleCount + width);
+
+                LightBVH::WideNodes wideNodes;
+                std::vector<uint64_t> bitmasks(triangleCount, kInvalidBitmask);
+                LightBVHBuilder::collapse(bvh.nodes, bvh.triangleIndices, width, wideNodes, bitmasks);
+                EXPECT(LightBVHBuilder::validateCollapse(bvh.nodes, bvh.triangleIndices, wideNodes, bitmasks)) << "width = " << width << ", triangleCount = " << triangleCount;
+
+                EXPECT_EQ(wideNodes.width, width);
+                EXPECT_EQ(wideNodes.childNodeIndices.size(), (size_t)wideNodes.getNodeCount() * width);
+
+                // Triangles that are not in the BVH are left untouched.
+                for (uint32_t i = 1; i < triangleCount; i += 2) EXPECT_EQ(bitmasks[i], kInvalidBitmask) << "i = " << i;
+
+                // Wide nodes have at least two children and are only partially filled if all their children are leaves.
+                for (uint32_t nodeIndex = 0; nodeIndex < wideNodes.getNodeCount(); nodeIndex++)
+                {
+                    uint32_t childCount = 0;
+                    bool allLeaves = true;
+                    for (uint32_t slot = 0; slot < width; slot++)
+                    {
+                        const uint32_t childRef = wideNodes.data[WideNodeLayout::getDwordOffset(width, nodeIndex, 0, slot)];
+                        if (childRef == WideNodeLayout::kInvalidChild) continue;
+                        childCount++;
+                        allLeaves &= (childRef & WideNodeLayout::kLeafChildFlag) != 0;
+                    }
+                    EXPECT_GE(childCount, 2u) << "nodeIndex = " << nodeIndex;
+                    if (childCount < width) EXPECT(allLeaves) << "nodeIndex = " << nodeIndex;
+                }
+            }
+        }
+    }
+
+    CPU_TEST(LightBVHCollapse_SingleLeaf)
+    {
+        TestBVH bvh = buildRandomBVH(2, 0);
+        EXPECT_EQ(bvh.nodes.size(), 1u);
+
+        LightBVH::WideNodes wideNodes;
+        std::vector<uint64_t> bitmasks(bvh.triangleCount, kInvalidBitmask);
+        LightBVHBuilder::collapse(bvh.nodes, bvh.triangleIndices, 4, wideNodes, bitmasks);
+        EXPECT(LightBVHBuilder::validateCollapse(bvh.nodes, bvh.triangleIndices, wideNodes, bitmasks));
+
+        EXPECT_EQ(wideNodes.getNodeCount(), 1u);
+        EXPECT(wideNodes.data[0] == WideNodeLayout::kLeafChildFlag);
+        EXPECT_EQ(wideNodes.childNodeIndices[0], 0u);
+        EXPECT_EQ(bitmasks[0], 0ull);
+    }
+
+    CPU_TEST(LightBVHCollapse_TooDeep)
+    {
+        for (uint32_t width : { 4u, 8u })
+        {
+            // A short spine collapses into one wide node per spine node.
+            {
+                TestBVH bvh = buildDegenerateBVH(20);
+
+                LightBVH::WideNodes wideNodes;
+                std::vector<uint64_t> bitmasks(bvh.triangleCount, kInvalidBitmask);
+                EXPECT(LightBVHBuilder::collapse(bvh.nodes, bvh.triangleIndices, width, wideNodes, bitmasks)) << "width = " << width;
+                EXPECT(LightBVHBuilder::validateCollapse(bvh.nodes, bvh.triangleIndices, wideNodes, bitmasks)) << "width = " << width;
+                EXPECT_GE(wideNodes.getNodeCount(), 20u) << "width = " << width;
+            }
+
+            // A spine that is too deep for the wide traversal paths is not collapsed, and the outputs are left unchanged.
+            {
+                TestBVH bvh = buildDegenerateBVH(50);
+
+                LightBVH::WideNodes wideNodes;
+                std::vector<uint64_t> bitmasks(bvh.triangleCount, kInvalidBitmask);
+                EXPECT(!LightBVHBuilder::collapse(bvh.nodes, bvh.triangleIndices, width, wideNodes, bitmasks)) << "width = " << width;
+                EXPECT_EQ(wideNodes.width, 2u);
+                EXPECT_EQ(wideNodes.getNodeCount(), 0u);
+                EXPECT(std::all_of(bitmasks.begin(), bitmasks.end(), [](uint64_t mask) { return mask == kInvalidBitmask; }));
+            }
+        }
+    }
+
+    CPU_TEST(LightBVHCollapse_DetectMismatch)
+    {
+        TestBVH bvh = buildRandomBVH(1000, 1);
+        const uint32_t width = 4;
+
+        LightBVH::WideNodes wideNodes;
+        std::vector<uint64_t> bitmasks(bvh.triangleCount, kInvalidBitmask);
+        LightBVHBuilder::collapse(bvh.nodes, bvh.triangleIndices, width, wideNodes, bitmasks);
+        EXPECT(LightBVHBuilder::validateCollapse(bvh.nodes, bvh.triangleIndices, wideNodes, bitmasks));
+
+        // Find a leaf child in the wide BVH.
+        uint32_t leafSlot = 0;
+        uint32_t leafRefOffset = 0;
+        for (;; leafSlot++)
+        {
+            leafRefOffset = WideNodeLayout::getDwordOffset(width, leafSlot / width, 0, leafSlot % width);
+            const uint32_t childRef = wideNodes.data[leafRefOffset];
+            if (childRef != WideNodeLayout::kInvalidChild && (childRef & WideNodeLayout::kLeafChildFlag)) break;
+        }
+
+        // Dropping a leaf loses its triangles.
+        {
+            auto corrupted = wideNodes;
+            corrupted.data[leafRefOffset] = WideNodeLayout::kInvalidChild;
+            corrupted.childNodeIndices[leafSlot] = WideNodeLayout::kInvalidChild;
+            EXPECT(!LightBVHBuilder::validateCollapse(bvh.nodes, bvh.triangleIndices, corrupted, bitmasks));
+        }
+
+        // Referencing a different binary node.
+        {
+            auto corrupted = wideNodes;
+            const uint32_t otherLeaf = (wideNodes.childNodeIndices[leafSlot] + 1) % (uint32_t)bvh.nodes.size();
+            corrupted.data[leafRefOffset] = WideNodeLayout::kLeafChildFlag | otherLeaf;
+            corrupted.childNodeIndices[leafSlot] = otherLeaf;
+            EXPECT(!LightBVHBuilder::validateCollapse(bvh.nodes, bvh.triangleIndices, corrupted, bitmasks));
+        }
+
+        // Child attributes that differ from the binary node.
+        {
+            auto corrupted = wideNodes;
+            corrupted.data[WideNodeLayout::getDwordOffset(width, leafSlot / width, WideNodeLayout::kFieldCount - 1, leafSlot % width)] ^= 1;
+            EXPECT(!LightBVHBuilder::validateCollapse(bvh.nodes, bvh.triangleIndices, corrupted, bitmasks));
+        }
+
+        // A triangle bitmask that does not lead to the triangle.
+        {
+            auto corruptedBitmasks = bitmasks;
+            corruptedBitmasks[bvh.triangleIndices[0]] ^= 1;
+            EXPECT(!LightBVHBuilder::validateCollapse(bvh.nodes, bvh.triangleIndices, wideNodes, corruptedBitmasks));
+        }
+
+        // A triangle that is not covered by the wide BVH.
+        {
+            auto triangleIndices = bvh.triangleIndices;
+            triangleIndices.push_back(1);
+            EXPECT(!LightBVHBuilder::validateCollapse(bvh.nodes, triangleIndices, wideNodes, bitmasks));
+        }
+    }
+}
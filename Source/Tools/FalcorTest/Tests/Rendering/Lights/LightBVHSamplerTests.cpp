@@ -0,0 +1,117 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Rendering/Lights/LightBVHSampler.h"
+#include "Scene/SceneBuilder.h"
+#include "Scene/Material/StandardMaterial.h"
+
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+/** Creates a scene with an emissive mesh whose light BVH is a deep spine.
+    All triangles span the same large square in the yz-plane, so all BVH nodes have the same surface area and the collapse
+    expands the first internal child. Each spine level splits off a group of coincident triangles at decreasing distance
+    from the origin along -x, which is expanded before the rest of the spine, so the spine advances by one level per wide node.
+    \param[in] levelCount Number of spine levels.
+*/
+Scene::SharedPtr createSpineScene(const std::shared_ptr<Device>& pDevice, uint32_t levelCount)
+{
+    const float kSize = 1000.f;
+
+    std::vector<float3> positions;
+    float x = 1e-6f;
+    for (uint32_t level = 0; level < levelCount; level++, x *= 0.5f)
+    {
+        for (uint32_t i = 0; i < 8; i++)
+        {
+            positions.push_back(float3(-x, -kSize, -kSize));
+            positions.push_back(float3(-1.1f * x, kSize, -kSize));
+            positions.push_back(float3(-x, 0.f, kSize));
+        }
+    }
+
+    std::vector<uint32_t> indices(positions.size());
+    for (uint32_t i = 0; i < indices.size(); i++) indices[i] = i;
+    const std::vector<float3> normals(positions.size(), glm::normalize(float3(0.f, -1.f, 1.f)));
+
+    auto pBuilder = SceneBuilder::create(pDevice, Settings());
+
+    auto pMaterial = StandardMaterial::create(pDevice, "emissive");
+    pMaterial->setEmissionSpectralProfile(true, pBuilder->addSpectralProfileRGB(float3(1.f)));
+
+    SceneBuilder::Mesh mesh;
+    mesh.name = "spine";
+    mesh.faceCount = (uint32_t)(indices.size() / 3);
+    mesh.vertexCount = (uint32_t)positions.size();
+    mesh.indexCount = (uint32_t)indices.size();
+    mesh.pIndices = indices.data();
+    mesh.topology = Vao::Topology::TriangleList;
+    mesh.pMaterial = pMaterial;
+    mesh.positions = { positions.data(), SceneBuilder::Mesh::AttributeFrequency::Vertex };
+    mesh.normals = { normals.data(), SceneBuilder::Mesh::AttributeFrequency::Vertex };
+    mesh.mergeDuplicateVertices = false;
+
+    MeshID meshID = pBuilder->addMesh(mesh);
+    NodeID nodeID = pBuilder->addNode(SceneBuilder::Node{ "spine", rmcv::identity<rmcv::mat4>(), rmcv::identity<rmcv::mat4>() });
+    pBuilder->addMeshInstance(nodeID, meshID);
+
+    return pBuilder->getScene();
+}
+
+std::string getBVHWidthDefine(GPUUnitTestContext& ctx, const Scene::SharedPtr& pScene, uint32_t nodeWidth)
+{
+    LightBVHSampler::Options options;
+    options.buildOptions.nodeWidth = nodeWidth;
+    options.buildOptions.maxTriangleCountPerLeaf = 1;
+    options.buildOptions.splitHeuristicSelection = LightBVHBuilder::SplitHeuristic::BinnedSAH;
+    options.buildOptions.usePreintegration = false;
+
+    auto pSampler = LightBVHSampler::create(ctx.getRenderContext(), pScene, options);
+    pSampler->update(ctx.getRenderContext());
+    return pSampler->getDefines().at("_LIGHT_BVH_WIDTH");
+}
+}
+
+GPU_TEST(LightBVHSampler_WidthDefine)
+{
+    auto pShallowScene = createSpineScene(ctx.getDevice(), 4);
+    auto pDeepScene = createSpineScene(ctx.getDevice(), 40);
+
+    for (uint32_t width : { 4u, 8u })
+    {
+        // A shallow BVH is collapsed to the requested width.
+        EXPECT_EQ(getBVHWidthDefine(ctx, pShallowScene, width), std::to_string(width));
+
+        // A BVH that is too deep to be collapsed falls back to the binary layout, and the shader must traverse it as such.
+        EXPECT_EQ(getBVHWidthDefine(ctx, pDeepScene, width), "2") << "width = " << width;
+    }
+}
+} // namespace Falcor
@@ -0,0 +1,165 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Animation/Animation.h"
+#include <algorithm>
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+std::vector<Animation::Keyframe> createKeyframes(uint32_t keyframeCount, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> dist(-1.f, 1.f);
+
+    std::vector<Animation::Keyframe> keyframes(keyframeCount);
+    for (uint32_t i = 0; i < keyframeCount; i++)
+    {
+        auto& keyframe = keyframes[i];
+        keyframe.time = i * 0.1;
+        keyframe.translation = float3(dist(rng), dist(rng), dist(rng));
+        keyframe.scaling = float3(1.f + 0.5f * dist(rng));
+        keyframe.rotation = glm::normalize(glm::quat(1.f, dist(rng), dist(rng), dist(rng)));
+    }
+    return keyframes;
+}
+}
+
+CPU_TEST(Animation_Keyframes)
+{
+    const uint32_t keyframeCount = 1000;
+    auto keyframes = createKeyframes(keyframeCount, 0);
+    const double duration = keyframes.back().time;
+
+    // Add keyframes in random order, and set them in reverse order with a duplicate.
+    auto shuffled = keyframes;
+    std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(1));
+    auto pAdded = Animation::create("added", NodeID{ 0 }, duration);
+    for (const auto& keyframe : shuffled) pAdded->addKeyframe(keyframe);
+
+    auto reversed = keyframes;
+    std::reverse(reversed.begin(), reversed.end());
+    Animation::Keyframe replaced = keyframes[10];
+    replaced.translation = float3(7.f);
+    reversed.push_back(replaced);
+    auto pSet = Animation::create("set", NodeID{ 0 }, duration);
+    pSet->setKeyframes(reversed);
+
+    EXPECT_EQ(pAdded->getKeyframeCount(), keyframeCount);
+    EXPECT_EQ(pSet->getKeyframeCount(), keyframeCount);
+    EXPECT(std::is_sorted(pAdded->getKeyframeTimes().begin(), pAdded->getKeyframeTimes().end()));
+    EXPECT(pAdded->getKeyframeTimes() == pSet->getKeyframeTimes());
+
+    for (uint32_t i = 0; i < keyframeCount; i++)
+    {
+        double time = keyframes[i].time;
+        EXPECT(pAdded->doesKeyframeExists(time));
+        auto keyframe = pAdded->getKeyframe(time);
+        EXPECT_EQ(keyframe.time, time);
+        EXPECT(keyframe.translation == keyframes[i].translation) << "i = " << i;
+        EXPECT(keyframe.scaling == keyframes[i].scaling) << "i = " << i;
+        EXPECT(keyframe.rotation == keyframes[i].rotation) << "i = " << i;
+
+        float3 expected = i == 10 ? replaced.translation : keyframes[i].translation;
+        EXPECT(pSet->getKeyframe(time).translation == expected) << "i = " << i;
+    }
+
+    EXPECT(!pAdded->doesKeyframeExists(0.05));
+    bool thrown = false;
+    try
+    {
+        pAdded->getKeyframe(0.05);
+    }
+    catch (const ArgumentError&)
+    {
+        thrown = true;
+    }
+    EXPECT(thrown);
+
+    // Replacing an existing keyframe keeps the keyframe count.
+    pAdded->addKeyframe(replaced);
+    EXPECT_EQ(pAdded->getKeyframeCount(), keyframeCount);
+    EXPECT(pAdded->getKeyframe(replaced.time).translation == replaced.translation);
+}
+
+CPU_TEST(Animation_Evaluate)
+{
+    // Evaluate many animated nodes at many times, in order and at random.
+    const uint32_t animationCount = 4096;
+    const uint32_t keyframeCount = 256;
+    const uint32_t timeCount = 64;
+
+    std::vector<Animation::SharedPtr> animations(animationCount);
+    for (uint32_t i = 0; i < animationCount; i++)
+    {
+        auto keyframes = createKeyframes(keyframeCount, i);
+        animations[i] = Animation::create(std::to_string(i), NodeID{ i }, keyframes.back().time);
+        animations[i]->setKeyframes(std::move(keyframes));
+        animations[i]->setInterpolationMode(i % 2 == 0 ? Animation::InterpolationMode::Linear : Animation::InterpolationMode::Hermite);
+        animations[i]->setPostInfinityBehavior(i % 3 == 0 ? Animation::Behavior::Cycle : Animation::Behavior::Constant);
+    }
+
+    std::mt19937 rng(0);
+    std::uniform_real_distribution<double> dist(-1.0, 30.0);
+    std::vector<double> times(timeCount);
+    for (auto& time : times) time = dist(rng);
+    std::sort(times.begin(), times.end());
+
+    std::vector<rmcv::mat4> transforms;
+    for (uint32_t i = 0; i < animationCount; i++)
+    {
+        const auto& pAnimation = animations[i];
+        pAnimation->evaluate(times, transforms);
+        EXPECT_EQ(transforms.size(), timeCount);
+
+        // Random access evaluation must give the same result as sorted batch evaluation.
+        std::vector<uint32_t> order(timeCount);
+        for (uint32_t j = 0; j < timeCount; j++) order[j] = j;
+        std::shuffle(order.begin(), order.end(), rng);
+        for (uint32_t j : order)
+        {
+            EXPECT(pAnimation->animate(times[j]) == transforms[j]) << "animation = " << i << ", time = " << times[j];
+        }
+    }
+
+    // Linearly interpolated animations pass through their keyframes.
+    const auto& pLinear = animations[0];
+    const auto& keyframeTimes = pLinear->getKeyframeTimes();
+    pLinear->evaluate(keyframeTimes, transforms);
+    for (size_t k = 0; k < keyframeTimes.size(); k++)
+    {
+        float3 translation = pLinear->getKeyframe(keyframeTimes[k]).translation;
+        EXPECT_EQ(transforms[k][0][3], translation.x) << "k = " << k;
+        EXPECT_EQ(transforms[k][1][3], translation.y) << "k = " << k;
+        EXPECT_EQ(transforms[k][2][3], translation.z) << "k = " << k;
+    }
+}
+}
+}
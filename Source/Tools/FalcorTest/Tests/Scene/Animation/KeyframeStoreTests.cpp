@@ -0,0 +1,123 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Animation/KeyframeStore.h"
+#include <cstring>
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+struct Vertex
+{
+    float position[3];
+    uint32_t packedNormal;
+    float texCrd[2];
+
+    bool operator==(const Vertex& rhs) const { return std::memcmp(this, &rhs, sizeof(Vertex)) == 0; }
+};
+
+/// Create keyframes of a mesh with slowly moving positions and constant normals and texture coordinates.
+std::vector<std::vector<Vertex>> createKeyframes(uint32_t keyframeCount, uint32_t vertexCount, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> dist(-1.f, 1.f);
+
+    std::vector<std::vector<Vertex>> keyframes(keyframeCount, std::vector<Vertex>(vertexCount));
+    for (uint32_t v = 0; v < vertexCount; v++)
+    {
+        Vertex vertex = { { dist(rng), dist(rng), dist(rng) }, (uint32_t)rng(), { dist(rng), dist(rng) } };
+        for (uint32_t k = 0; k < keyframeCount; k++)
+        {
+            keyframes[k][v] = vertex;
+            for (float& p : keyframes[k][v].position) p += 0.001f * k;
+        }
+    }
+    return keyframes;
+}
+} // namespace
+
+CPU_TEST(KeyframeStore)
+{
+    auto keyframes0 = createKeyframes(20, 1000, 0);
+    auto keyframes1 = createKeyframes(3, 17, 1);
+    std::vector<std::vector<Vertex>> keyframes2(5); // Empty keyframes.
+
+    KeyframeStore store;
+    auto stream0 = store.addStream(keyframes0);
+    auto stream1 = store.addStream(keyframes1);
+    auto stream2 = store.addStream(keyframes2);
+    store.finalize();
+
+    EXPECT_EQ(store.getStreamCount(), 3);
+    EXPECT_EQ(store.getKeyframeCount(stream0), 20);
+    EXPECT_EQ(store.getKeyframeSize(stream0), 1000 * sizeof(Vertex));
+    EXPECT_EQ(store.getKeyframeCount(stream2), 5);
+    EXPECT_EQ(store.getKeyframeSize(stream2), 0);
+    EXPECT_EQ(store.getDecodedSizeInBytes(), (20 * 1000 + 3 * 17) * sizeof(Vertex));
+
+    // Data that does not change between keyframes compresses to almost nothing.
+    EXPECT_LT(store.getEncodedSizeInBytes(), store.getDecodedSizeInBytes() * 3 / 4);
+
+    // Only the first keyframe of each stream is held in host memory.
+    EXPECT_LT(store.getMemoryUsageInBytes(), 2 * (1000 + 17) * sizeof(Vertex));
+
+    // Decoding is lossless, in any order.
+    for (uint32_t k = 20; k-- > 0;)
+    {
+        EXPECT(store.decodeKeyframe<Vertex>(stream0, k) == keyframes0[k]) << "k = " << k;
+    }
+    for (uint32_t k = 0; k < 3; k++)
+    {
+        EXPECT(store.decodeKeyframe<Vertex>(stream1, k) == keyframes1[k]) << "k = " << k;
+    }
+    EXPECT(store.decodeKeyframe<Vertex>(stream2, 4).empty());
+}
+
+CPU_TEST(KeyframeStore_Incompressible)
+{
+    // Random keyframes are stored without compression and still decode exactly.
+    std::mt19937 rng(0);
+    std::vector<std::vector<uint32_t>> keyframes(4, std::vector<uint32_t>(4096));
+    for (auto& keyframe : keyframes)
+    {
+        for (auto& w : keyframe) w = rng();
+    }
+
+    KeyframeStore store;
+    auto stream = store.addStream(keyframes);
+    store.finalize();
+
+    EXPECT_LE(store.getEncodedSizeInBytes(), 4 * 4096 * sizeof(uint32_t));
+    for (uint32_t k = 0; k < 4; k++)
+    {
+        EXPECT(store.decodeKeyframe<uint32_t>(stream, k) == keyframes[k]) << "k = " << k;
+    }
+}
+} // namespace Falcor
@@ -0,0 +1,144 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/AssetCache.h"
+
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+    std::filesystem::path createTempDirectory()
+    {
+        std::random_device rd;
+        auto path = std::filesystem::temp_directory_path() / fmt::format("FalcorAssetCacheTest_{:08x}", rd());
+        std::filesystem::remove_all(path);
+        return path;
+    }
+
+    AssetCache::Key makeKey(const std::string& str)
+    {
+        return SHA1::compute(str.data(), str.size());
+    }
+
+    std::vector<uint8_t> makeData(size_t size, uint8_t seed)
+    {
+        std::vector<uint8_t> data(size);
+        for (size_t i = 0; i < size; i++) data[i] = (uint8_t)(i * 31 + seed);
+        return data;
+    }
+
+    std::filesystem::path findEntry(const std::filesystem::path& directory)
+    {
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(directory))
+        {
+            if (entry.is_regular_file()) return entry.path();
+        }
+        return {};
+    }
+}
+
+    CPU_TEST(AssetCache_ReadWrite)
+    {
+        const auto directory = createTempDirectory();
+        {
+            AssetCache cache(directory);
+            const auto keyA = makeKey("a");
+            const auto keyB = makeKey("b");
+            const auto dataA = makeData(1000, 1);
+            const auto dataB = makeData(0, 2);
+
+            EXPECT(!cache.read(keyA));
+            cache.write(keyA, dataA);
+            cache.write(keyB, dataB);
+
+            auto resultA = cache.read(keyA);
+            EXPECT(resultA && *resultA == dataA);
+            auto resultB = cache.read(keyB);
+            EXPECT(resultB && resultB->empty());
+
+            auto stats = cache.getStats();
+            EXPECT_EQ(stats.hitCount, 2);
+            EXPECT_EQ(stats.missCount, 1);
+            EXPECT_EQ(stats.bytesSaved, 1000);
+            EXPECT_EQ(stats.bytesWritten, 1000);
+
+            // Overwrite existing entry.
+            const auto dataA2 = makeData(500, 3);
+            cache.write(keyA, dataA2);
+            resultA = cache.read(keyA);
+            EXPECT(resultA && *resultA == dataA2);
+
+            cache.resetStats();
+            stats = cache.getStats();
+            EXPECT_EQ(stats.hitCount, 0);
+            EXPECT_EQ(stats.missCount, 0);
+
+            // Entries are persistent across cache instances.
+            AssetCache cache2(directory);
+            resultB = cache2.read(keyB);
+            EXPECT(resultB && resultB->empty());
+        }
+        std::filesystem::remove_all(directory);
+    }
+
+    CPU_TEST(AssetCache_Corrupted)
+    {
+        const auto directory = createTempDirectory();
+        {
+            AssetCache cache(directory);
+            const auto key = makeKey("corrupted");
+            cache.write(key, makeData(256, 4));
+
+            const auto path = findEntry(directory);
+            EXPECT(!path.empty());
+
+            // Truncated entry.
+            std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+            EXPECT(!cache.read(key));
+
+            // Invalid header.
+            {
+                std::ofstream fs(path, std::ios_base::binary | std::ios_base::in | std::ios_base::out);
+                fs.write("garbage!", 8);
+            }
+            EXPECT(!cache.read(key));
+            EXPECT_EQ(cache.getStats().missCount, 2);
+
+            // Rewriting the entry repairs it.
+            cache.write(key, makeData(256, 4));
+            auto result = cache.read(key);
+            EXPECT(result && *result == makeData(256, 4));
+        }
+        std::filesystem::remove_all(directory);
+    }
+}
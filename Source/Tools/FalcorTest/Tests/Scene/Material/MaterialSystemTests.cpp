@@ -0,0 +1,225 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Material/MaterialSystem.h"
+#include "Scene/Material/StandardMaterial.h"
+#include "Utils/Logger.h"
+#include "Utils/Timing/CpuTimer.h"
+
+namespace Falcor
+{
+    namespace
+    {
+        /** Material that modifies another material while it is being updated.
+        */
+        class ChainedMaterial : public StandardMaterial
+        {
+        public:
+            ChainedMaterial(std::shared_ptr<Device> pDevice, const std::string& name) : StandardMaterial(pDevice, name, ShadingModel::MetalRough) {}
+
+            Material::UpdateFlags update(MaterialSystem* pOwner) override
+            {
+                auto flags = StandardMaterial::update(pOwner);
+                if (pTarget)
+                {
+                    pTarget->setRoughness(pTarget->getRoughness() + 0.25f);
+                    pTarget = nullptr;
+                }
+                return flags;
+            }
+
+            StandardMaterial::SharedPtr pTarget; ///< Material to modify on the next update.
+        };
+    }
+
+    GPU_TEST(MaterialSystem_RemoveDuplicateMaterials)
+    {
+        // Create materials cycling through a small set of unique parameter combinations.
+        const uint32_t uniqueCount = 37;
+        const uint32_t materialCount = 1000;
+
+        auto pMaterialSystem = MaterialSystem::create(ctx.getDevice());
+        std::vector<StandardMaterial::SharedPtr> materials;
+        for (uint32_t i = 0; i < materialCount; i++)
+        {
+            uint32_t u = i % uniqueCount;
+            auto pMaterial = StandardMaterial::create(ctx.getDevice(), "material" + std::to_string(i));
+            pMaterial->setBaseColor(float4(u / float(uniqueCount), 0.5f, 0.25f, 1.f));
+            pMaterial->setRoughness(u % 2 == 0 ? 0.f : 1.f);
+            pMaterial->setDoubleSided(u % 3 == 0);
+            pMaterialSystem->addMaterial(pMaterial);
+            materials.push_back(pMaterial);
+        }
+
+        // Materials that compare equal have the same hash.
+        for (uint32_t i = 0; i < uniqueCount * 2; i++)
+        {
+            const auto& pA = pMaterialSystem->getMaterial(MaterialID{ i });
+            const auto& pB = pMaterialSystem->getMaterial(MaterialID{ i + uniqueCount });
+            EXPECT(pA->isEqual(pB)) << "i = " << i;
+            EXPECT(pA->getHash() == pB->getHash()) << "i = " << i;
+        }
+
+        std::vector<MaterialID> idMap;
+        size_t removed = pMaterialSystem->removeDuplicateMaterials(idMap);
+        EXPECT_EQ(removed, materialCount - uniqueCount);
+        EXPECT_EQ(pMaterialSystem->getMaterialCount(), uniqueCount);
+        EXPECT_EQ(idMap.size(), materialCount);
+
+        // Each material is replaced by the first material with the same parameters.
+        for (uint32_t i = 0; i < materialCount; i++)
+        {
+            EXPECT_EQ(idMap[i].get(), i % uniqueCount) << "i = " << i;
+            EXPECT_EQ(pMaterialSystem->getMaterial(idMap[i])->getName(), "material" + std::to_string(i % uniqueCount));
+        }
+
+        // Changes to removed materials no longer mark any material dirty.
+        pMaterialSystem->update(true);
+        materials[materialCount - 1]->setRoughness(0.5f);
+        pMaterialSystem->update(false);
+        EXPECT_EQ(pMaterialSystem->getUpdateStats().updatedMaterialCount, 0u);
+
+        // Changes to the remaining materials are still tracked.
+        materials[uniqueCount - 1]->setRoughness(0.5f);
+        pMaterialSystem->update(false);
+        EXPECT_EQ(pMaterialSystem->getUpdateStats().updatedMaterialCount, 1u);
+    }
+
+    GPU_TEST(MaterialSystem_RemoveDuplicateMaterialsPerformance)
+    {
+        // Mostly unique materials, which is the worst case for comparing every material against all unique materials.
+        const uint32_t materialCount = 20000;
+        const uint32_t duplicateCount = 100;
+        const uint32_t uniqueCount = materialCount - duplicateCount;
+
+        auto pMaterialSystem = MaterialSystem::create(ctx.getDevice());
+        for (uint32_t i = 0; i < materialCount; i++)
+        {
+            uint32_t u = i % uniqueCount;
+            auto pMaterial = StandardMaterial::create(ctx.getDevice(), "material" + std::to_string(i));
+            pMaterial->setBaseColor(float4(u / float(uniqueCount), 0.5f, 0.25f, 1.f));
+            pMaterialSystem->addMaterial(pMaterial);
+        }
+
+        std::vector<MaterialID> idMap;
+        auto startTime = CpuTimer::getCurrentTimePoint();
+        size_t removed = pMaterialSystem->removeDuplicateMaterials(idMap);
+        double duration = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+
+        EXPECT_EQ(removed, duplicateCount);
+        EXPECT_EQ(pMaterialSystem->getMaterialCount(), uniqueCount);
+        logInfo("Removed {} duplicates from {} materials in {:.1f} ms.", removed, materialCount, duration);
+    }
+
+    GPU_TEST(MaterialSystem_UpdateDirtyMaterials)
+    {
+        const uint32_t materialCount = 100;
+
+        auto pMaterialSystem = MaterialSystem::create(ctx.getDevice());
+        std::vector<StandardMaterial::SharedPtr> materials;
+        for (uint32_t i = 0; i < materialCount; i++)
+        {
+            materials.push_back(StandardMaterial::create(ctx.getDevice(), "material" + std::to_string(i)));
+            pMaterialSystem->addMaterial(materials.back());
+        }
+
+        // The initial update uploads all materials at once.
+        pMaterialSystem->update(true);
+        {
+            const auto& stats = pMaterialSystem->getUpdateStats();
+            EXPECT_EQ(stats.updatedMaterialCount, materialCount);
+            EXPECT_EQ(stats.uploadedMaterialCount, materialCount);
+            EXPECT_EQ(stats.uploadCount, 1u);
+            EXPECT_EQ(stats.uploadedBytes, materialCount * sizeof(MaterialDataBlob));
+        }
+
+        // Without changes nothing is updated.
+        pMaterialSystem->update(false);
+        {
+            const auto& stats = pMaterialSystem->getUpdateStats();
+            EXPECT_EQ(stats.updatedMaterialCount, 0u);
+            EXPECT_EQ(stats.uploadCount, 0u);
+            EXPECT_EQ(stats.uploadedBytes, 0u);
+        }
+
+        // Only changed materials are updated, and consecutive materials are uploaded together.
+        for (uint32_t i : { 50, 10, 11, 12, 97 }) materials[i]->setBaseColor(float4(0.5f));
+        materials[11]->setRoughness(0.25f);
+        auto updates = pMaterialSystem->update(false);
+        EXPECT(is_set(updates, Material::UpdateFlags::DataChanged));
+        {
+            const auto& stats = pMaterialSystem->getUpdateStats();
+            EXPECT_EQ(stats.updatedMaterialCount, 5u);
+            EXPECT_EQ(stats.uploadedMaterialCount, 5u);
+            EXPECT_EQ(stats.uploadCount, 3u);
+            EXPECT_EQ(stats.uploadedBytes, 5 * sizeof(MaterialDataBlob));
+        }
+
+        pMaterialSystem->update(false);
+        EXPECT_EQ(pMaterialSystem->getUpdateStats().updatedMaterialCount, 0u);
+    }
+
+    GPU_TEST(MaterialSystem_UpdateMaterialsMarkedDirtyDuringUpdate)
+    {
+        auto pMaterialSystem = MaterialSystem::create(ctx.getDevice());
+        auto pMaterial0 = StandardMaterial::create(ctx.getDevice(), "material0");
+        auto pChained = std::make_shared<ChainedMaterial>(ctx.getDevice(), "chained");
+        auto pMaterial2 = StandardMaterial::create(ctx.getDevice(), "material2");
+        pMaterialSystem->addMaterial(pMaterial0);
+        pMaterialSystem->addMaterial(pChained);
+        pMaterialSystem->addMaterial(pMaterial2);
+        pMaterialSystem->update(true);
+
+        // The chained material marks a material with a higher ID dirty while it is updated.
+        // The change is not lost, but uploaded on the next update.
+        pChained->setBaseColor(float4(0.5f));
+        pChained->pTarget = pMaterial2;
+        pMaterialSystem->update(false);
+        EXPECT_EQ(pMaterialSystem->getUpdateStats().updatedMaterialCount, 1u);
+        EXPECT_EQ(pMaterialSystem->getUpdateStats().uploadedMaterialCount, 1u);
+
+        pMaterialSystem->update(false);
+        EXPECT_EQ(pMaterialSystem->getUpdateStats().updatedMaterialCount, 1u);
+        EXPECT_EQ(pMaterialSystem->getUpdateStats().uploadedMaterialCount, 1u);
+
+        // The same holds for a material that has already been updated in the same update.
+        pMaterial0->setBaseColor(float4(0.25f));
+        pChained->setBaseColor(float4(0.75f));
+        pChained->pTarget = pMaterial0;
+        pMaterialSystem->update(false);
+        EXPECT_EQ(pMaterialSystem->getUpdateStats().updatedMaterialCount, 2u);
+        EXPECT_EQ(pMaterialSystem->getUpdateStats().uploadedMaterialCount, 2u);
+
+        pMaterialSystem->update(false);
+        EXPECT_EQ(pMaterialSystem->getUpdateStats().updatedMaterialCount, 1u);
+        EXPECT_EQ(pMaterialSystem->getUpdateStats().uploadedMaterialCount, 1u);
+
+        pMaterialSystem->update(false);
+        EXPECT_EQ(pMaterialSystem->getUpdateStats().updatedMaterialCount, 0u);
+    }
+}
@@ -0,0 +1,220 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/MeshletBuilder.h"
+#include "Scene/SceneCache.h"
+
+#include <algorithm>
+#include <array>
+#include <sstream>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+/** Create a regular grid mesh of size x size quads in the xy-plane facing +z.
+ */
+void createGrid(uint32_t size, std::vector<uint32_t>& indices, std::vector<float3>& positions)
+{
+    const uint32_t w = size + 1;
+    positions.resize(w * w);
+    for (uint32_t y = 0; y < w; y++)
+        for (uint32_t x = 0; x < w; x++)
+            positions[y * w + x] = float3(x, y, 0.f);
+
+    indices.clear();
+    for (uint32_t y = 0; y < size; y++)
+    {
+        for (uint32_t x = 0; x < size; x++)
+        {
+            uint32_t i = y * w + x;
+            indices.insert(indices.end(), {i, i + 1, i + w});
+            indices.insert(indices.end(), {i + 1, i + w + 1, i + w});
+        }
+    }
+}
+
+/** Return the triangles in canonical form (rotated so that the smallest index is first, which preserves winding), sorted.
+ */
+std::vector<std::array<uint32_t, 3>> getCanonicalTriangles(const std::vector<std::array<uint32_t, 3>>& triangles)
+{
+    auto result = triangles;
+    for (auto& t : result)
+        std::rotate(t.begin(), std::min_element(t.begin(), t.end()), t.end());
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+bool isCulled(const MeshletDesc& meshlet, const float3& viewPos)
+{
+    float3 d = meshlet.center - viewPos;
+    return glm::dot(d, meshlet.coneAxis) >= meshlet.coneCutoff * glm::length(d) + meshlet.radius;
+}
+} // namespace
+
+CPU_TEST(MeshletBuilder_Partition)
+{
+    std::vector<uint32_t> indices;
+    std::vector<float3> positions;
+    createGrid(40, indices, positions);
+
+    const uint32_t maxVertices = 64;
+    const uint32_t maxTriangles = 124;
+    MeshletData data = MeshletBuilder::build(7, indices.data(), indices.size(), positions, maxVertices, maxTriangles);
+    EXPECT(!data.empty());
+
+    // Each triangle must be in exactly one meshlet with its winding preserved.
+    std::vector<std::array<uint32_t, 3>> refTriangles;
+    for (size_t i = 0; i < indices.size(); i += 3)
+        refTriangles.push_back({indices[i], indices[i + 1], indices[i + 2]});
+
+    std::vector<std::array<uint32_t, 3>> triangles;
+    uint32_t vertexOffset = 0;
+    uint32_t triangleOffset = 0;
+    for (const auto& meshlet : data.meshlets)
+    {
+        EXPECT_EQ(meshlet.meshID, 7u);
+        EXPECT_EQ(meshlet.vertexOffset, vertexOffset);
+        EXPECT_EQ(meshlet.triangleOffset, triangleOffset);
+        EXPECT_GT(meshlet.getVertexCount(), 0u);
+        EXPECT_GT(meshlet.getTriangleCount(), 0u);
+        EXPECT_LE(meshlet.getVertexCount(), maxVertices);
+        EXPECT_LE(meshlet.getTriangleCount(), maxTriangles);
+        vertexOffset += meshlet.getVertexCount();
+        triangleOffset += meshlet.getTriangleCount();
+
+        for (uint32_t i = 0; i < meshlet.getTriangleCount(); i++)
+        {
+            uint3 t = MeshletBuilder::unpackTriangle(data.triangles[meshlet.triangleOffset + i]);
+            EXPECT_LT(t.x, meshlet.getVertexCount());
+            EXPECT_LT(t.y, meshlet.getVertexCount());
+            EXPECT_LT(t.z, meshlet.getVertexCount());
+            const uint32_t* pVertices = data.vertices.data() + meshlet.vertexOffset;
+            triangles.push_back({pVertices[t.x], pVertices[t.y], pVertices[t.z]});
+        }
+
+        // All vertices must be inside the bounding sphere.
+        for (uint32_t i = 0; i < meshlet.getVertexCount(); i++)
+        {
+            const float3& p = positions[data.vertices[meshlet.vertexOffset + i]];
+            EXPECT_LE(glm::length(p - meshlet.center), meshlet.radius * 1.0001f);
+        }
+
+        // The grid is flat and faces +z, so the cone is tight around +z.
+        EXPECT_GE(meshlet.coneAxis.z, 0.999f);
+        EXPECT_LE(meshlet.coneCutoff, 0.01f);
+        EXPECT(isCulled(meshlet, meshlet.center - float3(0.f, 0.f, 10.f + meshlet.radius)));
+        EXPECT(!isCulled(meshlet, meshlet.center + float3(0.f, 0.f, 10.f + meshlet.radius)));
+    }
+    EXPECT_EQ(vertexOffset, data.vertices.size());
+    EXPECT_EQ(triangleOffset, data.triangles.size());
+    EXPECT(getCanonicalTriangles(triangles) == getCanonicalTriangles(refTriangles));
+
+    // The meshlets should be reasonably full.
+    EXPECT_LE(data.meshlets.size(), 2 * refTriangles.size() / maxTriangles + 1);
+}
+
+CPU_TEST(MeshletBuilder_Cone)
+{
+    // Two triangles folded 90 degrees along the x-axis, facing +y and +z respectively.
+    std::vector<float3> positions = {{0.f, 0.f, 0.f}, {1.f, 0.f, 0.f}, {0.f, 0.f, -1.f}, {0.f, 1.f, 0.f}};
+    std::vector<uint32_t> indices = {0, 1, 2, 0, 1, 3};
+    MeshletData data = MeshletBuilder::build(0, indices.data(), indices.size(), positions);
+    EXPECT_EQ(data.meshlets.size(), 1u);
+
+    const auto& meshlet = data.meshlets[0];
+    EXPECT_EQ(meshlet.getVertexCount(), 4u);
+    EXPECT_EQ(meshlet.getTriangleCount(), 2u);
+    EXPECT_LE(glm::length(meshlet.coneAxis - glm::normalize(float3(0.f, 1.f, 1.f))), 1e-5f);
+    EXPECT_LE(std::abs(meshlet.coneCutoff - std::sqrt(0.5f)), 1e-5f);
+
+    // Opposing triangles result in a cone that is too wide for culling.
+    indices = {0, 1, 2, 0, 2, 1};
+    data = MeshletBuilder::build(0, indices.data(), indices.size(), positions);
+    EXPECT_EQ(data.meshlets.size(), 1u);
+    EXPECT_EQ(data.meshlets[0].coneCutoff, 1.f);
+    EXPECT(!isCulled(data.meshlets[0], float3(0.f, -10.f, 0.f)));
+}
+
+CPU_TEST(MeshletBuilder_Append)
+{
+    std::vector<uint32_t> indices;
+    std::vector<float3> positions;
+    createGrid(16, indices, positions);
+
+    MeshletData a = MeshletBuilder::build(0, indices.data(), indices.size(), positions, 32, 32);
+    MeshletData b = MeshletBuilder::build(1, indices.data(), indices.size(), positions, 32, 32);
+
+    MeshletData data;
+    data.append(a);
+    data.append(b);
+    EXPECT(data.meshlets.size() == a.meshlets.size() + b.meshlets.size());
+    EXPECT(data.vertices.size() == a.vertices.size() + b.vertices.size());
+    EXPECT(data.triangles.size() == a.triangles.size() + b.triangles.size());
+
+    const auto& first = data.meshlets[a.meshlets.size()];
+    EXPECT_EQ(first.meshID, 1u);
+    EXPECT_EQ(first.vertexOffset, a.vertices.size());
+    EXPECT_EQ(first.triangleOffset, a.triangles.size());
+}
+
+CPU_TEST(MeshletBuilder_Serialization)
+{
+    std::vector<uint32_t> indices;
+    std::vector<float3> positions;
+    createGrid(20, indices, positions);
+
+    MeshletData data = MeshletBuilder::build(3, indices.data(), indices.size(), positions);
+
+    std::stringstream ss;
+    SceneCache::writeMeshletData(ss, data);
+    MeshletData loaded = SceneCache::readMeshletData(ss);
+    EXPECT(loaded == data);
+
+    // Empty meshlet data.
+    std::stringstream ssEmpty;
+    SceneCache::writeMeshletData(ssEmpty, MeshletData{});
+    EXPECT(SceneCache::readMeshletData(ssEmpty).empty());
+
+    // Inconsistent meshlet data is rejected.
+    data.triangles.pop_back();
+    std::stringstream ssInvalid;
+    SceneCache::writeMeshletData(ssInvalid, data);
+    bool invalidData = false;
+    try
+    {
+        SceneCache::readMeshletData(ssInvalid);
+    }
+    catch (const RuntimeError&)
+    {
+        invalidData = true;
+    }
+    EXPECT(invalidData);
+}
+} // namespace Falcor
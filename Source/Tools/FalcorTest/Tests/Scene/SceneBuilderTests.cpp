@@ -0,0 +1,201 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/SceneBuilder.h"
+#include "Scene/Material/StandardMaterial.h"
+
+#include <random>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+struct MeshData
+{
+    std::vector<uint32_t> indices;
+    std::vector<float3> positions;
+    std::vector<float3> normals;
+    std::vector<float2> texCrds;
+};
+
+/** Creates a random indexed triangle mesh. Some vertices are duplicated so that vertex merging has work to do.
+*/
+MeshData createMeshData(uint32_t triangleCount, std::mt19937& rng)
+{
+    std::uniform_real_distribution<float> u(0.f, 1.f);
+
+    MeshData data;
+    for (uint32_t i = 0; i < triangleCount * 3; i++)
+    {
+        if (i % 4 == 3)
+        {
+            // Duplicate the previous vertex.
+            data.positions.push_back(data.positions.back());
+            data.normals.push_back(data.normals.back());
+            data.texCrds.push_back(data.texCrds.back());
+        }
+        else
+        {
+            data.positions.push_back(float3(u(rng), u(rng), u(rng)) * 10.f);
+            data.normals.push_back(glm::normalize(float3(u(rng) - 0.5f, u(rng) - 0.5f, 1.f)));
+            data.texCrds.push_back(float2(u(rng), u(rng)));
+        }
+        data.indices.push_back(i);
+    }
+    return data;
+}
+
+SceneBuilder::Mesh createMesh(const MeshData& data, const std::string& name, const Material::SharedPtr& pMaterial)
+{
+    SceneBuilder::Mesh mesh;
+    mesh.name = name;
+    mesh.faceCount = (uint32_t)(data.indices.size() / 3);
+    mesh.vertexCount = (uint32_t)data.positions.size();
+    mesh.indexCount = (uint32_t)data.indices.size();
+    mesh.pIndices = data.indices.data();
+    mesh.topology = Vao::Topology::TriangleList;
+    mesh.pMaterial = pMaterial;
+    mesh.positions = { data.positions.data(), SceneBuilder::Mesh::AttributeFrequency::Vertex };
+    mesh.normals = { data.normals.data(), SceneBuilder::Mesh::AttributeFrequency::Vertex };
+    mesh.texCrds = { data.texCrds.data(), SceneBuilder::Mesh::AttributeFrequency::Vertex };
+    return mesh;
+}
+
+/** Builds a scene with one instance of each mesh.
+    \param[in] batched Add the meshes with a single addMeshes() call instead of one addMesh() call per mesh.
+    \param[out] meshIDs The mesh IDs returned by the scene builder.
+*/
+Scene::SharedPtr buildScene(const std::shared_ptr<Device>& pDevice, const std::vector<MeshData>& meshData, SceneBuilder::Flags flags, bool batched, std::vector<MeshID>& meshIDs)
+{
+    auto pBuilder = SceneBuilder::create(pDevice, Settings(), flags);
+
+    std::vector<Material::SharedPtr> materials;
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        auto pMaterial = StandardMaterial::create(pDevice, fmt::format("material{}", i));
+        pMaterial->setBaseColor(float4(0.25f * i, 0.5f, 0.5f, 1.f));
+        materials.push_back(pMaterial);
+    }
+
+    std::vector<SceneBuilder::Mesh> meshes;
+    for (size_t i = 0; i < meshData.size(); i++)
+        meshes.push_back(createMesh(meshData[i], fmt::format("mesh{}", i), materials[i % materials.size()]));
+
+    meshIDs.clear();
+    if (batched)
+    {
+        meshIDs = pBuilder->addMeshes(meshes);
+    }
+    else
+    {
+        for (const auto& mesh : meshes)
+            meshIDs.push_back(pBuilder->addMesh(mesh));
+    }
+
+    for (size_t i = 0; i < meshIDs.size(); i++)
+    {
+        NodeID nodeID = pBuilder->addNode(SceneBuilder::Node{ fmt::format("node{}", i), rmcv::identity<rmcv::mat4>(), rmcv::identity<rmcv::mat4>() });
+        pBuilder->addMeshInstance(nodeID, meshIDs[i]);
+    }
+
+    return pBuilder->getScene();
+}
+
+std::vector<uint8_t> readBuffer(const Buffer::SharedPtr& pBuffer)
+{
+    if (!pBuffer) return {};
+    const uint8_t* pData = static_cast<const uint8_t*>(pBuffer->map(Buffer::MapType::Read));
+    std::vector<uint8_t> data(pData, pData + pBuffer->getSize());
+    pBuffer->unmap();
+    return data;
+}
+}
+
+GPU_TEST(SceneBuilder_AddMeshes)
+{
+    std::mt19937 rng(1);
+    std::vector<MeshData> meshData;
+    for (uint32_t i = 0; i < 16; i++)
+        meshData.push_back(createMeshData(1 + i * i * 5, rng));
+
+    // The reference scene adds the meshes one by one and processes them immediately.
+    std::vector<MeshID> refMeshIDs;
+    auto pRefScene = buildScene(ctx.getDevice(), meshData, SceneBuilder::Flags::Default, false, refMeshIDs);
+    ASSERT(pRefScene);
+    ASSERT_EQ(refMeshIDs.size(), meshData.size());
+
+    const auto& pRefVao = pRefScene->getMeshVao();
+    std::vector<std::vector<uint8_t>> refVertexBuffers;
+    for (uint32_t i = 0; i < pRefVao->getVertexBuffersCount(); i++)
+        refVertexBuffers.push_back(readBuffer(pRefVao->getVertexBuffer(i)));
+    const auto refIndexBuffer = readBuffer(pRefVao->getIndexBuffer());
+
+    struct Variant
+    {
+        const char* name;
+        SceneBuilder::Flags flags;
+        bool batched;
+    };
+    const Variant variants[] = {
+        { "addMeshes", SceneBuilder::Flags::Default, true },
+        { "addMesh with DeferMeshProcessing", SceneBuilder::Flags::DeferMeshProcessing, false },
+        { "addMeshes with DeferMeshProcessing", SceneBuilder::Flags::DeferMeshProcessing, true },
+    };
+
+    for (const auto& variant : variants)
+    {
+        std::vector<MeshID> meshIDs;
+        auto pScene = buildScene(ctx.getDevice(), meshData, variant.flags, variant.batched, meshIDs);
+        ASSERT(pScene) << variant.name;
+
+        EXPECT(meshIDs == refMeshIDs) << variant.name;
+        ASSERT_EQ(pScene->getMeshCount(), pRefScene->getMeshCount()) << variant.name;
+
+        for (uint32_t i = 0; i < pRefScene->getMeshCount(); i++)
+        {
+            const MeshDesc& mesh = pScene->getMesh(MeshID(i));
+            const MeshDesc& refMesh = pRefScene->getMesh(MeshID(i));
+            EXPECT_EQ(pScene->getMeshName(i), pRefScene->getMeshName(i)) << variant.name;
+            EXPECT_EQ(mesh.vertexCount, refMesh.vertexCount) << variant.name << ", mesh " << i;
+            EXPECT_EQ(mesh.indexCount, refMesh.indexCount) << variant.name << ", mesh " << i;
+            EXPECT_EQ(mesh.vbOffset, refMesh.vbOffset) << variant.name << ", mesh " << i;
+            EXPECT_EQ(mesh.ibOffset, refMesh.ibOffset) << variant.name << ", mesh " << i;
+            EXPECT_EQ(mesh.materialID, refMesh.materialID) << variant.name << ", mesh " << i;
+            EXPECT_EQ(mesh.flags, refMesh.flags) << variant.name << ", mesh " << i;
+        }
+
+        // The mesh data in the global vertex and index buffers must be identical.
+        const auto& pVao = pScene->getMeshVao();
+        ASSERT_EQ(pVao->getVertexBuffersCount(), pRefVao->getVertexBuffersCount()) << variant.name;
+        for (uint32_t i = 0; i < pVao->getVertexBuffersCount(); i++)
+            EXPECT(readBuffer(pVao->getVertexBuffer(i)) == refVertexBuffers[i]) << variant.name << ", vertex buffer " << i;
+        EXPECT(readBuffer(pVao->getIndexBuffer()) == refIndexBuffer) << variant.name;
+    }
+}
+} // namespace Falcor
@@ -0,0 +1,201 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/VertexWelder.h"
+#include "Scene/SceneBuilder.h"
+#include "Scene/Material/StandardMaterial.h"
+#include "Utils/Logger.h"
+#include "Utils/Timing/CpuTimer.h"
+
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+VertexWelder::Vertex createVertex(float3 position)
+{
+    VertexWelder::Vertex v = {};
+    v.position = position;
+    v.normal = float3(0.f, 0.f, 1.f);
+    v.tangent = float4(1.f, 0.f, 0.f, 1.f);
+    return v;
+}
+
+/** Weld the vertices and return the welded index of each input vertex.
+ */
+std::vector<uint32_t> weld(const std::vector<VertexWelder::Vertex>& input, float positionTolerance, VertexWelder::VertexList& vertices)
+{
+    VertexWelder welder(input.size(), positionTolerance);
+    std::vector<uint32_t> indices;
+    for (const auto& v : input)
+    {
+        uint32_t index = welder.find(v, vertices);
+        if (index == VertexWelder::kInvalidIndex)
+            index = welder.insert(v, vertices);
+        indices.push_back(index);
+    }
+    return indices;
+}
+} // namespace
+
+CPU_TEST(VertexWelder_Exact)
+{
+    std::vector<VertexWelder::Vertex> input;
+    for (uint32_t i = 0; i < 1000; i++)
+        input.push_back(createVertex(float3(i % 100, i % 7, 0.f)));
+
+    // Exact duplicates, including -0 vs +0, are welded.
+    input.push_back(createVertex(float3(-0.f, 0.f, 0.f)));
+
+    // Vertices differing in position or in any other attribute are kept.
+    input.push_back(createVertex(float3(1e-6f, 0.f, 0.f)));
+    VertexWelder::Vertex v = createVertex(float3(0.f));
+    v.tangent.w = -1.f;
+    input.push_back(v);
+    v = createVertex(float3(0.f));
+    v.texCrd = float2(0.5f);
+    input.push_back(v);
+    v = createVertex(float3(0.f));
+    v.boneIDs = uint4(1, 0, 0, 0);
+    input.push_back(v);
+
+    VertexWelder::VertexList vertices;
+    std::vector<uint32_t> indices = weld(input, 0.f, vertices);
+
+    // Positions (i % 100, i % 7) repeat with period 700.
+    EXPECT_EQ(vertices.size(), 700 + 4);
+    for (size_t i = 0; i < 1000; i++)
+    {
+        EXPECT_EQ(indices[i], indices[i % 700]);
+        EXPECT(VertexWelder::compareVertices(input[i], vertices[indices[i]].first));
+    }
+    EXPECT_EQ(indices[1000], indices[0]);
+    for (size_t i = 1001; i < input.size(); i++)
+        EXPECT_EQ(indices[i], 700 + (i - 1001));
+}
+
+CPU_TEST(VertexWelder_Tolerance)
+{
+    const float kTolerance = 1e-3f;
+
+    std::vector<VertexWelder::Vertex> input;
+    for (uint32_t i = 0; i < 100; i++)
+        input.push_back(createVertex(float3(i, 0.f, 0.f)));
+
+    // Perturbed copies within the tolerance are welded, also across grid cells.
+    for (uint32_t i = 0; i < 100; i++)
+        input.push_back(createVertex(float3(i + 0.9f * kTolerance, -0.9f * kTolerance, 0.5f * kTolerance)));
+
+    // Copies outside the tolerance are kept.
+    for (uint32_t i = 0; i < 100; i++)
+        input.push_back(createVertex(float3(i, 0.f, 1.5f * kTolerance)));
+
+    VertexWelder::VertexList vertices;
+    std::vector<uint32_t> indices = weld(input, kTolerance, vertices);
+
+    EXPECT_EQ(vertices.size(), 200);
+    for (uint32_t i = 0; i < 100; i++)
+    {
+        EXPECT_EQ(indices[i], i);
+        EXPECT_EQ(indices[100 + i], i);
+        EXPECT_EQ(indices[200 + i], 100 + i);
+    }
+
+    // Without tolerance, nothing is welded.
+    vertices.clear();
+    weld(input, 0.f, vertices);
+    EXPECT_EQ(vertices.size(), input.size());
+}
+
+CPU_TEST(VertexWelder_Performance)
+{
+    // Triangle list of a grid of quads where every triangle has its own vertex copies, as produced by many importers.
+    const uint32_t kGridSize = 512;
+    std::vector<VertexWelder::Vertex> input;
+    input.reserve(size_t(kGridSize) * kGridSize * 6);
+    for (uint32_t y = 0; y < kGridSize; y++)
+    {
+        for (uint32_t x = 0; x < kGridSize; x++)
+        {
+            const uint2 corners[6] = { { 0, 0 }, { 1, 0 }, { 1, 1 }, { 0, 0 }, { 1, 1 }, { 0, 1 } };
+            for (const uint2& c : corners)
+                input.push_back(createVertex(float3(x + c.x, y + c.y, 0.f) * 0.01f));
+        }
+    }
+
+    for (float tolerance : { 0.f, 1e-4f })
+    {
+        VertexWelder::VertexList vertices;
+        auto startTime = CpuTimer::getCurrentTimePoint();
+        weld(input, tolerance, vertices);
+        double duration = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+
+        EXPECT_EQ(vertices.size(), size_t(kGridSize + 1) * (kGridSize + 1)) << "tolerance = " << tolerance;
+        logInfo("Welded {} vertices to {} vertices in {:.1f} ms (position tolerance {}).", input.size(), vertices.size(), duration, tolerance);
+    }
+}
+
+GPU_TEST(VertexWelder_NoWeldAcrossAttributeIndices)
+{
+    // Two triangles with identical vertices but different original vertex indices.
+    const std::vector<uint32_t> indices = { 0, 1, 2, 3, 4, 5 };
+    const std::vector<float3> positions = { float3(0, 0, 0), float3(1, 0, 0), float3(0, 1, 0), float3(0, 0, 0), float3(1, 0, 0), float3(0, 1, 0) };
+    const std::vector<float3> normals(6, float3(0, 0, 1));
+    const std::vector<float4> tangents(6, float4(1, 0, 0, 1));
+    const std::vector<float2> texCrds = { float2(0, 0), float2(1, 0), float2(0, 1), float2(0, 0), float2(1, 0), float2(0, 1) };
+
+    SceneBuilder::Mesh mesh;
+    mesh.name = "mesh";
+    mesh.faceCount = 2;
+    mesh.vertexCount = 6;
+    mesh.indexCount = 6;
+    mesh.pIndices = indices.data();
+    mesh.topology = Vao::Topology::TriangleList;
+    mesh.pMaterial = StandardMaterial::create(ctx.getDevice(), "material");
+    mesh.positions = { positions.data(), SceneBuilder::Mesh::AttributeFrequency::Vertex };
+    mesh.normals = { normals.data(), SceneBuilder::Mesh::AttributeFrequency::Vertex };
+    mesh.tangents = { tangents.data(), SceneBuilder::Mesh::AttributeFrequency::Vertex };
+    mesh.texCrds = { texCrds.data(), SceneBuilder::Mesh::AttributeFrequency::Vertex };
+    mesh.useOriginalTangentSpace = true;
+
+    auto pBuilder = SceneBuilder::create(ctx.getDevice(), Settings(), SceneBuilder::Flags::UseHashedVertexWelding);
+
+    // Without attribute indices, the vertices are welded.
+    SceneBuilder::ProcessedMesh welded = pBuilder->processMesh(mesh);
+    EXPECT_EQ(welded.staticData.size(), 3);
+
+    // With attribute indices, each vertex keeps its original index.
+    SceneBuilder::MeshAttributeIndices attributeIndices;
+    SceneBuilder::ProcessedMesh processed = pBuilder->processMesh(mesh, &attributeIndices);
+    ASSERT_EQ(processed.staticData.size(), 6);
+    ASSERT_EQ(attributeIndices.size(), 6);
+    for (uint32_t i = 0; i < 6; i++)
+        EXPECT_EQ(attributeIndices[i].positionIdx, i);
+}
+} // namespace Falcor
@@ -92,4 +92,49 @@ GPU_TEST(NestedStructs)
 
     ctx.unmapBuffer("result");
 }
+/** Test setting nested struct members through cached paths.
+    The paths are resolved once and applied to the shader variable by offset.
+*/
+GPU_TEST(NestedStructsCachedPaths)
+{
+    ctx.createProgram("Tests/Slang/NestedStructs.cs.slang", "main");
+    ctx.allocateStructuredBuffer("result", 27);
+
+    ShaderVar var = ctx.vars().getRootVar()["CB"];
+
+    static constexpr ShaderVarName kS3("s3");
+    static constexpr ShaderVarName kS2("s2");
+    static constexpr ShaderVarName kS1("s1");
+
+    const TypedShaderVarOffset s3s2s1a = var.resolvePath({kS3, kS2, kS1, "a"});
+    const TypedShaderVarOffset s3s2s1b = var.resolvePath({kS3, kS2, kS1, "b"});
+    const TypedShaderVarOffset s2c = var.resolvePath({kS2, "c"});
+    EXPECT(s3s2s1a.isValid());
+    EXPECT(s3s2s1b.isValid());
+    EXPECT(s2c.isValid());
+    EXPECT(var[s3s2s1a].getByteOffset() == var["s3"]["s2"]["s1"]["a"].getByteOffset());
+    EXPECT(var[s2c].getByteOffset() == var["s2"]["c"].getByteOffset());
+
+    var["a"] = 1.1f;
+    var[kS3]["a"] = 17;
+    var[s3s2s1a] = float2(9.3f, 2.1f);
+    var[s3s2s1b] = 23;
+    var[kS3][kS2]["b"] = 0.99f;
+    var[s2c] = uint2(7, 3);
+
+    ctx.runProgram();
+
+    const uint32_t* result = ctx.mapBuffer<const uint32_t>("result");
+
+    EXPECT_EQ(result[0], asuint(1.1f));
+    EXPECT_EQ(result[1], 17);
+    EXPECT_EQ(result[6], asuint(9.3f));
+    EXPECT_EQ(result[7], asuint(2.1f));
+    EXPECT_EQ(result[8], 23);
+    EXPECT_EQ(result[9], asuint(0.99f));
+    EXPECT_EQ(result[25], 7);
+    EXPECT_EQ(result[26], 3);
+
+    ctx.unmapBuffer("result");
+}
 } // namespace Falcor
@@ -317,4 +317,128 @@ GPU_TEST(BufferAllocatorStructAlign)
     }
 }
 
+CPU_TEST(BufferAllocatorFreeList)
+{
+    BufferAllocator buf(16, 0, 0);
+
+    size_t offsets[4];
+    for (size_t i = 0; i < 4; i++)
+    {
+        offsets[i] = buf.allocate(64);
+        std::memset(buf.getStartPointer() + offsets[i], 0xff, 64);
+        EXPECT_EQ(offsets[i], i * 64);
+    }
+    EXPECT_EQ(buf.getSize(), 256);
+    EXPECT_EQ(buf.getFreeSize(), 0);
+
+    // Released memory is reused by smaller allocations.
+    buf.free(offsets[1], 64);
+    EXPECT_EQ(buf.getFreeSize(), 64);
+
+    size_t offset = buf.allocate(20);
+    EXPECT_EQ(offset, 64);
+    EXPECT_EQ(buf.getFreeSize(), 44);
+    const uint32_t* data = reinterpret_cast<const uint32_t*>(buf.getStartPointer());
+    for (size_t i = 0; i < 5; i++) EXPECT_EQ(data[16 + i], 0) << "i = " << i; // Reused memory is cleared.
+
+    // The remainder of the block is reused with the alignment respected.
+    offset = buf.allocate(8);
+    EXPECT_EQ(offset, 96);
+    EXPECT_EQ(buf.getFreeSize(), 36);
+
+    // Adjacent released blocks are merged.
+    buf.free(offsets[2], 64);
+    EXPECT_EQ(buf.getFreeSize(), 100);
+    offset = buf.allocate(80);
+    EXPECT_EQ(offset, 112);
+    EXPECT_EQ(buf.getFreeSize(), 20);
+
+    // Allocations that don't fit in a released block are appended.
+    buf.free(offsets[3], 64);
+    offset = buf.allocate(100);
+    EXPECT_EQ(offset, 256);
+    EXPECT_EQ(buf.getSize(), 356);
+    EXPECT_EQ(buf.getFreeSize(), 84);
+
+    // Typed allocations can be released.
+    offset = buf.allocate<float4>(4);
+    EXPECT_EQ(offset, 192);
+    EXPECT_EQ(buf.getFreeSize(), 20);
+    buf.free<float4>(offset, 4);
+    EXPECT_EQ(buf.getFreeSize(), 84);
+
+    buf.clear();
+    EXPECT_EQ(buf.getSize(), 0);
+    EXPECT_EQ(buf.getFreeSize(), 0);
+    EXPECT_EQ(buf.allocate(4), 0);
+}
+
+GPU_TEST(BufferAllocatorDirtyRanges)
+{
+    BufferAllocator buf(0, 0, 0);
+    size_t offset = buf.allocate<uint32_t>(64);
+    EXPECT_EQ(offset, 0);
+
+    // Newly allocated memory is dirty until the GPU buffer is updated.
+    EXPECT_EQ(buf.getDirtyRanges().size(), 1);
+    Buffer::SharedPtr pBuffer = buf.getGPUBuffer(ctx.getDevice().get());
+    EXPECT_EQ(pBuffer->getSize(), 256);
+    EXPECT(buf.getDirtyRanges().empty());
+
+    // Modified regions are tracked as disjoint ranges.
+    buf.set<uint32_t>(16, 1);
+    buf.set<uint32_t>(128, 2);
+    buf.set<uint32_t>(64, 3);
+    auto checkRanges = [&](std::vector<std::pair<size_t, size_t>> ref)
+    {
+        std::vector<std::pair<size_t, size_t>> ranges(buf.getDirtyRanges().begin(), buf.getDirtyRanges().end());
+        EXPECT(ranges == ref);
+    };
+    checkRanges({ { 16, 20 }, { 64, 68 }, { 128, 132 } });
+
+    // Adjacent and overlapping ranges are merged.
+    buf.set<uint32_t>(20, 4);
+    buf.modified(60, 8);
+    checkRanges({ { 16, 24 }, { 60, 68 }, { 128, 132 } });
+    buf.modified(24, 36);
+    checkRanges({ { 16, 68 }, { 128, 132 } });
+
+    // The GPU buffer holds the updated data.
+    EXPECT(buf.getGPUBuffer(ctx.getDevice().get()) == pBuffer);
+    EXPECT(buf.getDirtyRanges().empty());
+
+    const uint32_t* data = reinterpret_cast<const uint32_t*>(pBuffer->map(Buffer::MapType::Read));
+    EXPECT_EQ(data[4], 1);
+    EXPECT_EQ(data[5], 4);
+    EXPECT_EQ(data[16], 3);
+    EXPECT_EQ(data[32], 2);
+    pBuffer->unmap();
+}
+
+GPU_TEST(BufferAllocatorGrowth)
+{
+    BufferAllocator buf(0, 0, 0);
+    for (uint32_t i = 0; i < 25; i++) buf.pushBack(i);
+
+    // The first GPU buffer has the exact size.
+    Buffer::SharedPtr pBuffer = buf.getGPUBuffer(ctx.getDevice().get());
+    EXPECT_EQ(pBuffer->getSize(), 100);
+
+    // Growing the buffer reserves additional space.
+    buf.pushBack(25u);
+    pBuffer = buf.getGPUBuffer(ctx.getDevice().get());
+    EXPECT_EQ(pBuffer->getSize(), 152);
+
+    // Allocations that fit in the reserved space don't recreate the buffer.
+    for (uint32_t i = 26; i < 38; i++) buf.pushBack(i);
+    EXPECT(buf.getGPUBuffer(ctx.getDevice().get()) == pBuffer);
+
+    const uint32_t* data = reinterpret_cast<const uint32_t*>(pBuffer->map(Buffer::MapType::Read));
+    for (uint32_t i = 0; i < 38; i++)
+    {
+        EXPECT_EQ(data[i], i) << "i = " << i;
+    }
+    pBuffer->unmap();
+}
+
 } // namespace Falcor
@@ -0,0 +1,135 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Color/SpectralDatabase.h"
+#include "Core/Platform/OS.h"
+#include <atomic>
+#include <fstream>
+#include <thread>
+
+namespace Falcor
+{
+namespace
+{
+void writeFile(const std::filesystem::path& path, const std::string& text)
+{
+    std::filesystem::create_directories(path.parent_path());
+    std::ofstream(path) << text;
+}
+} // namespace
+
+CPU_TEST(SpectralDatabase)
+{
+    const auto directory = getTempFilePath();
+    writeFile(directory / "tables/emission/lamp.spd", "# Comment\n400 0.5\n500 1.25\n600 0.75\n");
+    writeFile(directory / "tables/ior/Ag.eta.spd", "380 0.1\n720 0.2\n");
+    writeFile(directory / "tables/ior/Ag.k.spd", "380 3.5\n550 3.75\n720 4\n");
+    writeFile(directory / "tables/readme.txt", "Not a spectrum.\n");
+
+    const auto path = directory / "spectra.bin";
+    SpectralDatabase::compile(directory / "tables", path);
+
+    {
+        SpectralDatabase database(path);
+        EXPECT_EQ(database.getSpectrumCount(), 3);
+        EXPECT(database.getSpectrumNames() == std::vector<std::string>({ "emission/lamp", "ior/Ag.eta", "ior/Ag.k" }));
+        EXPECT(database.hasSpectrum("ior/Ag.k"));
+        EXPECT(!database.hasSpectrum("ior/Ag"));
+        EXPECT(!database.hasSpectrum("readme"));
+        EXPECT(!database.getSpectrum("emission/missing"));
+
+        // Spectra must match the ones read from the text files.
+        for (const auto& name : database.getSpectrumNames())
+        {
+            auto spectrum = database.getSpectrum(name);
+            EXPECT(spectrum.has_value());
+            if (!spectrum) continue;
+            auto reference = PiecewiseLinearSpectrum::fromFile(directory / "tables" / (name + ".spd"));
+            EXPECT(spectrum->getWavelengths() == reference.getWavelengths()) << name;
+            EXPECT(spectrum->getValues() == reference.getValues()) << name;
+            EXPECT_EQ(spectrum->getMaxValue(), reference.getMaxValue()) << name;
+        }
+
+        auto lamp = database.getSpectrum("emission/lamp");
+        EXPECT_EQ(lamp->eval(450.f), 0.875f);
+    }
+
+    // Opening a file that is not a database must fail.
+    bool thrown = false;
+    try
+    {
+        SpectralDatabase database(directory / "tables/readme.txt");
+    }
+    catch (const RuntimeError&)
+    {
+        thrown = true;
+    }
+    EXPECT(thrown);
+
+    std::filesystem::remove_all(directory);
+}
+
+CPU_TEST(SpectralDatabase_ConcurrentCompile)
+{
+    const auto directory = getTempFilePath();
+    writeFile(directory / "tables/emission/lamp.spd", "400 0.5\n500 1.25\n600 0.75\n");
+
+    // Processes compiling the same database race to write it. All of them must succeed and leave no temporary files.
+    const auto path = directory / "spectra.bin";
+    std::vector<std::thread> threads;
+    std::atomic<uint32_t> failureCount{ 0 };
+    for (uint32_t i = 0; i < 8; i++)
+    {
+        threads.emplace_back([&]()
+        {
+            try
+            {
+                SpectralDatabase::compile(directory / "tables", path);
+            }
+            catch (const RuntimeError&)
+            {
+                failureCount++;
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    EXPECT_EQ(failureCount, 0);
+
+    SpectralDatabase database(path);
+    EXPECT(database.hasSpectrum("emission/lamp"));
+
+    uint32_t fileCount = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(directory))
+    {
+        if (entry.is_regular_file()) fileCount++;
+    }
+    EXPECT_EQ(fileCount, 1);
+
+    std::filesystem::remove_all(directory);
+}
+} // namespace Falcor
@@ -0,0 +1,203 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Image/AsyncTextureLoader.h"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+using Priority = AsyncTextureLoader::Priority;
+
+/// Helper blocking a worker thread until released.
+struct Gate
+{
+    std::promise<void> promise;
+    std::shared_future<void> future = promise.get_future().share();
+
+    void release() { promise.set_value(); }
+};
+} // namespace
+
+CPU_TEST(AsyncTextureLoader_Priority)
+{
+    std::mutex mutex;
+    std::vector<int> decodeOrder;
+    std::vector<int> uploadOrder;
+    std::atomic<int> cancelledCallbacks = 0;
+
+    // The loader is created without a device and uses stub uploads that don't create textures.
+    auto decode = [&](int value)
+    {
+        return [&, value]()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            decodeOrder.push_back(value);
+            auto upload = [&, value]()
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                uploadOrder.push_back(value);
+                return Texture::SharedPtr();
+            };
+            return AsyncTextureLoader::DecodedTexture{ upload, 0 };
+        };
+    };
+
+    Gate started;
+    Gate gate;
+
+    {
+        AsyncTextureLoader loader(nullptr, 1);
+
+        // Block the single worker so that the following requests are queued.
+        loader.submit([&]() { started.release(); gate.future.wait(); return decode(0)(); });
+        started.future.wait();
+
+        loader.submit(decode(1), {}, Priority::Low);
+        loader.submit(decode(2), {}, Priority::Normal);
+        loader.submit(decode(3), {}, Priority::High);
+        auto promoted = loader.submit(decode(4), {}, Priority::Low);
+        auto cancelled = loader.submit(decode(5), [&](Texture::SharedPtr pTexture) { if (!pTexture) cancelledCallbacks++; }, Priority::High);
+
+        loader.setPriority(promoted.id, Priority::High);
+        EXPECT(loader.cancel(cancelled.id));
+        EXPECT(cancelled.future.get() == nullptr);
+        EXPECT(!loader.cancel(cancelled.id));
+
+        gate.release();
+    }
+
+    // Requests are decoded by priority and then in submission order. The cancelled request is never decoded.
+    std::vector<int> expectedOrder = { 0, 3, 4, 2, 1 };
+    EXPECT(decodeOrder == expectedOrder);
+    EXPECT_EQ(uploadOrder.size(), expectedOrder.size());
+    EXPECT_EQ(cancelledCallbacks.load(), 1);
+}
+
+CPU_TEST(AsyncTextureLoader_HostMemoryBudget)
+{
+    const size_t kThreadCount = 4;
+    const size_t kRequestCount = 64;
+    const size_t kTextureSize = 400;
+    const size_t kBudget = 1000;
+    const size_t kBatchSize = 4;
+
+    AsyncTextureLoader loader(nullptr, kThreadCount);
+    loader.setHostMemoryBudget(kBudget);
+    loader.setMaxUploadBatchSize(kBatchSize);
+
+    std::atomic<size_t> uploadCount = 0;
+    std::vector<std::future<Texture::SharedPtr>> futures;
+    for (size_t i = 0; i < kRequestCount; i++)
+    {
+        auto decodeFunction = [&]()
+        {
+            auto pData = std::make_shared<std::vector<uint8_t>>(kTextureSize);
+            auto upload = [&, pData]()
+            {
+                // Slow stub upload so that decoded textures accumulate.
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+                uploadCount++;
+                return Texture::SharedPtr();
+            };
+            return AsyncTextureLoader::DecodedTexture{ upload, pData->size() };
+        };
+        futures.push_back(std::move(loader.submit(decodeFunction).future));
+    }
+
+    for (auto& future : futures) future.wait();
+
+    auto stats = loader.getStats();
+    EXPECT_EQ(uploadCount.load(), kRequestCount);
+    EXPECT_EQ(stats.loadedCount, kRequestCount);
+    EXPECT_EQ(stats.cancelledCount, 0);
+    EXPECT_EQ(stats.hostMemoryInUse, 0);
+    EXPECT_GE(stats.uploadBatchCount, kRequestCount / kBatchSize);
+
+    // Decoding stops when the budget is reached. Only the decodes already in progress can exceed it.
+    EXPECT_GT(stats.peakHostMemoryInUse, 0);
+    EXPECT_LT(stats.peakHostMemoryInUse, kBudget + kThreadCount * kTextureSize);
+}
+
+CPU_TEST(AsyncTextureLoader_Exceptions)
+{
+    AsyncTextureLoader loader(nullptr, 2);
+
+    std::atomic<int> failedCallbacks = 0;
+    auto callback = [&](Texture::SharedPtr pTexture)
+    {
+        if (!pTexture) failedCallbacks++;
+    };
+
+    auto decodeThrows = loader.submit([]() -> AsyncTextureLoader::DecodedTexture { throw std::runtime_error("decode"); }, callback);
+    auto uploadThrows = loader.submit(
+        []()
+        {
+            auto upload = []() -> Texture::SharedPtr { throw std::runtime_error("upload"); };
+            return AsyncTextureLoader::DecodedTexture{ upload, 16 };
+        },
+        callback
+    );
+    auto loadThrows = loader.load([]() -> Texture::SharedPtr { throw std::runtime_error("load"); }, callback);
+
+    // The exceptions are returned through the futures.
+    auto expectThrows = [&](std::future<Texture::SharedPtr>& future, const std::string& message)
+    {
+        bool thrown = false;
+        try
+        {
+            future.get();
+        }
+        catch (const std::runtime_error& e)
+        {
+            thrown = true;
+            EXPECT_EQ(std::string(e.what()), message);
+        }
+        EXPECT(thrown) << message;
+    };
+    expectThrows(decodeThrows.future, "decode");
+    expectThrows(uploadThrows.future, "upload");
+    expectThrows(loadThrows.future, "load");
+
+    // The loader keeps working afterwards.
+    auto request = loader.submit([]() { return AsyncTextureLoader::DecodedTexture{ []() { return Texture::SharedPtr(); }, 0 }; });
+    EXPECT(request.future.get() == nullptr);
+
+    auto stats = loader.getStats();
+    EXPECT_EQ(stats.failedCount, 3);
+    EXPECT_EQ(stats.loadedCount, 1);
+    EXPECT_EQ(stats.hostMemoryInUse, 0);
+    EXPECT_EQ(failedCallbacks.load(), 3);
+}
+} // namespace Falcor
@@ -0,0 +1,213 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Image/Bitmap.h"
+#include "Utils/Image/TextureManager.h"
+
+#include <fstream>
+
+namespace Falcor
+{
+namespace
+{
+void saveTestImage(const std::filesystem::path& path)
+{
+    // Save a non-constant RGBA image.
+    std::vector<uint8_t> data(64 * 64 * 4);
+    for (size_t i = 0; i < data.size(); i++)
+        data[i] = (uint8_t)(i * 7);
+
+    Bitmap::saveImage(
+        path, 64, 64, Bitmap::FileFormat::PngFile, Bitmap::ExportFlags::ExportAlpha, ResourceFormat::RGBA8Unorm, true /* top-down */,
+        data.data()
+    );
+}
+
+std::vector<std::filesystem::path> findCacheEntries(const std::filesystem::path& directory)
+{
+    std::vector<std::filesystem::path> entries;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(directory))
+    {
+        if (entry.is_regular_file() && entry.path().extension() == ".dds") entries.push_back(entry.path());
+    }
+    return entries;
+}
+} // namespace
+
+GPU_TEST(TextureManager_TextureCache)
+{
+    const auto path = getRuntimeDirectory() / "test_texture_cache.png";
+    const auto cacheDirectory = getRuntimeDirectory() / "test_texture_cache";
+    std::filesystem::remove_all(cacheDirectory);
+    saveTestImage(path);
+
+    TextureManager::TextureCacheDesc desc;
+    desc.enabled = true;
+    desc.directory = cacheDirectory;
+
+    auto loadTexture = [&](TextureManager::Stats& stats)
+    {
+        auto pTextureManager = TextureManager::create(ctx.getDevice(), 16, 1);
+        pTextureManager->setTextureCache(desc);
+        auto handle = pTextureManager->loadTexture(path, true /* mips */, false /* srgb */, ResourceBindFlags::ShaderResource, false /* async */);
+        stats = pTextureManager->getStats();
+        return pTextureManager->getTexture(handle);
+    };
+
+    // The first load decodes the image and writes the cache entry.
+    TextureManager::Stats coldStats;
+    auto pColdTexture = loadTexture(coldStats);
+    EXPECT(pColdTexture != nullptr);
+    EXPECT_EQ(coldStats.textureCacheMissCount, 1);
+    EXPECT_EQ(coldStats.textureCacheHitCount, 0);
+    EXPECT_GT(coldStats.textureCacheDiskSizeInBytes, 0);
+
+    // The second load reads the cache entry.
+    TextureManager::Stats warmStats;
+    auto pWarmTexture = loadTexture(warmStats);
+    EXPECT(pWarmTexture != nullptr);
+    EXPECT_EQ(warmStats.textureCacheMissCount, 0);
+    EXPECT_EQ(warmStats.textureCacheHitCount, 1);
+    EXPECT_EQ(warmStats.textureCacheDiskSizeInBytes, coldStats.textureCacheDiskSizeInBytes);
+
+    if (pColdTexture && pWarmTexture)
+    {
+        EXPECT(isCompressedFormat(pWarmTexture->getFormat()));
+        EXPECT_EQ((uint32_t)pWarmTexture->getFormat(), (uint32_t)pColdTexture->getFormat());
+        EXPECT_EQ(pWarmTexture->getWidth(), 64);
+        EXPECT_EQ(pWarmTexture->getHeight(), 64);
+        EXPECT_EQ(pWarmTexture->getMipCount(), 7);
+    }
+
+    // Delete the test files.
+    std::filesystem::remove(path);
+    std::filesystem::remove_all(cacheDirectory);
+}
+
+GPU_TEST(TextureManager_AsyncLoading)
+{
+    const std::filesystem::path paths[] = {
+        getRuntimeDirectory() / "test_texture_manager_async0.png",
+        getRuntimeDirectory() / "test_texture_manager_async1.png",
+        getRuntimeDirectory() / "test_texture_manager_async2.png",
+    };
+    for (const auto& path : paths)
+        saveTestImage(path);
+
+    auto pTextureManager = TextureManager::create(ctx.getDevice(), 16, 2);
+    std::vector<TextureManager::TextureHandle> handles;
+    for (const auto& path : paths)
+        handles.push_back(pTextureManager->loadTexture(path, true /* mips */, false /* srgb */));
+
+    // Changing the priority and removing textures while they may still be loading.
+    pTextureManager->setTexturePriority(handles[2], AsyncTextureLoader::Priority::High);
+    pTextureManager->removeTexture(handles[1]);
+    EXPECT(!pTextureManager->getTextureDesc(handles[1]).isValid());
+
+    pTextureManager->waitForAllTexturesLoading();
+    for (size_t i : { 0, 2 })
+    {
+        auto pTexture = pTextureManager->getTexture(handles[i]);
+        EXPECT(pTexture != nullptr) << "i = " << i;
+        if (pTexture)
+        {
+            EXPECT_EQ(pTexture->getWidth(), 64);
+            EXPECT_EQ(pTexture->getMipCount(), 7);
+        }
+    }
+
+    // Loaded textures are not affected by priority changes.
+    pTextureManager->setTexturePriority(handles[0], AsyncTextureLoader::Priority::Low);
+    EXPECT(pTextureManager->getTexture(handles[0]) != nullptr);
+
+    for (const auto& path : paths)
+        std::filesystem::remove(path);
+}
+
+GPU_TEST(TextureManager_TextureCacheCorruptEntry)
+{
+    const auto path = getRuntimeDirectory() / "test_texture_cache_corrupt.png";
+    const auto cacheDirectory = getRuntimeDirectory() / "test_texture_cache_corrupt";
+    std::filesystem::remove_all(cacheDirectory);
+    saveTestImage(path);
+
+    TextureManager::TextureCacheDesc desc;
+    desc.enabled = true;
+    desc.directory = cacheDirectory;
+
+    // Load through the deferred path, which loads the textures in parallel.
+    auto loadTexture = [&](TextureManager::Stats& stats)
+    {
+        auto pTextureManager = TextureManager::create(ctx.getDevice(), 16, 1);
+        pTextureManager->setTextureCache(desc);
+        pTextureManager->beginDeferredLoading();
+        auto handle = pTextureManager->loadTexture(path, true /* mips */, false /* srgb */);
+        pTextureManager->endDeferredLoading();
+        stats = pTextureManager->getStats();
+        return pTextureManager->getTexture(handle);
+    };
+
+    TextureManager::Stats stats;
+    EXPECT(loadTexture(stats) != nullptr);
+    EXPECT_EQ(stats.textureCacheMissCount, 1);
+
+    auto entries = findCacheEntries(cacheDirectory);
+    ASSERT_EQ(entries.size(), 1);
+
+    // Corrupt the cache entry in different ways. Each time the image is decoded again and the entry is rewritten.
+    const std::vector<std::string> corruptContents = {
+        "", "DDS ", std::string(128, '\xff'),
+    };
+    for (const auto& contents : corruptContents)
+    {
+        {
+            std::ofstream file(entries[0], std::ios::binary | std::ios::trunc);
+            file.write(contents.data(), contents.size());
+        }
+
+        auto pTexture = loadTexture(stats);
+        EXPECT(pTexture != nullptr) << "size = " << contents.size();
+        EXPECT_EQ(stats.textureCacheHitCount, 0);
+        EXPECT_EQ(stats.textureCacheMissCount, 1);
+        if (pTexture)
+        {
+            EXPECT_EQ(pTexture->getWidth(), 64);
+            EXPECT_EQ(pTexture->getMipCount(), 7);
+        }
+
+        // The rewritten entry is used by the next load.
+        EXPECT(loadTexture(stats) != nullptr);
+        EXPECT_EQ(stats.textureCacheHitCount, 1);
+        EXPECT_EQ(stats.textureCacheMissCount, 0);
+    }
+
+    // Delete the test files.
+    std::filesystem::remove(path);
+    std::filesystem::remove_all(cacheDirectory);
+}
+} // namespace Falcor
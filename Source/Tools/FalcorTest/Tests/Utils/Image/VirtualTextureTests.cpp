@@ -0,0 +1,406 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Image/VirtualTexture.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+using TileCoord = VirtualTextureLayout::TileCoord;
+
+/// Feedback buffer helper with one bit per page table entry.
+struct Feedback
+{
+    std::vector<uint32_t> bits;
+
+    Feedback(const VirtualTextureResidency& residency) : bits(residency.getFeedbackWordCount(), 0) {}
+
+    void mark(const VirtualTextureResidency& residency, VirtualTextureResidency::TextureID textureID, const TileCoord& tile)
+    {
+        uint32_t entry = residency.getDesc(textureID).pageTableOffset + residency.getLayout(textureID).getTileIndex(tile);
+        bits[entry / 32] |= 1u << (entry % 32);
+    }
+};
+
+/// Color identifying a tile, stored in all texels of the page holding the tile.
+float4 getTileColor(const TileCoord& tile)
+{
+    return float4(tile.mip, tile.x, tile.y, 1.f);
+}
+} // namespace
+
+CPU_TEST(VirtualTextureLayout)
+{
+    VirtualTextureLayout layout(1000, 600, 100, 128);
+
+    EXPECT_EQ(layout.getMipCount(), 10);
+    EXPECT_EQ(layout.getTileCountX(0), 8);
+    EXPECT_EQ(layout.getTileCountY(0), 5);
+    EXPECT_EQ(layout.getTileCountX(1), 4);
+    EXPECT_EQ(layout.getTileCountY(1), 3);
+    EXPECT_EQ(layout.getTileCountX(2), 2);
+    EXPECT_EQ(layout.getTileCountY(2), 2);
+    EXPECT_EQ(layout.getTileCount(), 40 + 12 + 4 + 7);
+
+    // Check that tile indices and coordinates map to each other.
+    for (uint32_t i = 0; i < layout.getTileCount(); i++)
+    {
+        TileCoord coord = layout.getTileCoord(i);
+        EXPECT_EQ(layout.getTileIndex(coord), i) << "i = " << i;
+    }
+
+    EXPECT_EQ(layout.getTileIndex({ 1, 0, 0 }), 40);
+    EXPECT(layout.getTileCoord(layout.getParentTileIndex(layout.getTileIndex({ 0, 7, 4 }))) == TileCoord({ 1, 3, 2 }));
+    EXPECT(layout.getTileCoord(layout.getParentTileIndex(layout.getTileIndex({ 2, 1, 1 }))) == TileCoord({ 3, 0, 0 }));
+    EXPECT_EQ(layout.getParentTileIndex(layout.getTileCount() - 1), layout.getTileCount() - 1);
+}
+
+CPU_TEST(VirtualTextureLayout_NonPowerOfTwo)
+{
+    // 257 texels with 128 texel tiles gives 3 tiles in mip 0 but only 1 tile in mip 1.
+    {
+        VirtualTextureLayout layout(257, 257, 100, 128);
+        EXPECT_EQ(layout.getTileCountX(0), 3);
+        EXPECT_EQ(layout.getTileCountX(1), 1);
+        EXPECT(layout.getTileCoord(layout.getParentTileIndex(layout.getTileIndex({ 0, 2, 2 }))) == TileCoord({ 1, 0, 0 }));
+        EXPECT(layout.getTileCoord(layout.getParentTileIndex(layout.getTileIndex({ 0, 2, 0 }))) == TileCoord({ 1, 0, 0 }));
+    }
+
+    // The parent of each tile is the tile in the next mip level containing the tile's first texel.
+    for (uint32_t tileSize : { 1u, 4u, 16u, 128u })
+    {
+        for (uint32_t width = 1; width < 300; width += 7)
+        {
+            for (uint32_t height : { 1u, 3u, 129u, 257u })
+            {
+                VirtualTextureLayout layout(width, height, 100, tileSize);
+                for (uint32_t i = 0; i < layout.getTileCount(); i++)
+                {
+                    TileCoord coord = layout.getTileCoord(i);
+                    uint32_t parentIndex = layout.getParentTileIndex(i);
+                    ASSERT_LT(parentIndex, layout.getTileCount());
+                    if (coord.mip + 1 == layout.getMipCount())
+                    {
+                        EXPECT_EQ(parentIndex, i);
+                        continue;
+                    }
+
+                    uint32_t parentMip = coord.mip + 1;
+                    uint32_t texelX = std::min(coord.x * tileSize / 2, layout.getMipWidth(parentMip) - 1);
+                    uint32_t texelY = std::min(coord.y * tileSize / 2, layout.getMipHeight(parentMip) - 1);
+                    EXPECT(layout.getTileCoord(parentIndex) == TileCoord({ parentMip, texelX / tileSize, texelY / tileSize }))
+                        << "width = " << width << ", height = " << height << ", tileSize = " << tileSize << ", i = " << i;
+                }
+            }
+        }
+    }
+
+    // Requesting every tile of a non-power-of-two texture loads all of them.
+    VirtualTexturePoolDesc poolDesc;
+    poolDesc.tileSize = 128;
+    poolDesc.pagesPerRow = 8;
+    poolDesc.pageCount = 32;
+
+    VirtualTextureResidency residency(poolDesc);
+    auto textureID = residency.addTexture(257, 385, 100);
+    const auto& layout = residency.getLayout(textureID);
+
+    std::vector<uint32_t> feedback(residency.getFeedbackWordCount(), 0);
+    for (uint32_t i = 0; i < layout.getTileCount(); i++)
+        feedback[i / 32] |= 1u << (i % 32);
+
+    auto stats = residency.update(feedback.data(), feedback.size(), [](VirtualTextureResidency::TextureID, const TileCoord&, uint32_t) {});
+    EXPECT_EQ(stats.requestedTileCount, layout.getTileCount());
+    EXPECT_EQ(stats.loadedTileCount, layout.getTileCount());
+    for (uint32_t i = 0; i < layout.getTileCount(); i++)
+        EXPECT(residency.isResident(textureID, i)) << "i = " << i;
+}
+
+CPU_TEST(VirtualTextureResidency)
+{
+    VirtualTexturePoolDesc poolDesc;
+    poolDesc.tileSize = 64;
+    poolDesc.tileBorder = 4;
+    poolDesc.pagesPerRow = 2;
+    poolDesc.pageCount = 4;
+
+    VirtualTextureResidency residency(poolDesc);
+    residency.addTexture(16, 16, 1); // Offsets the page table range of the second texture.
+    auto textureID = residency.addTexture(256, 256, 3);
+    const auto& layout = residency.getLayout(textureID);
+    EXPECT_EQ(layout.getTileCount(), 16 + 4 + 1);
+    EXPECT_EQ(residency.getDesc(textureID).pageTableOffset, 1);
+
+    std::vector<TileCoord> loaded;
+    auto loadTile = [&](VirtualTextureResidency::TextureID id, const TileCoord& tile, uint32_t page)
+    {
+        EXPECT_EQ(id, textureID);
+        EXPECT_LT(page, poolDesc.pageCount);
+        loaded.push_back(tile);
+    };
+
+    auto getEntry = [&](const TileCoord& tile) { return residency.getPageTable()[residency.getDesc(textureID).pageTableOffset + layout.getTileIndex(tile)]; };
+
+    // Nothing is resident initially.
+    auto stats = residency.update(nullptr, 0, loadTile);
+    EXPECT_EQ(stats.loadedTileCount, 0);
+    EXPECT(!getEntry({ 0, 0, 0 }).isValid());
+
+    // Requesting a tile loads it and the coarser tiles covering it, coarse to fine.
+    {
+        Feedback feedback(residency);
+        feedback.mark(residency, textureID, { 0, 0, 0 });
+        stats = residency.update(feedback.bits.data(), feedback.bits.size(), loadTile);
+    }
+    EXPECT_EQ(stats.requestedTileCount, 3);
+    EXPECT_EQ(stats.loadedTileCount, 3);
+    EXPECT_EQ(stats.evictedTileCount, 0);
+    EXPECT(stats.pageTableChanged);
+    EXPECT(loaded == std::vector<TileCoord>({ { 2, 0, 0 }, { 1, 0, 0 }, { 0, 0, 0 } }));
+
+    // Non-resident tiles fall back to the closest resident coarser tile.
+    EXPECT(getEntry({ 0, 0, 0 }).isValid());
+    EXPECT_EQ(getEntry({ 0, 0, 0 }).getMip(), 0);
+    EXPECT_EQ(getEntry({ 0, 1, 1 }).getMip(), 1);
+    EXPECT_EQ(getEntry({ 0, 1, 1 }).getPage(), getEntry({ 1, 0, 0 }).getPage());
+    EXPECT_EQ(getEntry({ 0, 3, 3 }).getMip(), 2);
+    EXPECT_EQ(getEntry({ 0, 3, 3 }).getPage(), getEntry({ 2, 0, 0 }).getPage());
+
+    // Requesting another tile fills the last free page and evicts the least recently used tile.
+    loaded.clear();
+    {
+        Feedback feedback(residency);
+        feedback.mark(residency, textureID, { 0, 3, 3 });
+        stats = residency.update(feedback.bits.data(), feedback.bits.size(), loadTile);
+    }
+    EXPECT_EQ(stats.requestedTileCount, 3);
+    EXPECT_EQ(stats.loadedTileCount, 2);
+    EXPECT_EQ(stats.evictedTileCount, 1);
+    EXPECT_EQ(stats.pendingTileCount, 0);
+    EXPECT(loaded == std::vector<TileCoord>({ { 1, 1, 1 }, { 0, 3, 3 } }));
+    EXPECT(residency.isResident(textureID, layout.getTileIndex({ 2, 0, 0 })));
+    EXPECT(!residency.isResident(textureID, layout.getTileIndex({ 1, 0, 0 })));
+    EXPECT(residency.isResident(textureID, layout.getTileIndex({ 0, 0, 0 })));
+    EXPECT_EQ(getEntry({ 0, 1, 0 }).getMip(), 2);
+    EXPECT_EQ(residency.getResidentTileCount(), 4);
+
+    // Tiles requested in the current update are never evicted.
+    loaded.clear();
+    {
+        Feedback feedback(residency);
+        feedback.mark(residency, textureID, { 0, 0, 0 });
+        feedback.mark(residency, textureID, { 0, 3, 0 });
+        feedback.mark(residency, textureID, { 0, 0, 3 });
+        feedback.mark(residency, textureID, { 0, 3, 3 });
+        stats = residency.update(feedback.bits.data(), feedback.bits.size(), loadTile);
+    }
+    EXPECT_EQ(stats.requestedTileCount, 4 + 4 + 1);
+    EXPECT_EQ(stats.loadedTileCount, 0);
+    EXPECT_EQ(stats.evictedTileCount, 0);
+    EXPECT_EQ(stats.pendingTileCount, 5);
+    EXPECT(!stats.pageTableChanged);
+    EXPECT(loaded.empty());
+}
+
+CPU_TEST(VirtualTextureResidency_LoadLimit)
+{
+    VirtualTexturePoolDesc poolDesc;
+    poolDesc.tileSize = 32;
+    poolDesc.pagesPerRow = 8;
+    poolDesc.pageCount = 64;
+
+    VirtualTextureResidency residency(poolDesc, 2);
+    auto textureID = residency.addTexture(128, 128, 1);
+
+    Feedback feedback(residency);
+    for (uint32_t y = 0; y < 4; y++)
+        for (uint32_t x = 0; x < 4; x++)
+            feedback.mark(residency, textureID, { 0, x, y });
+
+    // At most two tiles are loaded per update. The remaining requests are loaded in later updates.
+    uint32_t totalLoaded = 0;
+    for (uint32_t i = 0; i < 8; i++)
+    {
+        auto stats = residency.update(feedback.bits.data(), feedback.bits.size(), [](auto, const auto&, uint32_t) {});
+        EXPECT_EQ(stats.loadedTileCount, 2);
+        EXPECT_EQ(stats.pendingTileCount, 16 - totalLoaded - 2);
+        totalLoaded += stats.loadedTileCount;
+    }
+    EXPECT_EQ(residency.getResidentTileCount(), 16);
+}
+
+GPU_TEST(VirtualTextureSampleLevel)
+{
+    Device* pDevice = ctx.getDevice().get();
+
+    VirtualTexturePoolDesc poolDesc;
+    poolDesc.tileSize = 4;
+    poolDesc.tileBorder = 1;
+    poolDesc.pagesPerRow = 4;
+    poolDesc.pageCount = 32;
+
+    VirtualTextureResidency residency(poolDesc);
+    residency.addTexture(8, 8, 1); // Offsets the page table range of the sampled texture.
+    auto textureID = residency.addTexture(16, 16, 3);
+    const auto& layout = residency.getLayout(textureID);
+    const VirtualTextureDesc desc = residency.getDesc(textureID);
+
+    // Pool texture. Each page is filled with the color of the tile it holds, including the border.
+    const uint32_t pageSize = poolDesc.tileSize + 2 * poolDesc.tileBorder;
+    const uint32_t poolWidth = poolDesc.pagesPerRow * pageSize;
+    const uint32_t poolHeight = (poolDesc.pageCount + poolDesc.pagesPerRow - 1) / poolDesc.pagesPerRow * pageSize;
+    std::vector<float4> poolData(poolWidth * poolHeight, float4(0.f));
+    auto loadTile = [&](VirtualTextureResidency::TextureID id, const TileCoord& tile, uint32_t page)
+    {
+        EXPECT_EQ(id, textureID);
+        const uint32_t originX = (page % poolDesc.pagesPerRow) * pageSize;
+        const uint32_t originY = (page / poolDesc.pagesPerRow) * pageSize;
+        for (uint32_t y = 0; y < pageSize; y++)
+            for (uint32_t x = 0; x < pageSize; x++)
+                poolData[(originY + y) * poolWidth + originX + x] = getTileColor(tile);
+    };
+
+    Sampler::Desc samplerDesc;
+    samplerDesc.setFilterMode(Sampler::Filter::Point, Sampler::Filter::Point, Sampler::Filter::Point);
+    samplerDesc.setAddressingMode(Sampler::AddressMode::Clamp, Sampler::AddressMode::Clamp, Sampler::AddressMode::Clamp);
+    Sampler::SharedPtr pSampler = Sampler::create(pDevice, samplerDesc);
+
+    // Sample the virtual texture on the GPU. Each sample is (u, v, lod, unused).
+    std::vector<uint32_t> feedback;
+    auto sampleLevel = [&](const std::vector<float4>& samples)
+    {
+        const auto& pageTable = residency.getPageTable();
+        auto pPageTable = Buffer::createStructured(
+            pDevice, sizeof(VirtualTexturePageEntry), (uint32_t)pageTable.size(), ResourceBindFlags::ShaderResource, Buffer::CpuAccess::None,
+            pageTable.data(), false
+        );
+        auto pPool = Texture::create2D(pDevice, poolWidth, poolHeight, ResourceFormat::RGBA32Float, 1, 1, poolData.data(), ResourceBindFlags::ShaderResource);
+        std::vector<uint32_t> initialFeedback(residency.getFeedbackWordCount(), 0);
+        auto pFeedback = Buffer::create(
+            pDevice, initialFeedback.size() * sizeof(uint32_t), ResourceBindFlags::UnorderedAccess, Buffer::CpuAccess::None, initialFeedback.data()
+        );
+        auto pSamples = Buffer::createStructured(
+            pDevice, sizeof(float4), (uint32_t)samples.size(), ResourceBindFlags::ShaderResource, Buffer::CpuAccess::None, samples.data(), false
+        );
+
+        ctx.createProgram("Tests/Utils/Image/VirtualTextureTests.cs.slang", "testSampleLevel");
+        ctx.allocateStructuredBuffer("result", (uint32_t)samples.size());
+        auto var = ctx["virtualTextures"];
+        var["pool"].setBlob(poolDesc);
+        var["pageTable"] = pPageTable;
+        var["physicalPages"] = pPool;
+        var["feedback"] = pFeedback;
+        ctx["pointSampler"] = pSampler;
+        ctx["samples"] = pSamples;
+        ctx["CB"]["desc"].setBlob(desc);
+        ctx["CB"]["n"] = (uint32_t)samples.size();
+        ctx.runProgram((uint32_t)samples.size());
+
+        const uint32_t* pFeedbackData = reinterpret_cast<const uint32_t*>(pFeedback->map(Buffer::MapType::Read));
+        feedback.assign(pFeedbackData, pFeedbackData + initialFeedback.size());
+        pFeedback->unmap();
+    };
+
+    // Reference tile lookup matching VirtualTextures::sampleLevel().
+    auto getSampledTileIndex = [&](const float4& s)
+    {
+        const float u = s.x - std::floor(s.x);
+        const float v = s.y - std::floor(s.y);
+        const uint32_t mip = std::min((uint32_t)std::max(s.z, 0.f), layout.getMipCount() - 1);
+        const uint32_t x = std::min((uint32_t)(u * layout.getMipWidth(mip)) / poolDesc.tileSize, layout.getTileCountX(mip) - 1);
+        const uint32_t y = std::min((uint32_t)(v * layout.getMipHeight(mip)) / poolDesc.tileSize, layout.getTileCountY(mip) - 1);
+        return layout.getTileIndex({ mip, x, y });
+    };
+
+    // The feedback has exactly the bits of the sampled tiles set, and can be passed on to the residency manager.
+    auto checkFeedback = [&](const std::vector<float4>& samples)
+    {
+        Feedback expected(residency);
+        for (const auto& s : samples)
+            expected.mark(residency, textureID, layout.getTileCoord(getSampledTileIndex(s)));
+        ASSERT_EQ(feedback.size(), expected.bits.size());
+        for (size_t i = 0; i < feedback.size(); i++)
+            EXPECT_EQ(feedback[i], expected.bits[i]) << "i = " << i;
+    };
+
+    // Sampling falls back to the finest resident tile covering the sampled tile.
+    auto checkResults = [&](const std::vector<float4>& samples)
+    {
+        const float4* result = ctx.mapBuffer<const float4>("result");
+        for (size_t i = 0; i < samples.size(); i++)
+        {
+            uint32_t tileIndex = getSampledTileIndex(samples[i]);
+            while (!residency.isResident(textureID, tileIndex) && layout.getParentTileIndex(tileIndex) != tileIndex)
+                tileIndex = layout.getParentTileIndex(tileIndex);
+            float4 expected = residency.isResident(textureID, tileIndex) ? getTileColor(layout.getTileCoord(tileIndex)) : float4(0.f);
+            EXPECT(result[i] == expected) << "i = " << i;
+        }
+        ctx.unmapBuffer("result");
+    };
+
+    // Nothing is resident initially. Sampling returns zero but still records the sampled tiles.
+    // The samples cover wrapping texture coordinates and negative and too large levels of detail.
+    const std::vector<float4> requests = {
+        float4(0.3f, 0.6f, 0.f, 0.f),
+        float4(1.3f, 2.1f, 0.5f, 0.f),
+        float4(0.9f, 0.9f, -1.f, 0.f),
+        float4(0.7f, 0.2f, 1.f, 0.f),
+        float4(0.1f, 0.1f, 5.f, 0.f),
+    };
+    sampleLevel(requests);
+    checkFeedback(requests);
+    checkResults(requests);
+
+    // Load the requested tiles from the feedback.
+    auto stats = residency.update(feedback.data(), feedback.size(), loadTile);
+    EXPECT_GT(stats.loadedTileCount, 0u);
+    EXPECT_EQ(stats.pendingTileCount, 0u);
+
+    // Sample the center of every tile. Tiles that were not requested fall back to the resident coarser tiles.
+    std::vector<float4> samples;
+    for (uint32_t mip = 0; mip < layout.getMipCount(); mip++)
+    {
+        for (uint32_t y = 0; y < layout.getTileCountY(mip); y++)
+        {
+            for (uint32_t x = 0; x < layout.getTileCountX(mip); x++)
+            {
+                const float u = (x + 0.5f) * poolDesc.tileSize / layout.getMipWidth(mip);
+                const float v = (y + 0.5f) * poolDesc.tileSize / layout.getMipHeight(mip);
+                samples.push_back(float4(u, v, mip + 0.5f, 0.f));
+            }
+        }
+    }
+    sampleLevel(samples);
+    checkFeedback(samples);
+    checkResults(samples);
+}
+} // namespace Falcor
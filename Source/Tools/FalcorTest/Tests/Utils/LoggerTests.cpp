@@ -0,0 +1,181 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Logger.h"
+#include "Utils/Timing/CpuTimer.h"
+
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+/** Sets up the logger to write info messages to the log file only, and restores the settings afterwards.
+*/
+struct ScopedLoggerSettings
+{
+    Logger::Level verbosity = Logger::getVerbosity();
+    Logger::OutputFlags outputs = Logger::getOutputs();
+
+    ScopedLoggerSettings(uint32_t rateLimitCount, double rateLimitWindow)
+    {
+        Logger::setVerbosity(Logger::Level::Info);
+        Logger::setOutputs(Logger::OutputFlags::File);
+        Logger::setRateLimit(rateLimitCount, rateLimitWindow);
+    }
+
+    ~ScopedLoggerSettings()
+    {
+        Logger::setRateLimit(Logger::kDefaultRateLimitCount, Logger::kDefaultRateLimitWindow);
+        Logger::setOutputs(outputs);
+        Logger::setVerbosity(verbosity);
+    }
+};
+
+std::string createToken(const char* name)
+{
+    return fmt::format("{}-{}", name, std::chrono::steady_clock::now().time_since_epoch().count());
+}
+
+/** Flush the logger and read all lines of the log file containing the given token.
+*/
+std::vector<std::string> readLogLines(const std::string& token)
+{
+    Logger::flush();
+
+    std::vector<std::string> lines;
+    std::ifstream file(Logger::getLogFilePath());
+    std::string line;
+    while (std::getline(file, line))
+    {
+        if (line.find(token) != std::string::npos)
+            lines.push_back(line);
+    }
+    return lines;
+}
+
+/** Count the messages in log lines, including the suppressed messages reported in them.
+*/
+uint64_t countMessages(const std::vector<std::string>& lines)
+{
+    uint64_t count = 0;
+    for (const auto& line : lines)
+    {
+        size_t pos = line.rfind(" identical message");
+        if (pos == std::string::npos)
+        {
+            count++;
+            continue;
+        }
+        size_t start = line.rfind('[', pos);
+        count += std::stoull(line.substr(start + 1, pos - start - 1));
+    }
+    return count;
+}
+} // namespace
+
+CPU_TEST(Logger_RateLimit)
+{
+    ScopedLoggerSettings settings(4, 3600.0);
+    const std::string token = createToken("Logger_RateLimit");
+
+    for (uint32_t i = 0; i < 100; i++)
+        logInfo("{} repeated message", token);
+
+    auto lines = readLogLines(token);
+    EXPECT_EQ(lines.size(), 5);
+    if (lines.size() == 5)
+    {
+        for (uint32_t i = 0; i < 4; i++)
+            EXPECT_EQ(lines[i], fmt::format("(Info) {} repeated message", token));
+        EXPECT_EQ(lines[4], fmt::format("(Info) {} repeated message [96 identical messages suppressed]", token));
+    }
+
+    // Different messages from the same call site are never suppressed.
+    for (uint32_t i = 0; i < 100; i++)
+        logInfo("{} message {}", token, i);
+    lines = readLogLines(token + " message");
+    EXPECT_EQ(lines.size(), 100);
+    if (lines.size() == 100)
+    {
+        for (uint32_t i = 0; i < 100; i++)
+            EXPECT_EQ(lines[i], fmt::format("(Info) {} message {}", token, i));
+    }
+
+    // Identical messages interleaved with others are still rate limited.
+    for (uint32_t i = 0; i < 10; i++)
+    {
+        logInfo("{} interleaved message", token);
+        logInfo("{} interleaved message {}", token, i);
+    }
+    EXPECT_EQ(readLogLines(token + " interleaved message [").size(), 1);
+    EXPECT_EQ(countMessages(readLogLines(token + " interleaved message")), 20);
+
+    // Rate limiting can be disabled.
+    Logger::setRateLimit(0, 0.0);
+    for (uint32_t i = 0; i < 10; i++)
+        logInfo("{} unlimited message", token);
+    EXPECT_EQ(readLogLines(token + " unlimited").size(), 10);
+}
+
+CPU_TEST(Logger_Throughput)
+{
+    ScopedLoggerSettings settings(Logger::kDefaultRateLimitCount, Logger::kDefaultRateLimitWindow);
+    const uint32_t kMessagesPerThread = 20000;
+
+    for (uint32_t threadCount : {1, 2, 4, 8})
+    {
+        const std::string token = createToken(fmt::format("Logger_Throughput{}", threadCount).c_str());
+
+        auto startTime = CpuTimer::getCurrentTimePoint();
+        std::vector<std::thread> threads;
+        for (uint32_t t = 0; t < threadCount; t++)
+        {
+            threads.emplace_back(
+                [&token, t]()
+                {
+                    for (uint32_t i = 0; i < kMessagesPerThread; i++)
+                        logInfo("{} thread {} message {}", token, t, i);
+                }
+            );
+        }
+        for (auto& thread : threads)
+            thread.join();
+        double duration = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+
+        // Every message is either written or reported as suppressed.
+        EXPECT_EQ(countMessages(readLogLines(token)), threadCount * kMessagesPerThread) << "threadCount = " << threadCount;
+
+        logInfo("Logged {} messages from {} threads in {:.2f} ms.", threadCount * kMessagesPerThread, threadCount, duration);
+    }
+}
+} // namespace Falcor
@@ -0,0 +1,230 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Logger.h"
+#include "Utils/Threading.h"
+#include "Utils/Timing/Profiler.h"
+#include "Utils/Timing/TimeReport.h"
+
+#include <nlohmann/json.hpp>
+
+#include <map>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+using EventType = Profiler::CpuTrace::EventType;
+
+size_t countEvents(const Profiler::CpuTrace& trace, EventType type, const std::string& name)
+{
+    size_t count = 0;
+    for (const auto& event : trace.getEvents())
+    {
+        if (event.type == type && name == event.name)
+            count++;
+    }
+    return count;
+}
+} // namespace
+
+CPU_TEST(Profiler_CpuTraceThreads)
+{
+    const uint32_t kThreadCount = 4;
+    const uint32_t kIterations = 5000; // More than one chunk of the per-thread buffers.
+
+    // Nothing is recorded without a running trace.
+    EXPECT(!Profiler::isCpuTracing());
+    {
+        ScopedCpuProfilerEvent event("Ignored");
+    }
+    EXPECT(Profiler::endCpuTrace() == nullptr);
+
+    Profiler::startCpuTrace();
+    EXPECT(Profiler::isCpuTracing());
+
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < kThreadCount; t++)
+    {
+        threads.emplace_back(
+            [t]()
+            {
+                Profiler::setCpuThreadName("ProfilerTest " + std::to_string(t));
+                for (uint32_t i = 0; i < kIterations; i++)
+                {
+                    ScopedCpuProfilerEvent outer("Outer");
+                    ScopedCpuProfilerEvent inner(std::string("Inner"));
+                }
+            }
+        );
+    }
+    for (auto& thread : threads)
+        thread.join();
+
+    auto pTrace = Profiler::endCpuTrace();
+    EXPECT(!Profiler::isCpuTracing());
+    ASSERT(pTrace != nullptr);
+
+    // Each thread has its own track.
+    std::map<uint32_t, std::string> threadNames;
+    for (const auto& thread : pTrace->getThreads())
+        threadNames[thread.index] = thread.name;
+    EXPECT_EQ(threadNames.size(), pTrace->getThreads().size());
+
+    std::set<uint32_t> testThreads;
+    for (const auto& event : pTrace->getEvents())
+    {
+        EXPECT(threadNames.count(event.threadIndex) == 1);
+        if (std::string(event.name) == "Outer")
+            testThreads.insert(event.threadIndex);
+    }
+    EXPECT_EQ(testThreads.size(), kThreadCount);
+    for (uint32_t index : testThreads)
+        EXPECT_EQ(threadNames[index].rfind("ProfilerTest ", 0), 0) << threadNames[index];
+
+    EXPECT_EQ(countEvents(*pTrace, EventType::Span, "Outer"), kThreadCount * kIterations);
+    EXPECT_EQ(countEvents(*pTrace, EventType::Span, "Inner"), kThreadCount * kIterations);
+    EXPECT_EQ(countEvents(*pTrace, EventType::Span, "Ignored"), 0);
+
+    // Events are sorted by start time and lie within the trace.
+    double lastStartTime = 0.0;
+    for (const auto& event : pTrace->getEvents())
+    {
+        EXPECT_GE(event.startTime, lastStartTime);
+        EXPECT_LE(event.startTime + event.duration, pTrace->getDuration());
+        lastStartTime = event.startTime;
+    }
+}
+
+CPU_TEST(Profiler_CpuTraceTimeReport)
+{
+    Profiler::startCpuTrace();
+
+    TimeReport timeReport;
+    timeReport.measure("ProfilerTest stage 1");
+    timeReport.measure("ProfilerTest stage 2");
+
+    auto pTrace = Profiler::endCpuTrace();
+    ASSERT(pTrace != nullptr);
+    EXPECT_EQ(countEvents(*pTrace, EventType::Span, "ProfilerTest stage 1"), 1);
+    EXPECT_EQ(countEvents(*pTrace, EventType::Span, "ProfilerTest stage 2"), 1);
+}
+
+CPU_TEST(Profiler_CpuTraceFlows)
+{
+    Threading::start();
+
+    const uint32_t kTaskCount = 64;
+
+    Profiler::startCpuTrace();
+    {
+        ScopedCpuProfilerEvent event("Dispatch");
+        std::vector<Threading::Task> tasks;
+        for (uint32_t i = 0; i < kTaskCount; i++)
+            tasks.push_back(Threading::dispatchTask([]() { ScopedCpuProfilerEvent event("Work"); }));
+        for (auto& task : tasks)
+            task.finish();
+    }
+    auto pTrace = Profiler::endCpuTrace();
+    ASSERT(pTrace != nullptr);
+
+    // Each dispatched task has a flow from the dispatching thread to the thread executing it.
+    std::map<uint64_t, uint32_t> flowStarts;
+    std::map<uint64_t, uint32_t> flowEnds;
+    for (const auto& event : pTrace->getEvents())
+    {
+        if (event.type == EventType::FlowStart)
+            flowStarts[event.flowId]++;
+        if (event.type == EventType::FlowEnd)
+            flowEnds[event.flowId]++;
+    }
+    EXPECT_EQ(flowStarts.size(), kTaskCount);
+    EXPECT(flowStarts == flowEnds);
+    EXPECT_EQ(countEvents(*pTrace, EventType::Span, "Work"), kTaskCount);
+
+    // Check the exported Chrome trace events.
+    auto json = nlohmann::json::parse(pTrace->toJsonString());
+    ASSERT(json.contains("traceEvents"));
+    std::map<std::string, size_t> phaseCounts;
+    std::set<uint32_t> namedThreads;
+    for (const auto& e : json["traceEvents"])
+    {
+        std::string phase = e["ph"];
+        phaseCounts[phase]++;
+        if (phase == "M" && e["name"] == "thread_name")
+            namedThreads.insert(e["tid"].get<uint32_t>());
+        if (phase == "X")
+        {
+            EXPECT(e.contains("dur"));
+            EXPECT(namedThreads.count(e["tid"].get<uint32_t>()) == 1);
+        }
+        if (phase == "s" || phase == "f")
+            EXPECT(e.contains("id"));
+    }
+    size_t spanCount = 0;
+    for (const auto& event : pTrace->getEvents())
+        spanCount += event.type == EventType::Span ? 1 : 0;
+    EXPECT_EQ(phaseCounts["X"], spanCount);
+    EXPECT_EQ(phaseCounts["s"], kTaskCount);
+    EXPECT_EQ(phaseCounts["f"], kTaskCount);
+    EXPECT_EQ(namedThreads.size(), pTrace->getThreads().size());
+}
+
+CPU_TEST(Profiler_CpuTraceOverhead)
+{
+    const uint32_t kIterations = 1000000;
+
+    auto measure = [&]()
+    {
+        auto startTime = CpuTimer::getCurrentTimePoint();
+        for (uint32_t i = 0; i < kIterations; i++)
+        {
+            ScopedCpuProfilerEvent event("Overhead");
+        }
+        return CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint()) * 1e6 / kIterations;
+    };
+
+    double disabledTime = measure();
+
+    Profiler::startCpuTrace();
+    double enabledTime = measure();
+    auto pTrace = Profiler::endCpuTrace();
+    ASSERT(pTrace != nullptr);
+    EXPECT_EQ(countEvents(*pTrace, EventType::Span, "Overhead"), kIterations);
+
+    logInfo("CPU trace marker overhead: {:.1f} ns (tracing disabled), {:.1f} ns (tracing enabled).", disabledTime, enabledTime);
+
+    // The bounds are generous to leave room for debug builds and slow timers, but catch markers that lock or allocate per event.
+    EXPECT_LT(disabledTime, 50.0);
+    EXPECT_LT(enabledTime, 1000.0);
+}
+} // namespace Falcor
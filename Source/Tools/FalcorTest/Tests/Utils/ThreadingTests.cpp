@@ -0,0 +1,222 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Logger.h"
+#include "Utils/Threading.h"
+#include "Utils/Timing/CpuTimer.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Falcor
+{
+CPU_TEST(Threading_DispatchTask)
+{
+    Threading::start();
+
+    std::atomic<uint32_t> counter{0};
+    std::vector<Threading::Task> tasks;
+    for (uint32_t i = 0; i < 1000; i++)
+        tasks.push_back(Threading::dispatchTask([&counter]() { counter++; }));
+
+    for (auto& task : tasks)
+    {
+        task.finish();
+        EXPECT(!task.isRunning());
+    }
+    EXPECT_EQ(counter.load(), 1000u);
+
+    Threading::Task empty;
+    EXPECT(!empty.isValid());
+    EXPECT(!empty.isRunning());
+    empty.finish();
+}
+
+CPU_TEST(Threading_Dependencies)
+{
+    Threading::start();
+
+    for (uint32_t iter = 0; iter < 100; iter++)
+    {
+        std::atomic<uint32_t> a{0};
+        std::atomic<uint32_t> b{0};
+        uint32_t result = 0;
+
+        auto taskA = Threading::dispatchTask([&a]() { a = 1; });
+        auto taskB = Threading::dispatchTask([&b]() { b = 2; });
+        auto taskC = Threading::dispatchTask([&]() { result = a + b; }, {taskA, taskB, Threading::Task()});
+        taskC.finish();
+
+        EXPECT(!taskA.isRunning());
+        EXPECT(!taskB.isRunning());
+        EXPECT_EQ(result, 3u);
+    }
+
+    // Dependency on a task that has already finished.
+    auto taskA = Threading::dispatchTask([]() {});
+    taskA.finish();
+    bool executed = false;
+    auto taskB = Threading::dispatchTask([&executed]() { executed = true; }, {taskA});
+    taskB.finish();
+    EXPECT(executed);
+}
+
+CPU_TEST(Threading_ParallelFor)
+{
+    Threading::start();
+
+    std::vector<uint32_t> values(100000, 0);
+    Threading::parallelFor(
+        0, values.size(), 0,
+        [&values](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++)
+                values[i] += (uint32_t)i;
+        }
+    );
+    for (size_t i = 0; i < values.size(); i++)
+        EXPECT_EQ(values[i], (uint32_t)i) << "i=" << i;
+
+    // Nested parallel loops must not deadlock.
+    std::atomic<uint32_t> counter{0};
+    Threading::parallelFor(
+        0, 32, 1,
+        [&counter](size_t, size_t) { Threading::parallelFor(0, 32, 1, [&counter](size_t, size_t) { counter++; }); }
+    );
+    EXPECT_EQ(counter.load(), 32u * 32u);
+
+    // Empty range.
+    Threading::parallelFor(5, 5, 1, [](size_t, size_t) { FALCOR_UNREACHABLE(); });
+}
+
+CPU_TEST(Threading_Finish)
+{
+    Threading::start();
+
+    std::atomic<uint32_t> counter{0};
+    for (uint32_t i = 0; i < 256; i++)
+        Threading::dispatchTask([&counter]() { counter++; });
+    Threading::finish();
+    EXPECT_EQ(counter.load(), 256u);
+}
+
+CPU_TEST(Threading_Exceptions)
+{
+    Threading::start();
+
+    auto expectThrows = [&](auto&& func, const std::string& message)
+    {
+        bool thrown = false;
+        try
+        {
+            func();
+        }
+        catch (const std::runtime_error& e)
+        {
+            thrown = true;
+            EXPECT_EQ(std::string(e.what()), message);
+        }
+        EXPECT(thrown) << message;
+    };
+
+    // The exception is rethrown by every call to finish().
+    auto task = Threading::dispatchTask([]() { throw std::runtime_error("task"); });
+    expectThrows([&]() { task.finish(); }, "task");
+    expectThrows([&]() { task.finish(); }, "task");
+    EXPECT(!task.isRunning());
+
+    // Dependents of a task that threw are still executed.
+    bool executed = false;
+    auto dependent = Threading::dispatchTask([&executed]() { executed = true; }, {task});
+    dependent.finish();
+    EXPECT(executed);
+
+    // parallelFor waits for all chunks and rethrows the exception of one of them.
+    std::atomic<uint32_t> counter{0};
+    expectThrows(
+        [&]()
+        {
+            Threading::parallelFor(
+                0, 64, 1,
+                [&counter](size_t begin, size_t)
+                {
+                    counter++;
+                    if (begin % 8 == 0) throw std::runtime_error("parallelFor");
+                }
+            );
+        },
+        "parallelFor"
+    );
+    EXPECT_EQ(counter.load(), 64u);
+
+    // The pool keeps working afterwards.
+    auto after = Threading::dispatchTask([&counter]() { counter++; });
+    after.finish();
+    EXPECT_EQ(counter.load(), 65u);
+}
+
+CPU_TEST(Threading_Performance)
+{
+    Threading::start();
+
+    // Latency: round trip of dispatching a single empty task and waiting for it.
+    const uint32_t kLatencyIterations = 10000;
+    auto startTime = CpuTimer::getCurrentTimePoint();
+    for (uint32_t i = 0; i < kLatencyIterations; i++)
+        Threading::dispatchTask([]() {}).finish();
+    double latency = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint()) * 1e3 / kLatencyIterations;
+
+    // Throughput: many small tasks in flight at once.
+    const uint32_t kTaskCount = 100000;
+    std::atomic<uint32_t> counter{0};
+    std::vector<Threading::Task> tasks;
+    tasks.reserve(kTaskCount);
+    startTime = CpuTimer::getCurrentTimePoint();
+    for (uint32_t i = 0; i < kTaskCount; i++)
+        tasks.push_back(Threading::dispatchTask([&counter]() { counter++; }));
+    for (auto& task : tasks)
+        task.finish();
+    double duration = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+    EXPECT_EQ(counter.load(), kTaskCount);
+
+    // parallelFor over a range split into one chunk per index.
+    const uint32_t kChunkCount = 100000;
+    counter = 0;
+    startTime = CpuTimer::getCurrentTimePoint();
+    Threading::parallelFor(0, kChunkCount, 1, [&counter](size_t, size_t) { counter++; });
+    double parallelForDuration = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+    EXPECT_EQ(counter.load(), kChunkCount);
+
+    logInfo(
+        "Task latency: {:.2f} us. Throughput: {:.0f} tasks/s (dispatchTask), {:.0f} chunks/s (parallelFor) on {} threads.", latency,
+        kTaskCount / (duration * 1e-3), kChunkCount / (parallelForDuration * 1e-3), Threading::getThreadCount()
+    );
+}
+} // namespace Falcor
@@ -0,0 +1,160 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Algorithm/VertexCacheOptimizer.h"
+
+#include <algorithm>
+#include <array>
+#include <random>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+    /** Create a regular grid mesh of size x size quads with triangles in random order.
+    */
+    void createShuffledGrid(uint32_t size, std::vector<uint32_t>& indices, std::vector<float3>& positions)
+    {
+        const uint32_t w = size + 1;
+        positions.resize(w * w);
+        for (uint32_t y = 0; y < w; y++)
+            for (uint32_t x = 0; x < w; x++)
+                positions[y * w + x] = float3(x, y, 0.f);
+
+        std::vector<std::array<uint32_t, 3>> triangles;
+        for (uint32_t y = 0; y < size; y++)
+        {
+            for (uint32_t x = 0; x < size; x++)
+            {
+                uint32_t i = y * w + x;
+                triangles.push_back({ i, i + 1, i + w });
+                triangles.push_back({ i + 1, i + w + 1, i + w });
+            }
+        }
+
+        std::mt19937 rng;
+        std::shuffle(triangles.begin(), triangles.end(), rng);
+
+        indices.clear();
+        for (const auto& t : triangles) indices.insert(indices.end(), t.begin(), t.end());
+    }
+
+    /** Return the triangles in canonical form (rotated so that the smallest index is first, which preserves winding), sorted.
+    */
+    std::vector<std::array<uint32_t, 3>> getCanonicalTriangles(const std::vector<uint32_t>& indices, const std::vector<uint32_t>* pRemap = nullptr)
+    {
+        std::vector<std::array<uint32_t, 3>> triangles;
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            std::array<uint32_t, 3> t = { indices[i], indices[i + 1], indices[i + 2] };
+            if (pRemap) for (auto& v : t) v = (*pRemap)[v];
+            auto minIt = std::min_element(t.begin(), t.end());
+            std::rotate(t.begin(), minIt, t.end());
+            triangles.push_back(t);
+        }
+        std::sort(triangles.begin(), triangles.end());
+        return triangles;
+    }
+}
+
+CPU_TEST(VertexCacheOptimizer_Analyze)
+{
+    // Two triangles sharing an edge.
+    std::vector<uint32_t> indices = { 0, 1, 2, 2, 1, 3 };
+    auto stats = analyzeVertexCache(indices.data(), indices.size(), 4);
+    EXPECT_EQ(stats.triangleCount, 2u);
+    EXPECT_EQ(stats.vertexCount, 4u);
+    EXPECT_EQ(stats.cacheMissCount, 4u);
+    EXPECT_EQ(stats.getACMR(), 2.f);
+    EXPECT_EQ(stats.getATVR(), 1.f);
+
+    // A cache of size 3 evicts vertex 1 before the last triangle.
+    indices = { 0, 1, 2, 3, 4, 5, 0, 1, 2 };
+    stats = analyzeVertexCache(indices.data(), indices.size(), 6, 3);
+    EXPECT_EQ(stats.cacheMissCount, 9u);
+
+    VertexCacheStats sum;
+    sum += stats;
+    sum += stats;
+    EXPECT_EQ(sum.triangleCount, 6u);
+    EXPECT_EQ(sum.cacheMissCount, 18u);
+}
+
+CPU_TEST(VertexCacheOptimizer_Optimize)
+{
+    std::vector<uint32_t> indices;
+    std::vector<float3> positions;
+    createShuffledGrid(32, indices, positions);
+    const size_t vertexCount = positions.size();
+
+    const auto refTriangles = getCanonicalTriangles(indices);
+    const auto statsBefore = analyzeVertexCache(indices.data(), indices.size(), vertexCount);
+
+    // Optimize vertex cache. The set of triangles and their winding must be preserved.
+    std::vector<uint32_t> clusterOffsets;
+    optimizeVertexCache(indices.data(), indices.size(), vertexCount, kDefaultVertexCacheSize, &clusterOffsets);
+    EXPECT(getCanonicalTriangles(indices) == refTriangles);
+    EXPECT(!clusterOffsets.empty());
+    EXPECT_EQ(clusterOffsets[0], 0u);
+    EXPECT(std::is_sorted(clusterOffsets.begin(), clusterOffsets.end()));
+
+    const auto statsAfter = analyzeVertexCache(indices.data(), indices.size(), vertexCount);
+    EXPECT_EQ(statsAfter.triangleCount, statsBefore.triangleCount);
+    EXPECT_EQ(statsAfter.vertexCount, statsBefore.vertexCount);
+    EXPECT_LT(statsAfter.getACMR(), statsBefore.getACMR());
+    EXPECT_LT(statsAfter.getACMR(), 1.f);
+
+    // Optimize overdraw. This only reorders clusters so the triangles are preserved.
+    optimizeOverdraw(indices.data(), indices.size(), positions, clusterOffsets);
+    EXPECT(getCanonicalTriangles(indices) == refTriangles);
+
+    // Optimize vertex fetch. The remap table must be a permutation and vertices must be referenced in increasing order.
+    std::vector<uint32_t> originalIndices = indices;
+    auto remap = optimizeVertexFetch(indices.data(), indices.size(), vertexCount);
+    EXPECT_EQ(remap.size(), vertexCount);
+
+    std::vector<uint32_t> inverse(vertexCount, uint32_t(-1));
+    for (uint32_t i = 0; i < vertexCount; i++)
+    {
+        EXPECT_LT(remap[i], vertexCount);
+        EXPECT_EQ(inverse[remap[i]], uint32_t(-1));
+        inverse[remap[i]] = i;
+    }
+    for (size_t i = 0; i < indices.size(); i++) EXPECT_EQ(indices[i], remap[originalIndices[i]]);
+
+    uint32_t maxIndex = 0;
+    for (auto i : indices)
+    {
+        EXPECT_LE(i, maxIndex + 1);
+        maxIndex = std::max(maxIndex, i);
+    }
+
+    EXPECT(getCanonicalTriangles(indices, &inverse) == refTriangles);
+}
+}
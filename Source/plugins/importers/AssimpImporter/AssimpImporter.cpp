@@ -31,6 +31,7 @@
 #include "Utils/Logger.h"
 #include "Utils/StringUtils.h"
 #include "Utils/NumericRange.h"
+#include "Utils/Timing/Profiler.h"
 #include "Utils/Timing/TimeReport.h"
 #include "Utils/Math/Common.h"
 #include "Utils/Math/FalcorMath.h"
@@ -253,6 +254,7 @@ void createAnimation(ImporterData& data, const aiAnimation* pAiAnim, ImportMode
 
         uint32_t pos = 0, rot = 0, scale = 0;
         Animation::Keyframe keyframe;
+        std::vector<Animation::Keyframe> keyframes;
         bool done = false;
 
         auto nextKeyTime = [&]()
@@ -279,9 +281,11 @@ void createAnimation(ImporterData& data, const aiAnimation* pAiAnim, ImportMode
             done = parseAnimationChannel(pAiNode->mRotationKeys, pAiNode->mNumRotationKeys, time, rot, keyframe.rotation) && done;
             done = parseAnimationChannel(pAiNode->mScalingKeys, pAiNode->mNumScalingKeys, time, scale, keyframe.scaling) && done;
 
-            for (auto pAnimation : animations)
-                pAnimation->addKeyframe(keyframe);
+            keyframes.push_back(keyframe);
         }
+
+        for (auto pAnimation : animations)
+            pAnimation->setKeyframes(keyframes);
     }
 }
 
@@ -555,6 +559,8 @@ void createMeshes(ImporterData& data)
         std::execution::par, range.begin(), range.end(),
         [&](size_t i)
         {
+            FALCOR_PROFILE_CPU("AssimpImporter::processMesh");
+
             const aiMesh* pAiMesh = meshes[i];
             const uint32_t perFaceIndexCount = pAiMesh->mFaces[0].mNumIndices;
 
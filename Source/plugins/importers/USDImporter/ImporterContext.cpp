@@ -34,6 +34,7 @@
 #include "Utils/Color/SpectrumUtils.h"
 #include "Rendering/Materials/PLT/PLTDiffuseMaterial.h"
 #include "Utils/Settings.h"
+#include "Utils/Timing/Profiler.h"
 #include "Subdivision.h"
 
 #include <glm/gtx/matrix_decompose.hpp>
@@ -1188,6 +1189,7 @@ namespace Falcor
             std::for_each(std::execution::par, meshRange.begin(), meshRange.end(),
                 [&](size_t i)
                 {
+                    FALCOR_PROFILE_CPU("USDImporter::processMesh");
                     FALCOR_ASSERT(ctx.meshTasks[i].sampleIdx == 0);
                     processMesh(ctx.meshes[ctx.meshTasks[i].meshId], ctx);
                 }
@@ -1224,6 +1226,7 @@ namespace Falcor
                 std::for_each(std::execution::par, keyframeRange.begin(), keyframeRange.end(),
                     [&](size_t i)
                     {
+                        FALCOR_PROFILE_CPU("USDImporter::processMeshKeyframe");
                         auto& task = ctx.meshKeyframeTasks[i];
                         processMeshKeyframe(ctx.meshes[task.meshId], task.meshId, task.sampleIdx, ctx);
                     }
@@ -1288,10 +1291,7 @@ namespace Falcor
                     if (protoInstance.keyframes.size() > 0)
                     {
                         Animation::SharedPtr pAnimation = Animation::create(protoInstance.name, rootNodeID, protoInstance.keyframes.back().time);
-                        for (const auto& keyframe : protoInstance.keyframes)
-                        {
-                            pAnimation->addKeyframe(keyframe);
-                        }
+                        pAnimation->setKeyframes(protoInstance.keyframes);
                         ctx.builder.addAnimation(pAnimation);
                     }
 
@@ -1325,10 +1325,7 @@ namespace Falcor
                         std::string animationName = protoGeom.nodes[animation.targetNodeID.get()].name;
                         NodeID targetNodeID{ animation.targetNodeID.get() + protoRootID.get() };
                         Animation::SharedPtr pAnimation = Animation::create(animationName, targetNodeID, animation.keyframes.back().time);
-                        for (const auto& keyframe : animation.keyframes)
-                        {
-                            pAnimation->addKeyframe(keyframe);
-                        }
+                        pAnimation->setKeyframes(animation.keyframes);
                         ctx.builder.addAnimation(pAnimation);
                     }
 
@@ -1377,7 +1374,11 @@ namespace Falcor
             // Process collected curves.
             NumericRange<size_t> range(0, ctx.curves.size());
             std::for_each(std::execution::par, range.begin(), range.end(),
-                [&](size_t i) { processCurve(ctx.curves[i], ctx); }
+                [&](size_t i)
+                {
+                    FALCOR_PROFILE_CPU("USDImporter::processCurve");
+                    processCurve(ctx.curves[i], ctx);
+                }
             );
 
             // Add processed curves or meshes (of the first keyframe) to scene builder.
@@ -1862,11 +1863,13 @@ namespace Falcor
         // Gather keyframes
         auto pAnimation = Animation::create(xformable.GetPath().GetString(), NodeID::Invalid(), times.back() / timeCodesPerSecond);
 
+        std::vector<Animation::Keyframe> keyframes;
+        keyframes.reserve(times.size());
         for (double t : times)
         {
-            Animation::Keyframe keyframe = createKeyframe(xformAPI, t, timeCodesPerSecond);
-            pAnimation->addKeyframe(keyframe);
+            keyframes.push_back(createKeyframe(xformAPI, t, timeCodesPerSecond));
         }
+        pAnimation->setKeyframes(std::move(keyframes));
 
         NodeID nodeID = builder.addNode(makeNode(xformable.GetPath().GetString(), nodeStack.back()));
         pAnimation->setNodeID(nodeID);